@@ -92,6 +92,7 @@ VERSTR = '\\"$${VER}\\"'          # place quotes around the version string
 DEFINES += VERSION=\"$${VERSTR}\" # create a VERSION macro containing the version string
 
 SOURCES += \
+    src/applications/gqrx/bookmark_scanner.cpp \
     src/applications/gqrx/main.cpp \
     src/applications/gqrx/mainwindow.cpp \
     src/applications/gqrx/receiver.cpp \
@@ -100,10 +101,14 @@ SOURCES += \
     src/applications/gqrx/tcp_remote_control_server.cpp \
     src/applications/gqrx/tcp_remote_control_settings.cpp \
     src/dsp/afsk1200/cafsk12.cpp \
-    src/dsp/afsk1200/costabf.c \
     src/dsp/agc_impl.cpp \
+    src/dsp/audio_fifo.cpp \
     src/dsp/correct_iq_cc.cpp \
+    src/dsp/data_tap.cpp \
+    src/dsp/filter/decimator.cpp \
+    src/dsp/filter/filter_designer.cpp \
     src/dsp/filter/fir_decim.cpp \
+    src/dsp/hbf_decim.cpp \
     src/dsp/lpf.cpp \
     src/dsp/rds/decoder_impl.cc \
     src/dsp/rds/parser_impl.cc \
@@ -116,8 +121,15 @@ SOURCES += \
     src/dsp/rx_meter.cpp \
     src/dsp/rx_noise_blanker_cc.cpp \
     src/dsp/rx_rds.cpp \
-    src/dsp/sniffer_f.cpp \
+    src/dsp/rx_squelch.cpp \
+    src/dsp/rx_tone_sql.cpp \
     src/dsp/stereo_demod.cpp \
+    src/interfaces/audio_rec_sink.cpp \
+    src/interfaces/iq_file_index.cpp \
+    src/interfaces/iq_file_sink.cpp \
+    src/interfaces/iq_file_source.cpp \
+    src/interfaces/iq_ring_sink.cpp \
+    src/interfaces/iq_server.cpp \
     src/interfaces/udp_sink_f.cpp \
     src/qtgui/afsk1200win.cpp \
     src/qtgui/agc_options.cpp \
@@ -135,16 +147,20 @@ SOURCES += \
     src/qtgui/dockfft.cpp \
     src/qtgui/freqctrl.cpp \
     src/qtgui/ioconfig.cpp \
+    src/qtgui/iq_timeline.cpp \
     src/qtgui/iq_tool.cpp \
     src/qtgui/meter.cpp \
     src/qtgui/nb_options.cpp \
     src/qtgui/plotter.cpp \
     src/qtgui/qtcolorpicker.cpp \
+    src/qtgui/scan_options.cpp \
+    src/qtgui/sql_options.cpp \
     src/receivers/nbrx.cpp \
     src/receivers/receiver_base.cpp \
     src/receivers/wfmrx.cpp
 
 HEADERS += \
+    src/applications/gqrx/bookmark_scanner.h \
     src/applications/gqrx/gqrx.h \
     src/applications/gqrx/mainwindow.h \
     src/applications/gqrx/receiver.h \
@@ -152,12 +168,18 @@ HEADERS += \
     src/applications/gqrx/tcp_remote_control_server.h \
     src/applications/gqrx/tcp_remote_control_settings.h \
     src/dsp/afsk1200/cafsk12.h \
-    src/dsp/afsk1200/filter.h \
-    src/dsp/afsk1200/filter-i386.h \
     src/dsp/agc_impl.h \
+    src/dsp/audio_fifo.h \
     src/dsp/correct_iq_cc.h \
+    src/dsp/data_tap.h \
+    src/dsp/filter/decimator.h \
+    src/dsp/filter/filter_designer.h \
+    src/dsp/filter/filtercoef_hbf_70.h \
+    src/dsp/filter/filtercoef_hbf_100.h \
+    src/dsp/filter/filtercoef_hbf_140.h \
     src/dsp/filter/fir_decim.h \
     src/dsp/filter/fir_decim_coef.h \
+    src/dsp/hbf_decim.h \
     src/dsp/lpf.h \
     src/dsp/rds/api.h \
     src/dsp/rds/parser.h \
@@ -175,8 +197,16 @@ HEADERS += \
     src/dsp/rx_meter.h \
     src/dsp/rx_noise_blanker_cc.h \
     src/dsp/rx_rds.h \
-    src/dsp/sniffer_f.h \
+    src/dsp/rx_squelch.h \
+    src/dsp/rx_tone_sql.h \
+    src/dsp/spsc_ring.h \
     src/dsp/stereo_demod.h \
+    src/interfaces/audio_rec_sink.h \
+    src/interfaces/iq_file_index.h \
+    src/interfaces/iq_file_sink.h \
+    src/interfaces/iq_file_source.h \
+    src/interfaces/iq_ring_sink.h \
+    src/interfaces/iq_server.h \
     src/interfaces/udp_sink_f.h \
     src/qtgui/afsk1200win.h \
     src/qtgui/agc_options.h \
@@ -195,11 +225,14 @@ HEADERS += \
     src/qtgui/dockrxopt.h \
     src/qtgui/freqctrl.h \
     src/qtgui/ioconfig.h \
+    src/qtgui/iq_timeline.h \
     src/qtgui/iq_tool.h \
     src/qtgui/meter.h \
     src/qtgui/nb_options.h \
     src/qtgui/plotter.h \
     src/qtgui/qtcolorpicker.h \
+    src/qtgui/scan_options.h \
+    src/qtgui/sql_options.h \
     src/receivers/nbrx.h \
     src/receivers/receiver_base.h \
     src/receivers/wfmrx.h
@@ -219,7 +252,9 @@ FORMS += \
     src/qtgui/iq_tool.ui \
     src/qtgui/dockrxopt.ui \
     src/qtgui/ioconfig.ui \
-    src/qtgui/nb_options.ui
+    src/qtgui/nb_options.ui \
+    src/qtgui/scan_options.ui \
+    src/qtgui/sql_options.ui
 
 # Use pulseaudio (ps: could use equals? undocumented)
 equals(AUDIO_BACKEND, "pulseaudio"): {
@@ -0,0 +1,492 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+
+#include "bookmark_scanner.h"
+#include "qtgui/bookmarks.h"
+#include "receiver.h"
+
+#define SCAN_POLL_MS           50    /* Signal check interval while stopped. */
+#define DEFAULT_SETTLE_MS      30
+#define DEFAULT_RETUNE_MS      100
+#define DEFAULT_DWELL_S        0.0
+#define DEFAULT_HANG_S         2.0
+#define DEFAULT_PRIORITY_TAG   "Priority"
+#define DEFAULT_PRIORITY_S     2.0
+
+BookmarkScanner::BookmarkScanner(receiver *rx, QObject *parent) :
+    QObject(parent),
+    rx(rx)
+{
+    state = SCAN_IDLE;
+    resume_state = SCAN_IDLE;
+    holding = false;
+    current = -1;
+    next = 0;
+    stopped_on = -1;
+    hw_freq = 0;
+    lnb_lo = 0;
+    hw_start = 0;
+    hw_stop = 0;
+    scan_ms = 0;
+    checks = 0;
+    rate = 0.f;
+
+    settle_ms = DEFAULT_SETTLE_MS;
+    retune_ms = DEFAULT_RETUNE_MS;
+    dwell_s = DEFAULT_DWELL_S;
+    hang_s = DEFAULT_HANG_S;
+    priority_tag = DEFAULT_PRIORITY_TAG;
+    priority_s = DEFAULT_PRIORITY_S;
+
+    timer.setSingleShot(true);
+    timer.setTimerType(Qt::PreciseTimer);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(step()));
+
+    connect(&Bookmarks::Get(), SIGNAL(BookmarksChanged()),
+            this, SLOT(updateChannels()));
+    connect(&Bookmarks::Get(), SIGNAL(TagListChanged()),
+            this, SLOT(updateChannels()));
+}
+
+/*! \brief Set the time to wait before checking a channel.
+ *
+ * The first half lets the samples of the previous channel drain from the
+ * DSP chain, the second half is used to average the power in the channel.
+ */
+void BookmarkScanner::setSettleTime(int settle_ms)
+{
+    this->settle_ms = qMax(2, settle_ms);
+}
+
+/*! \brief Set the additional time to wait after retuning the hardware. */
+void BookmarkScanner::setRetuneTime(int retune_ms)
+{
+    this->retune_ms = qMax(0, retune_ms);
+}
+
+/*! \brief Set the longest time to stay on an active channel, 0 for no limit. */
+void BookmarkScanner::setDwellTime(double dwell_s)
+{
+    this->dwell_s = dwell_s;
+}
+
+/*! \brief Set the time to stay on a channel after the signal has gone. */
+void BookmarkScanner::setHangTime(double hang_s)
+{
+    this->hang_s = hang_s;
+}
+
+/*! \brief Set the bookmark tag of the priority channels. */
+void BookmarkScanner::setPriorityTag(const QString &tag)
+{
+    if (tag == priority_tag)
+        return;
+
+    priority_tag = tag;
+    updateChannels();
+}
+
+/*! \brief Set how often the priority channels are checked, 0 to disable. */
+void BookmarkScanner::setPriorityInterval(double interval_s)
+{
+    priority_s = interval_s;
+}
+
+/*! \brief Start scanning.
+ *  \param hw_freq The current hardware frequency in Hz.
+ *  \param lnb_lo The LNB LO frequency in Hz.
+ *  \param hw_start The lowest hardware frequency in Hz.
+ *  \param hw_stop The highest hardware frequency in Hz.
+ *  \return False if none of the active bookmarks can be reached.
+ *
+ * Scanning starts with the first channel above the current frequency.
+ */
+bool BookmarkScanner::start(qint64 hw_freq, qint64 lnb_lo, qint64 hw_start,
+                            qint64 hw_stop)
+{
+    stop();
+
+    this->hw_freq = hw_freq;
+    this->lnb_lo = lnb_lo;
+    this->hw_start = hw_start;
+    this->hw_stop = hw_stop;
+
+    current = -1;
+    stopped_on = -1;
+    pending_priority.clear();
+    updateChannels();
+    if (channels.isEmpty())
+        return false;
+
+    qint64 rx_freq = lnb_lo + hw_freq + (qint64)rx->get_filter_offset();
+
+    next = 0;
+    while (next < channels.size() && channels[next].frequency <= rx_freq)
+        next++;
+    next %= channels.size();
+
+    holding = false;
+    checks = 0;
+    scan_ms = 0;
+    rate = 0.f;
+    scan_clock.start();
+    rate_clock.start();
+    priority_clock.start();
+
+    state = SCAN_FLUSH;
+    nextChannel();
+
+    return isRunning();
+}
+
+/*! \brief Stop scanning and stay on the current channel. */
+void BookmarkScanner::stop()
+{
+    if (state == SCAN_IDLE)
+        return;
+
+    timer.stop();
+    state = SCAN_IDLE;
+    holding = false;
+    stopped_on = -1;
+    pending_priority.clear();
+
+    emit stopped();
+}
+
+/*! \brief Rebuild the channel list from the active bookmarks. */
+void BookmarkScanner::updateChannels()
+{
+    Bookmarks  &bookmarks = Bookmarks::Get();
+    qint64      current_freq = (current >= 0) ? channels[current].frequency : 0;
+    qint64      stopped_freq = (stopped_on >= 0) ? channels[stopped_on].frequency : 0;
+
+    channels.clear();
+    for (int i = 0; i < bookmarks.size(); i++)
+    {
+        const BookmarkInfo &info = bookmarks.getBookmark(i);
+        qint64 rf = info.frequency - lnb_lo;
+
+        if (!info.IsActive() || rf < hw_start || rf > hw_stop)
+            continue;
+
+        channel ch;
+        ch.frequency = info.frequency;
+        ch.name = info.name;
+        ch.priority = false;
+        for (int t = 0; t < info.tags.size(); t++)
+            if (info.tags[t]->name == priority_tag)
+                ch.priority = true;
+
+        channels.append(ch);
+    }
+
+    std::sort(channels.begin(), channels.end());
+    current = findChannel(current_freq);
+
+    if (state == SCAN_IDLE)
+        return;
+
+    if (channels.isEmpty())
+    {
+        stop();
+        return;
+    }
+
+    // carry on from where we were, the pending priority checks are redone
+    pending_priority.clear();
+    next = 0;
+    while (next < channels.size() && channels[next].frequency <= current_freq)
+        next++;
+    next %= channels.size();
+
+    if (stopped_on >= 0)
+    {
+        stopped_on = findChannel(stopped_freq);
+        if (stopped_on < 0)
+            setActive(false);
+    }
+
+    // the channel we are on has been removed
+    if (current < 0)
+    {
+        if (stopped_on < 0)
+            setActive(false);
+        nextChannel();
+    }
+}
+
+/*! \brief Index of the channel with the given frequency, or -1. */
+int BookmarkScanner::findChannel(qint64 frequency) const
+{
+    for (int i = 0; i < channels.size(); i++)
+        if (channels[i].frequency == frequency)
+            return i;
+
+    return -1;
+}
+
+/*! \brief Advance the state machine, called from the timer. */
+void BookmarkScanner::step()
+{
+    bool    signal;
+    qint64  dwell_ms = (qint64)(dwell_s * 1000.0);
+
+    switch (state)
+    {
+    case SCAN_FLUSH:
+        // the previous channel has drained, start averaging this one
+        rx->reset_sql_power();
+        state = SCAN_MEASURE;
+        timer.start(settle_ms / 2);
+        break;
+
+    case SCAN_MEASURE:
+        signal = rx->get_sql_signal();
+
+        if (stopped_on < 0)
+        {
+            checks++;
+            if (signal)
+                setActive(true);
+            else
+                nextChannel();
+        }
+        else if (current != stopped_on)
+        {
+            // priority check while stopped on another channel
+            if (signal)
+            {
+                stopped_on = -1;
+                pending_priority.clear();
+                active_clock.restart();
+                state = SCAN_ACTIVE;
+                emit activeChanged(true, channels[current].name);
+                timer.start(SCAN_POLL_MS);
+            }
+            else
+            {
+                nextChannel();
+            }
+        }
+        else
+        {
+            // back on the active channel after the priority checks
+            stopped_on = -1;
+            if (signal)
+                state = SCAN_ACTIVE;
+            else
+            {
+                if (resume_state != SCAN_HANG)
+                    hang_clock.restart();
+                state = SCAN_HANG;
+            }
+            timer.start(SCAN_POLL_MS);
+        }
+        break;
+
+    case SCAN_ACTIVE:
+    case SCAN_HANG:
+        signal = rx->get_sql_signal();
+
+        if (signal)
+            state = SCAN_ACTIVE;
+        else if (state == SCAN_ACTIVE)
+        {
+            state = SCAN_HANG;
+            hang_clock.restart();
+        }
+
+        if ((state == SCAN_HANG && hang_clock.elapsed() >= hang_s * 1000.0) ||
+            (dwell_ms > 0 && active_clock.elapsed() >= dwell_ms))
+        {
+            setActive(false);
+            nextChannel();
+        }
+        else if (!channels[current].priority && priorityDue())
+        {
+            startPriorityCheck();
+        }
+        else
+        {
+            timer.start(SCAN_POLL_MS);
+        }
+        break;
+
+    case SCAN_IDLE:
+        break;
+    }
+
+    updateRate();
+}
+
+/*! \brief Tune to a channel.
+ *  \return The time to wait before checking the channel in ms, or -1 if
+ *          the channel can not be reached.
+ *
+ * Only the filter offset is changed if the channel is within 90% of the
+ * current band, like for remote frequency changes.
+ */
+int BookmarkScanner::tuneChannel(int index)
+{
+    qint64  rf = channels[index].frequency - lnb_lo;
+    qint64  max_offset = (qint64)(0.45 * rx->get_quad_rate());
+    qint64  offset = rf - hw_freq;
+    int     delay = settle_ms;
+
+    if (qAbs(offset) > max_offset)
+    {
+        // the center frequency of an I/Q file is fixed
+        if (rx->is_playing_iq())
+            return -1;
+
+        hw_freq = qBound(hw_start, rf + max_offset, hw_stop);
+        offset = rf - hw_freq;
+        if (qAbs(offset) > max_offset)
+            return -1;
+
+        rx->set_rf_freq((double)hw_freq);
+        delay += retune_ms;
+    }
+
+    rx->set_filter_offset((double)offset);
+
+    emit tuned(channels[index].frequency, hw_freq, offset);
+
+    return delay;
+}
+
+/*! \brief Tune to the next channel to check.
+ *
+ * Pending priority channels come first. After checking them while stopped
+ * on an active channel, the scanner goes back to that channel.
+ */
+void BookmarkScanner::nextChannel()
+{
+    int index = -1;
+    int delay = -1;
+
+    // skip channels that can not be reached, but only for one round
+    for (int tries = 0; delay < 0 && tries <= channels.size(); tries++)
+    {
+        if (stopped_on < 0 && pending_priority.isEmpty() && priorityDue())
+        {
+            for (int i = 0; i < channels.size(); i++)
+                if (channels[i].priority)
+                    pending_priority.append(i);
+            priority_clock.restart();
+        }
+
+        if (!pending_priority.isEmpty())
+            index = pending_priority.takeFirst();
+        else if (stopped_on >= 0)
+            index = stopped_on;
+        else
+        {
+            index = next;
+            next = (next + 1) % channels.size();
+        }
+
+        delay = tuneChannel(index);
+    }
+
+    if (delay < 0)
+    {
+        stop();
+        return;
+    }
+
+    current = index;
+    state = SCAN_FLUSH;
+    timer.start(delay - settle_ms / 2);
+}
+
+/*! \brief Whether the priority channels should be checked now. */
+bool BookmarkScanner::priorityDue() const
+{
+    return priority_s > 0.0 && priority_clock.elapsed() >= priority_s * 1000.0;
+}
+
+/*! \brief Leave the active channel briefly to check the priority channels. */
+void BookmarkScanner::startPriorityCheck()
+{
+    priority_clock.restart();
+
+    for (int i = 0; i < channels.size(); i++)
+        if (channels[i].priority && i != current)
+            pending_priority.append(i);
+
+    if (pending_priority.isEmpty())
+    {
+        timer.start(SCAN_POLL_MS);
+        return;
+    }
+
+    stopped_on = current;
+    resume_state = state;
+    nextChannel();
+}
+
+/*! \brief Stop on the current channel or resume scanning. */
+void BookmarkScanner::setActive(bool active)
+{
+    if (active == holding)
+        return;
+
+    holding = active;
+    if (active)
+    {
+        // the time on active channels does not count for the scan rate
+        scan_ms += scan_clock.elapsed();
+        active_clock.restart();
+        state = SCAN_ACTIVE;
+        timer.start(SCAN_POLL_MS);
+    }
+    else
+    {
+        scan_clock.restart();
+    }
+
+    emit activeChanged(active, current >= 0 ? channels[current].name : QString());
+}
+
+/*! \brief Update the scan rate once per second. */
+void BookmarkScanner::updateRate()
+{
+    if (rate_clock.elapsed() < 1000)
+        return;
+
+    qint64 total_ms = scan_ms + (holding ? 0 : scan_clock.elapsed());
+
+    if (total_ms > 0 && checks > 0)
+    {
+        rate = 1000.f * checks / total_ms;
+        emit rateChanged(rate);
+    }
+
+    checks = 0;
+    scan_ms = 0;
+    scan_clock.restart();
+    rate_clock.restart();
+}
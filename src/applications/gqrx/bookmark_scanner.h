@@ -0,0 +1,157 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef BOOKMARK_SCANNER_H
+#define BOOKMARK_SCANNER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+class receiver;
+
+/*! \brief Scan the active bookmarks for activity.
+ *
+ * Channels within the current sample rate are checked by moving the filter
+ * offset only, the hardware is retuned only when the next channel is
+ * outside. The hardware frequency is then chosen so that the channel is at
+ * the low edge of the band, which usually brings the following channels
+ * into the band as well.
+ *
+ * A channel is active when the averaged power in the channel is above the
+ * squelch level, see receiver::get_sql_signal(). It is checked after the
+ * settle time, which must cover the latency of the DSP chain. The scanner
+ * stops on an active channel until the signal has been gone for the hang
+ * time, or until the dwell time has passed. Channels with the priority tag
+ * are checked every priority interval, also while stopped on another
+ * channel.
+ *
+ * The receiver is tuned directly and tuned() tells mainwindow to update
+ * the widgets. Everything runs in the GUI thread.
+ */
+class BookmarkScanner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BookmarkScanner(receiver *rx, QObject *parent = 0);
+
+    void setSettleTime(int settle_ms);
+    int  getSettleTime() const { return settle_ms; }
+    void setRetuneTime(int retune_ms);
+    int  getRetuneTime() const { return retune_ms; }
+    void setDwellTime(double dwell_s);
+    double getDwellTime() const { return dwell_s; }
+    void setHangTime(double hang_s);
+    double getHangTime() const { return hang_s; }
+    void setPriorityTag(const QString &tag);
+    QString getPriorityTag() const { return priority_tag; }
+    void setPriorityInterval(double interval_s);
+    double getPriorityInterval() const { return priority_s; }
+
+    bool start(qint64 hw_freq, qint64 lnb_lo, qint64 hw_start, qint64 hw_stop);
+    void stop();
+    bool isRunning() const { return state != SCAN_IDLE; }
+
+    /*! \brief Channels checked per second while scanning. */
+    float getRate() const { return rate; }
+
+signals:
+    /*! \brief The receiver has been tuned to a new channel. */
+    void tuned(qint64 rx_freq, qint64 hw_freq, qint64 offset);
+
+    /*! \brief Stopped on an active channel, or resumed scanning. */
+    void activeChanged(bool active, const QString &name);
+
+    /*! \brief New scan rate in channels per second, once per second. */
+    void rateChanged(float channels_per_s);
+
+    /*! \brief The scanner has stopped. */
+    void stopped();
+
+private slots:
+    void updateChannels();
+    void step();
+
+private:
+    enum scan_state {
+        SCAN_IDLE = 0,
+        SCAN_FLUSH,     /*!< Tuned, waiting for the old channel to drain. */
+        SCAN_MEASURE,   /*!< Averaging the power in the new channel. */
+        SCAN_ACTIVE,    /*!< Stopped on a channel with a signal. */
+        SCAN_HANG       /*!< Signal gone, waiting for the hang time. */
+    };
+
+    struct channel {
+        qint64  frequency;
+        QString name;
+        bool    priority;
+
+        bool operator<(const channel &other) const
+        {
+            return frequency < other.frequency;
+        }
+    };
+
+    receiver       *rx;
+    QTimer          timer;
+    QList<channel>  channels;
+    QList<int>      pending_priority; /*!< Priority channels left to check. */
+
+    scan_state      state;
+    scan_state      resume_state;  /*!< State to resume after priority checks. */
+    bool            holding;       /*!< Stopped on an active channel. */
+    int             current;       /*!< Index of the tuned channel. */
+    int             next;          /*!< Next channel in the normal sequence. */
+    int             stopped_on;    /*!< Active channel during priority checks, or -1. */
+    qint64          hw_freq;
+    qint64          lnb_lo;
+    qint64          hw_start;
+    qint64          hw_stop;
+
+    QElapsedTimer   active_clock;   /*!< Time on the active channel. */
+    QElapsedTimer   hang_clock;     /*!< Time since the signal has gone. */
+    QElapsedTimer   priority_clock; /*!< Time since the last priority check. */
+    QElapsedTimer   rate_clock;     /*!< Time since the last rate update. */
+    qint64          scan_ms;        /*!< Time spent scanning in this interval. */
+    QElapsedTimer   scan_clock;     /*!< Running while not stopped on a channel. */
+    int             checks;         /*!< Channels checked in this interval. */
+    float           rate;
+
+    int             settle_ms;
+    int             retune_ms;
+    double          dwell_s;
+    double          hang_s;
+    QString         priority_tag;
+    double          priority_s;
+
+    int     tuneChannel(int index);
+    void    nextChannel();
+    bool    priorityDue() const;
+    void    startPriorityCheck();
+    void    setActive(bool active);
+    void    updateRate();
+    int     findChannel(qint64 frequency) const;
+};
+
+#endif // BOOKMARK_SCANNER_H
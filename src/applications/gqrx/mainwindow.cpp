@@ -70,7 +70,8 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     d_lnb_lo(0),
     d_hw_freq(0),
     d_have_audio(true),
-    dec_afsk1200(0)
+    d_iq_trig_auto(false),
+    d_iq_trig_active(0)
 {
     ui->setupUi(this);
     Bookmarks::create();
@@ -99,8 +100,13 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     rx = new receiver("", "", 1);
     rx->set_rf_freq(144500000.0f);
 
+    // bookmark scanner
+    scanner = new BookmarkScanner(rx, this);
+
     // remote controller
     remote = new RemoteControl();
+    remote->setReceiver(rx);
+    remote->setDirectTuning(true);
     remote_ctl_tcp_server = new TcpRemoteControlServer(remote);
 #if defined(ENABLE_SERIAL_REMOTE_CONTROL)
     remote_ctl_serial_device = new SerialRemoteControlDevice(remote);
@@ -113,6 +119,10 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     meter_timer = new QTimer(this);
     connect(meter_timer, SIGNAL(timeout()), this, SLOT(meterTimeout()));
 
+    /* remote control telemetry timer, runs while clients are subscribed */
+    telemetry_timer = new QTimer(this);
+    connect(telemetry_timer, SIGNAL(timeout()), this, SLOT(telemetryTimeout()));
+
     /* FFT timer & data */
     iq_fft_timer = new QTimer(this);
     connect(iq_fft_timer, SIGNAL(timeout()), this, SLOT(iqFftTimeout()));
@@ -127,6 +137,10 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     for (int i = 0; i < MAX_FFT_SIZE; i++)
         d_iirFftData[i] = -140.0;  // dBFS
 
+    /* I/Q recorder statistics */
+    iq_rec_timer = new QTimer(this);
+    connect(iq_rec_timer, SIGNAL(timeout()), this, SLOT(iqRecTimeout()));
+
     /* timer for data decoders */
     dec_timer = new QTimer(this);
     connect(dec_timer, SIGNAL(timeout()), this, SLOT(decoderTimeout()));
@@ -216,6 +230,8 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     connect(uiDockRxOpt, SIGNAL(demodSelected(int)), remote, SLOT(setMode(int)));
     connect(uiDockRxOpt, SIGNAL(fmMaxdevSelected(float)), this, SLOT(setFmMaxdev(float)));
     connect(uiDockRxOpt, SIGNAL(fmEmphSelected(double)), this, SLOT(setFmEmph(double)));
+    connect(uiDockRxOpt, SIGNAL(fmCtcssSelected(float)), this, SLOT(setCtcss(float)));
+    connect(uiDockRxOpt, SIGNAL(fmDcsSelected(int)), this, SLOT(setDcs(int)));
     connect(uiDockRxOpt, SIGNAL(amDcrToggled(bool)), this, SLOT(setAmDcr(bool)));
     connect(uiDockRxOpt, SIGNAL(cwOffsetChanged(int)), this, SLOT(setCwOffset(int)));
     connect(uiDockRxOpt, SIGNAL(agcToggled(bool)), this, SLOT(setAgcOn(bool)));
@@ -227,9 +243,15 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     connect(uiDockRxOpt, SIGNAL(noiseBlankerChanged(int,bool,float)), this, SLOT(setNoiseBlanker(int,bool,float)));
     connect(uiDockRxOpt, SIGNAL(sqlLevelChanged(double)), this, SLOT(setSqlLevel(double)));
     connect(uiDockRxOpt, SIGNAL(sqlAutoClicked()), this, SLOT(setSqlLevelAuto()));
+    connect(uiDockRxOpt, SIGNAL(sqlAttackChanged(double)), this, SLOT(setSqlAttack(double)));
+    connect(uiDockRxOpt, SIGNAL(sqlHangChanged(double)), this, SLOT(setSqlHang(double)));
+    connect(uiDockRxOpt, SIGNAL(sqlGateToggled(bool)), this, SLOT(setSqlGate(bool)));
     connect(uiDockAudio, SIGNAL(audioGainChanged(float)), this, SLOT(setAudioGain(float)));
+    connect(uiDockAudio, SIGNAL(audioBufferChanged(int,int,int,int)), this, SLOT(setAudioBuffer(int,int,int,int)));
     connect(uiDockAudio, SIGNAL(audioStreamingStarted(QString,int)), this, SLOT(startAudioStream(QString,int)));
     connect(uiDockAudio, SIGNAL(audioStreamingStopped()), this, SLOT(stopAudioStreaming()));
+    connect(uiDockAudio, SIGNAL(audioStreamFormatChanged(bool,int,bool,int)), this, SLOT(setAudioStreamFormat(bool,int,bool,int)));
+    connect(uiDockAudio, SIGNAL(audioRecModeChanged(int,double,int)), this, SLOT(setAudioRecMode(int,double,int)));
     connect(uiDockAudio, SIGNAL(audioRecStarted(QString)), this, SLOT(startAudioRec(QString)));
     connect(uiDockAudio, SIGNAL(audioRecStarted(QString)), remote, SLOT(startAudioRecorder(QString)));
     connect(uiDockAudio, SIGNAL(audioRecStopped()), this, SLOT(stopAudioRec()));
@@ -266,14 +288,24 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     // Bookmarks
     connect(uiDockBookmarks, SIGNAL(newBookmarkActivated(qint64, QString, int)), this, SLOT(onBookmarkActivated(qint64, QString, int)));
     connect(uiDockBookmarks->actionAddBookmark, SIGNAL(triggered()), this, SLOT(on_actionAddBookmark_triggered()));
+    connect(uiDockBookmarks, SIGNAL(scanToggled(bool)), this, SLOT(toggleScan(bool)));
+    connect(uiDockBookmarks, SIGNAL(scanOptionsChanged()), this, SLOT(setScanOptions()));
+    connect(scanner, SIGNAL(tuned(qint64,qint64,qint64)), this, SLOT(scannerTuned(qint64,qint64,qint64)));
+    connect(scanner, SIGNAL(stopped()), this, SLOT(scannerStopped()));
+    connect(scanner, SIGNAL(activeChanged(bool,QString)), uiDockBookmarks, SLOT(setScanActive(bool,QString)));
+    connect(scanner, SIGNAL(rateChanged(float)), uiDockBookmarks, SLOT(setScanRate(float)));
 
 
     // I/Q playback
-    connect(iq_tool, SIGNAL(startRecording(QString)), this, SLOT(startIqRecording(QString)));
+    connect(iq_tool, SIGNAL(startRecording(QString,int)), this, SLOT(startIqRecording(QString,int)));
     connect(iq_tool, SIGNAL(stopRecording()), this, SLOT(stopIqRecording()));
+    connect(iq_tool, SIGNAL(newPreTrigger(int)), this, SLOT(setIqPreTrigger(int)));
+    connect(iq_tool, SIGNAL(triggerRecording(bool)), this, SLOT(triggerIqRecording(bool)));
     connect(iq_tool, SIGNAL(startPlayback(QString,float)), this, SLOT(startIqPlayback(QString,float)));
     connect(iq_tool, SIGNAL(stopPlayback()), this, SLOT(stopIqPlayback()));
     connect(iq_tool, SIGNAL(seek(qint64)), this,SLOT(seekIqFile(qint64)));
+    connect(iq_tool, SIGNAL(newPlaybackSpeed(double)), this, SLOT(setIqPlaybackSpeed(double)));
+    connect(iq_tool, SIGNAL(newFilterOffset(qint64)), this, SLOT(setIqFilterOffset(qint64)));
 
     // remote control
     connect(remote, SIGNAL(newFilterOffset(qint64)), this, SLOT(setFilterOffset(qint64)));
@@ -281,13 +313,22 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     connect(remote, SIGNAL(newFrequency(qint64)), ui->freqCtrl, SLOT(setFrequency(qint64)));
     connect(remote, SIGNAL(newLnbLo(double)), uiDockInputCtl, SLOT(setLnbLo(double)));
     connect(remote, SIGNAL(newLnbLo(double)), this, SLOT(setLnbLo(double)));
+    connect(remote, SIGNAL(remoteTuned()), this, SLOT(remoteTuned()));
     connect(remote, SIGNAL(newMode(int)), this, SLOT(selectDemod(int)));
     connect(remote, SIGNAL(newMode(int)), uiDockRxOpt, SLOT(setCurrentDemod(int)));
     connect(remote, SIGNAL(newSquelchLevel(double)), this, SLOT(setSqlLevel(double)));
     connect(remote, SIGNAL(newSquelchLevel(double)), uiDockRxOpt, SLOT(setSquelchLevel(double)));
     connect(uiDockRxOpt, SIGNAL(sqlLevelChanged(double)), remote, SLOT(setSquelchLevel(double)));
+    connect(remote, SIGNAL(newCtcss(float)), this, SLOT(setCtcss(float)));
+    connect(remote, SIGNAL(newCtcss(float)), uiDockRxOpt, SLOT(setCtcss(float)));
+    connect(uiDockRxOpt, SIGNAL(fmCtcssSelected(float)), remote, SLOT(setCtcss(float)));
+    connect(remote, SIGNAL(newDcs(int)), this, SLOT(setDcs(int)));
+    connect(remote, SIGNAL(newDcs(int)), uiDockRxOpt, SLOT(setDcs(int)));
+    connect(uiDockRxOpt, SIGNAL(fmDcsSelected(int)), remote, SLOT(setDcs(int)));
     connect(remote, SIGNAL(startAudioRecorderEvent()), uiDockAudio, SLOT(startAudioRecorder()));
     connect(remote, SIGNAL(stopAudioRecorderEvent()), uiDockAudio, SLOT(stopAudioRecorder()));
+    connect(remote, SIGNAL(iqTriggerEvent(bool)), this, SLOT(triggerIqRecording(bool)));
+    connect(remote, SIGNAL(telemetryIntervalChanged(int)), this, SLOT(setTelemetryInterval(int)));
     connect(ui->plotter, SIGNAL(newFilterFreq(int, int)), remote, SLOT(setPassband(int, int)));
     connect(remote, SIGNAL(newPassband(int)), this, SLOT(setPassband(int)));
 
@@ -349,12 +390,18 @@ MainWindow::~MainWindow()
     meter_timer->stop();
     delete meter_timer;
 
+    telemetry_timer->stop();
+    delete telemetry_timer;
+
     iq_fft_timer->stop();
     delete iq_fft_timer;
 
     audio_fft_timer->stop();
     delete audio_fft_timer;
 
+    iq_rec_timer->stop();
+    delete iq_rec_timer;
+
     if (m_settings)
     {
         m_settings->setValue("configversion", 2);
@@ -384,6 +431,7 @@ MainWindow::~MainWindow()
     delete uiDockFft;
     delete uiDockInputCtl;
     delete uiDockRDS;
+    remote->setReceiver(0);
     delete rx;
 #if defined(ENABLE_SERIAL_REMOTE_CONTROL)
     delete remote_ctl_serial_device;
@@ -548,6 +596,12 @@ bool MainWindow::loadConfig(const QString cfgfile, bool check_crash,
 
     if (actual_rate > 0.)
     {
+        int_val = m_settings->value("input/decim_filter", 0).toInt(&conv_ok);
+        if (conv_ok && (int_val == 70 || int_val == 100 || int_val == 140))
+            rx->set_input_decim_filter((receiver::decim_filter)int_val);
+        else
+            rx->set_input_decim_filter(receiver::DECIM_FILTER_FIR);
+
         int_val = m_settings->value("input/decimation", 1).toInt(&conv_ok);
         if (conv_ok && int_val >= 2)
         {
@@ -591,6 +645,7 @@ bool MainWindow::loadConfig(const QString cfgfile, bool check_crash,
     uiDockRxOpt->readSettings(m_settings);
     uiDockFft->readSettings(m_settings);
     uiDockAudio->readSettings(m_settings);
+    uiDockBookmarks->readSettings(m_settings);
 
     {
         int64_val = m_settings->value("input/frequency", 14236000).toLongLong(&conv_ok);
@@ -629,6 +684,12 @@ bool MainWindow::loadConfig(const QString cfgfile, bool check_crash,
        ui->actionRemoteControlTcpServer->setChecked(true);
     }
 
+    if (m_settings->value("iq_server/enabled", false).toBool())
+    {
+        ui->actionIqServer->setChecked(true);
+        on_actionIqServer_triggered(true);
+    }
+
 #if defined(ENABLE_SERIAL_REMOTE_CONTROL)
     if (remote_ctl_serial_device->isEnabledInSettings(m_settings))
     {
@@ -714,6 +775,7 @@ void MainWindow::storeSession()
         uiDockRxOpt->saveSettings(m_settings);
         uiDockFft->saveSettings(m_settings);
         uiDockAudio->saveSettings(m_settings);
+        uiDockBookmarks->saveSettings(m_settings);
 
         remote_ctl_tcp_server->saveSettings(m_settings);
 #if defined(ENABLE_SERIAL_REMOTE_CONTROL)
@@ -722,6 +784,11 @@ void MainWindow::storeSession()
 
         iq_tool->saveSettings(m_settings);
 
+        if (ui->actionIqServer->isChecked())
+            m_settings->setValue("iq_server/enabled", true);
+        else
+            m_settings->remove("iq_server/enabled");
+
         {
             int     flo, fhi;
             ui->plotter->getHiLowCutFrequencies(&flo, &fhi);
@@ -828,9 +895,20 @@ void MainWindow::updateGainStages(bool read_from_device)
  */
 void MainWindow::setNewFrequency(qint64 rx_freq)
 {
+    // tuning by hand takes over from the scanner
+    scanner->stop();
+
     double hw_freq = (double)(rx_freq - d_lnb_lo) - rx->get_filter_offset();
     qint64 center_freq = rx_freq - (qint64)rx->get_filter_offset();
 
+    if (rx->is_playing_iq())
+    {
+        // the center frequency of an I/Q file is fixed; tune the channel
+        setIqFilterOffset(rx_freq - d_lnb_lo - d_hw_freq);
+        uiDockBookmarks->setNewFrequency(rx_freq);
+        return;
+    }
+
     d_hw_freq = (qint64)hw_freq;
 
     // set receiver frequency
@@ -843,6 +921,110 @@ void MainWindow::setNewFrequency(qint64 rx_freq)
     uiDockBookmarks->setNewFrequency(rx_freq);
 }
 
+/**
+ * @brief Update the GUI after a remote client has tuned the receiver.
+ *
+ * The receiver has already been tuned from the remote control thread, so
+ * only the widgets are updated here and their signals are blocked to avoid
+ * tuning the receiver a second time.
+ */
+void MainWindow::remoteTuned()
+{
+    qint64 rx_freq, hw_freq, offset;
+
+    remote->getRemoteTuning(rx_freq, hw_freq, offset);
+
+    scanner->stop();
+    updateTuning(rx_freq, hw_freq, offset);
+}
+
+/**
+ * @brief Update the GUI after the scanner has moved to a new channel.
+ *
+ * Like remoteTuned() the receiver has already been tuned. The remote control
+ * is told about the new frequency since the widget signals are blocked.
+ */
+void MainWindow::scannerTuned(qint64 rx_freq, qint64 hw_freq, qint64 offset)
+{
+    updateTuning(rx_freq, hw_freq, offset);
+
+    remote->setFilterOffset(offset);
+    remote->setNewFrequency(rx_freq);
+}
+
+/** Start or stop scanning the bookmarks. */
+void MainWindow::toggleScan(bool enabled)
+{
+    if (!enabled)
+    {
+        scanner->stop();
+        return;
+    }
+
+    setScanOptions();
+    if (!scanner->start(d_hw_freq, d_lnb_lo, d_hw_freq_start, d_hw_freq_stop))
+    {
+        uiDockBookmarks->setScanRunning(false);
+        ui->statusBar->showMessage(tr("No bookmarks with active tags within the tuning range"), 5000);
+    }
+}
+
+/** The scanner has stopped, show the achieved scan rate. */
+void MainWindow::scannerStopped()
+{
+    uiDockBookmarks->setScanRunning(false);
+
+    if (scanner->getRate() > 0.f)
+        ui->statusBar->showMessage(tr("Scanner stopped at %1 channels/s")
+                                   .arg(scanner->getRate(), 0, 'f', 1), 5000);
+}
+
+/** Apply the scanner options from the bookmarks dock. */
+void MainWindow::setScanOptions()
+{
+    scanner->setSettleTime(uiDockBookmarks->getScanSettleTime());
+    scanner->setRetuneTime(uiDockBookmarks->getScanRetuneTime());
+    scanner->setDwellTime(uiDockBookmarks->getScanDwellTime());
+    scanner->setHangTime(uiDockBookmarks->getScanHangTime());
+    scanner->setPriorityTag(uiDockBookmarks->getScanPriorityTag());
+    scanner->setPriorityInterval(uiDockBookmarks->getScanPriorityInterval());
+}
+
+/**
+ * @brief Show a tuning that has already been applied to the receiver.
+ * @param rx_freq The receive frequency in Hz.
+ * @param hw_freq The hardware frequency in Hz, without LNB LO.
+ * @param offset The filter offset in Hz.
+ *
+ * The widget signals are blocked to avoid tuning the receiver a second time.
+ */
+void MainWindow::updateTuning(qint64 rx_freq, qint64 hw_freq, qint64 offset)
+{
+    d_hw_freq = hw_freq;
+
+    ui->plotter->setCenterFreq(d_lnb_lo + d_hw_freq);
+    ui->plotter->setFilterOffset(offset);
+
+    uiDockRxOpt->blockSignals(true);
+    uiDockRxOpt->setFilterOffset(offset);
+    uiDockRxOpt->blockSignals(false);
+    uiDockRxOpt->setHwFreq(d_hw_freq);
+
+    updateFrequencyRange();
+
+    ui->freqCtrl->blockSignals(true);
+    ui->freqCtrl->setFrequency(rx_freq);
+    ui->freqCtrl->blockSignals(false);
+
+    uiDockAudio->setRxFrequency(rx_freq);
+    uiDockRxOpt->setRxFreq(rx_freq);
+    uiDockBookmarks->setNewFrequency(rx_freq);
+
+    if (rx->is_rds_decoder_active()) {
+        rx->reset_rds_parser();
+    }
+}
+
 /**
  * @brief Set new LNB LO frequency.
  * @param freq_mhz The new frequency in MHz.
@@ -880,6 +1062,8 @@ void MainWindow::setAntenna(const QString antenna)
  */
 void MainWindow::setFilterOffset(qint64 freq_hz)
 {
+    scanner->stop();
+
     rx->set_filter_offset((double) freq_hz);
     ui->plotter->setFilterOffset(freq_hz);
 
@@ -1127,6 +1311,12 @@ void MainWindow::selectDemod(int mode_idx)
     rx->set_filter((double)flo, (double)fhi, d_filter_shape);
     rx->set_cw_offset(cwofs);
     rx->set_sql_level(uiDockRxOpt->currentSquelchLevel());
+    rx->set_sql_attack(uiDockRxOpt->getSqlAttack());
+    rx->set_sql_hang(uiDockRxOpt->getSqlHang());
+    rx->set_sql_gate(uiDockRxOpt->getSqlGate());
+    rx->set_ctcss(uiDockRxOpt->currentCtcss());
+    if (uiDockRxOpt->currentDcs() > 0)
+        rx->set_dcs(uiDockRxOpt->currentDcs());
 
     remote->setMode(mode_idx);
     remote->setPassband(flo, fhi);
@@ -1162,6 +1352,24 @@ void MainWindow::setFmEmph(double tau)
     rx->set_fm_deemph(tau);
 }
 
+/**
+ * @brief CTCSS squelch tone selected.
+ * @param tone_hz The new tone in Hz, 0 to disable.
+ */
+void MainWindow::setCtcss(float tone_hz)
+{
+    rx->set_ctcss(tone_hz);
+}
+
+/**
+ * @brief DCS squelch code selected.
+ * @param code The new code, e.g. 23 for D023, 0 to disable.
+ */
+void MainWindow::setDcs(int code)
+{
+    rx->set_dcs(code);
+}
+
 
 /**
  * @brief AM DCR status changed (slot).
@@ -1186,6 +1394,13 @@ void MainWindow::setAudioGain(float value)
     rx->set_af_gain(value);
 }
 
+/** Set audio output buffering. All values in ms, 0 means default. */
+void MainWindow::setAudioBuffer(int latency_ms, int server_ms, int minreq_ms,
+                                int prebuf_ms)
+{
+    rx->set_audio_buffer(latency_ms, server_ms, minreq_ms, prebuf_ms);
+}
+
 /** Set AGC ON/OFF. */
 void MainWindow::setAgcOn(bool agc_on)
 {
@@ -1261,14 +1476,93 @@ double MainWindow::setSqlLevelAuto()
     return level;
 }
 
+/** Squelch attack (fade) time changed. */
+void MainWindow::setSqlAttack(double attack_ms)
+{
+    rx->set_sql_attack(attack_ms);
+}
+
+/** Squelch hang time changed. */
+void MainWindow::setSqlHang(double hang_ms)
+{
+    rx->set_sql_hang(hang_ms);
+}
+
+/** Squelch gating toggled. */
+void MainWindow::setSqlGate(bool gate)
+{
+    rx->set_sql_gate(gate);
+}
+
 /** Signal strength meter timeout. */
 void MainWindow::meterTimeout()
 {
-    float level;
+    rx_meter_levels levels;
+    audio_fifo_stats audio_stats;
+    double          latency;
+    float           sql_duty;
+
+    rx->get_signal_levels(levels);
+    ui->sMeter->setLevel(levels.level);
+    remote->setSignalLevel(levels.level);
+    remote->setSignalStats(levels.peak, levels.rms, levels.min,
+                           levels.noise_floor, levels.snr);
+    sql_duty = rx->get_sql_duty_cycle();
+    remote->setSquelchDutyCycle(sql_duty);
+    remote->setToneSquelchStatus(rx->get_tone_sql_open(),
+                                 rx->get_ctcss_detected());
+
+    latency = rx->get_audio_latency();
+    if (rx->get_audio_stats(audio_stats) != receiver::STATUS_OK)
+        audio_stats.underruns = audio_stats.overruns = 0;
+    uiDockAudio->setAudioLatency(latency, audio_stats.underruns,
+                                 audio_stats.overruns);
+    remote->setAudioLatency(latency, audio_stats.underruns,
+                            audio_stats.overruns);
+
+    updateIqTrigger(sql_duty, levels.snr);
+
+    if (rx->is_playing_iq())
+        iq_tool->setPlaybackPosition(rx->get_iq_playback_pos());
+}
+
+/**
+ * Remote control telemetry timeout.
+ *
+ * The levels are updated by meterTimeout(), here we only need the squelch
+ * state which can be read without disturbing the meter.
+ */
+void MainWindow::telemetryTimeout()
+{
+    remote->setSquelchStatus(rx->get_sql_open());
+    remote->sendTelemetry();
+}
 
-    level = rx->get_signal_pwr(true);
-    ui->sMeter->setLevel(level);
-    remote->setSignalLevel(level);
+/** Start or stop the telemetry timer, interval 0 means no subscribers. */
+void MainWindow::setTelemetryInterval(int interval_ms)
+{
+    if (interval_ms > 0)
+        telemetry_timer->start(interval_ms);
+    else
+        telemetry_timer->stop();
+}
+
+/** I/Q recorder statistics timeout. */
+void MainWindow::iqRecTimeout()
+{
+    iq_file_stats   stats;
+
+    if (rx->get_iq_recording_stats(stats) != receiver::STATUS_OK &&
+        rx->get_iq_commit_stats(stats) != receiver::STATUS_OK)
+    {
+        iq_rec_timer->stop();
+        return;
+    }
+
+    iq_tool->setRecordingStats(stats.throughput,
+                               stats.buffers_total ?
+                               100 * stats.buffers_free / stats.buffers_total : 0,
+                               stats.dropped, stats.error);
 }
 
 /** Baseband FFT plot timeout. */
@@ -1316,6 +1610,11 @@ void MainWindow::iqFftTimeout()
     }
 
     ui->plotter->setNewFftData(d_iirFftData, d_realFftData, fftsize);
+
+    // remote clients get the averaged spectrum shown in the panadapter
+    if (remote->hasSpectrumClients())
+        remote->sendSpectrum(d_iirFftData, fftsize, d_lnb_lo + d_hw_freq,
+                             (qint64) rx->get_quad_rate());
 }
 
 /** Audio FFT plot timeout. */
@@ -1378,7 +1677,8 @@ void MainWindow::rdsTimeout()
 
 /**
  * @brief Start audio recorder.
- * @param filename The file name into which audio should be recorded.
+ * @param filename The file name into which audio should be recorded, or the
+ *                 directory for the recordings in the squelch modes.
  */
 void MainWindow::startAudioRec(const QString filename)
 {
@@ -1408,6 +1708,8 @@ void MainWindow::startAudioRec(const QString filename)
 /** Stop audio recorder. */
 void MainWindow::stopAudioRec()
 {
+    audio_rec_stats stats;
+
     if (rx->stop_audio_recording())
     {
         /* okay, this one would be weird if it really happened */
@@ -1417,10 +1719,22 @@ void MainWindow::stopAudioRec()
     }
     else
     {
-        ui->statusBar->showMessage(tr("Audio recorder stopped"), 5000);
+        rx->get_audio_rec_stats(stats);
+        if (stats.error)
+            ui->statusBar->showMessage(tr("Audio recorder stopped after a write error"), 5000);
+        else
+            ui->statusBar->showMessage(tr("Audio recorder stopped: %1 transmission(s), %2 s recorded")
+                                       .arg(stats.transmissions)
+                                       .arg(stats.recorded, 0, 'f', 1), 5000);
     }
 }
 
+/** Set audio recording mode, see audio_rec_sink::rec_mode. */
+void MainWindow::setAudioRecMode(int mode, double hang, int rotate_min)
+{
+    rx->set_audio_rec_mode((audio_rec_sink::rec_mode) mode, hang, rotate_min);
+}
+
 
 /** Start playback of audio file. */
 void MainWindow::startAudioPlayback(const QString filename)
@@ -1454,10 +1768,36 @@ void MainWindow::stopAudioPlayback()
     }
 }
 
-/** Start streaming audio over UDP. */
+/**
+ * Start streaming audio over UDP.
+ *
+ * udp_host may contain several hosts separated by commas. Each host may
+ * have its own port as host:port, otherwise udp_port is used.
+ */
 void MainWindow::startAudioStream(const QString udp_host, int udp_port)
 {
-    rx->start_udp_streaming(udp_host.toStdString(), udp_port);
+    QStringList hosts = udp_host.split(",", QString::SkipEmptyParts);
+
+    rx->stop_udp_streaming();
+
+    for (int i = 0; i < hosts.size(); i++)
+    {
+        QString host = hosts[i].trimmed();
+        int     port = udp_port;
+        bool    ok;
+
+        // a single colon separates the port, more is an IPv6 address
+        if (host.count(':') == 1)
+        {
+            port = host.section(':', 1).toInt(&ok);
+            if (!ok)
+                port = udp_port;
+            host = host.section(':', 0, 0);
+        }
+
+        if (rx->add_udp_destination(host.toStdString(), port) != receiver::STATUS_OK)
+            qDebug() << "Can not stream audio to" << host << port;
+    }
 }
 
 /** Stop streaming audio over UDP. */
@@ -1466,21 +1806,30 @@ void MainWindow::stopAudioStreaming()
     rx->stop_udp_streaming();
 }
 
-/** Start I/Q recording. */
-void MainWindow::startIqRecording(const QString recdir)
+/** Set UDP audio stream format. */
+void MainWindow::setAudioStreamFormat(bool stereo, int format, bool header,
+                                      int packet_size)
+{
+    rx->set_udp_stream_format(stereo, (udp_sink_f::sample_format) format,
+                              header, packet_size);
+}
+
+/**
+ * Start I/Q recording.
+ * @param recdir The directory to record to.
+ * @param format The sample format, see iq_file_format.
+ */
+void MainWindow::startIqRecording(const QString recdir, int format)
 {
     qDebug() << __func__;
-    // generate file name using date, time, rf freq in kHz and BW in Hz
-    // gqrx_iq_yyyymmdd_hhmmss_freq_bw_fc.raw
-    qint64 freq = (qint64)(rx->get_rf_freq());
-    qint64 sr = (qint64)(rx->get_input_rate());
-    qint32 dec = (quint32)(rx->get_input_decim());
-    QString lastRec = QDateTime::currentDateTimeUtc().
-            toString("%1/gqrx_yyyyMMdd_hhmmss_%2_%3_fc.'raw'")
-            .arg(recdir).arg(freq).arg(sr/dec);
+
+    if (format < IQ_FORMAT_CF32 || format > IQ_FORMAT_CS8)
+        format = IQ_FORMAT_CF32;
+
+    QString lastRec = iqRecFileName(recdir, format);
 
     // start recorder; fails if recording already in progress
-    if (rx->start_iq_recording(lastRec.toStdString()))
+    if (rx->start_iq_recording(lastRec.toStdString(), (iq_file_format) format))
     {
         // reset action status
         ui->statusBar->showMessage(tr("Error starting I/Q recoder"));
@@ -1497,9 +1846,25 @@ void MainWindow::startIqRecording(const QString recdir)
     {
         ui->statusBar->showMessage(tr("Recording I/Q data to: %1").arg(lastRec),
                                    5000);
+        iq_rec_timer->start(1000);
     }
 }
 
+/** Generate a file name for a new I/Q recording. */
+QString MainWindow::iqRecFileName(const QString recdir, int format)
+{
+    // generate file name using date, time, rf freq in kHz and BW in Hz
+    // gqrx_iq_yyyymmdd_hhmmss_freq_bw_fc.raw (.cs16 and .cs8 for integer formats)
+    static const char *extensions[] = { "raw", "cs16", "cs8" };
+    qint64 freq = (qint64)(rx->get_rf_freq());
+    qint64 sr = (qint64)(rx->get_input_rate());
+    qint32 dec = (quint32)(rx->get_input_decim());
+
+    return QDateTime::currentDateTimeUtc().
+            toString("%1/gqrx_yyyyMMdd_hhmmss_%2_%3_fc.'%4'")
+            .arg(recdir).arg(freq).arg(sr/dec).arg(extensions[format]);
+}
+
 /** Stop current I/Q recording. */
 void MainWindow::stopIqRecording()
 {
@@ -1511,6 +1876,101 @@ void MainWindow::stopIqRecording()
         ui->statusBar->showMessage(tr("I/Q data recoding stopped"), 5000);
 }
 
+/** Pre-trigger history changed in the I/Q tool. */
+void MainWindow::setIqPreTrigger(int seconds)
+{
+    rx->set_iq_pretrigger(seconds);
+}
+
+/**
+ * Start or stop writing the pre-trigger buffer to a new recording.
+ *
+ * Activated by the I/Q tool, the remote control and updateIqTrigger().
+ */
+void MainWindow::triggerIqRecording(bool start)
+{
+    d_iq_trig_auto = false;
+
+    if (!start)
+    {
+        rx->stop_iq_commit();
+        return;
+    }
+
+    if (rx->is_committing_iq())
+        return;
+
+    int format = iq_tool->recFormat();
+    if (format < IQ_FORMAT_CF32 || format > IQ_FORMAT_CS8)
+        format = IQ_FORMAT_CF32;
+
+    QString filename = iqRecFileName(iq_tool->recDir(), format);
+
+    if (rx->start_iq_commit(filename.toStdString(), (iq_file_format) format))
+    {
+        ui->statusBar->showMessage(tr("Error starting pre-trigger I/Q recording"),
+                                   5000);
+    }
+    else
+    {
+        ui->statusBar->showMessage(tr("Recording I/Q data to: %1").arg(filename),
+                                   5000);
+        iq_tool->setTriggerStatus(true);
+        iq_rec_timer->start(1000);
+    }
+}
+
+/**
+ * Start and stop pre-trigger recordings on squelch or activity.
+ * @param sql_duty Fraction of time the squelch was open since the last call.
+ * @param snr The signal to noise ratio in the channel.
+ *
+ * Called from the meter timer. A recording started here is stopped when
+ * the trigger condition has been absent for the hold time; recordings
+ * started manually are left alone.
+ */
+void MainWindow::updateIqTrigger(float sql_duty, float snr)
+{
+    bool    committing = rx->is_committing_iq();
+    bool    active;
+    qint64  now;
+
+    iq_tool->setTriggerStatus(committing);
+    remote->setIqTriggerStatus(committing);
+
+    if (rx->get_iq_pretrigger() <= 0.0)
+        return;
+
+    switch (iq_tool->triggerMode())
+    {
+    case CIqTool::TRIGGER_SQUELCH:
+        active = sql_duty > 0.f;
+        break;
+    case CIqTool::TRIGGER_ACTIVITY:
+        active = snr >= iq_tool->triggerSnr();
+        break;
+    default:
+        return;
+    }
+
+    now = QDateTime::currentMSecsSinceEpoch();
+
+    if (active)
+    {
+        d_iq_trig_active = now;
+        if (!committing)
+        {
+            triggerIqRecording(true);
+            d_iq_trig_auto = rx->is_committing_iq();
+        }
+    }
+    else if (committing && d_iq_trig_auto &&
+             now - d_iq_trig_active >= 1000 * iq_tool->triggerHold())
+    {
+        triggerIqRecording(false);
+    }
+}
+
 void MainWindow::startIqPlayback(const QString filename, float samprate)
 {
     if (ui->actionDSP->isChecked())
@@ -1521,24 +1981,43 @@ void MainWindow::startIqPlayback(const QString filename, float samprate)
 
     storeSession();
 
-    int sri = (int)samprate;
-    QString devstr = QString("file='%1',rate=%2,throttle=true,repeat=false")
-            .arg(filename).arg(sri);
+    qDebug() << __func__ << ":" << filename;
 
-    qDebug() << __func__ << ":" << devstr;
+    // the file center frequency is fixed, remote tuning must go via the GUI
+    remote->setDirectTuning(false);
 
-    rx->set_input_device(devstr.toStdString());
+    if (rx->start_iq_playback(filename.toStdString(), samprate) !=
+        receiver::STATUS_OK)
+    {
+        ui->statusBar->showMessage(tr("Error opening %1").arg(filename), 5000);
+        iq_tool->cancelPlayback();
+        remote->setDirectTuning(true);
+        if (ui->actionDSP->isChecked())
+            on_actionDSP_triggered(true);
+        return;
+    }
+    rx->set_iq_playback_speed(iq_tool->playbackSpeed());
 
-    // sample rate
-    double actual_rate = rx->set_input_rate(samprate);
-    qDebug() << "Requested sample rate:" << samprate;
-    qDebug() << "Actual sample rate   :" << QString("%1")
+    double actual_rate = rx->get_input_rate();
+    qDebug() << "File sample rate:" << QString("%1")
                 .arg(actual_rate, 0, 'f', 6);
 
     uiDockRxOpt->setFilterOffsetRange((qint64)(actual_rate));
     ui->plotter->setSampleRate(actual_rate);
     ui->plotter->setSpanFreq((quint32)actual_rate);
     remote->setBandwidth(actual_rate);
+    iq_tool->setSampleRate((qint64)actual_rate);
+
+    // center frequency from the file metadata, if known
+    double file_freq = rx->get_rf_freq();
+    if (file_freq > 0.0)
+    {
+        d_hw_freq = (qint64)file_freq;
+        ui->plotter->setCenterFreq(d_lnb_lo + d_hw_freq);
+        uiDockRxOpt->setHwFreq(d_hw_freq);
+        ui->freqCtrl->setFrequency(d_lnb_lo + d_hw_freq +
+                                   (qint64)rx->get_filter_offset());
+    }
 
     // FIXME: would be nice with good/bad status
     ui->statusBar->showMessage(tr("Playing %1").arg(filename));
@@ -1560,9 +2039,9 @@ void MainWindow::stopIqPlayback()
 
     ui->statusBar->showMessage(tr("I/Q playback stopped"), 5000);
 
-    // restore original input device
-    QString indev = m_settings->value("input/device", "").toString();
-    rx->set_input_device(indev.toStdString());
+    // reconnect the input device
+    rx->stop_iq_playback();
+    remote->setDirectTuning(true);
 
     // restore sample rate
     bool conv_ok;
@@ -1585,6 +2064,7 @@ void MainWindow::stopIqPlayback()
 
     // restore frequency, gain, etc...
     uiDockInputCtl->readSettings(m_settings);
+    setNewFrequency(m_settings->value("input/frequency", 14236000).toLongLong());
 
     if (ui->actionDSP->isChecked())
     {
@@ -1596,13 +2076,26 @@ void MainWindow::stopIqPlayback()
 
 /**
  * Go to a specific offset in the IQ file.
- * @param seek_pos The byte offset from the begining of the file.
+ * @param seek_pos The sample offset from the begining of the file.
  */
 void MainWindow::seekIqFile(qint64 seek_pos)
 {
     rx->seek_iq_file((long)seek_pos);
 }
 
+/** Set the I/Q playback speed, 0 for as fast as possible. */
+void MainWindow::setIqPlaybackSpeed(double speed)
+{
+    rx->set_iq_playback_speed(speed);
+}
+
+/** Tune the channel within the I/Q file being played. */
+void MainWindow::setIqFilterOffset(qint64 offset)
+{
+    uiDockRxOpt->setFilterOffset(offset);
+    setFilterOffset(offset);
+}
+
 /** FFT size has changed. */
 void MainWindow::setIqFftSize(int size)
 {
@@ -1758,6 +2251,9 @@ void MainWindow::on_actionDSP_triggered(bool checked)
     }
     else
     {
+        /* the scanner needs the squelch to see signals */
+        scanner->stop();
+
         /* stop GUI timers */
         meter_timer->stop();
         iq_fft_timer->stop();
@@ -1974,6 +2470,31 @@ void MainWindow::on_actionRemoteControlTcpServer_triggered(bool checked)
         remote_ctl_tcp_server->stopServer();
 }
 
+/**
+ * I/Q server menu item toggled.
+ *
+ * The port is read from the iq_server/port setting, which can only be
+ * changed in the configuration file for now.
+ */
+void MainWindow::on_actionIqServer_triggered(bool checked)
+{
+    if (!checked)
+    {
+        rx->stop_iq_server();
+        return;
+    }
+
+    int port = m_settings->value("iq_server/port", 7357).toInt();
+
+    if (rx->start_iq_server(port) != receiver::STATUS_OK)
+    {
+        QMessageBox::warning(this, tr("I/Q server"),
+                             tr("Could not start the I/Q server on port %1.").arg(port),
+                             QMessageBox::Ok);
+        ui->actionIqServer->setChecked(false);
+    }
+}
+
 /**
  * Remote control configuration button (or menu item) for TCP server
  * clicked.
@@ -2046,42 +2567,38 @@ void MainWindow::on_actionRemoteSerialDeviceConfig_triggered()
 #endif // ENABLE_SERIAL_REMOTE_CONTROL
 
 
-#define DATA_BUFFER_SIZE 48000
-
 /**
  * AFSK1200 decoder action triggered.
  *
  * This slot is called when the user activates the AFSK1200
- * action. It will create an AFSK1200 decoder window and start
- * and start pushing data from the receiver to it.
+ * action. It will start a new AFSK1200 decoder in the receiver and create
+ * a window for displaying the decoded packets. Several decoders can be
+ * active at the same time.
  */
 void MainWindow::on_actionAFSK1200_triggered()
 {
+    Afsk1200Win *win;
+    int          id;
+
+    qDebug() << "Starting AFSK1200 decoder.";
 
-    if (dec_afsk1200 != 0)
+    id = rx->start_afsk1200_decoder(0);
+    if (id < 0)
     {
-        qDebug() << "AFSK1200 decoder already active.";
-        dec_afsk1200->raise();
+        QMessageBox::warning(this, tr("Gqrx error"),
+                             tr("Error starting AFSK1200 decoder."),
+                             QMessageBox::Ok, QMessageBox::Ok);
+        return;
     }
-    else
-    {
-        qDebug() << "Starting AFSK1200 decoder.";
 
-        /* start sample sniffer */
-        if (rx->start_sniffer(22050, DATA_BUFFER_SIZE) == receiver::STATUS_OK)
-        {
-            dec_afsk1200 = new Afsk1200Win(this);
-            connect(dec_afsk1200, SIGNAL(windowClosed()), this, SLOT(afsk1200win_closed()));
-            dec_afsk1200->show();
+    win = new Afsk1200Win(id, this);
+    connect(win, SIGNAL(windowClosed()), this, SLOT(afsk1200win_closed()));
+    connect(win, SIGNAL(channelChanged(int)), this, SLOT(afsk1200ChannelChanged(int)));
+    dec_afsk1200.insert(id, win);
+    win->show();
 
-            dec_timer->start(100);
-        }
-        else
-            QMessageBox::warning(this, tr("Gqrx error"),
-                                 tr("Error starting sample sniffer.\n"
-                                    "Close all data decoders and try again."),
-                                 QMessageBox::Ok, QMessageBox::Ok);
-    }
+    if (!dec_timer->isActive())
+        dec_timer->start(100);
 }
 
 
@@ -2089,33 +2606,52 @@ void MainWindow::on_actionAFSK1200_triggered()
  * Destroy AFSK1200 decoder window got closed.
  *
  * This slot is connected to the windowClosed() signal of the AFSK1200 decoder
- * object. We need this to properly destroy the object, stop timeout and clean
- * up whatever need to be cleaned up.
+ * windows. We need this to stop the decoder in the receiver, properly destroy
+ * the window and stop the timeout when the last decoder is gone.
  */
 void MainWindow::afsk1200win_closed()
 {
+    Afsk1200Win *win = qobject_cast<Afsk1200Win *>(sender());
+
+    if (!win)
+        return;
+
+    rx->stop_afsk1200_decoder(win->decoderId());
+    dec_afsk1200.remove(win->decoderId());
+
+    /* delete decoder window once its close event is finished */
+    win->deleteLater();
+
     /* stop cyclic processing */
-    dec_timer->stop();
-    rx->stop_sniffer();
+    if (dec_afsk1200.isEmpty())
+        dec_timer->stop();
+}
 
-    /* delete decoder object */
-    delete dec_afsk1200;
-    dec_afsk1200 = 0;
+
+/** New audio channel selected in an AFSK1200 decoder window. */
+void MainWindow::afsk1200ChannelChanged(int channel)
+{
+    Afsk1200Win *win = qobject_cast<Afsk1200Win *>(sender());
+
+    if (win)
+        rx->set_afsk1200_channel(win->decoderId(), channel);
 }
 
 
 /**
- * Cyclic processing for acquiring samples from receiver and processing them
- * with data decoders (see dec_* objects)
+ * Cyclic processing for fetching the frames decoded by the receiver and
+ * displaying them in the data decoder windows (see dec_* objects)
  */
 void MainWindow::decoderTimeout()
 {
-    float buffer[DATA_BUFFER_SIZE];
-    unsigned int num;
+    QMap<int, Afsk1200Win *>::const_iterator it;
+    std::string frame;
 
-    rx->get_sniffer_data(&buffer[0], num);
-    if (dec_afsk1200)
-        dec_afsk1200->process_samples(&buffer[0], num);
+    for (it = dec_afsk1200.constBegin(); it != dec_afsk1200.constEnd(); ++it)
+    {
+        while (rx->get_afsk1200_frame(it.key(), frame))
+            it.value()->addMessage(QString::fromStdString(frame));
+    }
 }
 
 void MainWindow::setRdsDecoder(bool checked)
@@ -25,6 +25,7 @@
 
 #include <QColor>
 #include <QMainWindow>
+#include <QMap>
 #include <QPointer>
 #include <QSettings>
 #include <QString>
@@ -42,6 +43,7 @@
 #include "qtgui/afsk1200win.h"
 #include "qtgui/iq_tool.h"
 
+#include "applications/gqrx/bookmark_scanner.h"
 #include "applications/gqrx/remote_control.h"
 
 // see https://bugreports.qt-project.org/browse/QTBUG-22829
@@ -97,6 +99,9 @@ private:
 
     bool d_have_audio;  /*!< Whether we have audio (i.e. not with demod_off. */
 
+    bool   d_iq_trig_auto;      /*!< Pre-trigger recording started automatically. */
+    qint64 d_iq_trig_active;    /*!< Last time the trigger condition was met [ms]. */
+
     /* dock widgets */
     DockRxOpt      *uiDockRxOpt;
     DockAudio      *uiDockAudio;
@@ -109,17 +114,21 @@ private:
 
 
     /* data decoders */
-    Afsk1200Win    *dec_afsk1200;
+    QMap<int, Afsk1200Win *> dec_afsk1200;  /*!< AFSK1200 decoder windows by decoder id. */
     bool            dec_rds;
 
     QTimer   *dec_timer;
     QTimer   *meter_timer;
+    QTimer   *telemetry_timer;
     QTimer   *iq_fft_timer;
     QTimer   *audio_fft_timer;
     QTimer   *rds_timer;
+    QTimer   *iq_rec_timer;
 
     receiver *rx;
 
+    BookmarkScanner *scanner;
+
     RemoteControl *remote;
     TcpRemoteControlServer *remote_ctl_tcp_server;
 #if defined(ENABLE_SERIAL_REMOTE_CONTROL)
@@ -134,12 +143,20 @@ private:
 private:
     void updateHWFrequencyRange(bool ignore_limits);
     void updateFrequencyRange();
+    void updateTuning(qint64 rx_freq, qint64 hw_freq, qint64 offset);
+    QString iqRecFileName(const QString recdir, int format);
+    void updateIqTrigger(float sql_duty, float snr);
     void updateGainStages(bool read_from_device);
     void showSimpleTextFile(const QString &resource_path,
                             const QString &window_title);
 
 private slots:
     /* rf */
+    void remoteTuned();
+    void scannerTuned(qint64 rx_freq, qint64 hw_freq, qint64 offset);
+    void scannerStopped();
+    void toggleScan(bool enabled);
+    void setScanOptions();
     void setLnbLo(double freq_mhz);
     void setAntenna(const QString antenna);
 
@@ -157,6 +174,8 @@ private slots:
     void selectDemod(int index);
     void setFmMaxdev(float max_dev);
     void setFmEmph(double tau);
+    void setCtcss(float tone_hz);
+    void setDcs(int code);
     void setAmDcr(bool enabled);
     void setCwOffset(int offset);
     void setAgcOn(bool agc_on);
@@ -168,24 +187,34 @@ private slots:
     void setNoiseBlanker(int nbid, bool on, float threshold);
     void setSqlLevel(double level_db);
     double setSqlLevelAuto();
+    void setSqlAttack(double attack_ms);
+    void setSqlHang(double hang_ms);
+    void setSqlGate(bool gate);
     void setAudioGain(float gain);
+    void setAudioBuffer(int latency_ms, int server_ms, int minreq_ms, int prebuf_ms);
     void setPassband(int bandwidth);
 
     /* audio recording and playback */
     void startAudioRec(const QString filename);
     void stopAudioRec();
+    void setAudioRecMode(int mode, double hang, int rotate_min);
     void startAudioPlayback(const QString filename);
     void stopAudioPlayback();
 
     void startAudioStream(const QString udp_host, int udp_port);
     void stopAudioStreaming();
+    void setAudioStreamFormat(bool stereo, int format, bool header, int packet_size);
 
     /* I/Q playback and recording*/
-    void startIqRecording(const QString recdir);
+    void startIqRecording(const QString recdir, int format);
     void stopIqRecording();
+    void setIqPreTrigger(int seconds);
+    void triggerIqRecording(bool start);
     void startIqPlayback(const QString filename, float samprate);
     void stopIqPlayback();
     void seekIqFile(qint64 seek_pos);
+    void setIqPlaybackSpeed(double speed);
+    void setIqFilterOffset(qint64 offset);
 
     /* FFT settings */
     void setIqFftSize(int size);
@@ -220,6 +249,7 @@ private slots:
     void on_actionIqTool_triggered();
     void on_actionFullScreen_triggered(bool checked);
     void on_actionRemoteControlTcpServer_triggered(bool checked);
+    void on_actionIqServer_triggered(bool checked);
     void on_actionRemoteTcpServerConfig_triggered();
 #if defined(ENABLE_SERIAL_REMOTE_CONTROL)
     void on_actionRemoteControlSerialDevice_triggered(bool checked);
@@ -236,14 +266,18 @@ private slots:
 
     /* window close signals */
     void afsk1200win_closed();
+    void afsk1200ChannelChanged(int channel);
     int  firstTimeConfig();
 
     /* cyclic processing */
     void decoderTimeout();
     void meterTimeout();
+    void telemetryTimeout();
+    void setTelemetryInterval(int interval_ms);
     void iqFftTimeout();
     void audioFftTimeout();
     void rdsTimeout();
+    void iqRecTimeout();
 };
 
 #endif // MAINWINDOW_H
@@ -36,7 +36,7 @@
 
 #include "applications/gqrx/receiver.h"
 #include "dsp/correct_iq_cc.h"
-//#include "dsp/hbf_decim.h"
+#include "dsp/hbf_decim.h"
 #include "dsp/filter/fir_decim.h"
 #include "dsp/rx_fft.h"
 #include "receivers/nbrx.h"
@@ -50,6 +50,8 @@
 #include <gnuradio/audio/sink.h>
 #endif
 
+/* Data tap buffer size for the I/Q server, about 100 ms at 10 Msps. */
+#define IQ_SERVER_TAP_SIZE  (1024 * 1024)
 
 /**
  * @brief Public contructor.
@@ -63,18 +65,26 @@ receiver::receiver(const std::string input_device,
     : d_running(false),
       d_input_rate(96000.0),
       d_audio_rate(48000),
+      d_audio_buf_ms(100),
+      d_audio_server_ms(50),
+      d_audio_minreq_ms(0),
+      d_audio_prebuf_ms(0),
       d_decim(decimation),
+      d_decim_filter(DECIM_FILTER_FIR),
       d_rf_freq(144800000.0),
       d_filter_offset(0.0),
       d_cw_offset(0.0),
       d_recording_iq(false),
-      d_recording_wav(false),
-      d_sniffer_active(false),
+      d_audio_rec_mode(audio_rec_sink::REC_CONTINUOUS),
       d_iq_rev(false),
       d_dc_cancel(false),
       d_iq_balance(false),
-      d_demod(RX_DEMOD_OFF)
+      d_demod(RX_DEMOD_OFF),
+      d_data_tap_next_id(0),
+      d_afsk1200_next_id(0)
 {
+    d_iq_server_taps[iq_server::SOURCE_IQ] = -1;
+    d_iq_server_taps[iq_server::SOURCE_FILTERED] = -1;
 
     tb = gr::make_top_block("gqrx");
 
@@ -93,7 +103,7 @@ receiver::receiver(const std::string input_device,
     {
         try
         {
-            input_decim = make_fir_decim_cc(d_decim);
+            input_decim = make_input_decim(d_decim);
         }
         catch (std::range_error &e)
         {
@@ -111,27 +121,21 @@ receiver::receiver(const std::string input_device,
     }
 
 
-    // create I/Q sink and close it
-    iq_sink = gr::blocks::file_sink::make(sizeof(gr_complex), get_null_file().c_str(), true);
-    iq_sink->set_unbuffered(true);
-    iq_sink->close();
+    iq_sink = make_iq_file_sink();
 
     rx = make_nbrx(d_quad_rate, d_audio_rate);
     lo = gr::analog::sig_source_c::make(d_quad_rate, gr::analog::GR_SIN_WAVE,
                                         0.0, 1.0);
     mixer = gr::blocks::multiply_cc::make();
 
-    iq_swap = make_iq_swap_cc(false);
-    dc_corr = make_dc_corr_cc(d_quad_rate, 1.0);
+    iq_corr = make_iq_corr_cc(d_quad_rate, 1.0);
     iq_fft = make_rx_fft_c(8192u, gr::filter::firdes::WIN_HANN);
 
     audio_fft = make_rx_fft_f(8192u, gr::filter::firdes::WIN_HANN);
     audio_gain0 = gr::blocks::multiply_const_ff::make(0.1);
     audio_gain1 = gr::blocks::multiply_const_ff::make(0.1);
 
-    wav_sink = gr::blocks::wavfile_sink::make(get_null_file().c_str(), 2,
-                                              (unsigned int) d_audio_rate,
-                                              16);
+    audio_rec = make_audio_rec_sink(d_audio_rate);
 
     audio_udp_sink = make_udp_sink_f();
 
@@ -142,14 +146,13 @@ receiver::receiver(const std::string input_device,
 #else
     audio_snk = gr::audio::sink::make(d_audio_rate, audio_device, true);
 #endif
+    apply_audio_buffer();
 
     output_devstr = audio_device;
 
     /* wav sink and source is created when rec/play is started */
     audio_null_sink0 = gr::blocks::null_sink::make(sizeof(float));
     audio_null_sink1 = gr::blocks::null_sink::make(sizeof(float));
-    sniffer = make_sniffer_f();
-    /* sniffer_rr is created at each activation. */
 
     set_demod(RX_DEMOD_NFM);
 
@@ -163,6 +166,7 @@ receiver::receiver(const std::string input_device,
 
 receiver::~receiver()
 {
+    stop_iq_server();
     tb->stop();
 }
 
@@ -170,6 +174,8 @@ receiver::~receiver()
 /** Start the receiver. */
 void receiver::start()
 {
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
     if (!d_running)
     {
         tb->start();
@@ -180,6 +186,8 @@ void receiver::start()
 /** Stop the receiver. */
 void receiver::stop()
 {
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
     if (d_running)
     {
         tb->stop();
@@ -197,6 +205,8 @@ void receiver::stop()
  */
 void receiver::set_input_device(const std::string device)
 {
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
     if (device.empty())
         return;
 
@@ -219,30 +229,14 @@ void receiver::set_input_device(const std::string device)
         tb->wait();
     }
 
-    if (d_decim >= 2)
-    {
-        tb->disconnect(src, 0, input_decim, 0);
-        tb->disconnect(input_decim, 0, iq_swap, 0);
-    }
-    else
-    {
-        tb->disconnect(src, 0, iq_swap, 0);
-    }
+    connect_input(false);
 
     src.reset();
     src = osmosdr::source::make(device);
     if(src->get_sample_rate() != 0)
         set_input_rate(src->get_sample_rate());
 
-    if (d_decim >= 2)
-    {
-        tb->connect(src, 0, input_decim, 0);
-        tb->connect(input_decim, 0, iq_swap, 0);
-    }
-    else
-    {
-        tb->connect(src, 0, iq_swap, 0);
-    }
+    connect_input(true);
 
     if (d_running)
         tb->start();
@@ -252,6 +246,8 @@ void receiver::set_input_device(const std::string device)
 /** Select new audio output device. */
 void receiver::set_output_device(const std::string device)
 {
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
     if (output_devstr.compare(device) == 0)
     {
 #ifndef QT_NO_DEBUG_OUTPUT
@@ -286,6 +282,7 @@ void receiver::set_output_device(const std::string device)
 #else
     audio_snk = gr::audio::sink::make(d_audio_rate, device, true);
 #endif
+    apply_audio_buffer();
 
     if (d_demod != RX_DEMOD_OFF)
     {
@@ -322,6 +319,14 @@ double receiver::set_input_rate(double rate)
     double  current_rate;
     bool    rate_has_changed;
 
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    if (iq_file_src)
+    {
+        // the rate of the file can not be changed
+        return d_input_rate;
+    }
+
     current_rate = src->get_sample_rate();
     rate_has_changed = !(rate == current_rate ||
             std::abs(rate - current_rate) < std::abs(std::min(rate, current_rate))
@@ -346,35 +351,72 @@ double receiver::set_input_rate(double rate)
     }
 
     d_quad_rate = d_input_rate / (double)d_decim;
-    dc_corr->set_sample_rate(d_quad_rate);
+    iq_corr->set_sample_rate(d_quad_rate);
     rx->set_quad_rate(d_quad_rate);
     lo->set_sampling_freq(d_quad_rate);
+    update_data_tap_rates();
     tb->unlock();
 
+    // waits for a pre-trigger commit to finish, keep it out of tb->lock()
+    if (iq_ring)
+        iq_ring->set_sample_rate(d_quad_rate);
+
     return d_input_rate;
 }
 
 /** Set input decimation */
 unsigned int receiver::set_input_decim(unsigned int decim)
 {
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
     if (decim == d_decim)
         return d_decim;
 
+    return reconfigure_input_decim(decim);
+}
+
+/**
+ * @brief Select the filter type used by the input decimator.
+ * @param type The decimator filter type.
+ *
+ * The half band cascades only support power of 2 decimations; the generic
+ * FIR decimator is used for other values.
+ */
+void receiver::set_input_decim_filter(decim_filter type)
+{
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    if (type == d_decim_filter)
+        return;
+
+    d_decim_filter = type;
+
+    if (d_decim >= 2)
+        reconfigure_input_decim(d_decim);
+}
+
+/** Create a new input decimator according to the selected filter type. */
+gr::basic_block_sptr receiver::make_input_decim(unsigned int decim) const
+{
+    bool pow2 = (decim & (decim - 1)) == 0;
+
+    if (d_decim_filter != DECIM_FILTER_FIR && pow2)
+        return make_hbf_decim(decim, (unsigned int)d_decim_filter);
+
+    return make_fir_decim_cc(decim);
+}
+
+/** Rebuild the input decimator and reconnect it to the flow graph. */
+unsigned int receiver::reconfigure_input_decim(unsigned int decim)
+{
     if (d_running)
     {
         tb->stop();
         tb->wait();
     }
 
-    if (d_decim >= 2)
-    {
-        tb->disconnect(src, 0, input_decim, 0);
-        tb->disconnect(input_decim, 0, iq_swap, 0);
-    }
-    else
-    {
-        tb->disconnect(src, 0, iq_swap, 0);
-    }
+    connect_iq_recorders(false);
+    connect_input(false);
 
     input_decim.reset();
     d_decim = decim;
@@ -382,7 +424,7 @@ unsigned int receiver::set_input_decim(unsigned int decim)
     {
         try
         {
-            input_decim = make_fir_decim_cc(d_decim);
+            input_decim = make_input_decim(d_decim);
         }
         catch (std::range_error &e)
         {
@@ -400,19 +442,13 @@ unsigned int receiver::set_input_decim(unsigned int decim)
     }
 
     // update quadrature rate
-    dc_corr->set_sample_rate(d_quad_rate);
+    iq_corr->set_sample_rate(d_quad_rate);
     rx->set_quad_rate(d_quad_rate);
     lo->set_sampling_freq(d_quad_rate);
+    update_data_tap_rates();
 
-    if (d_decim >= 2)
-    {
-        tb->connect(src, 0, input_decim, 0);
-        tb->connect(input_decim, 0, iq_swap, 0);
-    }
-    else
-    {
-        tb->connect(src, 0, iq_swap, 0);
-    }
+    connect_input(true);
+    connect_iq_recorders(true);
 
 #ifdef CUSTOM_AIRSPY_KERNELS
     if (input_devstr.find("airspy") != std::string::npos)
@@ -422,6 +458,9 @@ unsigned int receiver::set_input_decim(unsigned int decim)
     if (d_running)
         tb->start();
 
+    if (iq_ring)
+        iq_ring->set_sample_rate(d_quad_rate);
+
     return d_decim;
 }
 
@@ -448,7 +487,7 @@ void receiver::set_iq_swap(bool reversed)
         return;
 
     d_iq_rev = reversed;
-    iq_swap->set_enabled(d_iq_rev);
+    iq_corr->set_swap(d_iq_rev);
 }
 
 /**
@@ -471,12 +510,7 @@ void receiver::set_dc_cancel(bool enable)
         return;
 
     d_dc_cancel = enable;
-
-    // until we have a way to switch on/off
-    // inside the dc_corr_cc we do a reconf
-    rx_demod demod = d_demod;
-    d_demod = RX_DEMOD_OFF;
-    set_demod(demod);
+    iq_corr->set_dc_cancel(d_dc_cancel);
 }
 
 /**
@@ -500,7 +534,8 @@ void receiver::set_iq_balance(bool enable)
 
     d_iq_balance = enable;
 
-    src->set_iq_balance_mode(enable ? 2 : 0);
+    // done in software so that it works with any input device
+    iq_corr->set_iq_balance(d_iq_balance);
 }
 
 /**
@@ -521,10 +556,18 @@ bool receiver::get_iq_balance(void) const
  */
 receiver::status receiver::set_rf_freq(double freq_hz)
 {
+    // may be called from the remote control thread
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    // the frequency of a file is fixed
+    if (iq_file_src)
+        return STATUS_ERROR;
+
     d_rf_freq = freq_hz;
 
     src->set_center_freq(d_rf_freq);
     // FIXME: read back frequency?
+    update_rec_frequency();
 
     return STATUS_OK;
 }
@@ -536,6 +579,11 @@ receiver::status receiver::set_rf_freq(double freq_hz)
  */
 double receiver::get_rf_freq(void)
 {
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    if (iq_file_src)
+        return iq_file_src->frequency();
+
     d_rf_freq = src->get_center_freq();
 
     return d_rf_freq;
@@ -639,8 +687,12 @@ receiver::status receiver::set_auto_gain(bool automatic)
  */
 receiver::status receiver::set_filter_offset(double offset_hz)
 {
+    // may be called from the remote control thread
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
     d_filter_offset = offset_hz;
     lo->set_frequency(-d_filter_offset + d_cw_offset);
+    update_rec_frequency();
 
     return STATUS_OK;
 }
@@ -658,6 +710,8 @@ double receiver::get_filter_offset(void) const
 /* CW offset can serve as a "BFO" if the GUI needs it */
 receiver::status receiver::set_cw_offset(double offset_hz)
 {
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
     d_cw_offset = offset_hz;
     lo->set_frequency(-d_filter_offset + d_cw_offset);
     rx->set_cw_offset(d_cw_offset);
@@ -719,6 +773,19 @@ float receiver::get_signal_pwr(bool dbfs) const
     return rx->get_signal_level(dbfs);
 }
 
+/**
+ * @brief Get all signal level detectors.
+ * @param levels Peak, RMS, min, noise floor and SNR measured since the
+ *               previous call, all in dBFS (SNR in dB).
+ *
+ * This starts a new measurement interval, i.e. it should be used instead
+ * of get_signal_pwr() and not in addition to it.
+ */
+void receiver::get_signal_levels(rx_meter_levels &levels) const
+{
+    rx->get_signal_levels(levels);
+}
+
 /** Set new FFT size. */
 void receiver::set_iq_fft_size(int newsize)
 {
@@ -779,6 +846,141 @@ receiver::status receiver::set_sql_alpha(double alpha)
     return STATUS_OK; // FIXME
 }
 
+/**
+ * @brief Set squelch attack time.
+ * @param attack_ms The time in milliseconds used to fade audio in and out.
+ */
+receiver::status receiver::set_sql_attack(double attack_ms)
+{
+    if (rx->has_sql())
+        rx->set_sql_attack(attack_ms);
+
+    return STATUS_OK; // FIXME
+}
+
+/**
+ * @brief Set squelch hang time.
+ * @param hang_ms The time in milliseconds the squelch stays open after the
+ *                signal has dropped below the squelch level.
+ */
+receiver::status receiver::set_sql_hang(double hang_ms)
+{
+    if (rx->has_sql())
+        rx->set_sql_hang(hang_ms);
+
+    return STATUS_OK; // FIXME
+}
+
+/**
+ * @brief Enable or disable squelch gating.
+ *
+ * When enabled the squelch does not produce any samples while closed, so
+ * the demodulator and audio chain behind it are idle.
+ */
+receiver::status receiver::set_sql_gate(bool gate)
+{
+    if (rx->has_sql())
+        rx->set_sql_gate(gate);
+
+    return STATUS_OK; // FIXME
+}
+
+/**
+ * @brief Get squelch duty cycle.
+ * @returns The fraction of time the squelch has been open since the
+ *          previous call, 1.0 if the receiver has no squelch.
+ */
+float receiver::get_sql_duty_cycle()
+{
+    if (rx->has_sql())
+        return rx->get_sql_duty_cycle();
+
+    return 1.0;
+}
+
+/**
+ * @brief Get the current squelch state.
+ * @return Whether the squelch is open, always true if the receiver has no
+ *         squelch. Unlike get_sql_duty_cycle() this does not reset anything.
+ */
+bool receiver::get_sql_open()
+{
+    if (rx->has_sql())
+        return rx->get_sql_open();
+
+    return true;
+}
+
+/**
+ * @brief Whether the signal in the channel is above the squelch level.
+ * @return True while the averaged power is above the squelch level, always
+ *         true if the receiver has no squelch. The squelch hang time is not
+ *         included, so this follows the channel quickly after retuning.
+ */
+bool receiver::get_sql_signal()
+{
+    if (rx->has_sql())
+        return rx->get_sql_signal();
+
+    return true;
+}
+
+/**
+ * @brief Restart the squelch power average.
+ *
+ * Used after moving to another channel so that the signal in the previous
+ * channel does not show up in get_sql_signal() for the next one.
+ */
+void receiver::reset_sql_power()
+{
+    if (rx->has_sql())
+        rx->reset_sql_power();
+}
+
+/**
+ * @brief Set CTCSS squelch tone.
+ * @param tone_hz The tone frequency in Hz, 0 to disable.
+ *
+ * Selecting a CTCSS tone disables DCS squelch. Only the narrow band FM
+ * receiver supports tone squelch.
+ */
+receiver::status receiver::set_ctcss(float tone_hz)
+{
+    if (!rx->has_tone_sql())
+        return STATUS_ERROR;
+
+    rx->set_ctcss(tone_hz);
+
+    return STATUS_OK;
+}
+
+/**
+ * @brief Set DCS squelch code.
+ * @param code The DCS code written as decimal number, e.g. 23 for D023.
+ *             0 disables DCS squelch.
+ *
+ * Selecting a DCS code disables CTCSS squelch.
+ */
+receiver::status receiver::set_dcs(int code)
+{
+    if (!rx->has_tone_sql() || !rx->set_dcs(code))
+        return STATUS_ERROR;
+
+    return STATUS_OK;
+}
+
+/** Whether the tone squelch is open (always true when not in use). */
+bool receiver::get_tone_sql_open()
+{
+    return rx->get_tone_sql_open();
+}
+
+/** Get the strongest CTCSS tone in Hz, 0 if there is none. */
+float receiver::get_ctcss_detected()
+{
+    return rx->get_ctcss_detected();
+}
+
 /**
  * @brief Enable/disable receiver AGC.
  *
@@ -841,6 +1043,8 @@ receiver::status receiver::set_demod(rx_demod demod)
 {
     status ret = STATUS_OK;
 
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
     // Allow reconf using same demod to provide a workaround
     // for the "jerky streaming" we may experience with rtl
     // dongles (the jerkyness disappears when we run this function)
@@ -903,6 +1107,7 @@ receiver::status receiver::set_demod(rx_demod demod)
     }
 
     d_demod = demod;
+    update_iq_server_taps();
 
     if (d_running)
         tb->start();
@@ -953,87 +1158,87 @@ receiver::status receiver::set_af_gain(float gain_db)
 
 
 /**
- * @brief Start WAV file recorder.
- * @param filename The filename where to record.
+ * @brief Start audio recorder.
+ * @param filename The WAV file to record to, or the directory for the
+ *                 recordings when a squelch mode is selected.
+ * @sa set_audio_rec_mode()
  *
- * A new recorder object is created every time we start recording and deleted every time
- * we stop recording. The idea of creating one object and starting/stopping using different
- * file names does not work with WAV files (the initial /tmp/gqrx.wav will not be stopped
- * because the wav file can not be empty). See https://github.com/csete/gqrx/issues/36
+ * The recorder is always connected to the demodulator output and writes the
+ * files in a background thread, so it can be started and stopped at any time.
  */
 receiver::status receiver::start_audio_recording(const std::string filename)
 {
-    if (d_recording_wav)
+    if (audio_rec->is_open())
     {
         /* error - we are already recording */
         std::cout << "ERROR: Can not start audio recorder (already recording)" << std::endl;
 
         return STATUS_ERROR;
     }
-    if (!d_running)
-    {
-        /* receiver is not running */
-        std::cout << "Can not start audio recorder (receiver not running)" << std::endl;
-
-        return STATUS_ERROR;
-    }
-
-    // not strictly necessary to lock but I think it is safer
-    tb->lock();
 
-    // if this fails, we don't want to go and crash now, do we
-    try {
-        wav_sink->open(filename.c_str());
-        wav_sink->set_sample_rate((unsigned int) d_audio_rate);
-    }
-    catch (std::runtime_error &e) {
-        std::cout << "Error opening " << filename << ": " << e.what() << std::endl;
+    update_rec_frequency();
+    if (!audio_rec->open(filename, d_audio_rec_mode))
         return STATUS_ERROR;
-    }
-
-    tb->connect(rx, 0, wav_sink, 0);
-    tb->connect(rx, 1, wav_sink, 1);
-    tb->unlock();
-    d_recording_wav = true;
 
     std::cout << "Recording audio to " << filename << std::endl;
 
     return STATUS_OK;
 }
 
-/** Stop WAV file recorder. */
+/** Stop audio recorder. */
 receiver::status receiver::stop_audio_recording()
 {
-    if (!d_recording_wav) {
+    if (!audio_rec->is_open()) {
         /* error: we are not recording */
         std::cout << "ERROR: Can not stop audio recorder (not recording)" << std::endl;
 
         return STATUS_ERROR;
     }
-    if (!d_running)
-    {
-        /* receiver is not running */
-        std::cout << "Can not stop audio recorder (receiver not running)" << std::endl;
-
-        return STATUS_ERROR;
-    }
 
-    // not strictly necessary to lock but I think it is safer
-    tb->lock();
-    wav_sink->close();
-    tb->disconnect(rx, 0, wav_sink, 0);
-    tb->disconnect(rx, 1, wav_sink, 1);
-    tb->unlock();
-    d_recording_wav = false;
+    audio_rec->close();
 
     std::cout << "Audio recorder stopped" << std::endl;
 
     return STATUS_OK;
 }
 
+/**
+ * @brief Set audio recording mode.
+ * @param mode The recording mode used by the next recording.
+ * @param hang Time in seconds to keep recording after the squelch closes.
+ * @param rotate_min Period in minutes for starting a new file in rotate mode.
+ *
+ * The hang time and the rotation period take effect immediately.
+ */
+receiver::status receiver::set_audio_rec_mode(audio_rec_sink::rec_mode mode,
+                                              double hang, int rotate_min)
+{
+    d_audio_rec_mode = mode;
+    audio_rec->set_hang(hang);
+    audio_rec->set_rotate(rotate_min);
+
+    return STATUS_OK;
+}
+
+/** Get audio recorder statistics. */
+receiver::status receiver::get_audio_rec_stats(audio_rec_stats &stats)
+{
+    audio_rec->get_stats(stats);
+
+    return STATUS_OK;
+}
+
+/** Tell the audio recorder the frequency of the tuned channel. */
+void receiver::update_rec_frequency()
+{
+    audio_rec->set_frequency(d_rf_freq + d_filter_offset);
+}
+
 /** Start audio playback. */
 receiver::status receiver::start_audio_playback(const std::string filename)
 {
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
     if (!d_running)
     {
         /* receiver is not running */
@@ -1076,12 +1281,14 @@ receiver::status receiver::start_audio_playback(const std::string filename)
     tb->disconnect(rx, 1, audio_gain1, 0);
     tb->disconnect(rx, 0, audio_fft, 0);
     tb->disconnect(rx, 0, audio_udp_sink, 0);
+    tb->disconnect(rx, 1, audio_udp_sink, 1);
     tb->connect(rx, 0, audio_null_sink0, 0); /** FIXME: other channel? */
     tb->connect(rx, 1, audio_null_sink1, 0); /** FIXME: other channel? */
     tb->connect(wav_src, 0, audio_gain0, 0);
     tb->connect(wav_src, 1, audio_gain1, 0);
     tb->connect(wav_src, 0, audio_fft, 0);
     tb->connect(wav_src, 0, audio_udp_sink, 0);
+    tb->connect(wav_src, 1, audio_udp_sink, 1);
     start();
 
     std::cout << "Playing audio from " << filename << std::endl;
@@ -1092,18 +1299,22 @@ receiver::status receiver::start_audio_playback(const std::string filename)
 /** Stop audio playback. */
 receiver::status receiver::stop_audio_playback()
 {
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
     /* disconnect wav source and reconnect receiver */
     stop();
     tb->disconnect(wav_src, 0, audio_gain0, 0);
     tb->disconnect(wav_src, 1, audio_gain1, 0);
     tb->disconnect(wav_src, 0, audio_fft, 0);
     tb->disconnect(wav_src, 0, audio_udp_sink, 0);
+    tb->disconnect(wav_src, 1, audio_udp_sink, 1);
     tb->disconnect(rx, 0, audio_null_sink0, 0);
     tb->disconnect(rx, 1, audio_null_sink1, 0);
     tb->connect(rx, 0, audio_gain0, 0);
     tb->connect(rx, 1, audio_gain1, 0);
     tb->connect(rx, 0, audio_fft, 0);  /** FIXME: other channel? */
     tb->connect(rx, 0, audio_udp_sink, 0);
+    tb->connect(rx, 1, audio_udp_sink, 1);
     start();
 
     /* delete wav_src since we can not change file name */
@@ -1112,6 +1323,64 @@ receiver::status receiver::stop_audio_playback()
     return STATUS_OK;
 }
 
+/**
+ * @brief Get audio output buffer statistics.
+ * @param stats Buffer statistics.
+ *
+ * Only available with the pulseaudio and portaudio backends; the gr-audio
+ * sinks do not expose their buffers.
+ */
+receiver::status receiver::get_audio_stats(audio_fifo_stats &stats)
+{
+#if defined(WITH_PULSEAUDIO) || defined(WITH_PORTAUDIO)
+    audio_snk->get_stats(stats);
+    return STATUS_OK;
+#else
+    (void) stats;
+    return STATUS_ERROR;
+#endif
+}
+
+/**
+ * @brief Set audio output buffering.
+ * @param latency_ms Target latency of the audio buffer in front of the sink.
+ * @param server_ms Target latency of the audio server or device.
+ * @param minreq_ms Minimum request size of the audio server.
+ * @param prebuf_ms Amount of data the audio server buffers before playing.
+ *
+ * Values of 0 leave the server parameters to the server. Only the pulseaudio
+ * sink uses minreq_ms and prebuf_ms, and portaudio applies server_ms when
+ * the stream is restarted. Not supported by the gr-audio sinks.
+ */
+receiver::status receiver::set_audio_buffer(int latency_ms, int server_ms,
+                                            int minreq_ms, int prebuf_ms)
+{
+    d_audio_buf_ms = latency_ms;
+    d_audio_server_ms = server_ms;
+    d_audio_minreq_ms = minreq_ms;
+    d_audio_prebuf_ms = prebuf_ms;
+
+#if defined(WITH_PULSEAUDIO) || defined(WITH_PORTAUDIO)
+    apply_audio_buffer();
+    return STATUS_OK;
+#else
+    return STATUS_ERROR;
+#endif
+}
+
+/**
+ * @brief Get the measured audio output latency.
+ * @returns The latency in ms or -1 if not available.
+ */
+double receiver::get_audio_latency()
+{
+#if defined(WITH_PULSEAUDIO) || defined(WITH_PORTAUDIO)
+    return audio_snk->get_latency();
+#else
+    return -1.0;
+#endif
+}
+
 /** Start UDP streaming of audio. */
 receiver::status receiver::start_udp_streaming(const std::string host, int port)
 {
@@ -1126,75 +1395,321 @@ receiver::status receiver::stop_udp_streaming()
     return STATUS_OK;
 }
 
+/** Add a destination to the UDP audio stream. */
+receiver::status receiver::add_udp_destination(const std::string host, int port)
+{
+    if (audio_udp_sink->add_destination(host, port))
+        return STATUS_OK;
+    else
+        return STATUS_ERROR;
+}
+
+/** Remove a destination from the UDP audio stream. */
+receiver::status receiver::remove_udp_destination(const std::string host, int port)
+{
+    if (audio_udp_sink->remove_destination(host, port))
+        return STATUS_OK;
+    else
+        return STATUS_ERROR;
+}
+
+/**
+ * @brief Set UDP audio stream format.
+ * @param stereo Stream both audio channels instead of the left one only.
+ * @param format Sample format, 16 bit integer or 32 bit float.
+ * @param header Prepend a header with sequence number and sample index.
+ * @param packet_size Maximum datagram size in bytes.
+ */
+receiver::status receiver::set_udp_stream_format(bool stereo,
+                                                 udp_sink_f::sample_format format,
+                                                 bool header, int packet_size)
+{
+    audio_udp_sink->set_format(stereo, format, header);
+    audio_udp_sink->set_packet_size(packet_size);
+    return STATUS_OK;
+}
+
 /**
  * @brief Start I/Q data recorder.
  * @param filename The filename where to record.
+ * @param format The sample format in the file.
+ *
+ * The samples are written by a separate thread. A SigMF metadata file
+ * with the sample rate and frequency is written next to the data file.
  */
-receiver::status receiver::start_iq_recording(const std::string filename)
+receiver::status receiver::start_iq_recording(const std::string filename,
+                                              iq_file_format format)
 {
-    receiver::status status = STATUS_OK;
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
 
     if (d_recording_iq) {
         std::cout << __func__ << ": already recording" << std::endl;
         return STATUS_ERROR;
     }
 
-    // iq_sink was created in the constructor
-    if (iq_sink) {
-        tb->lock();
-        if (!iq_sink->open(filename.c_str()))
-        {
-            status = STATUS_ERROR;
-        }
-        else
-        {
-            if (d_decim >= 2)
-                tb->connect(input_decim, 0, iq_sink, 0);
-            else
-                tb->connect(src, 0, iq_sink, 0);
-
-            d_recording_iq = true;
-        }
-        tb->unlock();
-    }
-    else {
-        std::cout << __func__ << ": I/Q file sink does not exist" << std::endl;
+    if (!iq_sink->open(filename, format, d_input_rate / (double)d_decim,
+                       d_rf_freq))
         return STATUS_ERROR;
-    }
 
-    return status;
+    tb->lock();
+    if (d_decim >= 2)
+        tb->connect(input_decim, 0, iq_sink, 0);
+    else
+        tb->connect(input_source(), 0, iq_sink, 0);
+    tb->unlock();
+
+    d_recording_iq = true;
+
+    return STATUS_OK;
 }
 
 /** Stop I/Q data recorder. */
 receiver::status receiver::stop_iq_recording()
 {
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
     if (!d_recording_iq) {
         /* error: we are not recording */
         return STATUS_ERROR;
     }
 
     tb->lock();
-    iq_sink->close();
-
     if (d_decim >= 2)
         tb->disconnect(input_decim, 0, iq_sink, 0);
     else
-        tb->disconnect(src, 0, iq_sink, 0);
-
+        tb->disconnect(input_source(), 0, iq_sink, 0);
     tb->unlock();
+
+    // flush the queued data after the sink has been disconnected
+    iq_sink->close();
     d_recording_iq = false;
 
     return STATUS_OK;
 }
 
+/**
+ * @brief Get I/Q recorder statistics.
+ *
+ * The throughput is calculated since the previous call.
+ */
+receiver::status receiver::get_iq_recording_stats(iq_file_stats &stats)
+{
+    if (!d_recording_iq)
+        return STATUS_ERROR;
+
+    iq_sink->get_stats(stats);
+
+    return STATUS_OK;
+}
+
+/**
+ * @brief Enable or disable the pre-trigger I/Q buffer.
+ * @param seconds The amount of I/Q history to keep in memory, 0 to disable.
+ *
+ * The buffer is fed with the same samples as the I/Q recorder. It needs
+ * 8 bytes per sample, e.g. 16 MB per second at 2 Msps. Changing the
+ * history ends an ongoing commit.
+ */
+receiver::status receiver::set_iq_pretrigger(double seconds)
+{
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    if (seconds <= 0.0)
+    {
+        if (!iq_ring)
+            return STATUS_OK;
+
+        tb->lock();
+        if (d_decim >= 2)
+            tb->disconnect(input_decim, 0, iq_ring, 0);
+        else
+            tb->disconnect(input_source(), 0, iq_ring, 0);
+        tb->unlock();
+
+        // waits for an ongoing commit to be written
+        iq_ring.reset();
+    }
+    else if (iq_ring)
+    {
+        iq_ring->set_history(seconds);
+    }
+    else
+    {
+        iq_ring = make_iq_ring_sink(d_quad_rate, seconds);
+
+        tb->lock();
+        if (d_decim >= 2)
+            tb->connect(input_decim, 0, iq_ring, 0);
+        else
+            tb->connect(input_source(), 0, iq_ring, 0);
+        tb->unlock();
+    }
+
+    return STATUS_OK;
+}
+
+/** Get the pre-trigger history in seconds, 0 if disabled. */
+double receiver::get_iq_pretrigger() const
+{
+    return iq_ring ? iq_ring->get_history() : 0.0;
+}
+
+/**
+ * @brief Write the pre-trigger history and the following I/Q to a file.
+ * @param filename The filename where to record.
+ * @param format The sample format in the file.
+ * @return STATUS_ERROR if the pre-trigger buffer is disabled, a commit is
+ *         already in progress or the file can not be created.
+ *
+ * The history is read from the buffer by a separate thread; the DSP thread
+ * keeps only copying new samples into the buffer.
+ */
+receiver::status receiver::start_iq_commit(const std::string filename,
+                                           iq_file_format format)
+{
+    if (!iq_ring)
+        return STATUS_ERROR;
+
+    if (!iq_ring->commit(filename, format, d_rf_freq))
+        return STATUS_ERROR;
+
+    return STATUS_OK;
+}
+
+/**
+ * @brief Stop writing the pre-trigger buffer to file.
+ *
+ * Returns immediately; is_committing_iq() is true until the remaining
+ * samples have been written.
+ */
+receiver::status receiver::stop_iq_commit()
+{
+    if (!iq_ring)
+        return STATUS_ERROR;
+
+    iq_ring->stop_commit();
+
+    return STATUS_OK;
+}
+
+bool receiver::is_committing_iq() const
+{
+    return iq_ring && iq_ring->is_committing();
+}
+
+/** Get statistics of the ongoing pre-trigger commit. */
+receiver::status receiver::get_iq_commit_stats(iq_file_stats &stats)
+{
+    if (!is_committing_iq())
+        return STATUS_ERROR;
+
+    iq_ring->get_stats(stats);
+
+    return STATUS_OK;
+}
+
+/**
+ * @brief Play an I/Q file instead of the input device.
+ * @param filename The I/Q file, cf32 (.raw), cs16 or cs8.
+ * @param samprate The sample rate used if the file has no metadata.
+ * @return STATUS_ERROR if the file can not be opened.
+ *
+ * The file is memory mapped, see iq_file_source. The input rate and RF
+ * frequency are taken from the SigMF metadata or file name and remain
+ * fixed until stop_iq_playback().
+ */
+receiver::status receiver::start_iq_playback(const std::string filename,
+                                             double samprate)
+{
+    iq_file_info            info;
+    iq_file_source_sptr     file_src;
+
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    if (!get_iq_file_info(filename, info))
+        return STATUS_ERROR;
+
+    if (info.sample_rate <= 0.0)
+        info.sample_rate = samprate;
+
+    file_src = make_iq_file_source(filename, info);
+    if (!file_src->is_open())
+        return STATUS_ERROR;
+
+    if (d_running)
+    {
+        tb->stop();
+        tb->wait();
+    }
+
+    connect_iq_recorders(false);
+    connect_input(false);
+    iq_file_src = file_src;
+    connect_input(true);
+    connect_iq_recorders(true);
+
+    d_input_rate = info.sample_rate;
+    d_quad_rate = d_input_rate / (double)d_decim;
+    iq_corr->set_sample_rate(d_quad_rate);
+    rx->set_quad_rate(d_quad_rate);
+    lo->set_sampling_freq(d_quad_rate);
+    update_data_tap_rates();
+    d_rf_freq = info.frequency;
+    update_rec_frequency();
+
+    if (d_running)
+        tb->start();
+
+    if (iq_ring)
+        iq_ring->set_sample_rate(d_quad_rate);
+
+    return STATUS_OK;
+}
+
+/** Stop I/Q file playback and reconnect the input device. */
+receiver::status receiver::stop_iq_playback()
+{
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    if (!iq_file_src)
+        return STATUS_ERROR;
+
+    if (d_running)
+    {
+        tb->stop();
+        tb->wait();
+    }
+
+    connect_iq_recorders(false);
+    connect_input(false);
+    iq_file_src.reset();
+    connect_input(true);
+    connect_iq_recorders(true);
+
+    if (d_running)
+        tb->start();
+
+    return STATUS_OK;
+}
+
 /**
  * @brief Seek to position in IQ file source.
- * @param pos Byte offset from the beginning of the file.
+ * @param pos Sample offset from the beginning of the file.
+ *
+ * Seeking an I/Q file during playback does not lock the flow graph.
  */
 receiver::status receiver::seek_iq_file(long pos)
 {
     receiver::status status = STATUS_OK;
 
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    if (iq_file_src)
+    {
+        iq_file_src->seek(pos);
+        return STATUS_OK;
+    }
+
     tb->lock();
 
     if (src->seek(pos, SEEK_SET))
@@ -1212,80 +1727,520 @@ receiver::status receiver::seek_iq_file(long pos)
 }
 
 /**
- * @brief Start data sniffer.
- * @param buffsize The buffer that should be used in the sniffer.
- * @return STATUS_OK if the sniffer was started, STATUS_ERROR if the sniffer is already in use.
+ * @brief Set the I/Q playback speed.
+ * @param speed Factor of the file sample rate, 0 for as fast as possible.
  */
-receiver::status receiver::start_sniffer(unsigned int samprate, int buffsize)
+receiver::status receiver::set_iq_playback_speed(double speed)
 {
-    if (d_sniffer_active) {
-        /* sniffer already in use */
+    if (!iq_file_src)
         return STATUS_ERROR;
-    }
 
-    sniffer->set_buffer_size(buffsize);
-    sniffer_rr = make_resampler_ff((float)samprate/(float)d_audio_rate);
+    iq_file_src->set_speed(speed);
+
+    return STATUS_OK;
+}
+
+/** Get the I/Q playback position in seconds. */
+double receiver::get_iq_playback_pos() const
+{
+    if (!iq_file_src)
+        return 0.0;
+
+    return iq_file_src->get_position() / iq_file_src->sample_rate();
+}
+
+/**
+ * @brief Subscribe to a data stream in the receiver.
+ * @param point Where in the signal chain the data is taken.
+ * @param rate The sample rate delivered to the subscriber, 0 to use the
+ *             rate at the tap point.
+ * @param size The buffer size in samples. Samples that do not fit are
+ *             dropped and counted by the tap.
+ * @return The id of the new tap or -1 if the tap point is not available
+ *         with the current demodulator.
+ *
+ * Any number of taps can be active. The samples are read from the object
+ * returned by get_data_tap_c() or get_data_tap_f(), depending on whether
+ * the tap point is complex (TAP_IQ, TAP_FILTERED) or real (TAP_AUDIO_*).
+ */
+int receiver::add_data_tap(tap_point point, double rate, unsigned int size)
+{
+    data_tap_info   tap;
+    double          in_rate;
+    int             id;
+
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    in_rate = get_tap_point_rate(point);
+    if (in_rate <= 0.0)
+        return -1;
+
+    tap.point = point;
+    if (point == TAP_IQ || point == TAP_FILTERED)
+        tap.tap_c = make_data_tap_c(in_rate, rate, size);
+    else
+        tap.tap_f = make_data_tap_f(in_rate, rate, size);
+
+    id = d_data_tap_next_id++;
+
     tb->lock();
-    tb->connect(rx, 0, sniffer_rr, 0);
-    tb->connect(sniffer_rr, 0, sniffer, 0);
+    if (point == TAP_FILTERED || d_demod != RX_DEMOD_OFF)
+        connect_data_tap(tap);
     tb->unlock();
-    d_sniffer_active = true;
 
-    return STATUS_OK;
+    data_taps[id] = tap;
+
+    return id;
 }
 
 /**
- * @brief Stop data sniffer.
- * @return STATUS_ERROR i the sniffer is not currently active.
+ * @brief Remove a data tap.
+ * @param id The id returned by add_data_tap().
+ * @return STATUS_ERROR if there is no tap with this id.
  */
-receiver::status receiver::stop_sniffer()
+receiver::status receiver::remove_data_tap(int id)
 {
-    if (!d_sniffer_active) {
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    std::map<int, data_tap_info>::iterator it = data_taps.find(id);
+
+    if (it == data_taps.end())
         return STATUS_ERROR;
-    }
 
     tb->lock();
-    tb->disconnect(rx, 0, sniffer_rr, 0);
-    tb->disconnect(sniffer_rr, 0, sniffer, 0);
+    if (it->second.point == TAP_FILTERED || d_demod != RX_DEMOD_OFF)
+        disconnect_data_tap(it->second);
     tb->unlock();
-    d_sniffer_active = false;
 
-    /* delete resampler */
-    sniffer_rr.reset();
+    data_taps.erase(it);
 
     return STATUS_OK;
 }
 
-/** Get sniffer data. */
-void receiver::get_sniffer_data(float * outbuff, unsigned int &num)
+/** Get complex data tap, or an empty pointer if id is not a complex tap. */
+data_tap_c_sptr receiver::get_data_tap_c(int id)
+{
+    std::map<int, data_tap_info>::iterator it = data_taps.find(id);
+
+    if (it == data_taps.end())
+        return data_tap_c_sptr();
+
+    return it->second.tap_c;
+}
+
+/** Get audio data tap, or an empty pointer if id is not an audio tap. */
+data_tap_f_sptr receiver::get_data_tap_f(int id)
 {
-    sniffer->get_samples(outbuff, num);
+    std::map<int, data_tap_info>::iterator it = data_taps.find(id);
+
+    if (it == data_taps.end())
+        return data_tap_f_sptr();
+
+    return it->second.tap_f;
 }
 
-/** Convenience function to connect all blocks. */
-void receiver::connect_all(rx_chain type)
+/**
+ * @brief Get the sample rate at a tap point.
+ * @return The sample rate or 0 if the tap point is not available.
+ */
+double receiver::get_tap_point_rate(tap_point point)
 {
-    switch (type)
+    switch (point)
+    {
+    case TAP_IQ:
+        return d_quad_rate;
+
+    case TAP_FILTERED:
+        if (rx->has_filter_tap())
+            return rx->get_filter_tap_rate();
+        return 0.0;
+
+    case TAP_AUDIO_LEFT:
+    case TAP_AUDIO_RIGHT:
+        return d_audio_rate;
+
+    default:
+        return 0.0;
+    }
+}
+
+/**
+ * @brief Start the I/Q network server.
+ * @param port The TCP port to listen on.
+ *
+ * The server reads the baseband I/Q and the channel filter output through
+ * two data taps, so the flow graph produces each stream once regardless of
+ * the number of clients. The channel filter output is only available with
+ * demodulators that have a filter tap. The server only feeds a tap while a
+ * client streams from it, and set_demod() rebinds the filter tap to the new
+ * receiver chain.
+ */
+receiver::status receiver::start_iq_server(int port)
+{
+    int     id;
+
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    stop_iq_server();
+
+    d_iq_server_taps[iq_server::SOURCE_IQ] =
+            add_data_tap(TAP_IQ, 0.0, IQ_SERVER_TAP_SIZE);
+    d_iq_server_taps[iq_server::SOURCE_FILTERED] =
+            add_data_tap(TAP_FILTERED, 0.0, IQ_SERVER_TAP_SIZE);
+
+    d_iq_server = boost::shared_ptr<iq_server>(new iq_server());
+
+    id = d_iq_server_taps[iq_server::SOURCE_FILTERED];
+    if (!d_iq_server->start(port,
+                            get_data_tap_c(d_iq_server_taps[iq_server::SOURCE_IQ]),
+                            id < 0 ? data_tap_c_sptr() : get_data_tap_c(id)))
+    {
+        stop_iq_server();
+        return STATUS_ERROR;
+    }
+
+    return STATUS_OK;
+}
+
+/** Stop the I/Q network server and disconnect all clients. */
+receiver::status receiver::stop_iq_server()
+{
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    if (!d_iq_server)
+        return STATUS_ERROR;
+
+    d_iq_server->stop();
+    d_iq_server.reset();
+
+    for (int i = 0; i < iq_server::SOURCE_COUNT; i++)
+    {
+        if (d_iq_server_taps[i] >= 0)
+            remove_data_tap(d_iq_server_taps[i]);
+        d_iq_server_taps[i] = -1;
+    }
+
+    return STATUS_OK;
+}
+
+/**
+ * @brief Bind the I/Q server to the channel filter of the current receiver.
+ *
+ * Called when the receiver chain may have been replaced. connect_all()
+ * moves existing filter taps to a new receiver; this creates the tap if
+ * the previous receiver had no channel filter output and hands the server
+ * the tap that is valid now.
+ */
+void receiver::update_iq_server_taps()
+{
+    int    &id = d_iq_server_taps[iq_server::SOURCE_FILTERED];
+
+    if (!d_iq_server)
+        return;
+
+    if (!rx->has_filter_tap())
+    {
+        d_iq_server->set_tap(iq_server::SOURCE_FILTERED, data_tap_c_sptr());
+        return;
+    }
+
+    if (id < 0)
+    {
+        data_tap_info   tap;
+
+        tap.point = TAP_FILTERED;
+        tap.tap_c = make_data_tap_c(rx->get_filter_tap_rate(), 0.0,
+                                    IQ_SERVER_TAP_SIZE);
+        connect_data_tap(tap);
+
+        id = d_data_tap_next_id++;
+        data_taps[id] = tap;
+    }
+
+    d_iq_server->set_tap(iq_server::SOURCE_FILTERED, get_data_tap_c(id));
+}
+
+/** Get the number of clients connected to the I/Q server. */
+unsigned int receiver::get_iq_server_clients() const
+{
+    return d_iq_server ? d_iq_server->num_clients() : 0;
+}
+
+/**
+ * @brief Connect a data tap to its tap point.
+ *
+ * Taps at the channel filter are connected inside the receiver and stay
+ * connected while the receiver is not part of the flow graph. The other
+ * taps are connected to the flow graph and must only be connected while the
+ * demodulator is on.
+ */
+void receiver::connect_data_tap(const data_tap_info &tap)
+{
+    switch (tap.point)
+    {
+    case TAP_IQ:
+        tb->connect(mixer, 0, tap.tap_c, 0);
+        break;
+
+    case TAP_FILTERED:
+        rx->connect_filter_tap(tap.tap_c);
+        break;
+
+    case TAP_AUDIO_LEFT:
+        tb->connect(rx, 0, tap.tap_f, 0);
+        break;
+
+    case TAP_AUDIO_RIGHT:
+        tb->connect(rx, 1, tap.tap_f, 0);
+        break;
+    }
+}
+
+void receiver::disconnect_data_tap(const data_tap_info &tap)
+{
+    switch (tap.point)
+    {
+    case TAP_IQ:
+        tb->disconnect(mixer, 0, tap.tap_c, 0);
+        break;
+
+    case TAP_FILTERED:
+        rx->disconnect_filter_tap(tap.tap_c);
+        break;
+
+    case TAP_AUDIO_LEFT:
+        tb->disconnect(rx, 0, tap.tap_f, 0);
+        break;
+
+    case TAP_AUDIO_RIGHT:
+        tb->disconnect(rx, 1, tap.tap_f, 0);
+        break;
+    }
+}
+
+/** Update the input rate of the data taps after a sample rate change. */
+void receiver::update_data_tap_rates()
+{
+    std::map<int, data_tap_info>::iterator it;
+
+    for (it = data_taps.begin(); it != data_taps.end(); ++it)
+    {
+        double rate = get_tap_point_rate(it->second.point);
+
+        if (rate <= 0.0)
+            continue;
+
+        if (it->second.tap_c)
+            it->second.tap_c->set_input_rate(rate);
+        else
+            it->second.tap_f->set_input_rate(rate);
+    }
+}
+
+/**
+ * @brief Start an AFSK1200 packet decoder.
+ * @param channel The receiver output to decode, 0 = left, 1 = right.
+ * @return The id of the new decoder or -1 if the channel is invalid.
+ *
+ * The decoder runs in the flow graph and several decoders can be active at
+ * the same time. Decoded frames are fetched using get_afsk1200_frame().
+ */
+int receiver::start_afsk1200_decoder(int channel)
+{
+    afsk1200_decoder    decoder;
+    int                 id;
+
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    if (channel < 0 || channel > 1)
+        return -1;
+
+    decoder.channel = channel;
+    decoder.rr = make_resampler_ff((float)FREQ_SAMP/(float)d_audio_rate);
+    decoder.dec = make_cafsk12();
+
+    id = d_afsk1200_next_id++;
+
+    if (d_demod != RX_DEMOD_OFF)
+    {
+        tb->lock();
+        tb->connect(rx, channel, decoder.rr, 0);
+        tb->connect(decoder.rr, 0, decoder.dec, 0);
+        tb->unlock();
+    }
+
+    afsk1200_decs[id] = decoder;
+
+    return id;
+}
+
+/**
+ * @brief Stop an AFSK1200 packet decoder.
+ * @param id The id returned by start_afsk1200_decoder().
+ * @return STATUS_ERROR if there is no decoder with this id.
+ */
+receiver::status receiver::stop_afsk1200_decoder(int id)
+{
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    std::map<int, afsk1200_decoder>::iterator it = afsk1200_decs.find(id);
+
+    if (it == afsk1200_decs.end())
+        return STATUS_ERROR;
+
+    if (d_demod != RX_DEMOD_OFF)
+    {
+        tb->lock();
+        tb->disconnect(rx, it->second.channel, it->second.rr, 0);
+        tb->disconnect(it->second.rr, 0, it->second.dec, 0);
+        tb->unlock();
+    }
+
+    afsk1200_decs.erase(it);
+
+    return STATUS_OK;
+}
+
+/**
+ * @brief Select the receiver output an AFSK1200 decoder is connected to.
+ * @param id The id returned by start_afsk1200_decoder().
+ * @param channel The receiver output, 0 = left, 1 = right.
+ */
+receiver::status receiver::set_afsk1200_channel(int id, int channel)
+{
+    boost::recursive_mutex::scoped_lock lock(d_tune_mutex);
+
+    std::map<int, afsk1200_decoder>::iterator it = afsk1200_decs.find(id);
+
+    if (it == afsk1200_decs.end() || channel < 0 || channel > 1)
+        return STATUS_ERROR;
+
+    if (channel == it->second.channel)
+        return STATUS_OK;
+
+    if (d_demod != RX_DEMOD_OFF)
+    {
+        tb->lock();
+        tb->disconnect(rx, it->second.channel, it->second.rr, 0);
+        tb->connect(rx, channel, it->second.rr, 0);
+        tb->unlock();
+    }
+
+    it->second.channel = channel;
+
+    return STATUS_OK;
+}
+
+/**
+ * @brief Get the oldest decoded frame from an AFSK1200 decoder.
+ * @param id The id returned by start_afsk1200_decoder().
+ * @param frame The decoded frame formatted as text.
+ * @return False if the decoder does not exist or has no new frames.
+ */
+bool receiver::get_afsk1200_frame(int id, std::string &frame)
+{
+    std::map<int, afsk1200_decoder>::iterator it = afsk1200_decs.find(id);
+
+    if (it == afsk1200_decs.end())
+        return false;
+
+    return it->second.dec->get_frame(frame);
+}
+
+/** Apply the audio buffer settings to the current audio sink. */
+void receiver::apply_audio_buffer()
+{
+#if defined(WITH_PULSEAUDIO) || defined(WITH_PORTAUDIO)
+    audio_snk->set_target_latency(d_audio_buf_ms);
+    audio_snk->set_buffer_attr(d_audio_server_ms, d_audio_minreq_ms,
+                               d_audio_prebuf_ms);
+#endif
+}
+
+/** Get the block providing the input samples: the I/Q file or the device. */
+gr::basic_block_sptr receiver::input_source() const
+{
+    if (iq_file_src)
+        return iq_file_src;
+
+    return src;
+}
+
+/** Connect or disconnect the input source and decimator. */
+void receiver::connect_input(bool connect)
+{
+    if (connect)
     {
-    case RX_CHAIN_NONE:
         if (d_decim >= 2)
         {
-            tb->connect(src, 0, input_decim, 0);
-            tb->connect(input_decim, 0, iq_swap, 0);
+            tb->connect(input_source(), 0, input_decim, 0);
+            tb->connect(input_decim, 0, iq_corr, 0);
         }
         else
         {
-            tb->connect(src, 0, iq_swap, 0);
+            tb->connect(input_source(), 0, iq_corr, 0);
         }
-        if (d_dc_cancel)
+    }
+    else
+    {
+        if (d_decim >= 2)
         {
-            tb->connect(iq_swap, 0, dc_corr, 0);
-            tb->connect(dc_corr, 0, iq_fft, 0);
+            tb->disconnect(input_source(), 0, input_decim, 0);
+            tb->disconnect(input_decim, 0, iq_corr, 0);
         }
         else
         {
-            tb->connect(iq_swap, 0, iq_fft, 0);
+            tb->disconnect(input_source(), 0, iq_corr, 0);
         }
+    }
+}
+
+/**
+ * @brief Connect or disconnect the I/Q recorder and pre-trigger buffer.
+ *
+ * Both are fed from the output of the input decimator, when there is one.
+ */
+void receiver::connect_iq_recorders(bool connect)
+{
+    gr::basic_block_sptr    input = input_source();
+
+    if (d_decim >= 2)
+        input = input_decim;
+
+    if (connect)
+    {
+        if (d_recording_iq)
+            tb->connect(input, 0, iq_sink, 0);
+        if (iq_ring)
+            tb->connect(input, 0, iq_ring, 0);
+    }
+    else
+    {
+        if (d_recording_iq)
+            tb->disconnect(input, 0, iq_sink, 0);
+        if (iq_ring)
+            tb->disconnect(input, 0, iq_ring, 0);
+    }
+}
+
+/** Convenience function to connect all blocks. */
+void receiver::connect_all(rx_chain type)
+{
+    bool rx_changed = false;
+
+    switch (type)
+    {
+    case RX_CHAIN_NONE:
+        if (d_decim >= 2)
+        {
+            tb->connect(input_source(), 0, input_decim, 0);
+            tb->connect(input_decim, 0, iq_corr, 0);
+        }
+        else
+        {
+            tb->connect(input_source(), 0, iq_corr, 0);
+        }
+        tb->connect(iq_corr, 0, iq_fft, 0);
         break;
 
     case RX_CHAIN_NBRX:
@@ -1293,31 +2248,26 @@ void receiver::connect_all(rx_chain type)
         {
             rx.reset();
             rx = make_nbrx(d_quad_rate, d_audio_rate);
+            rx_changed = true;
         }
         if (d_decim >= 2)
         {
-            tb->connect(src, 0, input_decim, 0);
-            tb->connect(input_decim, 0, iq_swap, 0);
-        }
-        else
-        {
-            tb->connect(src, 0, iq_swap, 0);
-        }
-        if (d_dc_cancel)
-        {
-            tb->connect(iq_swap, 0, dc_corr, 0);
-            tb->connect(dc_corr, 0, iq_fft, 0);
-            tb->connect(dc_corr, 0, mixer, 0);
+            tb->connect(input_source(), 0, input_decim, 0);
+            tb->connect(input_decim, 0, iq_corr, 0);
         }
         else
         {
-            tb->connect(iq_swap, 0, iq_fft, 0);
-            tb->connect(iq_swap, 0, mixer, 0);
+            tb->connect(input_source(), 0, iq_corr, 0);
         }
+        tb->connect(iq_corr, 0, iq_fft, 0);
+        tb->connect(iq_corr, 0, mixer, 0);
         tb->connect(lo, 0, mixer, 1);
         tb->connect(mixer, 0, rx, 0);
         tb->connect(rx, 0, audio_fft, 0);
         tb->connect(rx, 0, audio_udp_sink, 0);
+        tb->connect(rx, 1, audio_udp_sink, 1);
+        tb->connect(rx, 0, audio_rec, 0);
+        tb->connect(rx, 1, audio_rec, 1);
         tb->connect(rx, 0, audio_gain0, 0);
         tb->connect(rx, 1, audio_gain1, 0);
         tb->connect(audio_gain0, 0, audio_snk, 0);
@@ -1329,31 +2279,26 @@ void receiver::connect_all(rx_chain type)
         {
             rx.reset();
             rx = make_wfmrx(d_quad_rate, d_audio_rate);
+            rx_changed = true;
         }
         if (d_decim >= 2)
         {
-            tb->connect(src, 0, input_decim, 0);
-            tb->connect(input_decim, 0, iq_swap, 0);
+            tb->connect(input_source(), 0, input_decim, 0);
+            tb->connect(input_decim, 0, iq_corr, 0);
         }
         else
         {
-            tb->connect(src, 0, iq_swap, 0);
-        }
-        if (d_dc_cancel)
-        {
-            tb->connect(iq_swap, 0, dc_corr, 0);
-            tb->connect(dc_corr, 0, iq_fft, 0);
-            tb->connect(dc_corr, 0, mixer, 0);
-        }
-        else
-        {
-            tb->connect(iq_swap, 0, iq_fft, 0);
-            tb->connect(iq_swap, 0, mixer, 0);
+            tb->connect(input_source(), 0, iq_corr, 0);
         }
+        tb->connect(iq_corr, 0, iq_fft, 0);
+        tb->connect(iq_corr, 0, mixer, 0);
         tb->connect(lo, 0, mixer, 1);
         tb->connect(mixer, 0, rx, 0);
         tb->connect(rx, 0, audio_fft, 0);
         tb->connect(rx, 0, audio_udp_sink, 0);
+        tb->connect(rx, 1, audio_udp_sink, 1);
+        tb->connect(rx, 0, audio_rec, 0);
+        tb->connect(rx, 1, audio_rec, 1);
         tb->connect(rx, 0, audio_gain0, 0);
         tb->connect(rx, 1, audio_gain1, 0);
         tb->connect(audio_gain0, 0, audio_snk, 0);
@@ -1364,26 +2309,29 @@ void receiver::connect_all(rx_chain type)
         break;
     }
 
-    // reconnect recorders and sniffers
-    if (d_recording_iq)
-    {
-        if (d_decim >= 2)
-            tb->connect(input_decim, 0, iq_sink, 0);
-        else
-            tb->connect(src, 0, iq_sink, 0);
-    }
+    // reconnect recorders, decoders and data taps
+    connect_iq_recorders(true);
+
+    if (type == RX_CHAIN_NONE)
+        return;
 
-    if (d_recording_wav)
+    std::map<int, afsk1200_decoder>::iterator it;
+    for (it = afsk1200_decs.begin(); it != afsk1200_decs.end(); ++it)
     {
-        tb->connect(rx, 0, wav_sink, 0);
-        tb->connect(rx, 1, wav_sink, 1);
+        tb->connect(rx, it->second.channel, it->second.rr, 0);
+        tb->connect(it->second.rr, 0, it->second.dec, 0);
     }
 
-    if (d_sniffer_active)
+    // filter taps are still connected inside the receiver unless it was
+    // replaced
+    std::map<int, data_tap_info>::iterator tap;
+    for (tap = data_taps.begin(); tap != data_taps.end(); ++tap)
     {
-        tb->connect(rx, 0, sniffer_rr, 0);
-        tb->connect(sniffer_rr, 0, sniffer, 0);
+        if (tap->second.point != TAP_FILTERED || rx_changed)
+            connect_data_tap(tap->second);
     }
+    if (rx_changed)
+        update_data_tap_rates();
 }
 
 void receiver::get_rds_data(std::string &outbuff, int &num)
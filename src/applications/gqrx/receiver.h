@@ -24,18 +24,20 @@
 #define RECEIVER_H
 
 #include <gnuradio/analog/sig_source_c.h>
-#include <gnuradio/blocks/file_sink.h>
 #include <gnuradio/blocks/multiply_const_ff.h>
 #include <gnuradio/blocks/multiply_cc.h>
 #include <gnuradio/blocks/null_sink.h>
-#include <gnuradio/blocks/wavfile_sink.h>
 #include <gnuradio/blocks/wavfile_source.h>
 #include <gnuradio/top_block.h>
 #include <osmosdr/source.h>
+#include <boost/thread/recursive_mutex.hpp>
+#include <map>
 #include <string>
 
+#include "dsp/audio_fifo.h"
 #include "dsp/correct_iq_cc.h"
 #include "dsp/filter/fir_decim.h"
+#include "dsp/hbf_decim.h"
 #include "dsp/rx_noise_blanker_cc.h"
 #include "dsp/rx_filter.h"
 #include "dsp/rx_meter.h"
@@ -43,8 +45,14 @@
 #include "dsp/rx_demod_fm.h"
 #include "dsp/rx_demod_am.h"
 #include "dsp/rx_fft.h"
-#include "dsp/sniffer_f.h"
+#include "dsp/data_tap.h"
+#include "dsp/afsk1200/cafsk12.h"
 #include "dsp/resampler_xx.h"
+#include "interfaces/audio_rec_sink.h"
+#include "interfaces/iq_file_sink.h"
+#include "interfaces/iq_file_source.h"
+#include "interfaces/iq_ring_sink.h"
+#include "interfaces/iq_server.h"
 #include "interfaces/udp_sink_f.h"
 #include "receivers/receiver_base.h"
 
@@ -98,6 +106,22 @@ public:
         RX_CHAIN_WFMRX = 2    /*!< Wide band FM receiver (for broadcast). */
     };
 
+    /** Input decimator filter types. */
+    enum decim_filter {
+        DECIM_FILTER_FIR     = 0,   /*!< Generic FIR cascade. */
+        DECIM_FILTER_HBF_70  = 70,  /*!< Half band cascade, 70 dB attenuation. */
+        DECIM_FILTER_HBF_100 = 100, /*!< Half band cascade, 100 dB attenuation. */
+        DECIM_FILTER_HBF_140 = 140  /*!< Half band cascade, 140 dB attenuation. */
+    };
+
+    /** Points in the signal chain where data taps can be attached. */
+    enum tap_point {
+        TAP_IQ          = 0,  /*!< Baseband I/Q before the channel filter. */
+        TAP_FILTERED    = 1,  /*!< Channel filter output (complex). */
+        TAP_AUDIO_LEFT  = 2,  /*!< Audio output, left channel. */
+        TAP_AUDIO_RIGHT = 3   /*!< Audio output, right channel. */
+    };
+
     /** Filter shape (convenience wrappers for "transition width"). */
     enum filter_shape {
         FILTER_SHAPE_SOFT = 0,   /*!< Soft: Transition band is TBD of width. */
@@ -124,6 +148,9 @@ public:
     unsigned int    set_input_decim(unsigned int decim);
     unsigned int    get_input_decim(void) const { return d_decim; }
 
+    void        set_input_decim_filter(decim_filter type);
+    decim_filter    get_input_decim_filter(void) const { return d_decim_filter; }
+
     double      get_quad_rate(void) const {
         return d_input_rate / (double)d_decim;
     }
@@ -158,6 +185,7 @@ public:
     status      set_filter(double low, double high, filter_shape shape);
     status      set_freq_corr(double ppm);
     float       get_signal_pwr(bool dbfs) const;
+    void        get_signal_levels(rx_meter_levels &levels) const;
     void        set_iq_fft_size(int newsize);
     void        set_iq_fft_window(int window_type);
     void        get_iq_fft_data(std::complex<float>* fftPoints,
@@ -172,6 +200,19 @@ public:
     /* Squelch parameter */
     status      set_sql_level(double level_db);
     status      set_sql_alpha(double alpha);
+    status      set_sql_attack(double attack_ms);
+    status      set_sql_hang(double hang_ms);
+    status      set_sql_gate(bool gate);
+    float       get_sql_duty_cycle();
+    bool        get_sql_open();
+    bool        get_sql_signal();
+    void        reset_sql_power();
+
+    /* Tone squelch */
+    status      set_ctcss(float tone_hz);
+    status      set_dcs(int code);
+    bool        get_tone_sql_open();
+    float       get_ctcss_detected();
 
     /* AGC */
     status      set_agc_on(bool agc_on);
@@ -194,24 +235,64 @@ public:
     status      set_af_gain(float gain_db);
     status      start_audio_recording(const std::string filename);
     status      stop_audio_recording();
+    status      set_audio_rec_mode(audio_rec_sink::rec_mode mode,
+                                   double hang, int rotate_min);
+    status      get_audio_rec_stats(audio_rec_stats &stats);
     status      start_audio_playback(const std::string filename);
     status      stop_audio_playback();
+    status      get_audio_stats(audio_fifo_stats &stats);
+    status      set_audio_buffer(int latency_ms, int server_ms,
+                                 int minreq_ms, int prebuf_ms);
+    double      get_audio_latency();
 
     status      start_udp_streaming(const std::string host, int port);
     status      stop_udp_streaming();
+    status      add_udp_destination(const std::string host, int port);
+    status      remove_udp_destination(const std::string host, int port);
+    status      set_udp_stream_format(bool stereo, udp_sink_f::sample_format format,
+                                      bool header, int packet_size);
 
     /* I/Q recording and playback */
-    status      start_iq_recording(const std::string filename);
+    status      start_iq_recording(const std::string filename,
+                                   iq_file_format format = IQ_FORMAT_CF32);
     status      stop_iq_recording();
+    status      get_iq_recording_stats(iq_file_stats &stats);
+
+    /* pre-trigger I/Q recording */
+    status      set_iq_pretrigger(double seconds);
+    double      get_iq_pretrigger() const;
+    status      start_iq_commit(const std::string filename,
+                                iq_file_format format = IQ_FORMAT_CF32);
+    status      stop_iq_commit();
+    bool        is_committing_iq() const;
+    status      get_iq_commit_stats(iq_file_stats &stats);
+
+    status      start_iq_playback(const std::string filename, double samprate);
+    status      stop_iq_playback();
+    bool        is_playing_iq() const { return iq_file_src.get() != 0; }
     status      seek_iq_file(long pos);
+    status      set_iq_playback_speed(double speed);
+    double      get_iq_playback_pos() const;
 
-    /* sample sniffer */
-    status      start_sniffer(unsigned int samplrate, int buffsize);
-    status      stop_sniffer();
-    void        get_sniffer_data(float * outbuff, unsigned int &num);
+    /* data taps */
+    int         add_data_tap(tap_point point, double rate, unsigned int size);
+    status      remove_data_tap(int id);
+    data_tap_c_sptr get_data_tap_c(int id);
+    data_tap_f_sptr get_data_tap_f(int id);
+    double      get_tap_point_rate(tap_point point);
 
-    bool        is_recording_audio(void) const { return d_recording_wav; }
-    bool        is_snifffer_active(void) const { return d_sniffer_active; }
+    /* I/Q network server */
+    status      start_iq_server(int port);
+    status      stop_iq_server();
+    unsigned int get_iq_server_clients() const;
+
+    bool        is_recording_audio(void) const { return audio_rec->is_open(); }
+
+    /* AFSK1200 packet decoders */
+    int         start_afsk1200_decoder(int channel = 0);
+    status      stop_afsk1200_decoder(int id);
+    status      set_afsk1200_channel(int id, int channel);
+    bool        get_afsk1200_frame(int id, std::string &frame);
 
     /* rds functions */
     void        get_rds_data(std::string &outbuff, int &num);
@@ -222,19 +303,25 @@ public:
 
 private:
     void        connect_all(rx_chain type);
+    void        apply_audio_buffer();
 
 private:
     bool        d_running;          /*!< Whether receiver is running or not. */
     double      d_input_rate;       /*!< Input sample rate. */
     double      d_quad_rate;        /*!< Quadrature rate (input_rate / decim) */
     double      d_audio_rate;       /*!< Audio output rate. */
+    int         d_audio_buf_ms;     /*!< Audio buffer target latency. */
+    int         d_audio_server_ms;  /*!< Audio server target latency, 0 for default. */
+    int         d_audio_minreq_ms;  /*!< Audio server minimum request, 0 for default. */
+    int         d_audio_prebuf_ms;  /*!< Audio server prebuffer, 0 for default. */
     unsigned int    d_decim;        /*!< input decimation. */
+    decim_filter    d_decim_filter; /*!< Input decimator filter type. */
     double      d_rf_freq;          /*!< Current RF frequency. */
     double      d_filter_offset;    /*!< Current filter offset */
     double      d_cw_offset;        /*!< CW offset */
+    boost::recursive_mutex d_tune_mutex; /*!< Serializes tuning with reconfiguration. */
     bool        d_recording_iq;     /*!< Whether we are recording I/Q file. */
-    bool        d_recording_wav;    /*!< Whether we are recording WAV file. */
-    bool        d_sniffer_active;   /*!< Only one data decoder allowed. */
+    audio_rec_sink::rec_mode d_audio_rec_mode; /*!< Audio recording mode. */
     bool        d_iq_rev;           /*!< Whether I/Q is reversed or not. */
     bool        d_dc_cancel;        /*!< Enable automatic DC removal. */
     bool        d_iq_balance;       /*!< Enable automatic IQ balance. */
@@ -247,11 +334,11 @@ private:
     gr::top_block_sptr         tb;        /*!< The GNU Radio top block. */
 
     osmosdr::source::sptr     src;       /*!< Real time I/Q source. */
-    fir_decim_cc_sptr         input_decim;      /*!< Input decimator. */
+    iq_file_source_sptr       iq_file_src;      /*!< I/Q file source, during playback. */
+    gr::basic_block_sptr      input_decim;      /*!< Input decimator. */
     receiver_base_cf_sptr     rx;        /*!< receiver. */
 
-    dc_corr_cc_sptr           dc_corr;   /*!< DC corrector block. */
-    iq_swap_cc_sptr           iq_swap;   /*!< I/Q swapping block. */
+    iq_corr_cc_sptr           iq_corr;   /*!< I/Q swap, DC and I/Q balance correction. */
 
     rx_fft_c_sptr             iq_fft;     /*!< Baseband FFT block. */
     rx_fft_f_sptr             audio_fft;  /*!< Audio FFT block. */
@@ -262,16 +349,48 @@ private:
     gr::blocks::multiply_const_ff::sptr audio_gain0; /*!< Audio gain block. */
     gr::blocks::multiply_const_ff::sptr audio_gain1; /*!< Audio gain block. */
 
-    gr::blocks::file_sink::sptr         iq_sink;     /*!< I/Q file sink. */
+    iq_file_sink_sptr                   iq_sink;     /*!< I/Q file sink. */
+    iq_ring_sink_sptr                   iq_ring;     /*!< Pre-trigger I/Q buffer, if enabled. */
 
-    gr::blocks::wavfile_sink::sptr      wav_sink;   /*!< WAV file sink for recording. */
+    audio_rec_sink_sptr                 audio_rec;  /*!< Audio recorder. */
     gr::blocks::wavfile_source::sptr    wav_src;    /*!< WAV file source for playback. */
     gr::blocks::null_sink::sptr         audio_null_sink0; /*!< Audio null sink used during playback. */
     gr::blocks::null_sink::sptr         audio_null_sink1; /*!< Audio null sink used during playback. */
 
     udp_sink_f_sptr   audio_udp_sink;  /*!< UDP sink to stream audio over the network. */
-    sniffer_f_sptr    sniffer;    /*!< Sample sniffer for data decoders. */
-    resampler_ff_sptr sniffer_rr; /*!< Sniffer resampler. */
+
+    /** Data tap attached to one of the tap points. */
+    struct data_tap_info {
+        tap_point         point;
+        data_tap_c_sptr   tap_c;    /*!< Set for complex tap points. */
+        data_tap_f_sptr   tap_f;    /*!< Set for audio tap points. */
+    };
+
+    std::map<int, data_tap_info> data_taps; /*!< Active data taps by id. */
+    int         d_data_tap_next_id; /*!< Id of the next data tap. */
+
+    void        connect_data_tap(const data_tap_info &tap);
+    void        disconnect_data_tap(const data_tap_info &tap);
+    void        update_data_tap_rates();
+
+    void        connect_iq_recorders(bool connect);
+    void        update_iq_server_taps();
+    void        connect_input(bool connect);
+    void        update_rec_frequency();
+    gr::basic_block_sptr input_source() const;
+
+    /** AFSK1200 decoder attached to one of the audio outputs. */
+    struct afsk1200_decoder {
+        int               channel;  /*!< Receiver output, 0 = left, 1 = right. */
+        resampler_ff_sptr rr;       /*!< Resampler to the decoder rate. */
+        cafsk12_sptr      dec;      /*!< The decoder sink. */
+    };
+
+    std::map<int, afsk1200_decoder> afsk1200_decs;  /*!< Active decoders by id. */
+    int         d_afsk1200_next_id; /*!< Id of the next decoder. */
+
+    boost::shared_ptr<iq_server> d_iq_server; /*!< I/Q network server. */
+    int         d_iq_server_taps[iq_server::SOURCE_COUNT]; /*!< Data taps used by the server. */
 
 #ifdef WITH_PULSEAUDIO
     pa_sink_sptr              audio_snk;  /*!< Pulse audio sink. */
@@ -281,6 +400,9 @@ private:
     gr::audio::sink::sptr     audio_snk;  /*!< gr audio sink */
 #endif
 
+    unsigned int reconfigure_input_decim(unsigned int decim);
+    gr::basic_block_sptr make_input_decim(unsigned int decim) const;
+
     //! Get a path to a file containing random bytes
     static std::string get_random_file(void);
 
@@ -22,11 +22,18 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <cmath>
+#include <cstring>
 #include <cstdlib>
 #include <iostream>
+#include <chrono>
+#include <QDateTime>
 #include <QString>
+#include <QRegExp>
 #include <QStringList>
+#include <QThread>
+#include <QtEndian>
 #include <QtGlobal>
+#include "receiver.h"
 #include "remote_control.h"
 
 RemoteControl::RemoteControl(QObject *parent) :
@@ -40,18 +47,61 @@ RemoteControl::RemoteControl(QObject *parent) :
     rc_passband_lo = 0;
     rc_passband_hi = 0;
     signal_level = -200.0;
+    signal_peak = -200.0;
+    signal_rms = -200.0;
+    signal_min = -200.0;
+    signal_noise = -200.0;
+    signal_snr = 0.0;
     squelch_level = -150.0;
+    squelch_duty = 1.0;
+    ctcss_tone = 0.0;
+    dcs_code = 0;
+    tone_sql_open = true;
+    ctcss_detected = 0.0;
+    audio_latency = -1.0;
+    audio_underruns = 0;
+    audio_overruns = 0;
     audio_recorder_status = false;
+    iq_trigger_status = false;
     receiver_running = false;
     hamlib_compatible = false;
+    squelch_open = true;
+    rx = 0;
+    direct_tuning = false;
+    tune_notify = false;
+    tune_latency_us = 0;
+    tune_latency_max_us = 0;
+    batch_depth = 0;
+    batch_depth_net = 0;
+    batch_offset = false;
+    batch_freq = false;
 }
 
 RemoteControl::~RemoteControl()
 {
 }
 
-/*! \brief Execute command and return response */
-QString RemoteControl::executeCommand(QString command, bool &quit_requested)
+#define TLM_MIN_INTERVAL_MS     10
+#define TLM_MAX_INTERVAL_MS     60000
+#define TLM_POLL_MS             50      /* change detection without interval */
+
+#define SPECTRUM_MAGIC          "GQSP"
+#define SPECTRUM_VERSION        1
+#define SPECTRUM_HEADER_SIZE    28
+#define SPECTRUM_MIN_BINS       16
+#define SPECTRUM_MAX_BINS       65535
+#define SPECTRUM_MAX_FPS        50
+
+static const char *telemetry_names[] = {
+    "STRENGTH", "SNR", "SQL", "FREQ", "MODE"
+};
+
+/*! \brief Execute command and return response
+ *  \param client Identifies the connection for SUBSCRIBE, 0 if pushing
+ *                telemetry is not possible.
+ */
+QString RemoteControl::executeCommand(QString command, bool &quit_requested,
+                                      QObject *client)
 {
     QString answer = "";
 
@@ -78,6 +128,14 @@ QString RemoteControl::executeCommand(QString command, bool &quit_requested)
         answer = cmd_get_level(cmdlist);
     else if (cmd == "L")
         answer = cmd_set_level(cmdlist);
+    else if (cmd == "c" || cmd == "\\get_ctcss_sql")
+        answer = cmd_get_ctcss();
+    else if (cmd == "C" || cmd == "\\set_ctcss_sql")
+        answer = cmd_set_ctcss(cmdlist);
+    else if (cmd == "d" || cmd == "\\get_dcs_sql")
+        answer = cmd_get_dcs();
+    else if (cmd == "D" || cmd == "\\set_dcs_sql")
+        answer = cmd_set_dcs(cmdlist);
     else if (cmd == "u")
         answer = cmd_get_func(cmdlist);
     else if (cmd == "U")
@@ -100,6 +158,12 @@ QString RemoteControl::executeCommand(QString command, bool &quit_requested)
         answer = cmd_lnb_lo(cmdlist);
     else if (cmd == "\\dump_state")
         answer = cmd_dump_state();
+    else if (cmd == "SUBSCRIBE")
+        answer = cmd_subscribe(cmdlist, client);
+    else if (cmd == "UNSUBSCRIBE")
+        answer = cmd_unsubscribe(client);
+    else if (cmd == "SPECTRUM")
+        answer = cmd_spectrum(cmdlist, client);
     else if (cmd == "q" || cmd == "Q")
     {
         // FIXME: for now we assume 'close' command
@@ -115,6 +179,266 @@ QString RemoteControl::executeCommand(QString command, bool &quit_requested)
     return answer;
 }
 
+/*! \brief Execute a batch of commands and return the responses.
+ *  \param commands The command lines, in the order they were received.
+ *  \param quit_requested Set if one of the commands closes the connection.
+ *  \param received_us When the commands were received, see timestampUs().
+ *
+ * The commands are executed back to back without returning to the event
+ * loop, so a batch from one client is never interleaved with commands from
+ * another. Frequency changes are applied once at the end of the batch, which
+ * avoids retuning the hardware for every intermediate frequency when clients
+ * pipeline many commands. Execution stops at a quit command.
+ *
+ * Batches for which isDirectBatch() is true may be executed from the network
+ * thread, all other commands must be executed in the GUI thread.
+ */
+QString RemoteControl::executeCommands(const QList<QByteArray> &commands,
+                                       bool &quit_requested, QObject *client,
+                                       qint64 received_us)
+{
+    QString answer;
+    bool    apply;
+
+    quit_requested = false;
+    if (received_us < 0)
+        received_us = timestampUs();
+
+    tune_mutex.lock();
+    batchDepth()++;
+    tune_mutex.unlock();
+
+    for (int i = 0; i < commands.size() && !quit_requested; i++)
+        answer += executeCommand(QString(commands[i]), quit_requested, client);
+
+    tune_mutex.lock();
+    apply = (--batchDepth() == 0);
+    tune_mutex.unlock();
+
+    if (apply)
+        applyNewRemoteFreq(received_us);
+
+    return answer;
+}
+
+/*! \brief Execute commands from the network thread in the GUI thread.
+ *
+ * The responses are returned with commandsExecuted().
+ */
+void RemoteControl::executeQueued(QObject *client,
+                                  const QList<QByteArray> &commands,
+                                  qint64 received_us)
+{
+    bool    quit_requested;
+    QString answer = executeCommands(commands, quit_requested, client,
+                                     received_us);
+
+    emit commandsExecuted(client, answer.toLatin1(), quit_requested);
+}
+
+/*! \brief Whether a batch only contains commands that are safe to execute
+ *         from the network thread, i.e. setting and reading the frequency.
+ */
+bool RemoteControl::isDirectBatch(const QList<QByteArray> &commands)
+{
+    for (int i = 0; i < commands.size(); i++)
+    {
+        QList<QByteArray> cmdlist = commands[i].simplified().split(' ');
+        const QByteArray &cmd = cmdlist[0];
+
+        if (cmd.isEmpty() || cmd == "f" || (cmd == "F" && cmdlist.size() > 1))
+            continue;
+
+        return false;
+    }
+
+    return true;
+}
+
+/*! \brief Monotonic time in microseconds for latency measurements. */
+qint64 RemoteControl::timestampUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*! \brief The batch nesting level of the calling thread. */
+int &RemoteControl::batchDepth()
+{
+    return QThread::currentThread() == thread() ? batch_depth : batch_depth_net;
+}
+
+/*! \brief Forget the telemetry subscription of a client that has gone. */
+void RemoteControl::removeClient(QObject *client)
+{
+    spectrum_subs.remove(client);
+    if (subscriptions.remove(client))
+        updateTelemetryInterval();
+}
+
+/*! \brief Push telemetry to the subscribed clients.
+ *
+ * Called periodically by mainwindow at the interval announced with
+ * telemetryIntervalChanged(). The values are formatted once and each client
+ * gets all of its lines in one telemetry() signal.
+ */
+void RemoteControl::sendTelemetry()
+{
+    QByteArray  values[TLM_COUNT];
+    qint64      now;
+
+    if (subscriptions.isEmpty())
+        return;
+
+    values[TLM_STRENGTH] = QByteArray::number(signal_level, 'f', 1);
+    values[TLM_SNR] = QByteArray::number(signal_snr, 'f', 1);
+    values[TLM_SQL] = squelch_open ? "1" : "0";
+    tune_mutex.lock();
+    values[TLM_FREQ] = QByteArray::number(rc_freq);
+    tune_mutex.unlock();
+    values[TLM_MODE] = intToModeStr(rc_mode).toLatin1();
+
+    now = telemetry_clock.elapsed();
+
+    // a client may unsubscribe while we emit
+    QList<QObject *> clients = subscriptions.keys();
+    for (int c = 0; c < clients.size(); c++)
+    {
+        QMap<QObject *, subscription>::iterator it = subscriptions.find(clients[c]);
+        if (it == subscriptions.end())
+            continue;
+
+        subscription &sub = it.value();
+        QByteArray  data;
+        bool        due = false;
+
+        if (sub.interval_ms > 0 && now >= sub.next_ms)
+        {
+            due = true;
+            sub.next_ms += sub.interval_ms;
+            if (sub.next_ms <= now)
+                sub.next_ms = now + sub.interval_ms;
+        }
+
+        for (int i = 0; i < TLM_COUNT; i++)
+        {
+            if (!(sub.items & (1u << i)))
+                continue;
+
+            // levels change all the time, only push them at the interval
+            bool level = (i == TLM_STRENGTH || i == TLM_SNR);
+            bool changed = (values[i] != sub.last[i]) &&
+                           (!level || sub.interval_ms == 0);
+
+            if (!due && !changed)
+                continue;
+
+            data += "* ";
+            data += telemetry_names[i];
+            data += ' ';
+            data += values[i];
+            data += '\n';
+            sub.last[i] = values[i];
+        }
+
+        if (!data.isEmpty())
+            emit telemetry(clients[c], data);
+    }
+}
+
+/*! \brief Build a binary spectrum frame.
+ *
+ * Each output bin is the maximum of the FFT bins it covers, so that narrow
+ * signals stay visible when the spectrum is reduced for a small display.
+ */
+static QByteArray spectrum_frame(const float *fft_db, int fftsize, int bins,
+                                 int format, qint64 center, qint64 span,
+                                 qint64 timestamp)
+{
+    QByteArray  frame(SPECTRUM_HEADER_SIZE + bins * format, 0);
+    uchar      *p = (uchar *) frame.data();
+
+    memcpy(p, SPECTRUM_MAGIC, 4);
+    p[4] = SPECTRUM_VERSION;
+    p[5] = format;
+    qToLittleEndian<quint16>(bins, p + 6);
+    qToLittleEndian<qint64>(center, p + 8);
+    qToLittleEndian<quint32>(span, p + 16);
+    qToLittleEndian<qint64>(timestamp, p + 20);
+    p += SPECTRUM_HEADER_SIZE;
+
+    for (int b = 0; b < bins; b++)
+    {
+        int     first = (qint64) b * fftsize / bins;
+        int     last = (qint64)(b + 1) * fftsize / bins;
+        float   db = fft_db[first];
+
+        for (int i = first + 1; i < last; i++)
+            db = qMax(db, fft_db[i]);
+
+        if (format == 1)
+        {
+            // 1 dB per step
+            p[b] = (uchar)(qint8) qBound(-128.f, roundf(db), 127.f);
+        }
+        else
+        {
+            // 0.01 dB per step
+            qToLittleEndian<qint16>((qint16) qBound(-32768.f, roundf(db * 100.f),
+                                                    32767.f), p + 2 * b);
+        }
+    }
+
+    return frame;
+}
+
+/*! \brief Send a spectrum frame to the clients that are due.
+ *  \param fft_db The FFT in dBFS, shifted so that the center is in the middle.
+ *  \param center The center frequency in Hz.
+ *  \param span The width of the spectrum in Hz.
+ *
+ * Called by mainwindow for every new FFT. Clients asking for the same number
+ * of bins and format share one frame.
+ */
+void RemoteControl::sendSpectrum(const float *fft_db, int fftsize,
+                                 qint64 center, qint64 span)
+{
+    QMap<int, QByteArray>   frames;
+    qint64                  now;
+    qint64                  timestamp;
+
+    if (spectrum_subs.isEmpty() || fftsize <= 0)
+        return;
+
+    now = telemetry_clock.elapsed();
+    timestamp = QDateTime::currentMSecsSinceEpoch();
+
+    QList<QObject *> clients = spectrum_subs.keys();
+    for (int c = 0; c < clients.size(); c++)
+    {
+        QMap<QObject *, spectrum_sub>::iterator it = spectrum_subs.find(clients[c]);
+        if (it == spectrum_subs.end())
+            continue;
+
+        spectrum_sub &sub = it.value();
+        if (now < sub.next_ms)
+            continue;
+
+        sub.next_ms += sub.interval_ms;
+        if (sub.next_ms <= now)
+            sub.next_ms = now + sub.interval_ms;
+
+        int bins = qMin(sub.bins, fftsize);
+        int key = bins * 4 + sub.format;
+
+        if (!frames.contains(key))
+            frames[key] = spectrum_frame(fft_db, fftsize, bins, sub.format,
+                                         center, span, timestamp);
+
+        emit telemetry(clients[c], frames[key]);
+    }
+}
+
 /*! \brief Slot called when the receiver is tuned to a new frequency.
  *  \param freq The new frequency in Hz.
  *
@@ -123,12 +447,16 @@ QString RemoteControl::executeCommand(QString command, bool &quit_requested)
  */
 void RemoteControl::setNewFrequency(qint64 freq)
 {
+    QMutexLocker lock(&tune_mutex);
+
     rc_freq = freq;
 }
 
 /*! \brief Slot called when the filter offset is changed. */
 void RemoteControl::setFilterOffset(qint64 freq)
 {
+    QMutexLocker lock(&tune_mutex);
+
     rc_filter_offset = freq;
 }
 
@@ -137,21 +465,86 @@ void RemoteControl::setFilterOffset(qint64 freq)
  */
 void RemoteControl::setLnbLo(double freq_mhz)
 {
+    QMutexLocker lock(&tune_mutex);
+
     rc_lnb_lo_mhz = freq_mhz;
 }
 
 void RemoteControl::setBandwidth(qint64 bw)
 {
+    QMutexLocker lock(&tune_mutex);
+
     // we want to leave some margin
     bw_half = (qint64)(0.9f * (bw / 2.f));
 }
 
+/*! \brief Set the receiver that remote frequency changes are applied to. */
+void RemoteControl::setReceiver(receiver *rx)
+{
+    QMutexLocker lock(&tune_mutex);
+
+    this->rx = rx;
+}
+
+/*! \brief Enable or disable tuning the receiver without the GUI.
+ *
+ * Must be disabled while the GUI has to take part in tuning, e.g. during
+ * I/Q file playback where the channel is moved instead of the hardware.
+ */
+void RemoteControl::setDirectTuning(bool enabled)
+{
+    QMutexLocker lock(&tune_mutex);
+
+    direct_tuning = enabled;
+}
+
+/*! \brief Get the tuning applied by remote clients (from mainwindow).
+ *  \param rx_freq The receive frequency in Hz.
+ *  \param hw_freq The hardware frequency in Hz, without LNB LO.
+ *  \param offset The filter offset in Hz.
+ *
+ * Called in response to remoteTuned(). Further changes are signalled again.
+ */
+void RemoteControl::getRemoteTuning(qint64 &rx_freq, qint64 &hw_freq,
+                                    qint64 &offset)
+{
+    QMutexLocker lock(&tune_mutex);
+
+    rx_freq = rc_freq;
+    offset = rc_filter_offset;
+    hw_freq = rc_freq - llround(rc_lnb_lo_mhz * 1.e6) - rc_filter_offset;
+    tune_notify = false;
+}
+
 /*! \brief Set signal level in dBFS. */
 void RemoteControl::setSignalLevel(float level)
 {
     signal_level = level;
 }
 
+/*! \brief Set all signal detectors in dBFS (SNR in dB). */
+void RemoteControl::setSignalStats(float peak, float rms, float min,
+                                   float noise_floor, float snr)
+{
+    signal_peak = peak;
+    signal_rms = rms;
+    signal_min = min;
+    signal_noise = noise_floor;
+    signal_snr = snr;
+}
+
+/*! \brief Set squelch duty cycle, i.e. the fraction of time it was open. */
+void RemoteControl::setSquelchDutyCycle(float duty)
+{
+    squelch_duty = duty;
+}
+
+/*! \brief Set squelch state (from mainwindow). */
+void RemoteControl::setSquelchStatus(bool open)
+{
+    squelch_open = open;
+}
+
 /*! \brief Set demodulator (from mainwindow). */
 void RemoteControl::setMode(int mode)
 {
@@ -164,11 +557,13 @@ void RemoteControl::setMode(int mode)
 /*! \brief Set passband (from mainwindow). */
 void RemoteControl::setPassband(int passband_lo, int passband_hi)
 {
+    QMutexLocker lock(&tune_mutex);
+
     rc_passband_lo = passband_lo;
     rc_passband_hi = passband_hi;
 }
 
-/*! \brief New remote frequency received. */
+/*! \brief New remote frequency received. Called with tune_mutex locked. */
 void RemoteControl::setNewRemoteFreq(qint64 freq)
 {
     qint64 delta = freq - rc_freq;
@@ -179,7 +574,7 @@ void RemoteControl::setNewRemoteFreq(qint64 freq)
         (rc_filter_offset < 0 && rc_filter_offset + rc_passband_lo > -bwh_eff))
     {
         // move filter offset
-        emit newFilterOffset(rc_filter_offset);
+        batch_offset = true;
     }
     else
     {
@@ -189,19 +584,110 @@ void RemoteControl::setNewRemoteFreq(qint64 freq)
             rc_filter_offset = -0.2f * bwh_eff;
         else
             rc_filter_offset = 0.2f * bwh_eff;
-        emit newFilterOffset(rc_filter_offset);
-        emit newFrequency(freq);
+        batch_offset = true;
+        batch_freq = true;
     }
 
     rc_freq = freq;
 }
 
+/*! \brief Apply the frequency changes made since the last call.
+ *  \param received_us When the command was received, for measuring latency.
+ *
+ * With direct tuning the receiver is tuned right here, in whatever thread
+ * the command was executed, and mainwindow only updates the widgets when it
+ * gets to it. Otherwise the changes go through mainwindow as before.
+ */
+void RemoteControl::applyNewRemoteFreq(qint64 received_us)
+{
+    bool    offset, freq;
+    bool    notify = false;
+    qint64  filter_offset, rx_freq;
+
+    QMutexLocker lock(&tune_mutex);
+
+    offset = batch_offset;
+    freq = batch_freq;
+    batch_offset = false;
+    batch_freq = false;
+    filter_offset = rc_filter_offset;
+    rx_freq = rc_freq;
+
+    if (!offset && !freq)
+        return;
+
+    if (rx && direct_tuning)
+    {
+        if (offset)
+            rx->set_filter_offset((double) filter_offset);
+        if (freq)
+            rx->set_rf_freq((double)(rx_freq - llround(rc_lnb_lo_mhz * 1.e6) -
+                                     filter_offset));
+
+        // a busy GUI gets one notification for any number of changes
+        notify = !tune_notify;
+        tune_notify = true;
+        offset = freq = false;
+    }
+    lock.unlock();
+
+    if (notify)
+        emit remoteTuned();
+    if (offset)
+        emit newFilterOffset(filter_offset);
+    if (freq)
+        emit newFrequency(rx_freq);
+
+    // direct connections to mainwindow tune synchronously as well
+    lock.relock();
+    tune_latency_us = timestampUs() - received_us;
+    tune_latency_max_us = qMax(tune_latency_max_us, tune_latency_us);
+}
+
 /*! \brief Set squelch level (from mainwindow). */
 void RemoteControl::setSquelchLevel(double level)
 {
     squelch_level = level;
 }
 
+/*! \brief Set CTCSS squelch tone (from mainwindow). */
+void RemoteControl::setCtcss(float tone_hz)
+{
+    ctcss_tone = tone_hz;
+    if (tone_hz > 0.0f)
+        dcs_code = 0;
+}
+
+/*! \brief Set DCS squelch code (from mainwindow). */
+void RemoteControl::setDcs(int code)
+{
+    dcs_code = code;
+    if (code > 0)
+        ctcss_tone = 0.0;
+}
+
+/*! \brief Set tone squelch state and detected CTCSS tone (from mainwindow). */
+void RemoteControl::setToneSquelchStatus(bool open, float detected_hz)
+{
+    tone_sql_open = open;
+    ctcss_detected = detected_hz;
+}
+
+/*! \brief Set measured audio output latency and buffer stats (from mainwindow). */
+void RemoteControl::setAudioLatency(double latency_ms, unsigned long underruns,
+                                    unsigned long overruns)
+{
+    audio_latency = latency_ms;
+    audio_underruns = underruns;
+    audio_overruns = overruns;
+}
+
+/*! \brief Set pre-trigger I/Q recording status (from mainwindow). */
+void RemoteControl::setIqTriggerStatus(bool committing)
+{
+    iq_trigger_status = committing;
+}
+
 /*! \brief Start audio recorder (from mainwindow). */
 void RemoteControl::startAudioRecorder(QString unused)
 {
@@ -358,6 +844,8 @@ QString RemoteControl::intToModeStr(int mode)
 /* Get frequency */
 QString RemoteControl::cmd_get_freq() const
 {
+    QMutexLocker lock(&tune_mutex);
+
     return QString("%1\n").arg(rc_freq);
 }
 
@@ -369,7 +857,16 @@ QString RemoteControl::cmd_set_freq(QStringList cmdlist)
 
     if (ok)
     {
+        bool apply;
+
+        tune_mutex.lock();
         setNewRemoteFreq((qint64)freq);
+        apply = (batchDepth() == 0);
+        tune_mutex.unlock();
+
+        if (apply)
+            applyNewRemoteFreq(timestampUs());
+
         return QString("RPRT 0\n");
     }
 
@@ -425,11 +922,46 @@ QString RemoteControl::cmd_get_level(QStringList cmdlist)
     QString lvl = cmdlist.value(1, "");
 
     if (lvl == "?")
-       answer = QString("SQL STRENGTH\n");
+       answer = QString("SQL STRENGTH PEAK RMS MIN NOISE_FLOOR SNR SQL_DUTY TSQL CTCSS "
+                        "AUDIO_LATENCY AUDIO_UNDERRUNS AUDIO_OVERRUNS "
+                        "TUNE_LATENCY TUNE_LATENCY_MAX\n");
     else if (lvl.compare("STRENGTH", Qt::CaseInsensitive) == 0 || lvl.isEmpty())
        answer = QString("%1\n").arg(signal_level, 0, 'f', 1);
     else if (lvl.compare("SQL", Qt::CaseInsensitive) == 0)
        answer = QString("%1\n").arg(squelch_level, 0, 'f', 1);
+    else if (lvl.compare("PEAK", Qt::CaseInsensitive) == 0)
+       answer = QString("%1\n").arg(signal_peak, 0, 'f', 1);
+    else if (lvl.compare("RMS", Qt::CaseInsensitive) == 0)
+       answer = QString("%1\n").arg(signal_rms, 0, 'f', 1);
+    else if (lvl.compare("MIN", Qt::CaseInsensitive) == 0)
+       answer = QString("%1\n").arg(signal_min, 0, 'f', 1);
+    else if (lvl.compare("NOISE_FLOOR", Qt::CaseInsensitive) == 0)
+       answer = QString("%1\n").arg(signal_noise, 0, 'f', 1);
+    else if (lvl.compare("SNR", Qt::CaseInsensitive) == 0)
+       answer = QString("%1\n").arg(signal_snr, 0, 'f', 1);
+    else if (lvl.compare("SQL_DUTY", Qt::CaseInsensitive) == 0)
+       answer = QString("%1\n").arg(squelch_duty, 0, 'f', 3);
+    else if (lvl.compare("TSQL", Qt::CaseInsensitive) == 0)
+       answer = QString("%1\n").arg(tone_sql_open);
+    else if (lvl.compare("CTCSS", Qt::CaseInsensitive) == 0)
+       answer = QString("%1\n").arg(ctcss_detected, 0, 'f', 1);
+    else if (lvl.compare("AUDIO_LATENCY", Qt::CaseInsensitive) == 0)
+       answer = QString("%1\n").arg(audio_latency, 0, 'f', 1);
+    else if (lvl.compare("AUDIO_UNDERRUNS", Qt::CaseInsensitive) == 0)
+       answer = QString("%1\n").arg(audio_underruns);
+    else if (lvl.compare("AUDIO_OVERRUNS", Qt::CaseInsensitive) == 0)
+       answer = QString("%1\n").arg(audio_overruns);
+    else if (lvl.compare("TUNE_LATENCY", Qt::CaseInsensitive) == 0)
+    {
+       QMutexLocker lock(&tune_mutex);
+       answer = QString("%1\n").arg(1.e-3 * tune_latency_us, 0, 'f', 3);
+    }
+    else if (lvl.compare("TUNE_LATENCY_MAX", Qt::CaseInsensitive) == 0)
+    {
+       QMutexLocker lock(&tune_mutex);
+       answer = QString("%1\n").arg(1.e-3 * tune_latency_max_us, 0, 'f', 3);
+       tune_latency_max_us = 0;
+    }
     else
        answer = QString("RPRT 1\n");
 
@@ -474,9 +1006,11 @@ QString RemoteControl::cmd_get_func(QStringList cmdlist)
     QString func = cmdlist.value(1, "");
 
     if (func == "?")
-        answer = QString("RECORD\n");
+        answer = QString("RECORD IQ_TRIGGER\n");
     else if (func.compare("RECORD", Qt::CaseInsensitive) == 0)
         answer = QString("%1\n").arg(audio_recorder_status);
+    else if (func.compare("IQ_TRIGGER", Qt::CaseInsensitive) == 0)
+        answer = QString("%1\n").arg(iq_trigger_status);
     else
         answer = QString("RPRT 1\n");
 
@@ -493,7 +1027,7 @@ QString RemoteControl::cmd_set_func(QStringList cmdlist)
 
     if (func == "?")
     {
-        answer = QString("RECORD\n");
+        answer = QString("RECORD IQ_TRIGGER\n");
     }
     else if ((func.compare("RECORD", Qt::CaseInsensitive) == 0) && ok)
     {
@@ -511,6 +1045,19 @@ QString RemoteControl::cmd_set_func(QStringList cmdlist)
                 emit stopAudioRecorderEvent();
         }
     }
+    else if ((func.compare("IQ_TRIGGER", Qt::CaseInsensitive) == 0) && ok)
+    {
+        if (!receiver_running)
+        {
+            answer = QString("RPRT 1\n");
+        }
+        else
+        {
+            // the status is updated by the main window
+            answer = QString("RPRT 0\n");
+            emit iqTriggerEvent(status);
+        }
+    }
     else
     {
         answer = QString("RPRT 1\n");
@@ -519,6 +1066,49 @@ QString RemoteControl::cmd_set_func(QStringList cmdlist)
     return answer;
 }
 
+/* Get CTCSS squelch tone in tenths of Hz (hamlib format), 0 if off */
+QString RemoteControl::cmd_get_ctcss() const
+{
+    return QString("%1\n").arg(qRound(ctcss_tone * 10.0f));
+}
+
+/* Set CTCSS squelch tone in tenths of Hz, 0 to disable */
+QString RemoteControl::cmd_set_ctcss(QStringList cmdlist)
+{
+    bool ok;
+    int tone = cmdlist.value(1, "ERR").toInt(&ok);
+
+    if (!ok || tone < 0 || tone > 3000)
+        return QString("RPRT 1\n");
+
+    setCtcss(0.1f * tone);
+    emit newCtcss(ctcss_tone);
+
+    return QString("RPRT 0\n");
+}
+
+/* Get DCS squelch code, 0 if off */
+QString RemoteControl::cmd_get_dcs() const
+{
+    return QString("%1\n").arg(dcs_code);
+}
+
+/* Set DCS squelch code, e.g. 23 for D023, 0 to disable */
+QString RemoteControl::cmd_set_dcs(QStringList cmdlist)
+{
+    bool ok;
+    QString code_str = cmdlist.value(1, "ERR");
+    int code = code_str.toInt(&ok);
+
+    if (!ok || code < 0 || code > 777 || code_str.contains(QRegExp("[89]")))
+        return QString("RPRT 1\n");
+
+    setDcs(code);
+    emit newDcs(dcs_code);
+
+    return QString("RPRT 0\n");
+}
+
 /* Get current 'VFO' (fake, only for hamlib) */
 QString RemoteControl::cmd_get_vfo() const
 {
@@ -678,3 +1268,127 @@ QString RemoteControl::cmd_dump_state() const
         /* Bit field list of set parm */
         "0\n" /* RIG_PARM_NONE */);
 }
+
+/* Subscribe to telemetry */
+QString RemoteControl::cmd_subscribe(QStringList cmdlist, QObject *client)
+{
+    QString         items_str = cmdlist.value(1, "");
+    subscription    sub;
+    bool            ok = true;
+
+    if (items_str == "?")
+        return QString("STRENGTH SNR SQL FREQ MODE ALL\n");
+
+    if (!client || items_str.isEmpty())
+        return QString("RPRT 1\n");
+
+    sub.items = 0;
+    QStringList items = items_str.split(",", QString::SkipEmptyParts);
+    for (int i = 0; i < items.size(); i++)
+    {
+        int j;
+
+        if (items[i].compare("ALL", Qt::CaseInsensitive) == 0)
+        {
+            sub.items = (1u << TLM_COUNT) - 1;
+            continue;
+        }
+
+        for (j = 0; j < TLM_COUNT; j++)
+        {
+            if (items[i].compare(telemetry_names[j], Qt::CaseInsensitive) == 0)
+                break;
+        }
+        if (j == TLM_COUNT)
+            return QString("RPRT 1\n");
+
+        sub.items |= 1u << j;
+    }
+
+    sub.interval_ms = cmdlist.value(2, "0").toInt(&ok);
+    if (!ok || sub.interval_ms < 0 || sub.items == 0)
+        return QString("RPRT 1\n");
+    if (sub.interval_ms > 0)
+        sub.interval_ms = qBound(TLM_MIN_INTERVAL_MS, sub.interval_ms,
+                                 TLM_MAX_INTERVAL_MS);
+
+    if (!telemetry_clock.isValid())
+        telemetry_clock.start();
+
+    // the current values are pushed on the next tick
+    sub.next_ms = telemetry_clock.elapsed();
+    subscriptions[client] = sub;
+    updateTelemetryInterval();
+
+    return QString("RPRT 0\n");
+}
+
+/* Stop pushing telemetry */
+QString RemoteControl::cmd_unsubscribe(QObject *client)
+{
+    if (subscriptions.remove(client))
+        updateTelemetryInterval();
+
+    return QString("RPRT 0\n");
+}
+
+/* Start or stop the binary spectrum stream */
+QString RemoteControl::cmd_spectrum(QStringList cmdlist, QObject *client)
+{
+    QString         bins_str = cmdlist.value(1, "");
+    QString         format = cmdlist.value(3, "INT8");
+    spectrum_sub    sub;
+    bool            ok1, ok2;
+
+    if (bins_str == "?")
+        return QString("INT8 INT16\n");
+
+    sub.bins = bins_str.toInt(&ok1);
+    int fps = cmdlist.value(2, "10").toInt(&ok2);
+    if (!client || !ok1 || !ok2)
+        return QString("RPRT 1\n");
+
+    if (sub.bins == 0)
+    {
+        spectrum_subs.remove(client);
+        return QString("RPRT 0\n");
+    }
+
+    if (format.compare("INT8", Qt::CaseInsensitive) == 0)
+        sub.format = 1;
+    else if (format.compare("INT16", Qt::CaseInsensitive) == 0)
+        sub.format = 2;
+    else
+        return QString("RPRT 1\n");
+
+    if (sub.bins < SPECTRUM_MIN_BINS || sub.bins > SPECTRUM_MAX_BINS ||
+        fps < 1 || fps > SPECTRUM_MAX_FPS)
+        return QString("RPRT 1\n");
+
+    if (!telemetry_clock.isValid())
+        telemetry_clock.start();
+
+    sub.interval_ms = 1000 / fps;
+    sub.next_ms = telemetry_clock.elapsed();
+    spectrum_subs[client] = sub;
+
+    return QString("RPRT 0\n");
+}
+
+/*! \brief Tell mainwindow how often sendTelemetry() needs to be called. */
+void RemoteControl::updateTelemetryInterval()
+{
+    int interval = 0;
+
+    QMap<QObject *, subscription>::const_iterator it;
+    for (it = subscriptions.constBegin(); it != subscriptions.constEnd(); ++it)
+    {
+        int sub_interval = it.value().interval_ms > 0 ?
+                           qMin(it.value().interval_ms, TLM_POLL_MS) : TLM_POLL_MS;
+
+        if (interval == 0 || sub_interval < interval)
+            interval = sub_interval;
+    }
+
+    emit telemetryIntervalChanged(interval);
+}
@@ -24,6 +24,11 @@
 #ifndef REMOTE_CONTROL_H
 #define REMOTE_CONTROL_H
 
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMap>
+#include <QMutex>
 #include <QObject>
 #include <QSettings>
 #include <QString>
@@ -51,9 +56,33 @@
  *
  *  close: Close connection (useful for interactive telnet sessions).
  *
+ *  SUBSCRIBE <items> [interval_ms]: Push telemetry to the client instead
+ *  of polling. Items are a comma separated list of STRENGTH, SNR, SQL, FREQ
+ *  and MODE, or ALL. With an interval all items are pushed periodically and
+ *  SQL, FREQ and MODE also as soon as they change; without an interval an
+ *  item is only pushed when its value changes. Pushed lines start with '*':
+ *
+ *     gqrx:  * SQL 1\n
+ *     gqrx:  * STRENGTH -52.3\n
+ *
+ *  UNSUBSCRIBE: Stop pushing telemetry.
+ *
+ *  SPECTRUM <bins> [fps] [INT8|INT16]: Stream binary spectrum frames, see
+ *  resources/remote-control.txt for the frame format. SPECTRUM 0 stops.
+ *
+ * Commands may be pipelined. All complete lines received together are
+ * executed as one batch and answered in order with a single write.
+ *
+ *
+ * Frequency changes are applied to the receiver directly by RemoteControl,
+ * possibly from the network thread, and the GUI is told afterwards with
+ * remoteTuned(). The tuning state is protected by tune_mutex, everything
+ * else is only used from the GUI thread.
  *
  * FIXME: The server code is very minimalistic and probably not very robust.
  */
+class receiver;
+
 class RemoteControl : public QObject
 {
     Q_OBJECT
@@ -62,20 +91,47 @@ public:
     ~RemoteControl();
 
     void setReceiverStatus(bool enabled);
+    void setReceiver(receiver *rx);
+    void setDirectTuning(bool enabled);
+    void getRemoteTuning(qint64 &rx_freq, qint64 &hw_freq, qint64 &offset);
+
+    static bool isDirectBatch(const QList<QByteArray> &commands);
+    static qint64 timestampUs();
 
-    QString executeCommand(QString command, bool &quit_requested);
+    QString executeCommand(QString command, bool &quit_requested,
+                           QObject *client = 0);
+    QString executeCommands(const QList<QByteArray> &commands,
+                            bool &quit_requested, QObject *client = 0,
+                            qint64 received_us = -1);
+    Q_INVOKABLE void removeClient(QObject *client);
+    void    sendTelemetry();
+    bool    hasSpectrumClients() const { return !spectrum_subs.isEmpty(); }
+    void    sendSpectrum(const float *fft_db, int fftsize, qint64 center,
+                         qint64 span);
 
 public slots:
+    void executeQueued(QObject *client, const QList<QByteArray> &commands,
+                       qint64 received_us);
     void setNewFrequency(qint64 freq);
     void setFilterOffset(qint64 freq);
     void setLnbLo(double freq_mhz);
     void setBandwidth(qint64 bw);
     void setSignalLevel(float level);
+    void setSignalStats(float peak, float rms, float min, float noise_floor,
+                        float snr);
     void setMode(int mode);
     void setPassband(int passband_lo, int passband_hi);
     void setSquelchLevel(double level);
+    void setSquelchDutyCycle(float duty);
+    void setCtcss(float tone_hz);
+    void setDcs(int code);
+    void setToneSquelchStatus(bool open, float detected_hz);
+    void setSquelchStatus(bool open);
+    void setAudioLatency(double latency_ms, unsigned long underruns,
+                         unsigned long overruns);
     void startAudioRecorder(QString unused);
     void stopAudioRecorder();
+    void setIqTriggerStatus(bool committing);
 
 signals:
     void newFrequency(qint64 freq);
@@ -84,8 +140,23 @@ signals:
     void newMode(int mode);
     void newPassband(int passband);
     void newSquelchLevel(double level);
+    void newCtcss(float tone_hz);
+    void newDcs(int code);
     void startAudioRecorderEvent();
     void stopAudioRecorderEvent();
+    void iqTriggerEvent(bool start);
+
+    /*! \brief The receiver has been tuned by a remote client, see getRemoteTuning(). */
+    void remoteTuned();
+
+    /*! \brief Responses to commands passed to executeQueued(). */
+    void commandsExecuted(QObject *client, const QByteArray &answer, bool quit);
+
+    /*! \brief Telemetry lines or spectrum frames for a subscribed client. */
+    void telemetry(QObject *client, const QByteArray &data);
+
+    /*! \brief Shortest telemetry interval needed in ms, 0 if there are no subscribers. */
+    void telemetryIntervalChanged(int interval_ms);
 
 private:
     qint64      rc_freq;
@@ -97,12 +168,72 @@ private:
     int         rc_passband_lo;    /*!< Current low cutoff. */
     int         rc_passband_hi;    /*!< Current high cutoff. */
     float       signal_level;      /*!< Signal level in dBFS */
+    float       signal_peak;       /*!< Peak signal level in dBFS */
+    float       signal_rms;        /*!< RMS signal level in dBFS */
+    float       signal_min;        /*!< Minimum signal level in dBFS */
+    float       signal_noise;      /*!< Noise floor estimate in dBFS */
+    float       signal_snr;        /*!< Signal to noise ratio in dB */
     double      squelch_level;     /*!< Squelch level in dBFS */
+    float       squelch_duty;      /*!< Fraction of time the squelch was open */
+    float       ctcss_tone;        /*!< CTCSS squelch tone in Hz, 0 if off */
+    int         dcs_code;          /*!< DCS squelch code, 0 if off */
+    bool        tone_sql_open;     /*!< Tone squelch state */
+    float       ctcss_detected;    /*!< Strongest CTCSS tone in Hz */
+    double      audio_latency;     /*!< Audio output latency in ms */
+    unsigned long audio_underruns; /*!< Audio buffer underruns */
+    unsigned long audio_overruns;  /*!< Audio buffer overruns */
     bool        audio_recorder_status; /*!< Recording enabled */
+    bool        iq_trigger_status; /*!< Pre-trigger I/Q recording in progress */
     bool        receiver_running;  /*!< Wether the receiver is running or not */
     bool        hamlib_compatible;
 
+    bool        squelch_open;      /*!< Squelch state */
+
+    enum telemetry_item {
+        TLM_STRENGTH = 0,
+        TLM_SNR,
+        TLM_SQL,
+        TLM_FREQ,
+        TLM_MODE,
+        TLM_COUNT
+    };
+
+    /*! \brief Telemetry subscription of one client. */
+    struct subscription {
+        unsigned int    items;          /*!< Bit mask of telemetry_item. */
+        int             interval_ms;    /*!< Push period, 0 for on change only. */
+        qint64          next_ms;        /*!< Time of the next periodic push. */
+        QByteArray      last[TLM_COUNT];    /*!< Last values sent. */
+    };
+
+    QMap<QObject *, subscription> subscriptions;
+
+    /*! \brief Spectrum stream of one client. */
+    struct spectrum_sub {
+        int             bins;           /*!< Requested number of bins. */
+        int             format;         /*!< 1 for int8, 2 for int16. */
+        int             interval_ms;    /*!< Frame period. */
+        qint64          next_ms;        /*!< Time of the next frame. */
+    };
+
+    QMap<QObject *, spectrum_sub> spectrum_subs;
+    QElapsedTimer telemetry_clock;
+
+    receiver   *rx;                /*!< Receiver tuned by remote commands. */
+    bool        direct_tuning;     /*!< Whether rx may be tuned directly. */
+    bool        tune_notify;       /*!< remoteTuned() sent, not yet handled. */
+    qint64      tune_latency_us;   /*!< Last command to hardware latency. */
+    qint64      tune_latency_max_us;    /*!< Maximum since last read. */
+    mutable QMutex tune_mutex;     /*!< Protects the tuning state. */
+
+    int         batch_depth;       /*!< Nesting level of executeCommands() in the GUI thread. */
+    int         batch_depth_net;   /*!< Nesting level in the network thread. */
+    bool        batch_offset;      /*!< Filter offset changed during batch. */
+    bool        batch_freq;        /*!< Hardware retune needed after batch. */
+
     void        setNewRemoteFreq(qint64 freq);
+    void        applyNewRemoteFreq(qint64 received_us);
+    int        &batchDepth();
     int         modeStrToInt(QString mode_str);
     QString     intToModeStr(int mode);
 
@@ -114,6 +245,10 @@ private:
     QString     cmd_get_level(QStringList cmdlist);
     QString     cmd_set_level(QStringList cmdlist);
     QString     cmd_get_func(QStringList cmdlist);
+    QString     cmd_get_ctcss() const;
+    QString     cmd_set_ctcss(QStringList cmdlist);
+    QString     cmd_get_dcs() const;
+    QString     cmd_set_dcs(QStringList cmdlist);
     QString     cmd_set_func(QStringList cmdlist);
     QString     cmd_get_vfo() const;
     QString     cmd_set_vfo(QStringList cmdlist);
@@ -124,6 +259,11 @@ private:
     QString     cmd_LOS();
     QString     cmd_lnb_lo(QStringList cmdlist);
     QString     cmd_dump_state() const;
+    QString     cmd_subscribe(QStringList cmdlist, QObject *client);
+    QString     cmd_unsubscribe(QObject *client);
+    QString     cmd_spectrum(QStringList cmdlist, QObject *client);
+
+    void        updateTelemetryInterval();
 };
 
 #endif // REMOTE_CONTROL_H
@@ -40,6 +40,9 @@ SerialRemoteControlDevice::SerialRemoteControlDevice(RemoteControl *remote_contr
 {
     setPortName(DEFAULT_PORT_NAME);
     setBaudRate(DEFAULT_BAUD_RATE);
+
+    connect(remote_control, SIGNAL(telemetry(QObject*,QByteArray)),
+            this, SLOT(sendTelemetry(QObject*,QByteArray)));
 }
 
 SerialRemoteControlDevice::~SerialRemoteControlDevice()
@@ -87,6 +90,8 @@ void SerialRemoteControlDevice::closeDevice()
         rc_serial_port->deleteLater();
         rc_serial_port = 0;
     }
+
+    remote_control->removeClient(this);
 }
 
 bool SerialRemoteControlDevice::isEnabledInSettings(QSettings *settings)
@@ -172,25 +177,32 @@ void SerialRemoteControlDevice::setBaudRate(int baud_rate)
     }
 }
 
+/*! \brief Read and execute all complete commands as one batch. */
 void SerialRemoteControlDevice::startRead()
 {
-    char    buffer[1024] = {0};
-    int     bytes_read;
+    QList<QByteArray>   commands;
 
-    bytes_read = rc_serial_port->readLine(buffer, 1024);
-    if (bytes_read < 2)  // command + '\n'
+    while (rc_serial_port->canReadLine() || rc_serial_port->bytesAvailable() >= 1024)
+        commands.append(rc_serial_port->readLine(1024));
+
+    if (commands.isEmpty())
         return;
 
     bool quit_requested = false;
 
-    QString answer = remote_control->executeCommand(QString(buffer), quit_requested);
+    QString answer = remote_control->executeCommands(commands, quit_requested,
+                                                     this);
+
+    if (!answer.isEmpty())
+        rc_serial_port->write(answer.toLatin1());
 
     if (quit_requested)
-    {
         closeDevice();
-        return;
-    }
+}
 
-    if (!answer.isEmpty())
-        rc_serial_port->write(answer.toLatin1());
+/*! \brief Send telemetry if the device has subscribed. */
+void SerialRemoteControlDevice::sendTelemetry(QObject *client, const QByteArray &data)
+{
+    if (client == this && isDeviceOpen())
+        rc_serial_port->write(data);
 }
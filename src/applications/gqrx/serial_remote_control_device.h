@@ -24,6 +24,7 @@
 #ifndef SERIAL_REMOTE_CONTROL_DEVICE_H
 #define SERIAL_REMOTE_CONTROL_DEVICE_H
 
+#include <QByteArray>
 #include <QObject>
 #include <QStringList>
 
@@ -56,6 +57,7 @@ public:
 
 private slots:
     void startRead();
+    void sendTelemetry(QObject *client, const QByteArray &data);
 
 private:
     void readSettingsFromSection(QSettings* settings, QString section_name);
@@ -32,6 +32,9 @@
 
 #define DEFAULT_RC_PORT            7356
 #define DEFAULT_RC_ALLOWED_HOSTS   "::ffff:127.0.0.1"
+#define MAX_RC_CLIENTS             16
+#define MAX_RC_LINE                1024
+#define MAX_RC_BACKLOG             (1024 * 1024)
 
 TcpRemoteControlServer::TcpRemoteControlServer(RemoteControl *remote_control,
                                                QObject *parent)
@@ -39,41 +42,78 @@ TcpRemoteControlServer::TcpRemoteControlServer(RemoteControl *remote_control,
 {
     rc_port = DEFAULT_RC_PORT;
     rc_allowed_hosts.append(DEFAULT_RC_ALLOWED_HOSTS);
+    rc_listening = false;
 
-    rc_socket = 0;
+    qRegisterMetaType<QList<QByteArray> >("QList<QByteArray>");
+
+    // child objects follow us into the control thread
+    rc_server = new QTcpServer(this);
 
 #if QT_VERSION < 0x050900
     // Disable proxy setting detected by Qt
     // Workaround for https://bugreports.qt.io/browse/QTBUG-58374
     // Fix: https://codereview.qt-project.org/#/c/186124/
-    rc_server.setProxy(QNetworkProxy::NoProxy);
+    rc_server->setProxy(QNetworkProxy::NoProxy);
 #endif
 
-    connect(&rc_server, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
+    connect(rc_server, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
+    connect(remote_control, SIGNAL(telemetry(QObject*,QByteArray)),
+            this, SLOT(sendTelemetry(QObject*,QByteArray)));
+    connect(remote_control, SIGNAL(commandsExecuted(QObject*,QByteArray,bool)),
+            this, SLOT(finishBatch(QObject*,QByteArray,bool)));
+
+    moveToThread(&rc_thread);
+    rc_thread.start();
 }
 
 TcpRemoteControlServer::~TcpRemoteControlServer()
 {
-    stopServer();
+    QMetaObject::invokeMethod(this, "stopListening",
+                              Qt::BlockingQueuedConnection);
+    rc_thread.quit();
+    rc_thread.wait();
 }
 
 void TcpRemoteControlServer::startServer()
 {
-    if (!rc_server.isListening())
-        rc_server.listen(QHostAddress::Any, rc_port);
+    rc_mutex.lock();
+    rc_listening = true;
+    rc_mutex.unlock();
+
+    QMetaObject::invokeMethod(this, "startListening", Qt::QueuedConnection);
 }
 
 void TcpRemoteControlServer::stopServer()
 {
-    if (rc_socket != 0)
-    {
-        rc_socket->close();
-        rc_socket->deleteLater();
-        rc_socket = 0;
-    }
+    rc_mutex.lock();
+    rc_listening = false;
+    rc_mutex.unlock();
 
-    if (rc_server.isListening())
-        rc_server.close();
+    QMetaObject::invokeMethod(this, "stopListening", Qt::QueuedConnection);
+}
+
+/*! \brief Start listening on the configured port (control thread). */
+void TcpRemoteControlServer::startListening()
+{
+    rc_mutex.lock();
+    int port = rc_port;
+    rc_mutex.unlock();
+
+    if (rc_server->isListening() && rc_server->serverPort() != port)
+        rc_server->close();
+
+    if (!rc_server->isListening())
+        rc_server->listen(QHostAddress::Any, port);
+}
+
+/*! \brief Close all clients and stop listening (control thread). */
+void TcpRemoteControlServer::stopListening()
+{
+    while (!rc_sockets.isEmpty())
+        closeClient(rc_sockets.first());
+
+    if (rc_server->isListening())
+        rc_server->close();
 }
 
 bool TcpRemoteControlServer::isEnabledInSettings(QSettings *settings)
@@ -95,9 +135,11 @@ void TcpRemoteControlServer::saveSettings(QSettings *settings) const
     if (!settings)
         return;
 
+    QMutexLocker locker(&rc_mutex);
+
     settings->beginGroup("tcp_remote_control_server");
 
-    if (rc_server.isListening())
+    if (rc_listening)
         settings->setValue("enabled", true);
     else
         settings->remove("enabled");
@@ -123,89 +165,206 @@ void TcpRemoteControlServer::saveSettings(QSettings *settings) const
  */
 void TcpRemoteControlServer::setPort(int port)
 {
+    QMutexLocker locker(&rc_mutex);
+
     if (port == rc_port)
         return;
 
     rc_port = port;
-    if (rc_server.isListening())
-    {
-        rc_server.close();
-        rc_server.listen(QHostAddress::Any, rc_port);
-    }
+    if (rc_listening)
+        QMetaObject::invokeMethod(this, "startListening", Qt::QueuedConnection);
 }
 
 int  TcpRemoteControlServer::getPort() const
 {
+    QMutexLocker locker(&rc_mutex);
     return rc_port;
 }
 
 void TcpRemoteControlServer::setHosts(QStringList hosts)
 {
+    QMutexLocker locker(&rc_mutex);
     rc_allowed_hosts = hosts;
 }
 
 QStringList TcpRemoteControlServer::getHosts() const
 {
+    QMutexLocker locker(&rc_mutex);
     return rc_allowed_hosts;
 }
 
-/*! \brief Accept a new client connection.
+/*! \brief Accept new client connections.
  *
- * This slot is called when a client opens a new connection.
+ * This slot is called when clients open new connections. Several clients
+ * can be connected at the same time, e.g. a Doppler tracker and a scanner.
  */
 void TcpRemoteControlServer::acceptConnection()
 {
-    if (rc_socket)
-    {
-        rc_socket->close();
-        rc_socket->deleteLater();
-    }
-    rc_socket = rc_server.nextPendingConnection();
+    QStringList allowed_hosts = getHosts();
 
-    // check if host is allowed
-    QString address = rc_socket->peerAddress().toString();
-    if (rc_allowed_hosts.indexOf(address) == -1)
-    {
-        std::cout << "*** Remote connection attempt from " << address.toStdString()
-                  << " (not in allowed list)" << std::endl;
-        rc_socket->close();
-        rc_socket->deleteLater();
-        rc_socket = 0;
-    }
-    else
+    while (rc_server->hasPendingConnections())
     {
-        connect(rc_socket, SIGNAL(readyRead()), this, SLOT(startRead()));
+        QTcpSocket *socket = rc_server->nextPendingConnection();
+
+        // check if host is allowed
+        QString address = socket->peerAddress().toString();
+        if (allowed_hosts.indexOf(address) == -1)
+        {
+            std::cout << "*** Remote connection attempt from " << address.toStdString()
+                      << " (not in allowed list)" << std::endl;
+            socket->close();
+            socket->deleteLater();
+            continue;
+        }
+
+        if (rc_sockets.size() >= MAX_RC_CLIENTS)
+        {
+            std::cout << "*** Remote connection attempt from " << address.toStdString()
+                      << " (too many clients)" << std::endl;
+            socket->close();
+            socket->deleteLater();
+            continue;
+        }
+
+        // responses are small and latency matters more than throughput
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+        rc_sockets.append(socket);
+        connect(socket, SIGNAL(readyRead()), this, SLOT(startRead()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(clientDisconnected()));
     }
 }
 
-/*! \brief Start reading from the socket.
+/*! \brief Read and execute commands from a client.
  *
- * This slot is called when the client TCP socket emits a readyRead() signal,
+ * This slot is called when a client TCP socket emits a readyRead() signal,
  * i.e. when there is data to read.
  */
 void TcpRemoteControlServer::startRead()
 {
-    char    buffer[1024] = {0};
-    int     bytes_read;
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+
+    if (socket && rc_sockets.contains(socket))
+        readClient(socket);
+}
+
+/*! \brief Execute the complete lines received from a client.
+ *
+ * All complete lines are executed as one batch and the responses are sent
+ * back with a single write. Incomplete lines stay in the socket buffer until
+ * the rest arrives.
+ *
+ * Frequency commands are executed right here in the control thread, other
+ * batches are executed by the GUI thread and answered in finishBatch().
+ * Reading from the client is paused meanwhile to keep the responses in order.
+ */
+void TcpRemoteControlServer::readClient(QTcpSocket *socket)
+{
+    QList<QByteArray>   commands;
 
-    bytes_read = rc_socket->readLine(buffer, 1024);
-    if (bytes_read < 2)  // command + '\n'
+    if (rc_busy.contains(socket))
         return;
 
-    bool quit_requested = false;
+    // overlong lines are split like before rather than buffered forever
+    while (socket->canReadLine() || socket->bytesAvailable() >= MAX_RC_LINE)
+        commands.append(socket->readLine(MAX_RC_LINE));
 
-    QString answer = remote_control->executeCommand(QString(buffer), quit_requested);
+    if (commands.isEmpty())
+        return;
 
-    if (quit_requested)
+    qint64 received_us = RemoteControl::timestampUs();
+
+    if (!RemoteControl::isDirectBatch(commands))
     {
-        rc_socket->close();
-        rc_socket->deleteLater();
-        rc_socket = 0;
+        rc_busy.insert(socket);
+        QMetaObject::invokeMethod(remote_control, "executeQueued",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(QObject*, socket),
+                                  Q_ARG(QList<QByteArray>, commands),
+                                  Q_ARG(qint64, received_us));
         return;
     }
 
+    bool quit_requested = false;
+
+    QString answer = remote_control->executeCommands(commands, quit_requested,
+                                                     socket, received_us);
+
     if (!answer.isEmpty())
-        rc_socket->write(answer.toLatin1());
+        socket->write(answer.toLatin1());
+
+    if (quit_requested)
+        closeClient(socket);
+}
+
+/*! \brief Send the responses to a batch executed by the GUI thread. */
+void TcpRemoteControlServer::finishBatch(QObject *client,
+                                         const QByteArray &answer, bool quit)
+{
+    // the client may have been closed while the commands were executed
+    QTcpSocket *socket = findClient(client);
+
+    if (!socket)
+        return;
+
+    rc_busy.remove(socket);
+
+    if (!answer.isEmpty())
+        socket->write(answer);
+
+    if (quit)
+        closeClient(socket);
+    else
+        readClient(socket);
+}
+
+/*! \brief Remove a client that has closed its connection. */
+void TcpRemoteControlServer::clientDisconnected()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+
+    if (socket && rc_sockets.contains(socket))
+        closeClient(socket);
+}
+
+/*! \brief Send telemetry to a subscribed client. */
+void TcpRemoteControlServer::sendTelemetry(QObject *client, const QByteArray &data)
+{
+    // the signal goes to all transports, only handle our own clients
+    QTcpSocket *socket = findClient(client);
+
+    // drop data for clients that do not keep up instead of buffering it
+    if (socket && socket->bytesToWrite() < MAX_RC_BACKLOG)
+        socket->write(data);
+}
+
+/*! \brief Look up one of our clients.
+ *
+ * Queued signals may refer to clients that have already been deleted, so
+ * the pointer is only compared and never dereferenced before it is found.
+ */
+QTcpSocket *TcpRemoteControlServer::findClient(QObject *client) const
+{
+    for (int i = 0; i < rc_sockets.size(); i++)
+        if (static_cast<QObject *>(rc_sockets[i]) == client)
+            return rc_sockets[i];
+
+    return 0;
+}
+
+/*! \brief Close a client connection after sending pending responses. */
+void TcpRemoteControlServer::closeClient(QTcpSocket *socket)
+{
+    rc_sockets.removeAll(socket);
+    rc_busy.remove(socket);
+
+    // subscriptions belong to the GUI thread
+    QMetaObject::invokeMethod(remote_control, "removeClient",
+                              Qt::QueuedConnection,
+                              Q_ARG(QObject*, socket));
+    socket->disconnect(this);
+    socket->disconnectFromHost();
+    socket->deleteLater();
 }
 
 void TcpRemoteControlServer::readSettingsFromSection(QSettings* settings,
@@ -24,15 +24,28 @@
 #ifndef TCP_REMOTE_CONTROL_SERVER_H
 #define TCP_REMOTE_CONTROL_SERVER_H
 
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
 #include <QObject>
+#include <QSet>
 #include <QStringList>
 #include <QTcpServer>
+#include <QThread>
 
 class QSettings;
 class QTcpSocket;
 
 class RemoteControl;
 
+/*! \brief TCP transport for the remote control protocol.
+ *
+ * The sockets live in a separate control thread so that frequency commands
+ * can be executed without waiting for the GUI event loop, see
+ * RemoteControl::isDirectBatch(). All other commands are forwarded to the
+ * GUI thread and the responses are sent back when they have been executed.
+ * The public methods may be called from the GUI thread.
+ */
 class TcpRemoteControlServer : public QObject
 {
     Q_OBJECT
@@ -54,19 +67,31 @@ public:
     QStringList getHosts() const;
 
 private slots:
+    void startListening();
+    void stopListening();
     void acceptConnection();
     void startRead();
+    void clientDisconnected();
+    void finishBatch(QObject *client, const QByteArray &answer, bool quit);
+    void sendTelemetry(QObject *client, const QByteArray &data);
 
 private:
     void readSettingsFromSection(QSettings* settings, QString section_name);
+    void readClient(QTcpSocket *socket);
+    QTcpSocket *findClient(QObject *client) const;
+    void closeClient(QTcpSocket *socket);
 
     RemoteControl*  remote_control;
 
-    QTcpServer      rc_server;         /*!< The active server object. */
-    QTcpSocket*     rc_socket;         /*!< The active socket object. */
+    QThread         rc_thread;         /*!< The control thread owning the sockets. */
+    QTcpServer     *rc_server;         /*!< The active server object. */
+    QList<QTcpSocket*>  rc_sockets;    /*!< The connected clients. */
+    QSet<QTcpSocket*>   rc_busy;       /*!< Clients waiting for the GUI thread. */
 
+    mutable QMutex  rc_mutex;          /*!< Protects the settings below. */
     QStringList     rc_allowed_hosts;  /*!< Hosts where we accept connection from. */
     int             rc_port;           /*!< The port we are listening on. */
+    bool            rc_listening;      /*!< Whether the server is running. */
 };
 
 #endif // TCP_REMOTE_CONTROL_SERVER_H
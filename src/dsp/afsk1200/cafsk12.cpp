@@ -20,27 +20,36 @@
  *      along with this program; if not, write to the Free Software
  *      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
  */
-#include <QDebug>
-#include <QTime>
 #include <math.h>
 #include <stdio.h>
 #include <stdarg.h>
-#include "filter.h"
+#include <string.h>
+#include <time.h>
+#include <gnuradio/io_signature.h>
 #include "cafsk12.h"
 
 
+cafsk12_sptr make_cafsk12(int queue_size)
+{
+    return gnuradio::get_initial_sptr(new CAfsk12(queue_size));
+}
 
 
-CAfsk12::CAfsk12(QObject *parent) :
-    QObject(parent)
+CAfsk12::CAfsk12(int queue_size)
+    : gr::sync_block ("afsk12",
+          gr::io_signature::make(1, 1, sizeof(float)),
+          gr::io_signature::make(0, 0, 0)),
+      d_dropped(0)
 {
-    state = (demod_state *) malloc(sizeof(demod_state));
+    /* correlators need CORRLEN samples ending at the current one */
+    set_history(CORRLEN);
+    d_frames.set_capacity(queue_size);
     reset();
 }
 
 CAfsk12::~CAfsk12()
 {
-    free(state);
+
 }
 
 /*! \brief Reset the decoder. */
@@ -49,66 +58,158 @@ void CAfsk12::reset()
     float f;
     int i;
 
-    hdlc_init(state);
-    memset(&state->l1.afsk12, 0, sizeof(state->l1.afsk12));
+    gr::thread::scoped_lock lock(d_setlock);
+
+    hdlc_init();
+    memset(&l1, 0, sizeof(l1));
+
+    /* Reference tap k goes to branch k % SUBSAMP. Taps beyond CORRLEN are
+     * zero so every branch has the same length.
+     */
+    memset(corr_mark_i, 0, sizeof(corr_mark_i));
+    memset(corr_mark_q, 0, sizeof(corr_mark_q));
+    memset(corr_space_i, 0, sizeof(corr_space_i));
+    memset(corr_space_q, 0, sizeof(corr_space_q));
     for (f = 0, i = 0; i < CORRLEN; i++) {
-        corr_mark_i[i] = cos(f);
-        corr_mark_q[i] = sin(f);
+        corr_mark_i[i % SUBSAMP][i / SUBSAMP] = cos(f);
+        corr_mark_q[i % SUBSAMP][i / SUBSAMP] = sin(f);
         f += 2.0*M_PI*FREQ_MARK/FREQ_SAMP;
     }
     for (f = 0, i = 0; i < CORRLEN; i++) {
-        corr_space_i[i] = cos(f);
-        corr_space_q[i] = sin(f);
+        corr_space_i[i % SUBSAMP][i / SUBSAMP] = cos(f);
+        corr_space_q[i % SUBSAMP][i / SUBSAMP] = sin(f);
         f += 2.0*M_PI*FREQ_SPACE/FREQ_SAMP;
     }
-
 }
 
 
-void CAfsk12::demod(float *buffer, int length)
+/*! \brief Work method.
+ *
+ * Input sample i together with the CORRLEN-1 samples of history is the
+ * correlator window ending at the i'th new sample. The correlators are
+ * evaluated at every SUBSAMP'th window starting at l1.subsamp.
+ */
+int CAfsk12::work(int noutput_items,
+                  gr_vector_const_void_star &input_items,
+                  gr_vector_void_star &output_items)
 {
-    float f;
+    const float *in = (const float *)input_items[0];
+    const int    inlen = noutput_items + CORRLEN - 1;
+    int          first = l1.subsamp;
+    int          num, len, b, i, m;
+    float        f;
     unsigned char curbit;
 
-    if (state->l1.afsk12.subsamp) {
-        int numfill = SUBSAMP - state->l1.afsk12.subsamp;
-        if (length < numfill) {
-            state->l1.afsk12.subsamp += length;
-            return;
+    (void) output_items;
+
+    gr::thread::scoped_lock lock(d_setlock);
+
+    if (first >= noutput_items) {
+        l1.subsamp -= noutput_items;
+        return noutput_items;
+    }
+
+    num = (noutput_items - first + SUBSAMP - 1) / SUBSAMP;
+    l1.subsamp = first + num * SUBSAMP - noutput_items;
+
+    /* split input into polyphase branches */
+    len = num + CORRLEN_PH - 1;
+    for (b = 0; b < SUBSAMP; b++) {
+        if ((int)d_branch[b].size() < len)
+            d_branch[b].resize(len);
+
+        float *br = &d_branch[b][0];
+        for (m = 0; m < len; m++) {
+            i = first + m * SUBSAMP + b;
+            br[m] = (i < inlen) ? in[i] : 0.0f;
+        }
+    }
+
+    if ((int)d_mark_i.size() < num) {
+        d_mark_i.resize(num);
+        d_mark_q.resize(num);
+        d_space_i.resize(num);
+        d_space_q.resize(num);
+    }
+
+    float *mi = &d_mark_i[0];
+    float *mq = &d_mark_q[0];
+    float *si = &d_space_i[0];
+    float *sq = &d_space_q[0];
+
+    memset(mi, 0, num * sizeof(float));
+    memset(mq, 0, num * sizeof(float));
+    memset(si, 0, num * sizeof(float));
+    memset(sq, 0, num * sizeof(float));
+
+    /* correlator bank, one reference tap at a time over all windows */
+    for (b = 0; b < SUBSAMP; b++) {
+        for (i = 0; i < CORRLEN_PH; i++) {
+            const float *x = &d_branch[b][i];
+            const float cmi = corr_mark_i[b][i];
+            const float cmq = corr_mark_q[b][i];
+            const float csi = corr_space_i[b][i];
+            const float csq = corr_space_q[b][i];
+
+            for (m = 0; m < num; m++) {
+                mi[m] += x[m] * cmi;
+                mq[m] += x[m] * cmq;
+                si[m] += x[m] * csi;
+                sq[m] += x[m] * csq;
+            }
         }
-        buffer += numfill;
-        length -= numfill;
-        state->l1.afsk12.subsamp = 0;
     }
-    for (; length >= SUBSAMP; length -= SUBSAMP, buffer += SUBSAMP) {
-        f = fsqr(mac(buffer, corr_mark_i, CORRLEN)) +
-            fsqr(mac(buffer, corr_mark_q, CORRLEN)) -
-            fsqr(mac(buffer, corr_space_i, CORRLEN)) -
-            fsqr(mac(buffer, corr_space_q, CORRLEN));
-        state->l1.afsk12.dcd_shreg <<= 1;
-        state->l1.afsk12.dcd_shreg |= (f > 0);
-        verbprintf(10, "%c", '0'+(state->l1.afsk12.dcd_shreg & 1));
+
+    /* mark minus space energy */
+    for (m = 0; m < num; m++)
+        mi[m] = mi[m] * mi[m] + mq[m] * mq[m] - si[m] * si[m] - sq[m] * sq[m];
+
+    /* bit synchronizer */
+    for (m = 0; m < num; m++) {
+        f = mi[m];
+        l1.dcd_shreg <<= 1;
+        l1.dcd_shreg |= (f > 0);
         /*
          * check if transition
          */
-        if ((state->l1.afsk12.dcd_shreg ^ (state->l1.afsk12.dcd_shreg >> 1)) & 1) {
-            if (state->l1.afsk12.sphase < (0x8000u-(SPHASEINC/2)))
-                state->l1.afsk12.sphase += SPHASEINC/8;
+        if ((l1.dcd_shreg ^ (l1.dcd_shreg >> 1)) & 1) {
+            if (l1.sphase < (0x8000u-(SPHASEINC/2)))
+                l1.sphase += SPHASEINC/8;
             else
-                state->l1.afsk12.sphase -= SPHASEINC/8;
+                l1.sphase -= SPHASEINC/8;
         }
-        state->l1.afsk12.sphase += SPHASEINC;
-        if (state->l1.afsk12.sphase >= 0x10000u) {
-            state->l1.afsk12.sphase &= 0xffffu;
-            state->l1.afsk12.lasts <<= 1;
-            state->l1.afsk12.lasts |= state->l1.afsk12.dcd_shreg & 1;
-            curbit = (state->l1.afsk12.lasts ^
-                  (state->l1.afsk12.lasts >> 1) ^ 1) & 1;
-            verbprintf(9, " %c ", '0'+curbit);
-            hdlc_rxbit(state, curbit);
+        l1.sphase += SPHASEINC;
+        if (l1.sphase >= 0x10000u) {
+            l1.sphase &= 0xffffu;
+            l1.lasts <<= 1;
+            l1.lasts |= l1.dcd_shreg & 1;
+            curbit = (l1.lasts ^ (l1.lasts >> 1) ^ 1) & 1;
+            hdlc_rxbit(curbit);
         }
     }
-    state->l1.afsk12.subsamp = length;
+
+    return noutput_items;
+}
+
+
+bool CAfsk12::get_frame(std::string &frame)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    if (d_frames.empty())
+        return false;
+
+    frame = d_frames.front();
+    d_frames.pop_front();
+
+    return true;
+}
+
+unsigned int CAfsk12::frames_dropped()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    return d_dropped;
 }
 
 /** HDLC functions **/
@@ -152,60 +253,59 @@ static const unsigned short crc_ccitt_table[] = {
     0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78
 };
 
-void CAfsk12::hdlc_init(struct demod_state *s)
+void CAfsk12::hdlc_init()
 {
-    memset(&s->l2.hdlc, 0, sizeof(s->l2.hdlc));
+    memset(&hdlc, 0, sizeof(hdlc));
 }
 
 
-void CAfsk12::hdlc_rxbit(struct demod_state *s, int bit)
+void CAfsk12::hdlc_rxbit(int bit)
 {
-    s->l2.hdlc.rxbitstream <<= 1;
-    s->l2.hdlc.rxbitstream |= !!bit;
-    if ((s->l2.hdlc.rxbitstream & 0xff) == 0x7e) {
-        if (s->l2.hdlc.rxstate && (s->l2.hdlc.rxptr - s->l2.hdlc.rxbuf) > 2)
-            ax25_disp_packet(s->l2.hdlc.rxbuf, s->l2.hdlc.rxptr - s->l2.hdlc.rxbuf);
-        s->l2.hdlc.rxstate = 1;
-        s->l2.hdlc.rxptr = s->l2.hdlc.rxbuf;
-        s->l2.hdlc.rxbitbuf = 0x80;
+    hdlc.rxbitstream <<= 1;
+    hdlc.rxbitstream |= !!bit;
+    if ((hdlc.rxbitstream & 0xff) == 0x7e) {
+        if (hdlc.rxstate && (hdlc.rxptr - hdlc.rxbuf) > 2)
+            ax25_disp_packet(hdlc.rxbuf, hdlc.rxptr - hdlc.rxbuf);
+        hdlc.rxstate = 1;
+        hdlc.rxptr = hdlc.rxbuf;
+        hdlc.rxbitbuf = 0x80;
         return;
     }
-    if ((s->l2.hdlc.rxbitstream & 0x7f) == 0x7f) {
-        s->l2.hdlc.rxstate = 0;
+    if ((hdlc.rxbitstream & 0x7f) == 0x7f) {
+        hdlc.rxstate = 0;
         return;
     }
-    if (!s->l2.hdlc.rxstate)
+    if (!hdlc.rxstate)
         return;
-    if ((s->l2.hdlc.rxbitstream & 0x3f) == 0x3e) /* stuffed bit */
+    if ((hdlc.rxbitstream & 0x3f) == 0x3e) /* stuffed bit */
         return;
-    if (s->l2.hdlc.rxbitstream & 1)
-        s->l2.hdlc.rxbitbuf |= 0x100;
-    if (s->l2.hdlc.rxbitbuf & 1) {
-        if (s->l2.hdlc.rxptr >= s->l2.hdlc.rxbuf+sizeof(s->l2.hdlc.rxbuf)) {
-            s->l2.hdlc.rxstate = 0;
-            verbprintf(1, "Error: packet size too large\n");
+    if (hdlc.rxbitstream & 1)
+        hdlc.rxbitbuf |= 0x100;
+    if (hdlc.rxbitbuf & 1) {
+        if (hdlc.rxptr >= hdlc.rxbuf+sizeof(hdlc.rxbuf)) {
+            /* packet too large, drop it */
+            hdlc.rxstate = 0;
             return;
         }
-        *s->l2.hdlc.rxptr++ = s->l2.hdlc.rxbitbuf >> 1;
-        s->l2.hdlc.rxbitbuf = 0x80;
+        *hdlc.rxptr++ = hdlc.rxbitbuf >> 1;
+        hdlc.rxbitbuf = 0x80;
         return;
     }
-    s->l2.hdlc.rxbitbuf >>= 1;
+    hdlc.rxbitbuf >>= 1;
 }
 
 
-static int verbose_level = 2;
-
-void CAfsk12::verbprintf(int verb_level, const char *fmt, ...)
+/* printf style append to a string */
+static void strappendf(std::string &str, const char *fmt, ...)
 {
+    char buf[64];
     va_list args;
 
     va_start(args, fmt);
-    if (verb_level <= verbose_level) {
-        vfprintf(stdout, fmt, args);
-        fflush(stdout);
-    }
+    vsnprintf(buf, sizeof(buf), fmt, args);
     va_end(args);
+
+    str.append(buf);
 }
 
 
@@ -221,23 +321,24 @@ static inline int check_crc_ccitt(const unsigned char *buf, int cnt)
 
 void CAfsk12::ax25_disp_packet(unsigned char *bp, unsigned int len)
 {
-    QString message;
+    std::string message;
+    char timestr[16];
+    time_t now;
+    struct tm tm_now;
     unsigned char v1=1,cmd=0;
     unsigned char i,j;
 
-    verbprintf(6, "AX.25 PKT; L=%d\n", len);
-
     if (!bp || len < 10)
         return;
 #if 1
-    if (!check_crc_ccitt(bp, len)) {
-        verbprintf(6, "CRC check failed\n");
+    if (!check_crc_ccitt(bp, len))
         return;
-    }
 #endif
 
     /* get current time that will be prepended to packet display */
-    QTime time = QTime::currentTime();
+    now = time(0);
+    localtime_r(&now, &tm_now);
+    strftime(timestr, sizeof(timestr), "%H:%M:%S", &tm_now);
 
     len -= 2;
     if (bp[1] & 1) {
@@ -247,47 +348,39 @@ void CAfsk12::ax25_disp_packet(unsigned char *bp, unsigned int len)
         v1 = 0;
         cmd = (bp[1] & 2) != 0;
 
-        verbprintf(0, "AFSK1200: fm ? to ");
-        message.append(QString("%1$ fm ? to ").arg(time.toString("hh:mm:ss")));
+        strappendf(message, "%s$ fm ? to ", timestr);
 
         i = (bp[2] >> 2) & 0x3f;
         if (i) {
-            verbprintf(0, "%c",i+0x20);
-            message.append(QChar(i+0x20));
+            message.push_back(i+0x20);
         }
 
         i = ((bp[2] << 4) | ((bp[3] >> 4) & 0xf)) & 0x3f;
         if (i) {
-            verbprintf(0, "%c",i+0x20);
-            message.append(QChar(i+0x20));
+            message.push_back(i+0x20);
         }
 
         i = ((bp[3] << 2) | ((bp[4] >> 6) & 3)) & 0x3f;
         if (i) {
-            verbprintf(0, "%c",i+0x20);
-            message.append(QChar(i+0x20));
+            message.push_back(i+0x20);
         }
 
         i = bp[4] & 0x3f;
         if (i) {
-            verbprintf(0, "%c",i+0x20);
-            message.append(QChar(i+0x20));
+            message.push_back(i+0x20);
         }
 
         i = (bp[5] >> 2) & 0x3f;
         if (i) {
-            verbprintf(0, "%c",i+0x20);
-            message.append(QChar(i+0x20));
+            message.push_back(i+0x20);
         }
 
         i = ((bp[5] << 4) | ((bp[6] >> 4) & 0xf)) & 0x3f;
         if (i) {
-            verbprintf(0, "%c",i+0x20);
-            message.append(QChar(i+0x20));
+            message.push_back(i+0x20);
         }
 
-        verbprintf(0, "-%u QSO Nr %u", bp[6] & 0xf, (bp[0] << 6) | (bp[1] >> 2));
-        message.append(QString("-%1 QSO Nr %1").arg(bp[6] & 0xf).arg((bp[0] << 6) | (bp[1] >> 2)));
+        strappendf(message, "-%u QSO Nr %u", bp[6] & 0xf, (bp[0] << 6) | (bp[1] >> 2));
 
         bp += 7;
         len -= 7;
@@ -303,48 +396,39 @@ void CAfsk12::ax25_disp_packet(unsigned char *bp, unsigned int len)
             cmd = (bp[6] & 0x80);
         }
 
-        verbprintf(0, "AFSK1200: fm ");
-        message.append(QString("%1$ fm ").arg(time.toString("hh:mm:ss")));
+        strappendf(message, "%s$ fm ", timestr);
 
         for(i = 7; i < 13; i++)
             if ((bp[i] &0xfe) != 0x40) {
-                verbprintf(0, "%c",bp[i] >> 1);
-                message.append(QChar(bp[i] >> 1));
+                message.push_back(bp[i] >> 1);
             }
 
-        verbprintf(0, "-%u to ",(bp[13] >> 1) & 0xf);
-        message.append(QString("-%1 to ").arg((bp[13] >> 1) & 0xf));
+        strappendf(message, "-%u to ", (bp[13] >> 1) & 0xf);
 
         for(i = 0; i < 6; i++)
             if ((bp[i] &0xfe) != 0x40) {
-                verbprintf(0, "%c",bp[i] >> 1);
-                message.append(QChar(bp[i] >> 1));
+                message.push_back(bp[i] >> 1);
             }
 
-        verbprintf(0, "-%u",(bp[6] >> 1) & 0xf);
-        message.append(QString("-%1").arg((bp[6] >> 1) & 0xf));
+        strappendf(message, "-%u", (bp[6] >> 1) & 0xf);
 
         bp += 14;
         len -= 14;
         if ((!(bp[-1] & 1)) && (len >= 7)) {
-            verbprintf(0, " via ");
             message.append(" via ");
         }
 
         while ((!(bp[-1] & 1)) && (len >= 7)) {
             for(i = 0; i < 6; i++)
                 if ((bp[i] &0xfe) != 0x40) {
-                    verbprintf(0, "%c",bp[i] >> 1);
-                    message.append(QChar(bp[i] >> 1));
+                    message.push_back(bp[i] >> 1);
                 }
 
-            verbprintf(0, "-%u",(bp[6] >> 1) & 0xf);
-            message.append(QString("-%1").arg((bp[6] >> 1) & 0xf));
+            strappendf(message, "-%u", (bp[6] >> 1) & 0xf);
 
             bp += 7;
             len -= 7;
             if ((!(bp[-1] & 1)) && (len >= 7)) {
-                verbprintf(0, ",");
                 message.append(",");
             }
         }
@@ -358,106 +442,77 @@ void CAfsk12::ax25_disp_packet(unsigned char *bp, unsigned int len)
              ((i & 0x10) ? (cmd ? '+' : '-') : (cmd ? '^' : 'v'));
     if (!(i & 1)) {
         /* Info frame */
-        verbprintf(0, " I%u%u%c",(i >> 5) & 7,(i >> 1) & 7,j);
-        message.append(QString(" I%1%2%3").arg((i >> 5) & 7).arg((i >> 1) & 7).arg(j));
+        strappendf(message, " I%u%u%c", (i >> 5) & 7, (i >> 1) & 7, j);
     }
     else if (i & 2) {
         /* U frame */
         switch (i & (~0x10)) {
         case 0x03:
-            verbprintf(0, " UI%c",j);
-            message.append(QString(" UI%1").arg(QChar(j)));
+            strappendf(message, " UI%c", j);
             break;
         case 0x2f:
-            verbprintf(0, " SABM%c",j);
-            message.append(QString(" SABM%1").arg(QChar(j)));
+            strappendf(message, " SABM%c", j);
             break;
         case 0x43:
-            verbprintf(0, " DISC%c",j);
-            message.append(QString(" DISC%1").arg(QChar(j)));
+            strappendf(message, " DISC%c", j);
             break;
         case 0x0f:
-            verbprintf(0, " DM%c",j);
-            message.append(QString(" DM%1").arg(QChar(j)));
+            strappendf(message, " DM%c", j);
             break;
         case 0x63:
-            verbprintf(0, " UA%c",j);
-            message.append(QString(" UA%1").arg(QChar(j)));
+            strappendf(message, " UA%c", j);
             break;
         case 0x87:
-            verbprintf(0, " FRMR%c",j);
-            message.append(QString(" FRMR%1").arg(QChar(j)));
+            strappendf(message, " FRMR%c", j);
             break;
         default:
-            verbprintf(0, " unknown U (0x%x)%c",i & (~0x10),j);
-            message.append(QString(" unknown U (0x%1)%2").arg(i & (~0x10),0,16).arg(QChar(j)));
+            strappendf(message, " unknown U (0x%x)%c", i & (~0x10), j);
             break;
         }
     } else {
         /* supervisory */
         switch (i & 0xf) {
         case 0x1:
-            verbprintf(0, " RR%u%c",(i >> 5) & 7,j);
-            message.append(QString(" RR%1%2").arg((i >> 5) & 7).arg(QChar(j)));
+            strappendf(message, " RR%u%c", (i >> 5) & 7, j);
             break;
         case 0x5:
-            verbprintf(0, " RNR%u%c",(i >> 5) & 7,j);
-            message.append(QString(" RNR%1%2").arg((i >> 5) & 7).arg(QChar(j)));
+            strappendf(message, " RNR%u%c", (i >> 5) & 7, j);
             break;
         case 0x9:
-            verbprintf(0, " REJ%u%c",(i >> 5) & 7,j);
-            message.append(QString(" REJ%1%2").arg((i >> 5) & 7).arg(QChar(j)));
+            strappendf(message, " REJ%u%c", (i >> 5) & 7, j);
             break;
         default:
-            verbprintf(0, " unknown S (0x%x)%u%c", i & 0xf, (i >> 5) & 7, j);
-            message.append(QString(" unknown S (0x%1)%2%3").arg(i & 0xf,0,16).arg((i >> 5) & 7).arg(QChar(j)));
+            strappendf(message, " unknown S (0x%x)%u%c", i & 0xf, (i >> 5) & 7, j);
             break;
         }
     }
 
     if (!len) {
-        verbprintf(0, "\n");
-        //message.append("\n");
         goto finished;
     }
 
     i = *bp++;
-    verbprintf(0, " pid=%02X\n", i);
-    message.append(QString(" pid=%1\n          ").arg(i,0,16).toUpper());
+    strappendf(message, " PID=%X\n          ", i);
 
     len--;
-    j = 0;
     while (len) {
         i = *bp++;
         if ((i >= 32) && (i < 128)) {
-            verbprintf(0, "%c",i);
-            message.append(QChar(i));
+            message.push_back(i);
         }
-        else if (i == 13) {
-            if (j) {
-                verbprintf(0, "\n");
-                //message.append("\n");
-            }
-            j = 0;
-        }
-        else {
-            verbprintf(0, ".");
+        else if (i != 13) {
             message.append(".");
         }
-
-        if (i >= 32)
-            j = 1;
         len--;
     }
-    if (j) {
-        verbprintf(0, "\n");
-        //message.append("\n");
-    }
 
     /* I just secured myself a ticket to hell */
     finished:
     if (message.size() > 0) {
-        emit newMessage(message);
+        boost::mutex::scoped_lock lock(d_mutex);
+
+        if (d_frames.full())
+            d_dropped++;
+        d_frames.push_back(message);
     }
 }
-
@@ -23,11 +23,11 @@
 #ifndef CAFSK12_H
 #define CAFSK12_H
 
-#include <QObject>
-
-extern const float costabf[0x400];
-#define COS(x) costabf[(((x)>>6)&0x3ffu)]
-#define SIN(x) COS((x)+0xc000)
+#include <string>
+#include <vector>
+#include <gnuradio/sync_block.h>
+#include <boost/thread/mutex.hpp>
+#include <boost/circular_buffer.hpp>
 
 /*
  * Standard TCM3105 clock frequency: 4.4336MHz
@@ -43,135 +43,100 @@ extern const float costabf[0x400];
 #define CORRLEN ((int)(FREQ_SAMP/BAUD))
 #define SPHASEINC (0x10000u*BAUD*SUBSAMP/FREQ_SAMP)
 
+/* Number of correlator taps in each polyphase branch. */
+#define CORRLEN_PH ((CORRLEN+SUBSAMP-1)/SUBSAMP)
 
-struct demod_state {
-    const struct demod_param *dem_par;
-    union {
-        struct l2_state_hdlc {
-            unsigned char rxbuf[512];
-            unsigned char *rxptr;
-            unsigned int rxstate;
-            unsigned int rxbitstream;
-            unsigned int rxbitbuf;
-        } hdlc;
-
-        struct l2_state_pocsag {
-            unsigned long rx_data;
-            struct l2_pocsag_rx {
-                unsigned char rx_sync;
-                unsigned char rx_word;
-                unsigned char rx_bit;
-                char func;
-                unsigned long adr;
-                unsigned char buffer[128];
-                unsigned int numnibbles;
-            } rx[2];
-        } pocsag;
-    } l2;
-    union {
-        struct l1_state_poc5 {
-            unsigned int dcd_shreg;
-            unsigned int sphase;
-            unsigned int subsamp;
-        } poc5;
-
-        struct l1_state_poc12 {
-            unsigned int dcd_shreg;
-            unsigned int sphase;
-            unsigned int subsamp;
-        } poc12;
-
-        struct l1_state_poc24 {
-            unsigned int dcd_shreg;
-            unsigned int sphase;
-        } poc24;
-
-        struct l1_state_afsk12 {
-            unsigned int dcd_shreg;
-            unsigned int sphase;
-            unsigned int lasts;
-            unsigned int subsamp;
-        } afsk12;
-
-        struct l1_state_afsk24 {
-            unsigned int dcd_shreg;
-            unsigned int sphase;
-            unsigned int lasts;
-        } afsk24;
-
-        struct l1_state_hapn48 {
-            unsigned int shreg;
-            unsigned int sphase;
-            float lvllo, lvlhi;
-        } hapn48;
-
-        struct l1_state_fsk96 {
-            unsigned int dcd_shreg;
-            unsigned int sphase;
-            unsigned int descram;
-        } fsk96;
-
-        struct l1_state_dtmf {
-            unsigned int ph[8];
-            float energy[4];
-            float tenergy[4][16];
-            int blkcount;
-            int lastch;
-        } dtmf;
-
-        struct l1_state_zvei {
-            unsigned int ph[16];
-            float energy[4];
-            float tenergy[4][32];
-            int blkcount;
-            int lastch;
-        } zvei;
-
-        struct l1_state_scope {
-            int datalen;
-            int dispnum;
-            float data[512];
-        } scope;
-    } l1;
-};
 
+class CAfsk12;
 
-struct demod_param {
-    const char *name;
-    unsigned int samplerate;
-    unsigned int overlap;
-    //void (*init)(struct demod_state *s);
-    //void (*demod)(struct demod_state *s, float *buffer, int length);
-};
+typedef boost::shared_ptr<CAfsk12> cafsk12_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of CAfsk12.
+ *  \param queue_size The maximum number of decoded frames kept in the queue.
+ *
+ * This is effectively the public constructor. The input sample rate must be
+ * FREQ_SAMP.
+ */
+cafsk12_sptr make_cafsk12(int queue_size=100);
 
 
-class CAfsk12 : public QObject
+/*! \brief AFSK1200 packet decoder sink.
+ *  \ingroup DSP
+ *
+ * The decoder runs in the flow graph and decodes AX.25 frames continuously
+ * from the audio stream. Decoded frames are formatted as text and stored in
+ * a queue, which the user interface empties using get_frame().
+ *
+ * The mark and space correlators are evaluated every SUBSAMP input samples.
+ * The input is split into SUBSAMP polyphase branches so that each branch is
+ * correlated with every SUBSAMP'th reference tap using unit stride over a
+ * whole work() call, i.e. one tap is applied to a contiguous run of outputs
+ * at a time instead of summing all taps for one output.
+ */
+class CAfsk12 : public gr::sync_block
 {
-    Q_OBJECT
+    friend cafsk12_sptr make_cafsk12(int queue_size);
+
+protected:
+    CAfsk12(int queue_size);
+
 public:
-    explicit CAfsk12(QObject *parent = 0);
     ~CAfsk12();
 
-    void demod(float *buffer, int length);
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
     void reset();
 
-signals:
-    void newMessage(const QString &message);
+    /*! \brief Get the oldest decoded frame.
+     *  \param frame The formatted frame.
+     *  \returns False if the queue is empty.
+     */
+    bool get_frame(std::string &frame);
 
-public slots:
+    /*! \brief Number of frames dropped because the queue was full. */
+    unsigned int frames_dropped();
 
 private:
-    float corr_mark_i[CORRLEN];
-    float corr_mark_q[CORRLEN];
-    float corr_space_i[CORRLEN];
-    float corr_space_q[CORRLEN];
+    /* correlator reference taps split into polyphase branches */
+    float corr_mark_i[SUBSAMP][CORRLEN_PH];
+    float corr_mark_q[SUBSAMP][CORRLEN_PH];
+    float corr_space_i[SUBSAMP][CORRLEN_PH];
+    float corr_space_q[SUBSAMP][CORRLEN_PH];
+
+    /* work buffers: input branches and correlator outputs */
+    std::vector<float> d_branch[SUBSAMP];
+    std::vector<float> d_mark_i;
+    std::vector<float> d_mark_q;
+    std::vector<float> d_space_i;
+    std::vector<float> d_space_q;
+
+    /* bit synchronizer */
+    struct l1_state_afsk12 {
+        unsigned int dcd_shreg;
+        unsigned int sphase;
+        unsigned int lasts;
+        unsigned int subsamp;
+    } l1;
+
+    /* HDLC deframer */
+    struct l2_state_hdlc {
+        unsigned char rxbuf[512];
+        unsigned char *rxptr;
+        unsigned int rxstate;
+        unsigned int rxbitstream;
+        unsigned int rxbitbuf;
+    } hdlc;
 
-    struct demod_state *state;
+    boost::mutex d_mutex;
+    boost::circular_buffer<std::string> d_frames;
+    unsigned int d_dropped;
 
     /* HDLC functions */
-    void hdlc_init(struct demod_state *s);
-    void hdlc_rxbit(struct demod_state *s, int bit);
-    void verbprintf(int verb_level, const char *fmt, ...);
+    void hdlc_init();
+    void hdlc_rxbit(int bit);
     void ax25_disp_packet(unsigned char *bp, unsigned int len);
 };
 
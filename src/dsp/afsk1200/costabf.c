@@ -1,262 +0,0 @@
-/*
- * This file is machine generated, DO NOT EDIT!
- */
-
-float costabf[1024] = {
-	 1.000000000,  0.999981165,  0.999924719,  0.999830604, 
-	 0.999698818,  0.999529421,  0.999322355,  0.999077737, 
-	 0.998795450,  0.998475552,  0.998118103,  0.997723043, 
-	 0.997290432,  0.996820271,  0.996312618,  0.995767415, 
-	 0.995184720,  0.994564593,  0.993906975,  0.993211925, 
-	 0.992479563,  0.991709769,  0.990902662,  0.990058184, 
-	 0.989176512,  0.988257587,  0.987301409,  0.986308098, 
-	 0.985277653,  0.984210074,  0.983105481,  0.981963873, 
-	 0.980785251,  0.979569793,  0.978317380,  0.977028131, 
-	 0.975702107,  0.974339366,  0.972939968,  0.971503913, 
-	 0.970031261,  0.968522072,  0.966976464,  0.965394437, 
-	 0.963776052,  0.962121427,  0.960430503,  0.958703458, 
-	 0.956940353,  0.955141187,  0.953306019,  0.951435030, 
-	 0.949528158,  0.947585583,  0.945607305,  0.943593442, 
-	 0.941544056,  0.939459205,  0.937339008,  0.935183525, 
-	 0.932992816,  0.930766940,  0.928506076,  0.926210225, 
-	 0.923879504,  0.921514034,  0.919113874,  0.916679084, 
-	 0.914209783,  0.911706030,  0.909168005,  0.906595707, 
-	 0.903989315,  0.901348829,  0.898674488,  0.895966232, 
-	 0.893224299,  0.890448749,  0.887639642,  0.884797096, 
-	 0.881921291,  0.879012227,  0.876070082,  0.873094976, 
-	 0.870086968,  0.867046237,  0.863972843,  0.860866964, 
-	 0.857728601,  0.854557991,  0.851355195,  0.848120332, 
-	 0.844853580,  0.841554999,  0.838224709,  0.834862888, 
-	 0.831469595,  0.828045070,  0.824589312,  0.821102500, 
-	 0.817584813,  0.814036310,  0.810457170,  0.806847572, 
-	 0.803207517,  0.799537241,  0.795836926,  0.792106569, 
-	 0.788346410,  0.784556568,  0.780737221,  0.776888490, 
-	 0.773010433,  0.769103348,  0.765167236,  0.761202395, 
-	 0.757208824,  0.753186822,  0.749136388,  0.745057762, 
-	 0.740951121,  0.736816585,  0.732654274,  0.728464365, 
-	 0.724247098,  0.720002532,  0.715730846,  0.711432219, 
-	 0.707106769,  0.702754736,  0.698376238,  0.693971455, 
-	 0.689540565,  0.685083687,  0.680601001,  0.676092684, 
-	 0.671558976,  0.666999936,  0.662415802,  0.657806695, 
-	 0.653172851,  0.648514390,  0.643831551,  0.639124453, 
-	 0.634393275,  0.629638255,  0.624859512,  0.620057225, 
-	 0.615231574,  0.610382795,  0.605511069,  0.600616455, 
-	 0.595699310,  0.590759695,  0.585797846,  0.580813944, 
-	 0.575808167,  0.570780754,  0.565731823,  0.560661554, 
-	 0.555570245,  0.550457954,  0.545324981,  0.540171444, 
-	 0.534997642,  0.529803634,  0.524589658,  0.519356012, 
-	 0.514102757,  0.508830130,  0.503538370,  0.498227656, 
-	 0.492898196,  0.487550169,  0.482183784,  0.476799220, 
-	 0.471396744,  0.465976506,  0.460538715,  0.455083579, 
-	 0.449611336,  0.444122136,  0.438616246,  0.433093816, 
-	 0.427555084,  0.422000259,  0.416429549,  0.410843164, 
-	 0.405241311,  0.399624199,  0.393992037,  0.388345033, 
-	 0.382683426,  0.377007425,  0.371317208,  0.365612984, 
-	 0.359895051,  0.354163527,  0.348418683,  0.342660725, 
-	 0.336889863,  0.331106305,  0.325310290,  0.319502026, 
-	 0.313681751,  0.307849646,  0.302005947,  0.296150893, 
-	 0.290284663,  0.284407526,  0.278519690,  0.272621363, 
-	 0.266712755,  0.260794103,  0.254865646,  0.248927608, 
-	 0.242980182,  0.237023607,  0.231058106,  0.225083917, 
-	 0.219101235,  0.213110313,  0.207111374,  0.201104641, 
-	 0.195090324,  0.189068660,  0.183039889,  0.177004218, 
-	 0.170961887,  0.164913118,  0.158858150,  0.152797192, 
-	 0.146730468,  0.140658244,  0.134580702,  0.128498107, 
-	 0.122410677,  0.116318628,  0.110222206,  0.104121633, 
-	 0.098017141,  0.091908954,  0.085797310,  0.079682440, 
-	 0.073564567,  0.067443922,  0.061320737,  0.055195246, 
-	 0.049067676,  0.042938258,  0.036807224,  0.030674804, 
-	 0.024541229,  0.018406730,  0.012271538,  0.006135885, 
-	 0.000000000, -0.006135885, -0.012271538, -0.018406730, 
-	-0.024541229, -0.030674804, -0.036807224, -0.042938258, 
-	-0.049067676, -0.055195246, -0.061320737, -0.067443922, 
-	-0.073564567, -0.079682440, -0.085797310, -0.091908954, 
-	-0.098017141, -0.104121633, -0.110222206, -0.116318628, 
-	-0.122410677, -0.128498107, -0.134580702, -0.140658244, 
-	-0.146730468, -0.152797192, -0.158858150, -0.164913118, 
-	-0.170961887, -0.177004218, -0.183039889, -0.189068660, 
-	-0.195090324, -0.201104641, -0.207111374, -0.213110313, 
-	-0.219101235, -0.225083917, -0.231058106, -0.237023607, 
-	-0.242980182, -0.248927608, -0.254865646, -0.260794103, 
-	-0.266712755, -0.272621363, -0.278519690, -0.284407526, 
-	-0.290284663, -0.296150893, -0.302005947, -0.307849646, 
-	-0.313681751, -0.319502026, -0.325310290, -0.331106305, 
-	-0.336889863, -0.342660725, -0.348418683, -0.354163527, 
-	-0.359895051, -0.365612984, -0.371317208, -0.377007425, 
-	-0.382683426, -0.388345033, -0.393992037, -0.399624199, 
-	-0.405241311, -0.410843164, -0.416429549, -0.422000259, 
-	-0.427555084, -0.433093816, -0.438616246, -0.444122136, 
-	-0.449611336, -0.455083579, -0.460538715, -0.465976506, 
-	-0.471396744, -0.476799220, -0.482183784, -0.487550169, 
-	-0.492898196, -0.498227656, -0.503538370, -0.508830130, 
-	-0.514102757, -0.519356012, -0.524589658, -0.529803634, 
-	-0.534997642, -0.540171444, -0.545324981, -0.550457954, 
-	-0.555570245, -0.560661554, -0.565731823, -0.570780754, 
-	-0.575808167, -0.580813944, -0.585797846, -0.590759695, 
-	-0.595699310, -0.600616455, -0.605511069, -0.610382795, 
-	-0.615231574, -0.620057225, -0.624859512, -0.629638255, 
-	-0.634393275, -0.639124453, -0.643831551, -0.648514390, 
-	-0.653172851, -0.657806695, -0.662415802, -0.666999936, 
-	-0.671558976, -0.676092684, -0.680601001, -0.685083687, 
-	-0.689540565, -0.693971455, -0.698376238, -0.702754736, 
-	-0.707106769, -0.711432219, -0.715730846, -0.720002532, 
-	-0.724247098, -0.728464365, -0.732654274, -0.736816585, 
-	-0.740951121, -0.745057762, -0.749136388, -0.753186822, 
-	-0.757208824, -0.761202395, -0.765167236, -0.769103348, 
-	-0.773010433, -0.776888490, -0.780737221, -0.784556568, 
-	-0.788346410, -0.792106569, -0.795836926, -0.799537241, 
-	-0.803207517, -0.806847572, -0.810457170, -0.814036310, 
-	-0.817584813, -0.821102500, -0.824589312, -0.828045070, 
-	-0.831469595, -0.834862888, -0.838224709, -0.841554999, 
-	-0.844853580, -0.848120332, -0.851355195, -0.854557991, 
-	-0.857728601, -0.860866964, -0.863972843, -0.867046237, 
-	-0.870086968, -0.873094976, -0.876070082, -0.879012227, 
-	-0.881921291, -0.884797096, -0.887639642, -0.890448749, 
-	-0.893224299, -0.895966232, -0.898674488, -0.901348829, 
-	-0.903989315, -0.906595707, -0.909168005, -0.911706030, 
-	-0.914209783, -0.916679084, -0.919113874, -0.921514034, 
-	-0.923879504, -0.926210225, -0.928506076, -0.930766940, 
-	-0.932992816, -0.935183525, -0.937339008, -0.939459205, 
-	-0.941544056, -0.943593442, -0.945607305, -0.947585583, 
-	-0.949528158, -0.951435030, -0.953306019, -0.955141187, 
-	-0.956940353, -0.958703458, -0.960430503, -0.962121427, 
-	-0.963776052, -0.965394437, -0.966976464, -0.968522072, 
-	-0.970031261, -0.971503913, -0.972939968, -0.974339366, 
-	-0.975702107, -0.977028131, -0.978317380, -0.979569793, 
-	-0.980785251, -0.981963873, -0.983105481, -0.984210074, 
-	-0.985277653, -0.986308098, -0.987301409, -0.988257587, 
-	-0.989176512, -0.990058184, -0.990902662, -0.991709769, 
-	-0.992479563, -0.993211925, -0.993906975, -0.994564593, 
-	-0.995184720, -0.995767415, -0.996312618, -0.996820271, 
-	-0.997290432, -0.997723043, -0.998118103, -0.998475552, 
-	-0.998795450, -0.999077737, -0.999322355, -0.999529421, 
-	-0.999698818, -0.999830604, -0.999924719, -0.999981165, 
-	-1.000000000, -0.999981165, -0.999924719, -0.999830604, 
-	-0.999698818, -0.999529421, -0.999322355, -0.999077737, 
-	-0.998795450, -0.998475552, -0.998118103, -0.997723043, 
-	-0.997290432, -0.996820271, -0.996312618, -0.995767415, 
-	-0.995184720, -0.994564593, -0.993906975, -0.993211925, 
-	-0.992479563, -0.991709769, -0.990902662, -0.990058184, 
-	-0.989176512, -0.988257587, -0.987301409, -0.986308098, 
-	-0.985277653, -0.984210074, -0.983105481, -0.981963873, 
-	-0.980785251, -0.979569793, -0.978317380, -0.977028131, 
-	-0.975702107, -0.974339366, -0.972939968, -0.971503913, 
-	-0.970031261, -0.968522072, -0.966976464, -0.965394437, 
-	-0.963776052, -0.962121427, -0.960430503, -0.958703458, 
-	-0.956940353, -0.955141187, -0.953306019, -0.951435030, 
-	-0.949528158, -0.947585583, -0.945607305, -0.943593442, 
-	-0.941544056, -0.939459205, -0.937339008, -0.935183525, 
-	-0.932992816, -0.930766940, -0.928506076, -0.926210225, 
-	-0.923879504, -0.921514034, -0.919113874, -0.916679084, 
-	-0.914209783, -0.911706030, -0.909168005, -0.906595707, 
-	-0.903989315, -0.901348829, -0.898674488, -0.895966232, 
-	-0.893224299, -0.890448749, -0.887639642, -0.884797096, 
-	-0.881921291, -0.879012227, -0.876070082, -0.873094976, 
-	-0.870086968, -0.867046237, -0.863972843, -0.860866964, 
-	-0.857728601, -0.854557991, -0.851355195, -0.848120332, 
-	-0.844853580, -0.841554999, -0.838224709, -0.834862888, 
-	-0.831469595, -0.828045070, -0.824589312, -0.821102500, 
-	-0.817584813, -0.814036310, -0.810457170, -0.806847572, 
-	-0.803207517, -0.799537241, -0.795836926, -0.792106569, 
-	-0.788346410, -0.784556568, -0.780737221, -0.776888490, 
-	-0.773010433, -0.769103348, -0.765167236, -0.761202395, 
-	-0.757208824, -0.753186822, -0.749136388, -0.745057762, 
-	-0.740951121, -0.736816585, -0.732654274, -0.728464365, 
-	-0.724247098, -0.720002532, -0.715730846, -0.711432219, 
-	-0.707106769, -0.702754736, -0.698376238, -0.693971455, 
-	-0.689540565, -0.685083687, -0.680601001, -0.676092684, 
-	-0.671558976, -0.666999936, -0.662415802, -0.657806695, 
-	-0.653172851, -0.648514390, -0.643831551, -0.639124453, 
-	-0.634393275, -0.629638255, -0.624859512, -0.620057225, 
-	-0.615231574, -0.610382795, -0.605511069, -0.600616455, 
-	-0.595699310, -0.590759695, -0.585797846, -0.580813944, 
-	-0.575808167, -0.570780754, -0.565731823, -0.560661554, 
-	-0.555570245, -0.550457954, -0.545324981, -0.540171444, 
-	-0.534997642, -0.529803634, -0.524589658, -0.519356012, 
-	-0.514102757, -0.508830130, -0.503538370, -0.498227656, 
-	-0.492898196, -0.487550169, -0.482183784, -0.476799220, 
-	-0.471396744, -0.465976506, -0.460538715, -0.455083579, 
-	-0.449611336, -0.444122136, -0.438616246, -0.433093816, 
-	-0.427555084, -0.422000259, -0.416429549, -0.410843164, 
-	-0.405241311, -0.399624199, -0.393992037, -0.388345033, 
-	-0.382683426, -0.377007425, -0.371317208, -0.365612984, 
-	-0.359895051, -0.354163527, -0.348418683, -0.342660725, 
-	-0.336889863, -0.331106305, -0.325310290, -0.319502026, 
-	-0.313681751, -0.307849646, -0.302005947, -0.296150893, 
-	-0.290284663, -0.284407526, -0.278519690, -0.272621363, 
-	-0.266712755, -0.260794103, -0.254865646, -0.248927608, 
-	-0.242980182, -0.237023607, -0.231058106, -0.225083917, 
-	-0.219101235, -0.213110313, -0.207111374, -0.201104641, 
-	-0.195090324, -0.189068660, -0.183039889, -0.177004218, 
-	-0.170961887, -0.164913118, -0.158858150, -0.152797192, 
-	-0.146730468, -0.140658244, -0.134580702, -0.128498107, 
-	-0.122410677, -0.116318628, -0.110222206, -0.104121633, 
-	-0.098017141, -0.091908954, -0.085797310, -0.079682440, 
-	-0.073564567, -0.067443922, -0.061320737, -0.055195246, 
-	-0.049067676, -0.042938258, -0.036807224, -0.030674804, 
-	-0.024541229, -0.018406730, -0.012271538, -0.006135885, 
-	-0.000000000,  0.006135885,  0.012271538,  0.018406730, 
-	 0.024541229,  0.030674804,  0.036807224,  0.042938258, 
-	 0.049067676,  0.055195246,  0.061320737,  0.067443922, 
-	 0.073564567,  0.079682440,  0.085797310,  0.091908954, 
-	 0.098017141,  0.104121633,  0.110222206,  0.116318628, 
-	 0.122410677,  0.128498107,  0.134580702,  0.140658244, 
-	 0.146730468,  0.152797192,  0.158858150,  0.164913118, 
-	 0.170961887,  0.177004218,  0.183039889,  0.189068660, 
-	 0.195090324,  0.201104641,  0.207111374,  0.213110313, 
-	 0.219101235,  0.225083917,  0.231058106,  0.237023607, 
-	 0.242980182,  0.248927608,  0.254865646,  0.260794103, 
-	 0.266712755,  0.272621363,  0.278519690,  0.284407526, 
-	 0.290284663,  0.296150893,  0.302005947,  0.307849646, 
-	 0.313681751,  0.319502026,  0.325310290,  0.331106305, 
-	 0.336889863,  0.342660725,  0.348418683,  0.354163527, 
-	 0.359895051,  0.365612984,  0.371317208,  0.377007425, 
-	 0.382683426,  0.388345033,  0.393992037,  0.399624199, 
-	 0.405241311,  0.410843164,  0.416429549,  0.422000259, 
-	 0.427555084,  0.433093816,  0.438616246,  0.444122136, 
-	 0.449611336,  0.455083579,  0.460538715,  0.465976506, 
-	 0.471396744,  0.476799220,  0.482183784,  0.487550169, 
-	 0.492898196,  0.498227656,  0.503538370,  0.508830130, 
-	 0.514102757,  0.519356012,  0.524589658,  0.529803634, 
-	 0.534997642,  0.540171444,  0.545324981,  0.550457954, 
-	 0.555570245,  0.560661554,  0.565731823,  0.570780754, 
-	 0.575808167,  0.580813944,  0.585797846,  0.590759695, 
-	 0.595699310,  0.600616455,  0.605511069,  0.610382795, 
-	 0.615231574,  0.620057225,  0.624859512,  0.629638255, 
-	 0.634393275,  0.639124453,  0.643831551,  0.648514390, 
-	 0.653172851,  0.657806695,  0.662415802,  0.666999936, 
-	 0.671558976,  0.676092684,  0.680601001,  0.685083687, 
-	 0.689540565,  0.693971455,  0.698376238,  0.702754736, 
-	 0.707106769,  0.711432219,  0.715730846,  0.720002532, 
-	 0.724247098,  0.728464365,  0.732654274,  0.736816585, 
-	 0.740951121,  0.745057762,  0.749136388,  0.753186822, 
-	 0.757208824,  0.761202395,  0.765167236,  0.769103348, 
-	 0.773010433,  0.776888490,  0.780737221,  0.784556568, 
-	 0.788346410,  0.792106569,  0.795836926,  0.799537241, 
-	 0.803207517,  0.806847572,  0.810457170,  0.814036310, 
-	 0.817584813,  0.821102500,  0.824589312,  0.828045070, 
-	 0.831469595,  0.834862888,  0.838224709,  0.841554999, 
-	 0.844853580,  0.848120332,  0.851355195,  0.854557991, 
-	 0.857728601,  0.860866964,  0.863972843,  0.867046237, 
-	 0.870086968,  0.873094976,  0.876070082,  0.879012227, 
-	 0.881921291,  0.884797096,  0.887639642,  0.890448749, 
-	 0.893224299,  0.895966232,  0.898674488,  0.901348829, 
-	 0.903989315,  0.906595707,  0.909168005,  0.911706030, 
-	 0.914209783,  0.916679084,  0.919113874,  0.921514034, 
-	 0.923879504,  0.926210225,  0.928506076,  0.930766940, 
-	 0.932992816,  0.935183525,  0.937339008,  0.939459205, 
-	 0.941544056,  0.943593442,  0.945607305,  0.947585583, 
-	 0.949528158,  0.951435030,  0.953306019,  0.955141187, 
-	 0.956940353,  0.958703458,  0.960430503,  0.962121427, 
-	 0.963776052,  0.965394437,  0.966976464,  0.968522072, 
-	 0.970031261,  0.971503913,  0.972939968,  0.974339366, 
-	 0.975702107,  0.977028131,  0.978317380,  0.979569793, 
-	 0.980785251,  0.981963873,  0.983105481,  0.984210074, 
-	 0.985277653,  0.986308098,  0.987301409,  0.988257587, 
-	 0.989176512,  0.990058184,  0.990902662,  0.991709769, 
-	 0.992479563,  0.993211925,  0.993906975,  0.994564593, 
-	 0.995184720,  0.995767415,  0.996312618,  0.996820271, 
-	 0.997290432,  0.997723043,  0.998118103,  0.998475552, 
-	 0.998795450,  0.999077737,  0.999322355,  0.999529421, 
-	 0.999698818,  0.999830604,  0.999924719,  0.999981165
-};
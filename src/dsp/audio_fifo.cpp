@@ -0,0 +1,241 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "dsp/audio_fifo.h"
+
+/* Maximum resampling correction. */
+#define MAX_PPM     2000.0
+
+/* Minimum target latency in ms. */
+#define MIN_TARGET_MS   10
+
+/* Time constant of the buffer fill smoothing in seconds. */
+#define FILL_TAU    1.0
+
+/* PI loop gains, with the buffer fill error in seconds. KI = KP^2 / 4
+ * gives a critically damped loop with a time constant of 1 / KP seconds.
+ */
+#define LOOP_KP     0.05
+#define LOOP_KI     (LOOP_KP * LOOP_KP / 4.0)
+
+
+audio_fifo::audio_fifo(unsigned int sample_rate, unsigned int target_ms,
+                       unsigned int size_ms)
+    : d_ring(size_ms * sample_rate / 1000),
+      d_sample_rate(sample_rate),
+      d_mu(1.0),
+      d_ratio(1.0),
+      d_integ(0.0),
+      d_fill(0.0),
+      d_running(false),
+      d_span(0),
+      d_span_len(0),
+      d_span_pos(0),
+      d_target(0),
+      d_flush(false),
+      d_underruns(0),
+      d_skips(0),
+      d_latency(0),
+      d_ppm(0)
+{
+    memset(d_hist, 0, sizeof(d_hist));
+    set_target_latency(target_ms);
+}
+
+audio_fifo::~audio_fifo()
+{
+
+}
+
+void audio_fifo::write(const float *left, const float *right, unsigned int num)
+{
+    unsigned int i;
+
+    if (d_wbuf.size() < num)
+        d_wbuf.resize(num);
+
+    if (!right)
+        right = left;
+
+    for (i = 0; i < num; i++)
+    {
+        d_wbuf[i].l = left[i];
+        d_wbuf[i].r = right[i];
+    }
+
+    d_ring.write(&d_wbuf[0], num);
+}
+
+/* Get the next frame from the ring buffer (reader). */
+bool audio_fifo::next_frame(frame &f)
+{
+    if (d_span_pos == d_span_len)
+    {
+        d_ring.consume(d_span_len);
+        d_span_len = d_ring.read_span(&d_span);
+        d_span_pos = 0;
+        if (d_span_len == 0)
+            return false;
+    }
+
+    f = d_span[d_span_pos++];
+
+    return true;
+}
+
+void audio_fifo::read(float *out, unsigned int frames)
+{
+    unsigned int    target = d_target.load(boost::memory_order_relaxed);
+    unsigned int    fill;
+    unsigned int    i;
+    frame           f;
+    float           mu, c0, c1, c2, c3;
+
+    if (d_flush.exchange(false))
+    {
+        while (next_frame(f))
+            ;
+        d_running = false;
+    }
+
+    fill = d_ring.available() - d_span_pos;
+
+    if (!d_running)
+    {
+        d_latency.store(fill, boost::memory_order_relaxed);
+
+        /* prefill to the target latency before starting */
+        if (fill < target)
+        {
+            memset(out, 0, 2 * frames * sizeof(float));
+            return;
+        }
+
+        d_running = true;
+        d_fill = fill;
+        d_mu = 1.0;
+        memset(d_hist, 0, sizeof(d_hist));
+    }
+
+    if (fill > 2 * target)
+    {
+        /* drop the excess, e.g. after the audio device has been stalled */
+        for (i = fill - target; i > 0 && next_frame(f); i--)
+            ;
+        d_skips.fetch_add(1, boost::memory_order_relaxed);
+        fill = target;
+        d_fill = target;
+    }
+
+    update_ratio(fill, frames);
+
+    for (i = 0; i < frames; i++)
+    {
+        while (d_mu >= 1.0)
+        {
+            if (!next_frame(f))
+            {
+                /* underrun: output silence and prefill again */
+                d_underruns.fetch_add(1, boost::memory_order_relaxed);
+                d_running = false;
+                memset(out, 0, 2 * (frames - i) * sizeof(float));
+                return;
+            }
+            d_hist[0] = d_hist[1];
+            d_hist[1] = d_hist[2];
+            d_hist[2] = d_hist[3];
+            d_hist[3] = f;
+            d_mu -= 1.0;
+        }
+
+        /* cubic Hermite interpolation between d_hist[1] and d_hist[2] */
+        mu = d_mu;
+        c0 = d_hist[1].l;
+        c1 = 0.5f * (d_hist[2].l - d_hist[0].l);
+        c2 = d_hist[0].l - 2.5f * d_hist[1].l + 2.0f * d_hist[2].l - 0.5f * d_hist[3].l;
+        c3 = 0.5f * (d_hist[3].l - d_hist[0].l) + 1.5f * (d_hist[1].l - d_hist[2].l);
+        *out++ = ((c3 * mu + c2) * mu + c1) * mu + c0;
+
+        c0 = d_hist[1].r;
+        c1 = 0.5f * (d_hist[2].r - d_hist[0].r);
+        c2 = d_hist[0].r - 2.5f * d_hist[1].r + 2.0f * d_hist[2].r - 0.5f * d_hist[3].r;
+        c3 = 0.5f * (d_hist[3].r - d_hist[0].r) + 1.5f * (d_hist[1].r - d_hist[2].r);
+        *out++ = ((c3 * mu + c2) * mu + c1) * mu + c0;
+
+        d_mu += d_ratio;
+    }
+}
+
+/* Update the resampling ratio from the buffer fill (reader). */
+void audio_fifo::update_ratio(unsigned int fill, unsigned int frames)
+{
+    double dt = (double)frames / (double)d_sample_rate;
+    double alpha = std::min(1.0, dt / FILL_TAU);
+    double err, corr;
+    double max_corr = MAX_PPM * 1.0e-6;
+
+    d_fill += alpha * ((double)fill - d_fill);
+
+    /* error in seconds, positive when there is too much data */
+    err = (d_fill - (double)d_target.load(boost::memory_order_relaxed)) /
+          (double)d_sample_rate;
+
+    d_integ += LOOP_KI * err * dt;
+    d_integ = std::max(-max_corr, std::min(max_corr, d_integ));
+
+    corr = LOOP_KP * err + d_integ;
+    corr = std::max(-max_corr, std::min(max_corr, corr));
+    d_ratio = 1.0 + corr;
+
+    d_latency.store((unsigned int)d_fill, boost::memory_order_relaxed);
+    d_ppm.store((int)lrint(corr * 1.0e6), boost::memory_order_relaxed);
+}
+
+void audio_fifo::flush()
+{
+    d_flush.store(true);
+}
+
+void audio_fifo::set_target_latency(unsigned int target_ms)
+{
+    unsigned int target;
+
+    /* leave room for the writer above twice the target */
+    target_ms = std::max(target_ms, (unsigned int) MIN_TARGET_MS);
+    target = target_ms * d_sample_rate / 1000;
+    target = std::min(target, d_ring.capacity() / 3);
+    d_target.store(target);
+}
+
+void audio_fifo::get_stats(audio_fifo_stats &stats) const
+{
+    double ms_per_frame = 1000.0 / (double)d_sample_rate;
+
+    stats.underruns = d_underruns.load(boost::memory_order_relaxed);
+    stats.overruns = d_ring.overruns() + d_skips.load(boost::memory_order_relaxed);
+    stats.latency_ms = ms_per_frame * d_latency.load(boost::memory_order_relaxed);
+    stats.target_ms = ms_per_frame * d_target.load(boost::memory_order_relaxed);
+    stats.ratio_ppm = d_ppm.load(boost::memory_order_relaxed);
+}
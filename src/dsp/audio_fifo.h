@@ -0,0 +1,128 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef AUDIO_FIFO_H
+#define AUDIO_FIFO_H
+
+#include <vector>
+#include <boost/atomic.hpp>
+#include "dsp/spsc_ring.h"
+
+
+/*! \brief Audio buffer statistics. */
+struct audio_fifo_stats
+{
+    unsigned long   underruns;      /*!< Number of times the buffer ran empty. */
+    unsigned long   overruns;       /*!< Number of times samples were dropped. */
+    double          latency_ms;     /*!< Current buffer fill in ms. */
+    double          target_ms;      /*!< Target buffer fill in ms. */
+    double          ratio_ppm;      /*!< Resampling correction in ppm. */
+};
+
+
+/*! \brief Buffer between the flow graph and an audio device callback.
+ *  \ingroup DSP
+ *
+ * The flow graph writes stereo samples using write() and the audio callback
+ * reads them using read(). Neither side blocks or takes a lock, so a stalled
+ * audio device can not hold up the flow graph and vice versa.
+ *
+ * The sample clocks of the SDR and the sound card always differ slightly,
+ * which would eventually empty or fill any buffer. The reader therefore
+ * resamples the audio by a small, slowly adjusted ratio that keeps the
+ * buffer fill at the target latency. The ratio is controlled by a PI loop
+ * acting on the smoothed buffer fill, and is limited to +/- MAX_PPM so the
+ * pitch change is inaudible. Interpolation uses a 4-point cubic Hermite
+ * spline.
+ *
+ * After an underrun the reader outputs silence until the buffer is filled
+ * to the target latency again. If the buffer fill grows beyond twice the
+ * target, e.g. after the device was stalled, the excess is dropped.
+ */
+class audio_fifo
+{
+public:
+    /*! \brief Create a new audio buffer.
+     *  \param sample_rate The audio sample rate.
+     *  \param target_ms The target latency in ms.
+     *  \param size_ms The buffer size in ms.
+     */
+    audio_fifo(unsigned int sample_rate, unsigned int target_ms = 100,
+               unsigned int size_ms = 2000);
+    ~audio_fifo();
+
+    /*! \brief Write samples (flow graph thread).
+     *  \param left The left channel.
+     *  \param right The right channel, or NULL to use left for both.
+     *  \param num The number of samples in each channel.
+     */
+    void write(const float *left, const float *right, unsigned int num);
+
+    /*! \brief Read interleaved stereo samples (audio thread).
+     *  \param out Output buffer for 2 x frames samples.
+     *  \param frames The number of frames to read.
+     *
+     * Always fills the whole buffer, with silence if there is no data.
+     */
+    void read(float *out, unsigned int frames);
+
+    /*! \brief Discard buffered audio. The reader does it on its next read. */
+    void flush();
+
+    /*! \brief Set the target latency, at least 10 ms. */
+    void set_target_latency(unsigned int target_ms);
+
+    void get_stats(audio_fifo_stats &stats) const;
+
+private:
+    struct frame {
+        float l;
+        float r;
+    };
+
+    bool next_frame(frame &f);
+    void update_ratio(unsigned int fill, unsigned int frames);
+
+    spsc_ring<frame>    d_ring;
+    std::vector<frame>  d_wbuf;         /*!< Interleaving buffer (writer). */
+    unsigned int        d_sample_rate;
+
+    /* reader state */
+    frame               d_hist[4];      /*!< Interpolator history. */
+    double              d_mu;           /*!< Fractional read position. */
+    double              d_ratio;        /*!< Input frames per output frame. */
+    double              d_integ;        /*!< PI loop integrator. */
+    double              d_fill;         /*!< Smoothed buffer fill in frames. */
+    bool                d_running;      /*!< False while prefilling. */
+    const frame        *d_span;         /*!< Current read span. */
+    unsigned int        d_span_len;
+    unsigned int        d_span_pos;
+
+    boost::atomic<unsigned int>     d_target;       /*!< Target fill in frames. */
+    boost::atomic<bool>             d_flush;
+    boost::atomic<unsigned long>    d_underruns;
+    boost::atomic<unsigned long>    d_skips;        /*!< Excess fill dropped by reader. */
+    boost::atomic<unsigned int>     d_latency;      /*!< Buffer fill in frames. */
+    boost::atomic<int>              d_ppm;
+};
+
+#endif // AUDIO_FIFO_H
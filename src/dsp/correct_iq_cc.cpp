@@ -26,149 +26,207 @@
 #include "dsp/correct_iq_cc.h"
 
 
-dc_corr_cc_sptr make_dc_corr_cc(double sample_rate, double tau)
+/** Combined I/Q swap, DC removal and I/Q balance **/
+iq_corr_cc_sptr make_iq_corr_cc(double sample_rate, double tau)
 {
-    return gnuradio::get_initial_sptr(new dc_corr_cc(sample_rate, tau));
+    return gnuradio::get_initial_sptr(new iq_corr_cc(sample_rate, tau));
 }
 
-
-/*! \brief Create DC correction object.
- *
- * Use make_dc_corr_cc() instead.
- */
-dc_corr_cc::dc_corr_cc(double sample_rate, double tau)
-    : gr::hier_block2 ("dc_corr_cc",
+iq_corr_cc::iq_corr_cc(double sample_rate, double tau)
+    : gr::sync_block ("iq_corr_cc",
           gr::io_signature::make(1, 1, sizeof(gr_complex)),
-          gr::io_signature::make(1, 1, sizeof(gr_complex)))
+          gr::io_signature::make(1, 1, sizeof(gr_complex))),
+      d_sr(sample_rate),
+      d_tau(tau),
+      d_swap(false),
+      d_dc_cancel(false),
+      d_iq_balance(false),
+      d_dc_i(0.0f),
+      d_dc_q(0.0f),
+      d_w_re(0.0f),
+      d_w_im(0.0f)
 {
-    d_sr = sample_rate;
-    d_tau = tau;
-    d_alpha = 1.0 / (1.0 + d_tau * sample_rate);
-
-#ifndef QT_NO_DEBUG_OUTPUT
-    std::cout << "IQ DCR alpha: " << d_alpha << std::endl;
-#endif
 
-    d_iir = gr::filter::single_pole_iir_filter_cc::make(d_alpha, 1);
-    d_sub = gr::blocks::sub_cc::make(1);
-
-    connect(self(), 0, d_iir, 0);
-    connect(self(), 0, d_sub, 0);
-    connect(d_iir, 0, d_sub, 1);
-    connect(d_sub, 0, self(), 0);
 }
 
-dc_corr_cc::~dc_corr_cc()
+iq_corr_cc::~iq_corr_cc()
 {
 
 }
 
-/*! \brief Set new sample rate. */
-void dc_corr_cc::set_sample_rate(double sample_rate)
+int iq_corr_cc::work(int noutput_items,
+                     gr_vector_const_void_star &input_items,
+                     gr_vector_void_star &output_items)
 {
-    d_sr = sample_rate;
-    d_alpha = 1.0 / (1.0 + d_tau * sample_rate);
+    const gr_complex *in = (const gr_complex *) input_items[0];
+    gr_complex *out = (gr_complex *) output_items[0];
 
-    d_iir->set_taps(d_alpha);
+    process(in, out, noutput_items);
 
-#ifndef QT_NO_DEBUG_OUTPUT
-    std::cout << "IQ DCR samp_rate: " << sample_rate << std::endl;
-    std::cout << "IQ DCR alpha: " << d_alpha << std::endl;
-#endif
+    return noutput_items;
 }
 
-/*! \brief Set new time constant. */
-void dc_corr_cc::set_tau(double tau)
+/*! \brief Correct a buffer of samples.
+ *  \param in The input samples.
+ *  \param out The output samples. May be the same buffer as \p in.
+ *  \param nitems The number of samples to process.
+ *
+ * Every sample is read before its output is written, so the correction can
+ * be done in place, e.g. on a buffer that is about to be recorded.
+ */
+void iq_corr_cc::process(const gr_complex *in, gr_complex *out, int nitems)
 {
-    d_tau = tau;
-    d_alpha = 1.0 / (1.0 + d_tau * d_sr);
+    const float *src = (const float *) in;
+    float *dst = (float *) out;
 
-    d_iir->set_taps(d_alpha);
+    gr::thread::scoped_lock lock(d_setlock);
 
-#ifndef QT_NO_DEBUG_OUTPUT
-    std::cout << "IQ DCR alpha: " << d_alpha << std::endl;
-#endif
-}
+    if (nitems <= 0)
+        return;
 
+    const int   si = d_swap ? 1 : 0;
+    const int   sq = 1 - si;
+    const bool  dc_cancel = d_dc_cancel;
+    const bool  iq_balance = d_iq_balance;
+    const float dc_i = dc_cancel ? d_dc_i : 0.0f;
+    const float dc_q = dc_cancel ? d_dc_q : 0.0f;
+    const float w_re = iq_balance ? d_w_re : 0.0f;
+    const float w_im = iq_balance ? d_w_im : 0.0f;
+
+    /* Residual DC and E{y^2}, E{|y|^2} of the corrected output. Each sum is
+     * split into four partial sums, one per sample in a group of four, so
+     * the additions are not one long serial chain. Without -ffast-math the
+     * compiler may not reorder float additions itself; with the split done
+     * by hand GCC vectorizes the inner loop at -O3.
+     */
+    float sum_i[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float sum_q[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float sum_yy_re[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float sum_yy_im[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float sum_pwr[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    int k = 0;
+    for (; k + 4 <= nitems; k += 4)
+    {
+        for (int l = 0; l < 4; l++)
+        {
+            float i = src[2*(k+l)+si] - dc_i;
+            float q = src[2*(k+l)+sq] - dc_q;
 
-/** I/Q swap **/
-iq_swap_cc_sptr make_iq_swap_cc(bool enabled)
-{
-    return gnuradio::get_initial_sptr(new iq_swap_cc(enabled));
-}
+            sum_i[l] += i;
+            sum_q[l] += q;
 
-iq_swap_cc::iq_swap_cc(bool enabled)
-    : gr::hier_block2 ("iq_swap_cc",
-          gr::io_signature::make(1, 1, sizeof(gr_complex)),
-          gr::io_signature::make(1, 1, sizeof(gr_complex)))
-{
-    d_enabled = enabled;
-    d_c2f = gr::blocks::complex_to_float::make();
-    d_f2c = gr::blocks::float_to_complex::make();
+            /* y = x + w * conj(x) */
+            float yi = i + w_re * i + w_im * q;
+            float yq = q + w_im * i - w_re * q;
 
-    connect(self(), 0, d_c2f, 0);
-    if (enabled)
+            sum_yy_re[l] += yi * yi - yq * yq;
+            sum_yy_im[l] += 2.0f * yi * yq;
+            sum_pwr[l] += yi * yi + yq * yq;
+
+            dst[2*(k+l)] = yi;
+            dst[2*(k+l)+1] = yq;
+        }
+    }
+
+    /* remaining 0..3 samples */
+    for (int l = 0; k < nitems; k++, l++)
     {
-        connect(d_c2f, 0, d_f2c, 1);
-        connect(d_c2f, 1, d_f2c, 0);
+        float i = src[2*k+si] - dc_i;
+        float q = src[2*k+sq] - dc_q;
+
+        sum_i[l] += i;
+        sum_q[l] += q;
+
+        float yi = i + w_re * i + w_im * q;
+        float yq = q + w_im * i - w_re * q;
+
+        sum_yy_re[l] += yi * yi - yq * yq;
+        sum_yy_im[l] += 2.0f * yi * yq;
+        sum_pwr[l] += yi * yi + yq * yq;
+
+        dst[2*k] = yi;
+        dst[2*k+1] = yq;
+    }
+
+    /* Fraction of the time constant covered by this buffer. The I/Q balance
+     * update is normalized by the output power, but E{y^2} changes by about
+     * 2*w*E{|x|^2} for a change of w, i.e. the effective loop gain is 2*mu.
+     * Keep it well below 1 so short time constants or large buffers can not
+     * make the estimate overshoot and diverge.
+     */
+    float mu = (float) (nitems / (d_tau * d_sr));
+    if (mu > 0.1f)
+        mu = 0.1f;
+
+    if (dc_cancel)
+    {
+        float si_tot = (sum_i[0] + sum_i[1]) + (sum_i[2] + sum_i[3]);
+        float sq_tot = (sum_q[0] + sum_q[1]) + (sum_q[2] + sum_q[3]);
+
+        d_dc_i += mu * si_tot / (float) nitems;
+        d_dc_q += mu * sq_tot / (float) nitems;
     }
-    else
+
+    float pwr = (sum_pwr[0] + sum_pwr[1]) + (sum_pwr[2] + sum_pwr[3]);
+    if (iq_balance && pwr > 0.0f)
     {
-        connect(d_c2f, 0, d_f2c, 0);
-        connect(d_c2f, 1, d_f2c, 1);
+        float yy_re = (sum_yy_re[0] + sum_yy_re[1]) + (sum_yy_re[2] + sum_yy_re[3]);
+        float yy_im = (sum_yy_im[0] + sum_yy_im[1]) + (sum_yy_im[2] + sum_yy_im[3]);
+
+        d_w_re -= mu * yy_re / pwr;
+        d_w_im -= mu * yy_im / pwr;
     }
-    connect(d_f2c, 0, self(), 0);
 }
 
-iq_swap_cc::~iq_swap_cc()
+/*! \brief Set new sample rate. */
+void iq_corr_cc::set_sample_rate(double sample_rate)
 {
+    gr::thread::scoped_lock lock(d_setlock);
+    d_sr = sample_rate;
+}
 
+/*! \brief Set new time constant. */
+void iq_corr_cc::set_tau(double tau)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+    d_tau = tau;
 }
 
-/*! \brief Enabled or disable I/Q swapping. */
-void iq_swap_cc::set_enabled(bool enabled)
+/*! \brief Enable or disable I/Q swapping. */
+void iq_corr_cc::set_swap(bool enabled)
 {
-    if (enabled == d_enabled)
-        return;
+    gr::thread::scoped_lock lock(d_setlock);
 
 #ifndef QT_NO_DEBUG_OUTPUT
     std::cout << "IQ swap: " << enabled << std::endl;
 #endif
 
-    d_enabled = enabled;
-
-    lock();
-    if (d_enabled)
-    {
-        disconnect(d_c2f, 0, d_f2c, 0);
-        disconnect(d_c2f, 1, d_f2c, 1);
-        connect(d_c2f, 0, d_f2c, 1);
-        connect(d_c2f, 1, d_f2c, 0);
-    }
-    else
+    if (enabled != d_swap)
     {
-        disconnect(d_c2f, 0, d_f2c, 1);
-        disconnect(d_c2f, 1, d_f2c, 0);
-        connect(d_c2f, 0, d_f2c, 0);
-        connect(d_c2f, 1, d_f2c, 1);
+        /* estimates refer to the unswapped signal */
+        d_dc_i = d_dc_q = 0.0f;
+        d_w_re = d_w_im = 0.0f;
     }
+    d_swap = enabled;
+}
 
-/** DEBUG **/
-/** disconnect_all() does not work here **/
-/*
-    disconnect_all();
-    connect(self(), 0, d_c2f, 0);
-    if (enabled)
-    {
-        connect(d_c2f, 0, d_f2c, 1);
-        connect(d_c2f, 1, d_f2c, 0);
-    }
-    else
-    {
-        connect(d_c2f, 0, d_f2c, 0);
-        connect(d_c2f, 1, d_f2c, 1);
-    }
-    connect(d_f2c, 0, self(), 0);
-*/
-    unlock();
+/*! \brief Enable or disable automatic DC removal. */
+void iq_corr_cc::set_dc_cancel(bool enabled)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    if (enabled && !d_dc_cancel)
+        d_dc_i = d_dc_q = 0.0f;
+    d_dc_cancel = enabled;
+}
+
+/*! \brief Enable or disable automatic I/Q balance correction. */
+void iq_corr_cc::set_iq_balance(bool enabled)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    if (enabled && !d_iq_balance)
+        d_w_re = d_w_im = 0.0f;
+    d_iq_balance = enabled;
 }
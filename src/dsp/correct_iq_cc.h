@@ -24,74 +24,72 @@
 #define CORRECT_IQ_CC_H
 
 #include <gnuradio/gr_complex.h>
-#include <gnuradio/blocks/complex_to_float.h>
-#include <gnuradio/blocks/float_to_complex.h>
-#include <gnuradio/hier_block2.h>
-#include <gnuradio/filter/single_pole_iir_filter_cc.h>
-#include <gnuradio/blocks/sub_cc.h>
+#include <gnuradio/sync_block.h>
 
-class dc_corr_cc;
-class iq_swap_cc;
+class iq_corr_cc;
 
-typedef boost::shared_ptr<dc_corr_cc> dc_corr_cc_sptr;
-typedef boost::shared_ptr<iq_swap_cc> iq_swap_cc_sptr;
+typedef boost::shared_ptr<iq_corr_cc> iq_corr_cc_sptr;
 
-/*! \brief Return a shared_ptr to a new instance of dc_corr_cc.
+/*! \brief Return a shared_ptr to a new instance of iq_corr_cc.
  *  \param sample_rate The sample rate
- *  \param tau The time constant for the filter
+ *  \param tau The time constant for the DC and I/Q balance estimators
  */
-dc_corr_cc_sptr make_dc_corr_cc(double sample_rate, double tau=1.0);
+iq_corr_cc_sptr make_iq_corr_cc(double sample_rate, double tau=1.0);
 
-/*! \brief Single pole IIR filter-based DC offset correction block.
+/*! \brief Single pass I/Q front end conditioning.
  *  \ingroup DSP
  *
- * This block performs automatic DC offset removal using a single pole IIR
- * filter
+ * This block performs I/Q swapping, DC offset removal and blind adaptive
+ * I/Q imbalance correction. All three operations are performed in a single
+ * pass over the input and each of them can be bypassed at run time without
+ * reconfiguring the flow graph.
+ *
+ * DC offset and I/Q imbalance are estimated once per buffer and the
+ * corrections are held constant within it. Given the long time constants
+ * this is indistinguishable from per-sample tracking.
+ *
+ * The I/Q balance correction uses the circularity criterion, i.e. it
+ * computes y = x + w * conj(x) and adapts w to drive E{y^2} towards zero.
  */
-class dc_corr_cc : public gr::hier_block2
+class iq_corr_cc : public gr::sync_block
 {
-    friend dc_corr_cc_sptr make_dc_corr_cc(double sample_rate, double tau);
+    friend iq_corr_cc_sptr make_iq_corr_cc(double sample_rate, double tau);
 
 protected:
-    dc_corr_cc(double sample_rate, double tau);
+    iq_corr_cc(double sample_rate, double tau);
 
 public:
-    ~dc_corr_cc();
-    void set_sample_rate(double sample_rate);
-    void set_tau(double tau);
+    ~iq_corr_cc();
 
-private:
-    gr::filter::single_pole_iir_filter_cc::sptr d_iir;
-    gr::blocks::sub_cc::sptr                    d_sub;
-
-    double d_sr;     /*!< Sample rate. */
-    double d_tau;    /*!< Time constant. */
-    double d_alpha;  /*!< 1/(1+tau/T). */
-};
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
 
+    void process(const gr_complex *in, gr_complex *out, int nitems);
 
+    void set_sample_rate(double sample_rate);
+    void set_tau(double tau);
 
-/*! \brief Return a shared_ptr to a new instance of iq_swap_cc. */
-iq_swap_cc_sptr make_iq_swap_cc(bool enabled);
+    void set_swap(bool enabled);
+    void set_dc_cancel(bool enabled);
+    void set_iq_balance(bool enabled);
 
-/*! \brief Block to swap I and Q channels.
- *  \ingroup DSP
- */
-class iq_swap_cc : public gr::hier_block2
-{
-    friend iq_swap_cc_sptr make_iq_swap_cc(bool enabled);
+    bool get_swap() const { return d_swap; }
+    bool get_dc_cancel() const { return d_dc_cancel; }
+    bool get_iq_balance() const { return d_iq_balance; }
 
-protected:
-    iq_swap_cc(bool enabled);
+private:
+    double d_sr;         /*!< Sample rate. */
+    double d_tau;        /*!< Time constant. */
 
-public:
-    ~iq_swap_cc();
-    void set_enabled(bool enabled);
+    bool   d_swap;       /*!< Swap I and Q. */
+    bool   d_dc_cancel;  /*!< Remove DC offset. */
+    bool   d_iq_balance; /*!< Correct I/Q imbalance. */
 
-private:
-    gr::blocks::complex_to_float::sptr d_c2f;
-    gr::blocks::float_to_complex::sptr d_f2c;
-    bool d_enabled;
+    float  d_dc_i;       /*!< Current DC estimate, I. */
+    float  d_dc_q;       /*!< Current DC estimate, Q. */
+    float  d_w_re;       /*!< I/Q balance correction weight, real part. */
+    float  d_w_im;       /*!< I/Q balance correction weight, imaginary part. */
 };
 
 #endif /* CORRECT_IQ_CC_H */
@@ -0,0 +1,103 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <gnuradio/io_signature.h>
+#include "dsp/data_tap.h"
+
+
+data_tap_c_sptr make_data_tap_c(double in_rate, double out_rate, unsigned int size)
+{
+    return gnuradio::get_initial_sptr(new data_tap_c(in_rate, out_rate, size));
+}
+
+data_tap_f_sptr make_data_tap_f(double in_rate, double out_rate, unsigned int size)
+{
+    return gnuradio::get_initial_sptr(new data_tap_f(in_rate, out_rate, size));
+}
+
+
+data_tap_c::data_tap_c(double in_rate, double out_rate, unsigned int size)
+    : gr::hier_block2 ("data_tap_c",
+          gr::io_signature::make(1, 1, sizeof(gr_complex)),
+          gr::io_signature::make(0, 0, 0)),
+      d_in_rate(in_rate),
+      d_out_rate(out_rate)
+{
+    d_sink = gnuradio::get_initial_sptr(new tap_sink<gr_complex>(size));
+
+    if (d_out_rate > 0.0)
+    {
+        d_rr = make_resampler_cc(d_out_rate / d_in_rate);
+        connect(self(), 0, d_rr, 0);
+        connect(d_rr, 0, d_sink, 0);
+    }
+    else
+    {
+        connect(self(), 0, d_sink, 0);
+    }
+}
+
+data_tap_c::~data_tap_c()
+{
+
+}
+
+void data_tap_c::set_input_rate(double in_rate)
+{
+    d_in_rate = in_rate;
+    if (d_rr)
+        d_rr->set_rate(d_out_rate / d_in_rate);
+}
+
+
+data_tap_f::data_tap_f(double in_rate, double out_rate, unsigned int size)
+    : gr::hier_block2 ("data_tap_f",
+          gr::io_signature::make(1, 1, sizeof(float)),
+          gr::io_signature::make(0, 0, 0)),
+      d_in_rate(in_rate),
+      d_out_rate(out_rate)
+{
+    d_sink = gnuradio::get_initial_sptr(new tap_sink<float>(size));
+
+    if (d_out_rate > 0.0)
+    {
+        d_rr = make_resampler_ff(d_out_rate / d_in_rate);
+        connect(self(), 0, d_rr, 0);
+        connect(d_rr, 0, d_sink, 0);
+    }
+    else
+    {
+        connect(self(), 0, d_sink, 0);
+    }
+}
+
+data_tap_f::~data_tap_f()
+{
+
+}
+
+void data_tap_f::set_input_rate(double in_rate)
+{
+    d_in_rate = in_rate;
+    if (d_rr)
+        d_rr->set_rate(d_out_rate / d_in_rate);
+}
@@ -0,0 +1,182 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef DATA_TAP_H
+#define DATA_TAP_H
+
+#include <boost/atomic.hpp>
+#include <gnuradio/hier_block2.h>
+#include <gnuradio/sync_block.h>
+#include <gnuradio/gr_complex.h>
+#include "dsp/resampler_xx.h"
+#include "dsp/spsc_ring.h"
+
+
+/*! \brief Sink block writing its input into an spsc_ring.
+ *  \ingroup DSP
+ *
+ * The flow graph thread is the single producer. The block is used inside
+ * data_tap_c and data_tap_f. While disabled the input is discarded without
+ * touching the ring.
+ */
+template <class T>
+class tap_sink : public gr::sync_block
+{
+public:
+    tap_sink(unsigned int size)
+        : gr::sync_block ("tap_sink",
+              gr::io_signature::make(1, 1, sizeof(T)),
+              gr::io_signature::make(0, 0, 0)),
+          d_ring(size),
+          d_enabled(true)
+    {
+    }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items)
+    {
+        (void) output_items;
+
+        if (d_enabled.load(boost::memory_order_relaxed))
+            d_ring.write((const T *)input_items[0], noutput_items);
+
+        return noutput_items;
+    }
+
+    spsc_ring<T> &ring() { return d_ring; }
+
+    void set_enabled(bool enabled) { d_enabled = enabled; }
+
+private:
+    spsc_ring<T> d_ring;
+    boost::atomic<bool> d_enabled;
+};
+
+
+class data_tap_c;
+class data_tap_f;
+
+typedef boost::shared_ptr<data_tap_c> data_tap_c_sptr;
+typedef boost::shared_ptr<data_tap_f> data_tap_f_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of data_tap_c.
+ *  \param in_rate The sample rate at the tap point.
+ *  \param out_rate The sample rate delivered to the subscriber, 0 to use
+ *                  the rate of the tap point.
+ *  \param size The size of the buffer in samples.
+ */
+data_tap_c_sptr make_data_tap_c(double in_rate, double out_rate, unsigned int size);
+
+/*! \brief Return a shared_ptr to a new instance of data_tap_f.
+ *  \param in_rate The sample rate at the tap point.
+ *  \param out_rate The sample rate delivered to the subscriber, 0 to use
+ *                  the rate of the tap point.
+ *  \param size The size of the buffer in samples.
+ */
+data_tap_f_sptr make_data_tap_f(double in_rate, double out_rate, unsigned int size);
+
+
+/*! \brief Subscriber to a complex data stream in the flow graph.
+ *  \ingroup DSP
+ *
+ * The tap resamples the stream to the rate requested by the subscriber and
+ * delivers it through a lock-free ring buffer. The subscriber reads the
+ * samples in place using read_span() and consume() from a single thread.
+ */
+class data_tap_c : public gr::hier_block2
+{
+    friend data_tap_c_sptr make_data_tap_c(double in_rate, double out_rate, unsigned int size);
+
+protected:
+    data_tap_c(double in_rate, double out_rate, unsigned int size);
+
+public:
+    ~data_tap_c();
+
+    /*! \brief Update the sample rate at the tap point. */
+    void set_input_rate(double in_rate);
+
+    /*! \brief The sample rate delivered to the subscriber. */
+    double rate() const { return d_out_rate > 0.0 ? d_out_rate : d_in_rate; }
+
+    /*! \brief Enable or disable delivery of samples, e.g. while the
+     *         subscriber has nobody to pass them on to. Enabled by default.
+     *
+     * Only the copy into the ring buffer is skipped; the resampler, if the
+     * tap has one, keeps running.
+     */
+    void set_enabled(bool enabled) { d_sink->set_enabled(enabled); }
+
+    unsigned int read_span(const gr_complex **data) { return d_sink->ring().read_span(data); }
+    void consume(unsigned int num) { d_sink->ring().consume(num); }
+    unsigned int available() const { return d_sink->ring().available(); }
+    unsigned long overruns() const { return d_sink->ring().overruns(); }
+    unsigned long dropped() const { return d_sink->ring().dropped(); }
+
+private:
+    double                  d_in_rate;
+    double                  d_out_rate;
+    resampler_cc_sptr       d_rr;       /*!< Only used if out_rate is set. */
+    boost::shared_ptr< tap_sink<gr_complex> > d_sink;
+};
+
+
+/*! \brief Subscriber to a real data stream in the flow graph.
+ *  \ingroup DSP
+ *
+ * See data_tap_c.
+ */
+class data_tap_f : public gr::hier_block2
+{
+    friend data_tap_f_sptr make_data_tap_f(double in_rate, double out_rate, unsigned int size);
+
+protected:
+    data_tap_f(double in_rate, double out_rate, unsigned int size);
+
+public:
+    ~data_tap_f();
+
+    /*! \brief Update the sample rate at the tap point. */
+    void set_input_rate(double in_rate);
+
+    /*! \brief The sample rate delivered to the subscriber. */
+    double rate() const { return d_out_rate > 0.0 ? d_out_rate : d_in_rate; }
+
+    /*! \brief Enable or disable delivery of samples. */
+    void set_enabled(bool enabled) { d_sink->set_enabled(enabled); }
+
+    unsigned int read_span(const float **data) { return d_sink->ring().read_span(data); }
+    void consume(unsigned int num) { d_sink->ring().consume(num); }
+    unsigned int available() const { return d_sink->ring().available(); }
+    unsigned long overruns() const { return d_sink->ring().overruns(); }
+    unsigned long dropped() const { return d_sink->ring().dropped(); }
+
+private:
+    double                  d_in_rate;
+    double                  d_out_rate;
+    resampler_ff_sptr       d_rr;       /*!< Only used if out_rate is set. */
+    boost::shared_ptr< tap_sink<float> > d_sink;
+};
+
+#endif // DATA_TAP_H
@@ -0,0 +1,123 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Throughput benchmark for the input decimators.
+ *
+ * Runs a stream of complex samples through hbf_decim (70, 100 and 140 dB)
+ * and fir_decim_cc for every power of 2 decimation from 2 to 256 and prints
+ * the input sample rate each of them sustains on this machine. Only built
+ * when ENABLE_BENCHMARKS is set.
+ *
+ * Usage: decim_bench [input samples per run]
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <sys/time.h>
+
+#include <gnuradio/blocks/head.h>
+#include <gnuradio/blocks/null_sink.h>
+#include <gnuradio/blocks/vector_source.h>
+#include <gnuradio/top_block.h>
+
+#include "dsp/filter/fir_decim.h"
+#include "dsp/hbf_decim.h"
+
+
+/* Noise-like input so the filters do not run on denormals or zeros. */
+static std::vector<gr_complex> make_input(void)
+{
+    std::vector<gr_complex> data(65536);
+    unsigned int seed = 1;
+
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        float re = (float)((seed >> 8) & 0xffff) / 32768.f - 1.f;
+        seed = seed * 1103515245 + 12345;
+        float im = (float)((seed >> 8) & 0xffff) / 32768.f - 1.f;
+        data[i] = gr_complex(re, im);
+    }
+
+    return data;
+}
+
+static double now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + 1.e-6 * tv.tv_usec;
+}
+
+/* Returns the sustained input rate in Msps. */
+static double run(gr::basic_block_sptr decim, const std::vector<gr_complex> &input,
+                  unsigned long nsamples)
+{
+    gr::top_block_sptr tb = gr::make_top_block("decim_bench");
+    gr::blocks::vector_source_c::sptr src = gr::blocks::vector_source_c::make(input, true);
+    gr::blocks::head::sptr head = gr::blocks::head::make(sizeof(gr_complex), nsamples);
+    gr::blocks::null_sink::sptr sink = gr::blocks::null_sink::make(sizeof(gr_complex));
+
+    tb->connect(src, 0, head, 0);
+    tb->connect(head, 0, decim, 0);
+    tb->connect(decim, 0, sink, 0);
+
+    double start = now();
+    tb->run();
+
+    return 1.e-6 * nsamples / (now() - start);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long nsamples = 50000000;
+    unsigned int  atten[] = {70, 100, 140};
+    unsigned int  decim;
+    unsigned int  i;
+
+    if (argc > 1)
+        nsamples = strtoul(argv[1], NULL, 10);
+
+    std::vector<gr_complex> input = make_input();
+
+    printf("Input rate in Msps, %lu samples per run\n\n", nsamples);
+    printf("%6s %10s %10s %10s %10s\n", "decim", "hbf 70", "hbf 100", "hbf 140", "fir");
+
+    for (decim = 2; decim <= 256; decim *= 2)
+    {
+        printf("%6u", decim);
+        for (i = 0; i < 3; i++)
+            printf(" %10.1f", run(make_hbf_decim(decim, atten[i]), input, nsamples));
+
+        /* fir_decim_cc falls back to 2 for decimations above 128 */
+        if (decim <= 128)
+            printf(" %10.1f\n", run(make_fir_decim_cc(decim), input, nsamples));
+        else
+            printf(" %10s\n", "n/a");
+        fflush(stdout);
+    }
+
+    return 0;
+}
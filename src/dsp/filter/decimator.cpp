@@ -12,13 +12,15 @@
  */
 #include <gnuradio/gr_complex.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "decimator.h"
 #include "filtercoef_hbf_70.h"
 #include "filtercoef_hbf_100.h"
 #include "filtercoef_hbf_140.h"
 
-#define MAX_HALF_BAND_BUFSIZE 32768
+/* number of output samples processed per inner loop pass (fits in L1) */
+#define HALF_BAND_CHUNK     256
 #define DECIM_IS_POWER_OF_2(x)        ((x != 0) && ((x & (~x + 1)) == x))
 
 Decimator::Decimator()
@@ -27,6 +29,7 @@ Decimator::Decimator()
 
     decim = 0;
     atten = 0;
+    num_stages = 0;
 
     for (i = 0; i < MAX_STAGES; i++)
         filter_table[i] = 0;
@@ -65,16 +68,31 @@ unsigned int Decimator::init(unsigned int _decim, unsigned int _att)
     return decim;
 }
 
-int Decimator::process(int samples, gr_complex * pin, gr_complex * pout)
+int Decimator::process(int samples, const gr_complex * pin, gr_complex * pout)
 {
     int         i = 0;
     int         n = samples;
 
-    while (filter_table[i])
-        n = filter_table[i++]->DecBy2(n, pin, pin);
+    if ((int)buf_re.size() < samples)
+    {
+        buf_re.resize(samples);
+        buf_im.resize(samples);
+    }
+
+    float      *re = &buf_re[0];
+    float      *im = &buf_im[0];
+
+    for (i = 0; i < n; i++)
+    {
+        re[i] = pin[i].real();
+        im[i] = pin[i].imag();
+    }
 
-    for(i = 0; i < n; i++)
-        pout[i] = pin[i];
+    for (i = 0; i < num_stages; i++)
+        n = filter_table[i]->DecBy2(n, re, im, re, im);
+
+    for (i = 0; i < n; i++)
+        pout[i] = gr_complex(re[i], im[i]);
 
     return n;
 }
@@ -91,6 +109,7 @@ void Decimator::delete_filters()
             filter_table[i] = 0;
         }
     }
+    num_stages = 0;
 }
 
 int Decimator::init_filters_70(unsigned int decimation)
@@ -101,18 +120,17 @@ int Decimator::init_filters_70(unsigned int decimation)
     {
         if (decimation >= 4)
         {
-            filter_table[n++] = new CHalfBand11TapDecimateBy2(HBF_70_11);
-            fprintf(stderr, "  DEC %d: HBF_70_11 (unrolled)\n", n);
+            filter_table[n++] = new CHalfBandDecimateBy2(HBF_70_11_LENGTH, HBF_70_11);
         }
         else if (decimation == 2)
         {
             filter_table[n++] = new CHalfBandDecimateBy2(HBF_70_39_LENGTH, HBF_70_39);
-            fprintf(stderr, "  DEC %d: HBF_70_39\n", n);
         }
 
         decimation /= 2;
     }
 
+    num_stages = n;
     return (1 << n);
 }
 
@@ -124,23 +142,21 @@ int Decimator::init_filters_100(unsigned int decimation)
     {
         if (decimation >= 8)
         {
-            filter_table[n++] = new CHalfBand11TapDecimateBy2(HBF_100_11);
-            fprintf(stderr, "  DEC %d: HBF_100_11 (unrolled)\n", n);
+            filter_table[n++] = new CHalfBandDecimateBy2(HBF_100_11_LENGTH, HBF_100_11);
         }
         else if (decimation == 4)
         {
             filter_table[n++] = new CHalfBandDecimateBy2(HBF_100_19_LENGTH, HBF_100_19);
-            fprintf(stderr, "  DEC %d: HBF_100_19\n", n);
         }
         else if (decimation == 2)
         {
             filter_table[n++] = new CHalfBandDecimateBy2(HBF_100_59_LENGTH, HBF_100_59);
-            fprintf(stderr, "  DEC %d: HBF_100_59\n", n);
         }
 
         decimation /= 2;
     }
 
+    num_stages = n;
     return (1 << n);
 }
 
@@ -152,189 +168,135 @@ int Decimator::init_filters_140(unsigned int decimation)
     {
         if (decimation >= 16)
         {
-            filter_table[n++] = new CHalfBand11TapDecimateBy2(HBF_140_11);
-            fprintf(stderr, "  DEC %d: HBF_140_11 (unrolled)\n", n);
+            filter_table[n++] = new CHalfBandDecimateBy2(HBF_140_11_LENGTH, HBF_140_11);
         }
         else if (decimation == 8)
         {
             filter_table[n++] = new CHalfBandDecimateBy2(HBF_140_15_LENGTH, HBF_140_15);
-            fprintf(stderr, "  DEC %d: HBF_140_15\n", n);
         }
         else if (decimation == 4)
         {
             filter_table[n++] = new CHalfBandDecimateBy2(HBF_140_27_LENGTH, HBF_140_27);
-            fprintf(stderr, "  DEC %d: HBF_140_27\n", n);
         }
         else if (decimation == 2)
         {
             filter_table[n++] = new CHalfBandDecimateBy2(HBF_140_87_LENGTH, HBF_140_87);
-            fprintf(stderr, "  DEC %d: HBF_140_87\n", n);
         }
 
         decimation /= 2;
     }
 
+    num_stages = n;
     return (1 << n);
 }
 
 Decimator::CHalfBandDecimateBy2::CHalfBandDecimateBy2(int len, const float * pCoef)
-    : m_FirLength(len), m_pCoef(pCoef)
 {
-    gr_complex  CPXZERO(0.0,0.0);
+    int         i;
 
-    // create buffer for FIR implementation
-    m_pHBFirBuf = new gr_complex[MAX_HALF_BAND_BUFSIZE];
-    for (int i = 0; i < MAX_HALF_BAND_BUFSIZE; i++)
-        m_pHBFirBuf[i] = CPXZERO;
+    // Half band filter lengths are 4*k+3, i.e. the center tap has an odd
+    // index and lines up with the odd input phase.
+    m_NumTaps = (len + 1) / 2;
+    m_Hist = (len - 1) / 2;
+    m_CenterDelay = (m_Hist - 1) / 2;
+    m_CenterCoef = pCoef[m_Hist];
+
+    m_Coef.resize(m_NumTaps);
+    for (i = 0; i < m_NumTaps; i++)
+        m_Coef[i] = pCoef[2 * i];
+
+    // zero history
+    m_EvenRe.assign(m_Hist, 0.0f);
+    m_EvenIm.assign(m_Hist, 0.0f);
+    m_OddRe.assign(m_Hist, 0.0f);
+    m_OddIm.assign(m_Hist, 0.0f);
 }
 
 /*
  * Half band filter and decimate by 2 function.
- * Two restrictions on this routine:
- * InLength must be larger or equal to the Number of Halfband Taps
- * InLength must be an even number
+ * InLength must be an even number. Output may point to the input buffer.
  */
-int Decimator::CHalfBandDecimateBy2::DecBy2(int InLength, gr_complex * pInData,
-                                            gr_complex * pOutData)
+int Decimator::CHalfBandDecimateBy2::DecBy2(int InLength, const float * pInRe,
+                                            const float * pInIm, float * pOutRe,
+                                            float * pOutIm)
 {
-    gr_complex     acc;
-    int     i;
-    int     j;
-    int     numoutsamples = 0;
-
-    // copy input samples into buffer starting at position m_FirLength-1
-    for (i = 0, j = m_FirLength - 1; i < InLength; i++)
-        m_pHBFirBuf[j++] = pInData[i];
+    int         numoutsamples = InLength / 2;
+    int         i;
+    int         k;
+    int         n;
 
-    // perform decimation FIR filter on even samples
-    for (i = 0; i < InLength; i += 2)
+    if ((int)m_EvenRe.size() < m_Hist + numoutsamples)
     {
-        acc = m_pHBFirBuf[i] * m_pCoef[0];
-        for (j = 0; j < m_FirLength; j += 2)
-            acc += m_pHBFirBuf[i+j] * m_pCoef[j];
-
-        // center coefficient
-        acc += m_pHBFirBuf[i+(m_FirLength-1)/2] * m_pCoef[(m_FirLength-1)/2];
-        pOutData[numoutsamples++] = acc;
+        m_EvenRe.resize(m_Hist + numoutsamples);
+        m_EvenIm.resize(m_Hist + numoutsamples);
+        m_OddRe.resize(m_Hist + numoutsamples);
+        m_OddIm.resize(m_Hist + numoutsamples);
     }
 
-    // need to copy last m_FirLength - 1 input samples in buffer to beginning of buffer
-    // for FIR wrap around management
-    for (i = 0, j = InLength - m_FirLength + 1; i < m_FirLength - 1; i++)
-        m_pHBFirBuf[i] = pInData[j++];
-
-    return numoutsamples;
-}
-
-/*
- * Decimate by 2 Fixed 11 Tap Halfband filter class implementation
- */
-Decimator::CHalfBand11TapDecimateBy2::CHalfBand11TapDecimateBy2(const float * coef)
-{
-    gr_complex     CPXZERO(0.0, 0.0);
-
-    // preload only the taps that are used since evey other one is zero
-    // except center tap 5
-    H0 = coef[0];
-    H2 = coef[2];
-    H4 = coef[4];
-    H5 = coef[5];
-    H6 = coef[6];
-    H8 = coef[8];
-    H10 = coef[10];
-
-    d0 = CPXZERO;
-    d1 = CPXZERO;
-    d2 = CPXZERO;
-    d3 = CPXZERO;
-    d4 = CPXZERO;
-    d5 = CPXZERO;
-    d6 = CPXZERO;
-    d7 = CPXZERO;
-    d8 = CPXZERO;
-    d9 = CPXZERO;
-}
-
-/*
- * Decimate by 2 Fixed 11 Tap Halfband filter class implementation
- * Two restrictions on this routine:
- * InLength must be larger or equal to the Number of Halfband Taps(11)
- * InLength must be an even number
- * Loop unrolled for speed
- */
-int Decimator::CHalfBand11TapDecimateBy2::DecBy2(int InLength,
-                                                 gr_complex * pInData,
-                                                 gr_complex * pOutData)
-{
-    // calculate first 10 samples using previous samples in delay buffer
-    gr_complex     tmpout[9];
-
-    tmpout[0] = H0 * d0 + H2 * d2 + H4 * d4 + H5 * d5 + H6 * d6 + H8 * d8
-            + H10 * pInData[0];
-
-    tmpout[1] = H0 * d2 + H2 * d4 + H4 * d6 + H5 * d7 + H6 * d8
-            + H8 * pInData[0] + H10 * pInData[2];
-
-    tmpout[2] = H0 * d4 + H2 * d6 + H4 * d8 + H5 * d9 + H6 * pInData[0]
-            + H8 * pInData[2] + H10 * pInData[4];
-
-    tmpout[3] = H0 * d6 + H2 * d8 + H4 * pInData[0] + H5 * pInData[1]
-            + H6 * pInData[2] + H8 * pInData[4] + H10 * pInData[6];
-
-    tmpout[4] = H0 * d8 + H2 * pInData[0] + H4 * pInData[2] + H5 * pInData[3]
-            + H6 * pInData[4] + H8 * pInData[6] + H10 * pInData[8];
-
-    tmpout[5] = H0 * pInData[0] + H2 * pInData[2] + H4 * pInData[4]
-            + H5 * pInData[5] + H6 * pInData[6] + H8 * pInData[8]
-            + H10 * pInData[10];
-
-    tmpout[6] = H0 * pInData[2] + H2 * pInData[4] + H4 * pInData[6]
-            + H5 * pInData[7] + H6 * pInData[8] + H8 * pInData[10]
-            + H10 * pInData[12];
+    // split input into even and odd phases after the history
+    float      *er = &m_EvenRe[m_Hist];
+    float      *ei = &m_EvenIm[m_Hist];
+    float      *orr = &m_OddRe[m_Hist];
+    float      *oi = &m_OddIm[m_Hist];
+    for (i = 0; i < numoutsamples; i++)
+    {
+        er[i] = pInRe[2 * i];
+        ei[i] = pInIm[2 * i];
+        orr[i] = pInRe[2 * i + 1];
+        oi[i] = pInIm[2 * i + 1];
+    }
 
-    tmpout[7] = H0 * pInData[4] + H2 * pInData[6] + H4 * pInData[8]
-            + H5 * pInData[9] + H6 * pInData[10] + H8 * pInData[12]
-            + H10 * pInData[14];
+    const float    *coef = &m_Coef[0];
+    const int       half = m_NumTaps / 2;
 
-    tmpout[8] = H0 * pInData[6] + H2 * pInData[8] + H4 * pInData[10]
-            + H5 * pInData[11] + H6 * pInData[12] + H8 * pInData[14]
-            + H10 * pInData[16];
+    for (i = 0; i < numoutsamples; i += HALF_BAND_CHUNK)
+    {
+        int         len = numoutsamples - i;
+        if (len > HALF_BAND_CHUNK)
+            len = HALF_BAND_CHUNK;
+
+        float * __restrict          yr = pOutRe + i;
+        float * __restrict          yi = pOutIm + i;
+        const float * __restrict    xr = &m_EvenRe[i];
+        const float * __restrict    xi = &m_EvenIm[i];
+
+        // center tap from the odd phase
+        const float * __restrict    cr = &m_OddRe[i + m_CenterDelay];
+        const float * __restrict    ci = &m_OddIm[i + m_CenterDelay];
+        for (n = 0; n < len; n++)
+        {
+            yr[n] = m_CenterCoef * cr[n];
+            yi[n] = m_CenterCoef * ci[n];
+        }
 
-    // now loop through remaining input samples
-    gr_complex     *pIn = &pInData[8];
-    gr_complex     *pOut = &pOutData[9];
-    int         i;
+        // symmetric even taps, one multiplication per pair
+        for (k = 0; k < half; k++)
+        {
+            const float h = coef[k];
+            const int   j = m_NumTaps - 1 - k;
+            for (n = 0; n < len; n++)
+            {
+                yr[n] += h * (xr[n + k] + xr[n + j]);
+                yi[n] += h * (xi[n + k] + xi[n + j]);
+            }
+        }
 
-    for(i = 0; i < (InLength - 11 - 6) / 2; i++)
-    {
-      *pOut++ = (H0 * pIn[0]) + (H2 * pIn[2]) + (H4 * pIn[4]) +
-        (H5 * pIn[5]) + (H6 * pIn[6]) + (H8 * pIn[8]) + (H10 * pIn[10]);
-      pIn += 2;
+        if (m_NumTaps & 1)
+        {
+            const float h = coef[half];
+            for (n = 0; n < len; n++)
+            {
+                yr[n] += h * xr[n + half];
+                yi[n] += h * xi[n + half];
+            }
+        }
     }
 
-    // copy first outputs back into output array so outbuf can be same as inbuf
-    pOutData[0] = tmpout[0];
-    pOutData[1] = tmpout[1];
-    pOutData[2] = tmpout[2];
-    pOutData[3] = tmpout[3];
-    pOutData[4] = tmpout[4];
-    pOutData[5] = tmpout[5];
-    pOutData[6] = tmpout[6];
-    pOutData[7] = tmpout[7];
-    pOutData[8] = tmpout[8];
-
-    // copy last 10 input samples into delay buffer for next time
-    pIn = &pInData[InLength-1];
-    d9 = *pIn--;
-    d8 = *pIn--;
-    d7 = *pIn--;
-    d6 = *pIn--;
-    d5 = *pIn--;
-    d4 = *pIn--;
-    d3 = *pIn--;
-    d2 = *pIn--;
-    d1 = *pIn--;
-    d0 = *pIn;
-
-    return InLength / 2;
+    // keep last m_Hist samples of each phase for next call
+    memmove(&m_EvenRe[0], &m_EvenRe[numoutsamples], m_Hist * sizeof(float));
+    memmove(&m_EvenIm[0], &m_EvenIm[numoutsamples], m_Hist * sizeof(float));
+    memmove(&m_OddRe[0], &m_OddRe[numoutsamples], m_Hist * sizeof(float));
+    memmove(&m_OddIm[0], &m_OddIm[numoutsamples], m_Hist * sizeof(float));
+
+    return numoutsamples;
 }
@@ -13,6 +13,7 @@
 #ifndef DECIMATOR_H
 #define DECIMATOR_H 1
 
+#include <vector>
 #include <gnuradio/gr_complex.h>
 
 #define MAX_DECIMATION          512
@@ -25,57 +26,47 @@ public:
     virtual    ~Decimator();
 
     unsigned int    init(unsigned int _decim, unsigned int _att);
-    int             process(int samples, gr_complex * pin,
+    int             process(int samples, const gr_complex * pin,
                             gr_complex * pout);
 
 private:
 
     /**
-     * Abstract base class for all the different types of decimate by 2 stages
+     * Polyphase decimate-by-2 half band filter.
+     *
+     * All odd taps of a half band filter except the center tap are zero.
+     * The input is split into even and odd phases; the even phase is
+     * filtered with the non-zero taps while the odd phase only needs to be
+     * scaled by the center tap. The non-zero taps are symmetric, so each
+     * multiplication is shared by two input samples.
+     *
+     * Samples are processed in planar (separate I and Q) format. For each
+     * tap pair the inner loop runs over up to HALF_BAND_CHUNK consecutive
+     * output samples and only does independent multiply-adds, no sums
+     * across iterations.
      */
-    class CDec2
-    {
-    public:
-        CDec2() {}
-        virtual    ~CDec2(){}
-        virtual int DecBy2(int InLength, gr_complex * pInData,
-                           gr_complex * pOutData) = 0;
-    };
-
-    /**
-     * Generic dcimate-by-2 class
-     */
-    class CHalfBandDecimateBy2 : public CDec2
+    class CHalfBandDecimateBy2
     {
     public:
         CHalfBandDecimateBy2(int len, const float * pCoef);
-        ~CHalfBandDecimateBy2() {
-            if(m_pHBFirBuf) delete [] m_pHBFirBuf;
-        }
-        int     DecBy2(int InLength, gr_complex * pInData,
-                       gr_complex * pOutData);
+        ~CHalfBandDecimateBy2() {}
 
-        gr_complex     *m_pHBFirBuf;
-        int             m_FirLength;
-        const float    *m_pCoef;
-    };
+        /* Input length must be even. Output may be the same as input. */
+        int     DecBy2(int InLength, const float * pInRe,
+                       const float * pInIm, float * pOutRe, float * pOutIm);
 
-    /**
-     * 11-tap half-band filter with unrolled loop.
-     */
-    class CHalfBand11TapDecimateBy2 : public CDec2
-    {
-    public:
-        CHalfBand11TapDecimateBy2(const float * coef);
-        ~CHalfBand11TapDecimateBy2() {}
-        int     DecBy2(int InLength, gr_complex * pInData,
-                       gr_complex * pOutData);
-
-        // coefficients
-        float               H0, H2, H4, H5, H6, H8, H10;
+    private:
+        std::vector<float>  m_Coef;         /* even taps h[0], h[2], ... */
+        float               m_CenterCoef;   /* center tap */
+        int                 m_NumTaps;      /* number of even taps */
+        int                 m_Hist;         /* history length per phase */
+        int                 m_CenterDelay;  /* center tap offset in odd phase */
 
-        // delay buffer
-        std::complex<float> d0, d1, d2, d3, d4, d5, d6, d7, d8, d9;
+        /* polyphase delay lines, m_Hist history + new samples */
+        std::vector<float>  m_EvenRe;
+        std::vector<float>  m_EvenIm;
+        std::vector<float>  m_OddRe;
+        std::vector<float>  m_OddIm;
     };
 
 private:
@@ -83,7 +74,12 @@ private:
     int         init_filters_100(unsigned int decimation);
     int         init_filters_140(unsigned int decimation);
     void        delete_filters();
-    CDec2      *filter_table[MAX_STAGES];
+    CHalfBandDecimateBy2   *filter_table[MAX_STAGES];
+    int                     num_stages;     /* used entries in filter_table */
+
+    /* planar work buffers */
+    std::vector<float>  buf_re;
+    std::vector<float>  buf_im;
 
     unsigned int        atten;
     unsigned int        decim;
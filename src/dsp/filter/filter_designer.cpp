@@ -0,0 +1,187 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <iostream>
+#include <boost/bind.hpp>
+#include <gnuradio/filter/firdes.h>
+
+#include "dsp/filter/filter_designer.h"
+
+
+bool filter_designer::design_key::operator<(const design_key &other) const
+{
+    if (rate != other.rate)
+        return rate < other.rate;
+    if (low != other.low)
+        return low < other.low;
+    if (high != other.high)
+        return high < other.high;
+    if (tw != other.tw)
+        return tw < other.tw;
+    return offset < other.offset;
+}
+
+filter_designer::filter_designer(apply_fn apply, unsigned int cache_size)
+    : d_apply(apply),
+      d_cache_size(cache_size > 0 ? cache_size : 1),
+      d_pending(false),
+      d_seq(0),
+      d_quit(false)
+{
+    d_thread = gr::thread::thread(boost::bind(&filter_designer::worker, this));
+}
+
+filter_designer::~filter_designer()
+{
+    {
+        gr::thread::scoped_lock lock(d_mutex);
+        d_quit = true;
+    }
+    d_cond.notify_one();
+    d_thread.join();
+}
+
+void filter_designer::request(double sample_rate, double low, double high,
+                              double trans_width, double offset)
+{
+    design_key key = {sample_rate, low, high, trans_width, offset};
+
+    gr::thread::scoped_lock lock(d_mutex);
+
+    /* any result still being designed is now obsolete */
+    unsigned long seq = ++d_seq;
+
+    std::map<design_key, std::vector<gr_complex> >::const_iterator it = d_cache.find(key);
+    if (it != d_cache.end())
+    {
+        /* copy so the cache entry may be evicted while we apply */
+        std::vector<gr_complex> taps = it->second;
+
+        d_pending = false;
+        lock.unlock();
+        apply_if_current(seq, taps);
+        return;
+    }
+
+    d_pending_key = key;
+    d_pending = true;
+    lock.unlock();
+    d_cond.notify_one();
+}
+
+std::vector<gr_complex> filter_designer::design(double sample_rate, double low,
+                                                double high, double trans_width,
+                                                double offset)
+{
+    return gr::filter::firdes::complex_band_pass(1.0, sample_rate,
+                                                 low + offset,
+                                                 high + offset,
+                                                 trans_width);
+}
+
+void filter_designer::worker()
+{
+    gr::thread::scoped_lock lock(d_mutex);
+
+    while (true)
+    {
+        while (!d_pending && !d_quit)
+            d_cond.wait(lock);
+
+        if (d_quit)
+            break;
+
+        design_key      key = d_pending_key;
+        unsigned long   seq = d_seq;
+
+        d_pending = false;
+        lock.unlock();
+
+        std::vector<gr_complex> taps;
+        try
+        {
+            taps = design(key.rate, key.low, key.high, key.tw, key.offset);
+        }
+        catch (std::exception &e)
+        {
+            std::cerr << "Failed to design filter: " << e.what() << std::endl;
+        }
+
+        if (taps.empty())
+        {
+            lock.lock();
+            continue;
+        }
+
+#ifndef QT_NO_DEBUG_OUTPUT
+        std::cout << "Generated taps for new filter   LO:" << key.low
+                  << "   HI:" << key.high << " TW:" << key.tw
+                  << "   Taps: " << taps.size() << std::endl;
+#endif
+
+        lock.lock();
+        cache_insert(key, taps);
+        lock.unlock();
+
+        apply_if_current(seq, taps);
+
+        lock.lock();
+    }
+}
+
+/*! \brief Apply taps unless a newer request has been made.
+ *
+ * d_apply usually ends up in a block setter that waits for work() to
+ * finish, so it is called without holding d_mutex; request() never blocks
+ * behind it unless it has a cached result to apply itself. d_apply_mutex
+ * serialises the callers and, because the sequence number is checked while
+ * holding it, a superseded result can never overwrite a newer one.
+ */
+void filter_designer::apply_if_current(unsigned long seq,
+                                       const std::vector<gr_complex> &taps)
+{
+    gr::thread::scoped_lock apply_lock(d_apply_mutex);
+
+    {
+        gr::thread::scoped_lock lock(d_mutex);
+        if (seq != d_seq)
+            return;
+    }
+
+    d_apply(taps);
+}
+
+void filter_designer::cache_insert(const design_key &key,
+                                   const std::vector<gr_complex> &taps)
+{
+    if (d_cache.find(key) != d_cache.end())
+        return;
+
+    while (d_cache.size() >= d_cache_size)
+    {
+        d_cache.erase(d_cache_order.front());
+        d_cache_order.pop_front();
+    }
+
+    d_cache[key] = taps;
+    d_cache_order.push_back(key);
+}
@@ -0,0 +1,115 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FILTER_DESIGNER_H
+#define FILTER_DESIGNER_H
+
+#include <deque>
+#include <map>
+#include <vector>
+#include <boost/function.hpp>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/thread/thread.h>
+
+
+/*! \brief Background designer for complex band pass filter taps.
+ *  \ingroup DSP
+ *
+ * Generating windowed-sinc taps for narrow filters takes long enough to
+ * make dragging the filter edges in the plotter stutter when done in the
+ * GUI thread. This class moves the design to a worker thread:
+ *
+ *  - Requests are coalesced; only the most recent pending request is
+ *    designed, intermediate ones are dropped.
+ *  - Designs are cached using (rate, low, high, transition, offset) as key
+ *    so that returning to a previous setting is instantaneous.
+ *  - The finished taps are handed to the apply callback as a complete
+ *    vector. Results that have been superseded by a newer request are
+ *    discarded and never applied.
+ *
+ * The callback is invoked either from the calling thread (cache hit) or from
+ * the worker thread, but never concurrently and never with the internal
+ * lock held.
+ *
+ * Design errors (e.g. std::out_of_range from gr::filter::firdes) are caught
+ * in the worker and reported on stderr; the previous taps stay in use.
+ */
+class filter_designer
+{
+public:
+    typedef boost::function<void (const std::vector<gr_complex> &)> apply_fn;
+
+    explicit filter_designer(apply_fn apply, unsigned int cache_size = 64);
+    ~filter_designer();
+
+    /*! \brief Request new taps.
+     *  \param sample_rate The sample rate.
+     *  \param low The lower edge of the pass band.
+     *  \param high The upper edge of the pass band.
+     *  \param trans_width The width of the transition band.
+     *  \param offset Offset added to both edges (e.g. CW offset).
+     *
+     * Returns immediately. The taps are applied from the cache right away
+     * if available, otherwise they will be applied by the worker thread.
+     */
+    void request(double sample_rate, double low, double high,
+                 double trans_width, double offset);
+
+    /*! \brief Design taps synchronously (bypassing the worker thread). */
+    static std::vector<gr_complex> design(double sample_rate, double low,
+                                          double high, double trans_width,
+                                          double offset);
+
+private:
+    struct design_key
+    {
+        double  rate;
+        double  low;
+        double  high;
+        double  tw;
+        double  offset;
+
+        bool operator<(const design_key &other) const;
+    };
+
+    void worker();
+    void cache_insert(const design_key &key, const std::vector<gr_complex> &taps);
+    void apply_if_current(unsigned long seq, const std::vector<gr_complex> &taps);
+
+    apply_fn                    d_apply;
+    unsigned int                d_cache_size;
+
+    std::map<design_key, std::vector<gr_complex> >  d_cache;
+    std::deque<design_key>      d_cache_order;  /*!< Insertion order for eviction. */
+
+    design_key                  d_pending_key;
+    bool                        d_pending;      /*!< A request is waiting for the worker. */
+    unsigned long               d_seq;          /*!< Sequence number of latest request. */
+    bool                        d_quit;
+
+    gr::thread::mutex               d_mutex;
+    gr::thread::mutex               d_apply_mutex;  /*!< Serialises d_apply calls. */
+    gr::thread::condition_variable  d_cond;
+    gr::thread::thread              d_thread;
+};
+
+#endif // FILTER_DESIGNER_H
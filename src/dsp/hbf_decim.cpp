@@ -25,28 +25,30 @@
 #include <gnuradio/io_signature.h>
 #include <gnuradio/types.h>
 #include <iostream>
+#include <stdexcept>
 #include <stdio.h>
 
-#include "filter/decimator.h"
-#include "hbf_decim.h"
+#include "dsp/filter/decimator.h"
+#include "dsp/hbf_decim.h"
 
 
-hbf_decim_sptr make_hbf_decim(unsigned int decim)
+hbf_decim_sptr make_hbf_decim(unsigned int decim, unsigned int atten)
 {
-    return gnuradio::get_initial_sptr (new hbf_decim(decim));
+    return gnuradio::get_initial_sptr (new hbf_decim(decim, atten));
 }
 
-hbf_decim::hbf_decim(unsigned int decim)
+hbf_decim::hbf_decim(unsigned int decim, unsigned int atten)
   : gr::sync_decimator("hbf_decim",
           gr::io_signature::make(1, 1, sizeof(gr_complex)),
           gr::io_signature::make(1, 1, sizeof(gr_complex)), decim)
 {
     decimation = decim;
     dec = new Decimator();
-    if (dec->init(decim, 100) != decim)
+    if (dec->init(decim, atten) != decim)
+    {
+        delete dec;
         throw std::range_error("Decimation not supported");
-
-    std::cout << "New decimator: " << decimation << std::endl;
+    }
 }
 
 hbf_decim::~hbf_decim()
@@ -58,15 +60,13 @@ int hbf_decim::work(int noutput_items,
           gr_vector_const_void_star &input_items,
           gr_vector_void_star &output_items)
 {
-    gr_complex *in = (gr_complex *) input_items[0];
+    const gr_complex *in = (const gr_complex *) input_items[0];
     gr_complex *out = (gr_complex *) output_items[0];
 
-    /* HBF input length must be even and >= number of taps.
-     * Max taps is 87 => we need at least 44 * decim input samples
+    /* The filters keep their own history so any number of output
+     * items can be produced; the input length is always a multiple
+     * of the decimation and thus even in every stage.
      */
-    if (noutput_items < 44)
-        return 0;
-
     return dec->process(noutput_items * decimation, in, out);
 }
 
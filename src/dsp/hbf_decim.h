@@ -22,21 +22,28 @@
 
 #include <gnuradio/sync_decimator.h>
 #include <gnuradio/types.h>
-#include "filter/decimator.h"
+#include "dsp/filter/decimator.h"
 
 class hbf_decim;
 typedef boost::shared_ptr<hbf_decim> hbf_decim_sptr;
-hbf_decim_sptr make_hbf_decim(unsigned int decim);
 
 /**
- * Decimator block using half-band filters.
+ * Return a shared_ptr to a new instance of hbf_decim.
+ * @param decim The decimation, must be a power of 2 between 2 and 512.
+ * @param atten Stop band attenuation in dB (70, 100 or 140).
+ * @throws std::range_error if the decimation is not supported.
  */
-class hbf_decim : virtual public gr::sync_decimator
+hbf_decim_sptr make_hbf_decim(unsigned int decim, unsigned int atten = 100);
+
+/**
+ * Decimator block using a cascade of half-band filters.
+ */
+class hbf_decim : public gr::sync_decimator
 {
-    friend hbf_decim_sptr make_hbf_decim(unsigned int decim);
+    friend hbf_decim_sptr make_hbf_decim(unsigned int decim, unsigned int atten);
 
 protected:
-    hbf_decim(unsigned int decim);
+    hbf_decim(unsigned int decim, unsigned int atten);
 
 public:
     ~hbf_decim();
@@ -21,6 +21,7 @@
 #include "decoder_impl.h"
 #include "constants.h"
 #include <gnuradio/io_signature.h>
+#include <string.h>
 
 using namespace gr::rds;
 
@@ -41,6 +42,7 @@ decoder_impl::decoder_impl(bool log, bool debug)
     reg = 0;
     block_bit_counter = 0;
     wrong_blocks_counter = 0;
+    corrected_blocks_counter = 0;
     blocks_counter = 0;
     group_good_blocks_counter = 0;
     good_block = false;
@@ -48,6 +50,8 @@ decoder_impl::decoder_impl(bool log, bool debug)
     lastseen_offset = 0;
     block_number = 0;
 
+    init_tables();
+
     set_output_multiple(104);  // 1 RDS datagroup = 104 bits
 	message_port_register_out(pmt::mp("out"));
 	enter_no_sync();
@@ -66,6 +70,7 @@ void decoder_impl::enter_no_sync() {
 
 void decoder_impl::enter_sync(unsigned int sync_block_number) {
 	wrong_blocks_counter   = 0;
+	corrected_blocks_counter = 0;
 	blocks_counter         = 0;
 	block_bit_counter      = 0;
 	block_number           = (sync_block_number + 1) % 4;
@@ -92,8 +97,35 @@ unsigned int decoder_impl::calc_syndrome(unsigned long message,
 	return (reg & ((1<<plen)-1));	// select the bottom plen bits of reg
 }
 
+/* The syndrome is linear in the received bits, so it can be computed as the
+ * XOR of per byte lookups. calc_syndrome() is only used to build the tables. */
+void decoder_impl::init_tables() {
+	unsigned int i, k;
+
+	for (k = 0; k < 4; k++)
+		for (i = 0; i < 256; i++)
+			d_syndrome_table[k][i] = calc_syndrome((unsigned long)i << (8 * k), 26);
+
+	/* Burst errors up to 5 bits have unique syndromes (Annex B) */
+	memset(d_burst_table, 0, sizeof(d_burst_table));
+	for (i = 1; i < 32; i++)
+		for (k = 0; k < 26; k++) {
+			unsigned long error = (unsigned long)i << k;
+			if (error >> 26)
+				break;
+			d_burst_table[block_syndrome(error)] = error;
+		}
+}
+
+unsigned int decoder_impl::block_syndrome(unsigned long reg) const {
+	return d_syndrome_table[0][reg & 0xff] ^
+		d_syndrome_table[1][(reg >> 8) & 0xff] ^
+		d_syndrome_table[2][(reg >> 16) & 0xff] ^
+		d_syndrome_table[3][(reg >> 24) & 0x03];
+}
+
 void decoder_impl::decode_group(unsigned int *group) {
-	pmt::pmt_t data = pmt::make_blob(group, 4 * sizeof(group));
+	pmt::pmt_t data = pmt::make_blob(group, 4 * sizeof(group[0]));
 	message_port_pub(pmt::mp("out"), data);
 }
 
@@ -110,15 +142,16 @@ int decoder_impl::work (int noutput_items,
 
 	int i=0,j;
 	unsigned long bit_distance, block_distance;
-	unsigned int block_calculated_crc, block_received_crc, checkword,dataword;
+	unsigned int dataword;
 	unsigned int reg_syndrome;
+	unsigned long error;
 
 /* the synchronization process is described in Annex C, page 66 of the standard */
 	while (i<noutput_items) {
 		reg=(reg<<1)|in[i];		// reg contains the last 26 rds bits
 		switch (d_state) {
 			case NO_SYNC:
-				reg_syndrome = calc_syndrome(reg,26);
+				reg_syndrome = block_syndrome(reg);
 				for (j=0;j<5;j++) {
 					if (reg_syndrome==syndrome[j]) {
 						if (!presync) {
@@ -148,31 +181,23 @@ int decoder_impl::work (int noutput_items,
 				else {
 					good_block=false;
 					dataword=(reg>>10) & 0xffff;
-					block_calculated_crc=calc_syndrome(dataword,16);
-					checkword=reg & 0x3ff;
+					reg_syndrome=block_syndrome(reg);
 /* manage special case of C or C' offset word */
-					if (block_number==2) {
-						block_received_crc=checkword^offset_word[block_number];
-						if (block_received_crc==block_calculated_crc)
-							good_block=true;
-						else {
-							block_received_crc=checkword^offset_word[4];
-							if (block_received_crc==block_calculated_crc)
-								good_block=true;
-							else {
-								wrong_blocks_counter++;
-								good_block=false;
-							}
-						}
-					}
+					if (reg_syndrome==syndrome[block_number] ||
+						(block_number==2 && reg_syndrome==syndrome[4]))
+						good_block=true;
 					else {
-						block_received_crc=checkword^offset_word[block_number];
-						if (block_received_crc==block_calculated_crc)
+/* try to correct a burst error of up to 5 bits */
+						error=d_burst_table[reg_syndrome^syndrome[block_number]];
+						if (!error && block_number==2)
+							error=d_burst_table[reg_syndrome^syndrome[4]];
+						if (error) {
+							dataword=((reg^error)>>10) & 0xffff;
+							corrected_blocks_counter++;
 							good_block=true;
-						else {
-							wrong_blocks_counter++;
-							good_block=false;
 						}
+						else
+							wrong_blocks_counter++;
 					}
 /* done checking CRC */
 					if (block_number==0 && good_block) {
@@ -199,11 +224,13 @@ int decoder_impl::work (int noutput_items,
 							enter_no_sync();
 						} else {
 							lout << "@@@@@ Still Sync-ed (Got " << wrong_blocks_counter
-								<< " bad blocks on " << blocks_counter
+								<< " bad blocks and " << corrected_blocks_counter
+								<< " corrected blocks on " << blocks_counter
 								<< " total)" << std::endl;
 						}
 						blocks_counter=0;
 						wrong_blocks_counter=0;
+						corrected_blocks_counter=0;
 					}
 				}
 			break;
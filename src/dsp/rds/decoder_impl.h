@@ -37,12 +37,20 @@ private:
 	void enter_no_sync();
 	void enter_sync(unsigned int);
 	unsigned int calc_syndrome(unsigned long, unsigned char);
+	unsigned int block_syndrome(unsigned long reg) const;
+	void init_tables();
 	void decode_group(unsigned int*);
 
+	/* syndrome of a 26 bit block, one table per byte (the last one has 2 bits) */
+	unsigned short d_syndrome_table[4][256];
+	/* error pattern for a syndrome (0 if not a correctable burst) */
+	unsigned long  d_burst_table[1024];
+
 	unsigned long  bit_counter;
 	unsigned long  lastseen_offset_counter, reg;
 	unsigned int   block_bit_counter;
 	unsigned int   wrong_blocks_counter;
+	unsigned int   corrected_blocks_counter;
 	unsigned int   blocks_counter;
 	unsigned int   group_good_blocks_counter;
 	unsigned int   group[4];
@@ -23,6 +23,18 @@
 #include "tmc_events.h"
 #include <gnuradio/io_signature.h>
 #include <math.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+/* Number of groups that can be queued for the worker (about 10 s) */
+#define PARSER_QUEUE_SIZE 128
 
 using namespace gr::rds;
 
@@ -36,15 +48,61 @@ parser_impl::parser_impl(bool log, bool debug)
 			gr::io_signature::make (0, 0, 0),
 			gr::io_signature::make (0, 0, 0)),
 	log(log),
-	debug(debug)
+	debug(debug),
+	d_queue(PARSER_QUEUE_SIZE),
+	d_quit(false)
 {
 	message_port_register_in(pmt::mp("in"));
 	set_msg_handler(pmt::mp("in"), boost::bind(&parser_impl::parse, this, _1));
 	message_port_register_out(pmt::mp("out"));
 	reset();
+
+	d_thread = gr::thread::thread(boost::bind(&parser_impl::worker, this));
 }
 
 parser_impl::~parser_impl() {
+	{
+		gr::thread::scoped_lock lock(d_queue_mutex);
+		d_quit = true;
+	}
+	d_queue_cond.notify_one();
+	d_thread.join();
+}
+
+/* Run the worker below normal priority so that decoding and formatting
+ * the groups never competes with the DSP threads. */
+static void lower_thread_priority() {
+#if defined(__linux__)
+	/* on Linux the nice value is per thread */
+	setpriority(PRIO_PROCESS, syscall(SYS_gettid), 10);
+#elif defined(__APPLE__)
+	pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#endif
+}
+
+void parser_impl::worker() {
+	lower_thread_priority();
+
+	gr::thread::scoped_lock lock(d_queue_mutex);
+
+	while (true) {
+		while (d_queue.empty() && !d_quit)
+			d_queue_cond.wait(lock);
+
+		if (d_quit)
+			break;
+
+		rds_group group = d_queue.front();
+		d_queue.pop_front();
+		lock.unlock();
+
+		{
+			gr::thread::scoped_lock state_lock(d_mutex);
+			decode_group(group.block);
+		}
+
+		lock.lock();
+	}
 }
 
 void parser_impl::reset() {
@@ -141,17 +199,22 @@ void parser_impl::decode_type0(unsigned int *group, bool B) {
 
 		std::string af1_string;
 		std::string af2_string;
+		char buf[16];
 		/* only AF1 => no_af==1, only AF2 => no_af==2, both AF1 and AF2 => no_af==3 */
 		if(no_af) {
 			if(af_1 > 80e3) {
-				af1_string = str(boost::format("%2.2fMHz") % (af_1/1e3));
+				snprintf(buf, sizeof(buf), "%2.2fMHz", af_1/1e3);
+				af1_string = buf;
 			} else if((af_1<2e3)&&(af_1>100)) {
-				af1_string = str(boost::format("%ikHz") % int(af_1));
+				snprintf(buf, sizeof(buf), "%ikHz", int(af_1));
+				af1_string = buf;
 			}
 			if(af_2 > 80e3) {
-				af2_string = str(boost::format("%2.2fMHz") % (af_2/1e3));
+				snprintf(buf, sizeof(buf), "%2.2fMHz", af_2/1e3);
+				af2_string = buf;
 			} else if ((af_2 < 2e3) && (af_2 > 100)) {
-				af2_string = str(boost::format("%ikHz") % int(af_2));
+				snprintf(buf, sizeof(buf), "%ikHz", int(af_2));
+				af2_string = buf;
 			}
 		}
 		if(no_af == 1) {
@@ -159,7 +222,7 @@ void parser_impl::decode_type0(unsigned int *group, bool B) {
 		} else if(no_af == 2) {
 			af_string = af2_string;
 		} else if(no_af == 3) {
-			af_string = str(boost::format("%s, %s") % af1_string %af2_string);
+			af_string = af1_string + ", " + af2_string;
 		}
 	}
 
@@ -354,8 +417,10 @@ void parser_impl::decode_type4(unsigned int *group, bool B){
 	year += K;
 	month -= 1 + K * 12;
 
-	std::string time = str(boost::format("%02i.%02i.%4i, %02i:%02i (%+.1fh)")\
-		% day % month % (1900 + year) % hours % minutes % local_time_offset);
+	char buf[40];
+	snprintf(buf, sizeof(buf), "%02u.%02u.%4u, %02u:%02u (%+.1fh)",
+		day, month, 1900 + year, hours, minutes, local_time_offset);
+	std::string time(buf);
 	lout << "Clocktime: " << time << std::endl;
 
 	send_message(5,time);
@@ -569,16 +634,32 @@ void parser_impl::decode_type15(unsigned int *group, bool B){
 	dout << "type 15 not implemented yet" << std::endl;
 }
 
+/* Message handler, called from the block thread. Only queues the group,
+ * the actual decoding is done in the worker thread. */
 void parser_impl::parse(pmt::pmt_t msg) {
 	if(!pmt::is_blob(msg)) {
 		dout << "wrong input message (no blob)" << std::endl;
+		return;
 	}
-	if(pmt::blob_length(msg) != 4 * sizeof(unsigned long)) {
+	if(pmt::blob_length(msg) != 4 * sizeof(unsigned int)) {
 		dout << "input message has wrong size ("
 			<< pmt::blob_length(msg) << ")" << std::endl;
+		return;
 	}
-	unsigned int *group = (unsigned int*)pmt::blob_data(msg);
 
+	rds_group group;
+	memcpy(group.block, pmt::blob_data(msg), sizeof(group.block));
+
+	{
+		gr::thread::scoped_lock lock(d_queue_mutex);
+		if (d_queue.full())
+			dout << "RDS parser queue full, dropping group" << std::endl;
+		d_queue.push_back(group);
+	}
+	d_queue_cond.notify_one();
+}
+
+void parser_impl::decode_group(unsigned int *group) {
 	unsigned int group_type = (unsigned int)((group[1] >> 12) & 0xf);
 	bool ab = (group[1] >> 11 ) & 0x1;
 
@@ -590,7 +671,9 @@ void parser_impl::parse(pmt::pmt_t msg) {
 	int pi_country_identification = (program_identification >> 12) & 0xf;
 	int pi_area_coverage = (program_identification >> 8) & 0xf;
 	unsigned char pi_program_reference_number = program_identification & 0xff;
-	std::string pistring = str(boost::format("%04X") % program_identification);
+	char pibuf[8];
+	snprintf(pibuf, sizeof(pibuf), "%04X", program_identification);
+	std::string pistring(pibuf);
 	send_message(0, pistring);
 	send_message(2, pty_table[program_type]);
 
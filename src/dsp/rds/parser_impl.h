@@ -19,6 +19,7 @@
 
 #include "dsp/rds/parser.h"
 #include <gnuradio/thread/thread.h>
+#include <boost/circular_buffer.hpp>
 
 namespace gr {
 namespace rds {
@@ -34,6 +35,8 @@ private:
 	void reset();
 	void send_message(long, std::string);
 	void parse(pmt::pmt_t msg);
+	void worker();
+	void decode_group(unsigned int *group);
 	double decode_af(unsigned int);
 	void decode_optional_content(int, unsigned long int *);
 
@@ -72,6 +75,17 @@ private:
 	bool           log;
 	bool           debug;
 	gr::thread::mutex d_mutex;
+
+	/* Received groups waiting to be decoded by the worker thread. The
+	 * queue is bounded; when full the oldest group is dropped. */
+	struct rds_group {
+		unsigned int block[4];
+	};
+	boost::circular_buffer<rds_group> d_queue;
+	gr::thread::mutex              d_queue_mutex;
+	gr::thread::condition_variable d_queue_cond;
+	gr::thread::thread             d_thread;
+	bool                           d_quit;
 };
 
 } /* namespace rds */
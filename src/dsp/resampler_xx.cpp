@@ -20,43 +20,112 @@
  * the Free Software Foundation, Inc., 51 Franklin Street,
  * Boston, MA 02110-1301, USA.
  */
+#include <cmath>
 #include <cstdio>
 #include <gnuradio/io_signature.h>
 #include <gnuradio/filter/firdes.h>
 #include "dsp/resampler_xx.h"
 
+/* Largest interpolation used with the rational resampler. Above this the
+ * polyphase filter gets too long and the PFB arbitrary resampler is used. */
+#define RESAMPLER_MAX_INTERP    256
+#define RESAMPLER_MAX_DECIM     4096
 
-/* Create a new instance of resampler_cc and return
- * a boost shared_ptr. This is effectively the public constructor.
+/* Number of filters in the PFB arbitrary resampler. */
+#define RESAMPLER_PFB_SIZE      32
+
+
+/*! \brief Find the resampler to use for a given rate.
+ *
+ * Uses continued fractions to find the best rational approximation with a
+ * bounded numerator. The ratio is treated as rational if it matches to within
+ * single precision, since several callers compute the rate using floats; the
+ * resulting rate error is below 0.1 ppm.
  */
-resampler_cc_sptr make_resampler_cc(float rate)
+resampler_plan resampler_plan::make(double rate)
 {
-    return gnuradio::get_initial_sptr(new resampler_cc(rate));
-}
+    resampler_plan  plan = {RESAMPLER_ARB, 0, 0};
 
-resampler_cc::resampler_cc(float rate)
-    : gr::hier_block2 ("resampler_cc",
-          gr::io_signature::make (1, 1, sizeof(gr_complex)),
-          gr::io_signature::make (1, 1, sizeof(gr_complex)))
-{
-    /* I ceated this code based on:
-       http://gnuradio.squarespace.com/blog/2010/12/6/new-interface-for-pfb_arb_resampler_ccf.html
+    if (rate <= 0.0)
+        return plan;
+
+    /* convergents p/q of the continued fraction of rate */
+    unsigned long long  p0 = 0, q0 = 1;
+    unsigned long long  p1 = 1, q1 = 0;
+    double              x = rate;
+
+    for (int i = 0; i < 32; i++)
+    {
+        double              a = std::floor(x);
+        unsigned long long  p2 = (unsigned long long)a * p1 + p0;
+        unsigned long long  q2 = (unsigned long long)a * q1 + q0;
 
-       and blks2.pfb_arb_resampler.py
+        if (p2 > RESAMPLER_MAX_INTERP || q2 > RESAMPLER_MAX_DECIM)
+            break;
 
-       Note: In case of decimation, we limit the cutoff to the output bandwidth to avoid "phantom"
-             signals when we have a frequency translation in front of the PFB resampler.
-    */
+        if (std::fabs((double)p2 / (double)q2 - rate) <= 1.0e-7 * rate)
+        {
+            plan.kind = (p2 == 1) ? RESAMPLER_DECIM : RESAMPLER_RATIONAL;
+            plan.interp = (unsigned int)p2;
+            plan.decim = (unsigned int)q2;
+            break;
+        }
+
+        if (x - a < 1.0e-12)
+            break;
+
+        x = 1.0 / (x - a);
+        p0 = p1; q0 = q1;
+        p1 = p2; q1 = q2;
+    }
+
+    return plan;
+}
 
-    /* generate taps */
+/*! \brief Generate low pass taps.
+ *
+ * In case of decimation, we limit the cutoff to the output bandwidth to avoid "phantom"
+ * signals when we have a frequency translation in front of the resampler.
+ */
+std::vector<float> resampler_plan::taps(double rate) const
+{
     double cutoff = rate > 1.0 ? 0.4 : 0.4*rate;
     double trans_width = rate > 1.0 ? 0.2 : 0.2*rate;
-    unsigned int flt_size = 32;
+    double flt_size;
+
+    switch (kind)
+    {
+    case RESAMPLER_DECIM:
+        flt_size = 1.0;
+        break;
+    case RESAMPLER_RATIONAL:
+        flt_size = interp;
+        break;
+    default:
+        flt_size = RESAMPLER_PFB_SIZE;
+        break;
+    }
 
-    d_taps = gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
+    return gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
+}
+
+
+/* Create a new instance of resampler_cc and return
+ * a boost shared_ptr. This is effectively the public constructor.
+ */
+resampler_cc_sptr make_resampler_cc(double rate)
+{
+    return gnuradio::get_initial_sptr(new resampler_cc(rate));
+}
 
-    /* create the filter */
-    d_filter = gr::filter::pfb_arb_resampler_ccf::make(rate, d_taps, flt_size);
+resampler_cc::resampler_cc(double rate)
+    : gr::hier_block2 ("resampler_cc",
+          gr::io_signature::make (1, 1, sizeof(gr_complex)),
+          gr::io_signature::make (1, 1, sizeof(gr_complex))),
+      d_rate(rate)
+{
+    d_plan = resampler_plan::make(d_rate);
+    create_filter();
 
     /* connect filter */
     connect(self(), 0, d_filter, 0);
@@ -68,20 +137,66 @@ resampler_cc::~resampler_cc()
 
 }
 
-void resampler_cc::set_rate(float rate)
+/*! \brief Create filter block according to current plan and rate. */
+void resampler_cc::create_filter()
 {
-    /* generate taps */
-    double cutoff = rate > 1.0 ? 0.4 : 0.4*rate;
-    double trans_width = rate > 1.0 ? 0.2 : 0.2*rate;
-    unsigned int flt_size = 32;
-    d_taps = gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
+    d_taps = d_plan.taps(d_rate);
+    d_pfb.reset();
+
+    switch (d_plan.kind)
+    {
+    case resampler_plan::RESAMPLER_DECIM:
+        d_filter = gr::filter::fir_filter_ccf::make(d_plan.decim, d_taps);
+        break;
+    case resampler_plan::RESAMPLER_RATIONAL:
+        d_filter = gr::filter::rational_resampler_base_ccf::make(d_plan.interp,
+                                                                 d_plan.decim,
+                                                                 d_taps);
+        break;
+    default:
+        d_pfb = gr::filter::pfb_arb_resampler_ccf::make(d_rate, d_taps,
+                                                        RESAMPLER_PFB_SIZE);
+        d_filter = d_pfb;
+        break;
+    }
+}
+
+/*! \brief Set new resampling rate.
+ *
+ * Arbitrary rate changes are applied in place through the PFB setters and
+ * do not touch the flow graph. The interpolation and decimation of the FIR
+ * and rational resamplers are fixed when they are created and the buffers
+ * around them are sized accordingly, so a different integer or rational
+ * ratio needs a new filter block. The receiver only changes the ratio
+ * together with the input rate, while the top block is already locked for
+ * reconfiguring the source, so this does not cause an additional restart.
+ */
+void resampler_cc::set_rate(double rate)
+{
+    if (rate == d_rate)
+        return;
+
+    resampler_plan plan = resampler_plan::make(rate);
+    d_rate = rate;
+
+    if (d_pfb && plan.kind == resampler_plan::RESAMPLER_ARB)
+    {
+        d_plan = plan;
+        d_taps = d_plan.taps(d_rate);
+        d_pfb->set_taps(d_taps);
+        d_pfb->set_rate(d_rate);
+        return;
+    }
+
+    if (plan == d_plan)
+        return;
+
+    d_plan = plan;
 
-    /* FIXME: Should implement set_taps() in PFB */
     lock();
     disconnect(self(), 0, d_filter, 0);
     disconnect(d_filter, 0, self(), 0);
-    d_filter.reset();
-    d_filter = gr::filter::pfb_arb_resampler_ccf::make(rate, d_taps, flt_size);
+    create_filter();
     connect(self(), 0, d_filter, 0);
     connect(d_filter, 0, self(), 0);
     unlock();
@@ -90,34 +205,19 @@ void resampler_cc::set_rate(float rate)
 /* Create a new instance of resampler_ff and return
  * a boost shared_ptr. This is effectively the public constructor.
  */
-resampler_ff_sptr make_resampler_ff(float rate)
+resampler_ff_sptr make_resampler_ff(double rate)
 {
     return gnuradio::get_initial_sptr(new resampler_ff(rate));
 }
 
-resampler_ff::resampler_ff(float rate)
+resampler_ff::resampler_ff(double rate)
     : gr::hier_block2 ("resampler_ff",
           gr::io_signature::make (1, 1, sizeof(float)),
-          gr::io_signature::make (1, 1, sizeof(float)))
+          gr::io_signature::make (1, 1, sizeof(float))),
+      d_rate(rate)
 {
-    /* I ceated this code based on:
-       http://gnuradio.squarespace.com/blog/2010/12/6/new-interface-for-pfb_arb_resampler_ccf.html
-
-       and blks2.pfb_arb_resampler.py
-
-       Note: In case of decimation, we limit the cutoff to the output bandwidth to avoid "phantom"
-             signals when we have a frequency translation in front of the PFB resampler.
-    */
-
-    /* generate taps */
-    double cutoff = rate > 1.0 ? 0.4 : 0.4*rate;
-    double trans_width = rate > 1.0 ? 0.2 : 0.2*rate;
-    unsigned int flt_size = 32;
-
-    d_taps = gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
-
-    /* create the filter */
-    d_filter = gr::filter::pfb_arb_resampler_fff::make(rate, d_taps, flt_size);
+    d_plan = resampler_plan::make(d_rate);
+    create_filter();
 
     /* connect filter */
     connect(self(), 0, d_filter, 0);
@@ -129,20 +229,66 @@ resampler_ff::~resampler_ff()
 
 }
 
-void resampler_ff::set_rate(float rate)
+/*! \brief Create filter block according to current plan and rate. */
+void resampler_ff::create_filter()
 {
-    /* generate taps */
-    double cutoff = rate > 1.0 ? 0.4 : 0.4*rate;
-    double trans_width = rate > 1.0 ? 0.2 : 0.2*rate;
-    unsigned int flt_size = 32;
-    d_taps = gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
+    d_taps = d_plan.taps(d_rate);
+    d_pfb.reset();
+
+    switch (d_plan.kind)
+    {
+    case resampler_plan::RESAMPLER_DECIM:
+        d_filter = gr::filter::fir_filter_fff::make(d_plan.decim, d_taps);
+        break;
+    case resampler_plan::RESAMPLER_RATIONAL:
+        d_filter = gr::filter::rational_resampler_base_fff::make(d_plan.interp,
+                                                                 d_plan.decim,
+                                                                 d_taps);
+        break;
+    default:
+        d_pfb = gr::filter::pfb_arb_resampler_fff::make(d_rate, d_taps,
+                                                        RESAMPLER_PFB_SIZE);
+        d_filter = d_pfb;
+        break;
+    }
+}
+
+/*! \brief Set new resampling rate.
+ *
+ * Arbitrary rate changes are applied in place through the PFB setters and
+ * do not touch the flow graph. The interpolation and decimation of the FIR
+ * and rational resamplers are fixed when they are created and the buffers
+ * around them are sized accordingly, so a different integer or rational
+ * ratio needs a new filter block. The receiver only changes the ratio
+ * together with the input rate, while the top block is already locked for
+ * reconfiguring the source, so this does not cause an additional restart.
+ */
+void resampler_ff::set_rate(double rate)
+{
+    if (rate == d_rate)
+        return;
+
+    resampler_plan plan = resampler_plan::make(rate);
+    d_rate = rate;
+
+    if (d_pfb && plan.kind == resampler_plan::RESAMPLER_ARB)
+    {
+        d_plan = plan;
+        d_taps = d_plan.taps(d_rate);
+        d_pfb->set_taps(d_taps);
+        d_pfb->set_rate(d_rate);
+        return;
+    }
+
+    if (plan == d_plan)
+        return;
+
+    d_plan = plan;
 
-    /* FIXME: Should implement set_taps() in PFB */
     lock();
     disconnect(self(), 0, d_filter, 0);
     disconnect(d_filter, 0, self(), 0);
-    d_filter.reset();
-    d_filter = gr::filter::pfb_arb_resampler_fff::make(rate, d_taps, flt_size);
+    create_filter();
     connect(self(), 0, d_filter, 0);
     connect(d_filter, 0, self(), 0);
     unlock();
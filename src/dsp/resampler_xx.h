@@ -24,8 +24,12 @@
 #define RESAMPLER_XX_H
 
 #include <gnuradio/hier_block2.h>
+#include <gnuradio/filter/fir_filter_ccf.h>
+#include <gnuradio/filter/fir_filter_fff.h>
 #include <gnuradio/filter/pfb_arb_resampler_ccf.h>
 #include <gnuradio/filter/pfb_arb_resampler_fff.h>
+#include <gnuradio/filter/rational_resampler_base_ccf.h>
+#include <gnuradio/filter/rational_resampler_base_fff.h>
 
 
 class resampler_cc;
@@ -35,32 +39,71 @@ typedef boost::shared_ptr<resampler_cc> resampler_cc_sptr;
 typedef boost::shared_ptr<resampler_ff> resampler_ff_sptr;
 
 
+/*! \brief Resampler implementation selected for a given rate. */
+struct resampler_plan
+{
+    enum type {
+        RESAMPLER_DECIM    = 0, /*!< Integer decimation (or 1:1), FIR filter. */
+        RESAMPLER_RATIONAL = 1, /*!< Rational ratio, polyphase resampler. */
+        RESAMPLER_ARB      = 2  /*!< Arbitrary ratio, PFB arbitrary resampler. */
+    };
+
+    type            kind;
+    unsigned int    interp;
+    unsigned int    decim;
+
+    /*! \brief Find the cheapest resampler for the given rate. */
+    static resampler_plan make(double rate);
+
+    /*! \brief Generate filter taps suitable for the plan. */
+    std::vector<float> taps(double rate) const;
+
+    bool operator==(const resampler_plan &other) const
+    {
+        return kind == other.kind && interp == other.interp && decim == other.decim;
+    }
+};
+
+
 /*! \brief Return a shared_ptr to a new instance of resampler_cc.
  *  \param rate Resampling rate, i.e. output/input.
  *
  * This is effectively the public constructor.
  */
-resampler_cc_sptr make_resampler_cc(float rate);
+resampler_cc_sptr make_resampler_cc(double rate);
 
-/*! \brief Arbitrary rate resampler based on gr_pfb_arb_resampler_ccf
+/*! \brief Rational or arbitrary rate resampler (complex).
  *  \ingroup DSP
  *
- * This block is a convenience wrapper around gr_pfb_arb_resampler_ccf. It takes care
- * of generating filter taps that can be used for the filter, as well as calculating
- * the other required parameters.
+ * This block is a convenience wrapper around the GNU Radio resamplers. It
+ * checks whether the rate is an integer decimation or a rational number with
+ * a small numerator and uses a decimating FIR filter or a rational polyphase
+ * resampler in those cases. gr_pfb_arb_resampler_ccf is only used for
+ * arbitrary ratios. It also takes care of generating the filter taps.
  */
 class resampler_cc : public gr::hier_block2
 {
 
 public:
-    resampler_cc(float rate); // FIXME: should be private
+    resampler_cc(double rate); // FIXME: should be private
     ~resampler_cc();
 
-    void set_rate(float rate);
+    /*! \brief Set new resampling rate.
+     *
+     * Changes between arbitrary rates are done in place. Changing to a
+     * different integer or rational ratio replaces the filter block, so
+     * this should be called while the top block is locked.
+     */
+    void set_rate(double rate);
 
 private:
-    std::vector<float>            d_taps;
-    gr::filter::pfb_arb_resampler_ccf::sptr d_filter;
+    void create_filter();
+
+    double                  d_rate;
+    resampler_plan          d_plan;
+    std::vector<float>      d_taps;
+    gr::basic_block_sptr    d_filter;   /*!< The active filter block. */
+    gr::filter::pfb_arb_resampler_ccf::sptr d_pfb; /*!< Set when d_filter is a PFB. */
 };
 
 
@@ -69,28 +112,41 @@ private:
  *
  * This is effectively the public constructor.
  */
-resampler_ff_sptr make_resampler_ff(float rate);
+resampler_ff_sptr make_resampler_ff(double rate);
 
 
-/*! \brief Arbitrary rate resampler based on gr_pfb_arb_resampler_fff
+/*! \brief Rational or arbitrary rate resampler (real).
  *  \ingroup DSP
  *
- * This block is a convenience wrapper around gr_pfb_arb_resampler_fff. It takes care
- * of generating filter taps that can be used for the filter, as well as calculating
- * the other required parameters.
+ * This block is a convenience wrapper around the GNU Radio resamplers. It
+ * checks whether the rate is an integer decimation or a rational number with
+ * a small numerator and uses a decimating FIR filter or a rational polyphase
+ * resampler in those cases. gr_pfb_arb_resampler_fff is only used for
+ * arbitrary ratios. It also takes care of generating the filter taps.
  */
 class resampler_ff : public gr::hier_block2
 {
 
 public:
-    resampler_ff(float rate); // FIXME: should be private
+    resampler_ff(double rate); // FIXME: should be private
     ~resampler_ff();
 
-    void set_rate(float rate);
+    /*! \brief Set new resampling rate.
+     *
+     * Changes between arbitrary rates are done in place. Changing to a
+     * different integer or rational ratio replaces the filter block, so
+     * this should be called while the top block is locked.
+     */
+    void set_rate(double rate);
 
 private:
-    std::vector<float>            d_taps;
-    gr::filter::pfb_arb_resampler_fff::sptr d_filter;
+    void create_filter();
+
+    double                  d_rate;
+    resampler_plan          d_plan;
+    std::vector<float>      d_taps;
+    gr::basic_block_sptr    d_filter;   /*!< The active filter block. */
+    gr::filter::pfb_arb_resampler_fff::sptr d_pfb; /*!< Set when d_filter is a PFB. */
 };
 
 #endif // RESAMPLER_XX_H
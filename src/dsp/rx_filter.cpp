@@ -21,6 +21,7 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <cmath>
+#include <boost/bind.hpp>
 #include <gnuradio/io_signature.h>
 #include <gnuradio/filter/firdes.h>
 #include <iostream>
@@ -56,11 +57,16 @@ rx_filter::rx_filter(double sample_rate, double low, double high, double trans_w
     if (high > 0.95*sample_rate/2.0)
         d_high = 0.95*sample_rate/2.0;
 
-    /* generate taps */
-    d_taps = gr::filter::firdes::complex_band_pass(1.0, d_sample_rate, d_low, d_high, d_trans_width);
+    /* generate initial taps synchronously */
+    std::vector<gr_complex> taps = filter_designer::design(d_sample_rate, d_low,
+                                                           d_high, d_trans_width,
+                                                           d_cw_offset);
 
     /* create band pass filter */
-    d_bpf = gr::filter::fir_filter_ccc::make(1, d_taps);
+    d_bpf = gr::filter::fir_filter_ccc::make(1, taps);
+
+    /* subsequent updates are designed in the background */
+    d_designer.reset(new filter_designer(boost::bind(&rx_filter::apply_taps, this, _1)));
 
     /* connect filter */
     connect(self(), 0, d_bpf, 0);
@@ -69,7 +75,8 @@ rx_filter::rx_filter(double sample_rate, double low, double high, double trans_w
 
 rx_filter::~rx_filter ()
 {
-
+    /* stop designer thread before the filter goes away */
+    d_designer.reset();
 }
 
 void rx_filter::set_param(double low, double high, double trans_width)
@@ -83,19 +90,19 @@ void rx_filter::set_param(double low, double high, double trans_width)
     if (d_high > 0.95*d_sample_rate/2.0)
         d_high = 0.95*d_sample_rate/2.0;
 
-    /* generate new taps */
-    d_taps = gr::filter::firdes::complex_band_pass(1.0, d_sample_rate,
-                                                   d_low + d_cw_offset,
-                                                   d_high + d_cw_offset,
-                                                   d_trans_width);
-
-#ifndef QT_NO_DEBUG_OUTPUT
-    std::cout << "Generating taps for new filter   LO:" << d_low
-              << "   HI:" << d_high << " TW:" << d_trans_width
-              << "   Taps: " << d_taps.size() << std::endl;
-#endif
+    /* new taps are applied asynchronously; bursts are coalesced */
+    d_designer->request(d_sample_rate, d_low, d_high, d_trans_width, d_cw_offset);
+}
 
-    d_bpf->set_taps(d_taps);
+/*! \brief Swap in a complete set of new taps.
+ *
+ * Called by the filter designer. fir_filter_ccc::set_taps() takes the block's
+ * setter lock, which is also held during work(), so the filter never runs
+ * with a partially updated tap set.
+ */
+void rx_filter::apply_taps(const std::vector<gr_complex> &taps)
+{
+    d_bpf->set_taps(taps);
 }
 
 
@@ -23,9 +23,11 @@
 #ifndef RX_FILTER_H
 #define RX_FILTER_H
 
+#include <boost/scoped_ptr.hpp>
 #include <gnuradio/hier_block2.h>
 #include <gnuradio/filter/fir_filter_ccc.h>
 #include <gnuradio/filter/freq_xlating_fir_filter_ccc.h>
+#include "dsp/filter/filter_designer.h"
 
 
 #define RX_FILTER_MIN_WIDTH 100  /*! Minimum width of filter */
@@ -60,8 +62,16 @@ rx_filter_sptr make_rx_filter(double sample_rate,
  * interface to set the filter parameters.
  *
  * The user of this class is expected to provide valid parameters and no checks are
- * performed by the accessors (though the taps generator from gr::filter::firdes does perform
- * some sanity checks and throws std::out_of_range in case of bad parameter).
+ * performed by the accessors. The taps generator from gr::filter::firdes does perform
+ * some sanity checks and throws std::out_of_range in case of bad parameter, but
+ * only the constructor, which designs the initial taps synchronously, passes
+ * this exception on to the caller.
+ *
+ * The taps are designed asynchronously by a filter_designer, i.e. set_param()
+ * returns immediately and the new taps are swapped in as a whole once they
+ * are ready. This keeps the GUI responsive while dragging the filter edges.
+ * If the design fails, the error is printed on stderr and the filter keeps
+ * its previous taps.
  *
  * \note In order to have proper LSB/USB, we must exchange low and high and reverse their sign
  */
@@ -76,8 +86,10 @@ public:
     void set_cw_offset(double offset);
 
 private:
-    std::vector<gr_complex> d_taps;
+    void apply_taps(const std::vector<gr_complex> &taps);
+
     gr::filter::fir_filter_ccc::sptr  d_bpf;
+    boost::scoped_ptr<filter_designer> d_designer;
 
     double d_sample_rate;
     double d_low;
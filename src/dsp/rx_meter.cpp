@@ -21,11 +21,23 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <math.h>
+#include <algorithm>
 #include <gnuradio/io_signature.h>
 #include <dsp/rx_meter.h>
 #include <iostream>
 
 
+/* noise floor estimator */
+#define NF_BLOCK        64          /* samples per histogram entry */
+#define NF_MIN_DB       -160.0f     /* lowest histogram bin [dBFS] */
+#define NF_BIN_DB       0.5f        /* histogram resolution [dB] */
+#define NF_BINS         320         /* covers NF_MIN_DB ... 0 dBFS */
+#define NF_WINDOW       4096.0f     /* halve histogram after this many entries */
+#define NF_PERCENTILE   0.2f        /* noise floor percentile */
+
+#define DB(x)           (10.0f * log10f((x) + 1.0e-20f))
+
+
 rx_meter_c_sptr make_rx_meter_c (int detector)
 {
     return gnuradio::get_initial_sptr(new rx_meter_c (detector));
@@ -36,13 +48,16 @@ rx_meter_c::rx_meter_c(int detector)
           gr::io_signature::make(1, 1, sizeof(gr_complex)),
           gr::io_signature::make(0, 0, 0)),
       d_detector(detector),
-      d_level(0.0),
-      d_level_db(0.0),
-      d_sum(0.0),
-      d_sumsq(0.0),
-      d_num(0)
+      d_nf_hist(NF_BINS, 0.0f),
+      d_nf_total(0.0f),
+      d_nf_acc(0.0f),
+      d_nf_cnt(0)
 {
+    if (d_detector < DETECTOR_TYPE_SAMPLE || d_detector > DETECTOR_TYPE_RMS)
+        d_detector = DETECTOR_TYPE_RMS;
 
+    d_sample = 0.0f;
+    reset_stats();
 }
 
 rx_meter_c::~rx_meter_c()
@@ -50,7 +65,50 @@ rx_meter_c::~rx_meter_c()
 }
 
 
-#define ALPHA 0.4
+/*! \brief Compute power statistics of a block of samples.
+ *
+ * Uses four independent accumulators so that the compiler can keep them
+ * in one SIMD register without reordering floating point operations.
+ */
+static inline void meter_stats(const gr_complex *in, int n, float &sum,
+                               float &sumsq, float &min, float &max)
+{
+    const float *x = (const float *) in;
+    float s[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float s2[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float mn[4] = {min, min, min, min};
+    float mx[4] = {max, max, max, max};
+    int i, k;
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        for (k = 0; k < 4; k++)
+        {
+            float re = x[2 * (i + k)];
+            float im = x[2 * (i + k) + 1];
+            float pwr = re * re + im * im;
+
+            s[k] += pwr;
+            s2[k] += pwr * pwr;
+            mn[k] = pwr < mn[k] ? pwr : mn[k];
+            mx[k] = pwr > mx[k] ? pwr : mx[k];
+        }
+    }
+    for (; i < n; i++)
+    {
+        float pwr = x[2 * i] * x[2 * i] + x[2 * i + 1] * x[2 * i + 1];
+
+        s[0] += pwr;
+        s2[0] += pwr * pwr;
+        mn[0] = pwr < mn[0] ? pwr : mn[0];
+        mx[0] = pwr > mx[0] ? pwr : mx[0];
+    }
+
+    sum = (s[0] + s[1]) + (s[2] + s[3]);
+    sumsq = (s2[0] + s2[1]) + (s2[2] + s2[3]);
+    min = std::min(std::min(mn[0], mn[1]), std::min(mn[2], mn[3]));
+    max = std::max(std::max(mx[0], mx[1]), std::max(mx[2], mx[3]));
+}
 
 int rx_meter_c::work (int noutput_items,
                       gr_vector_const_void_star &input_items,
@@ -59,80 +117,46 @@ int rx_meter_c::work (int noutput_items,
     (void) output_items; // unused
 
     const gr_complex *in = (const gr_complex *) input_items[0];
-    float pwr = 0.0;
-    int   i = 0;
-
-    if (d_num == 0)
-    {
-        // first sample after a reset
-        d_level = in[0].real()*in[0].real() + in[0].imag()*in[0].imag();
-        d_sum = d_level;
-        d_sumsq = d_level*d_level;
-        i = 1;
-    }
+    int i = 0;
 
-    d_num += noutput_items;
+    gr::thread::scoped_lock lock(d_setlock);
 
-    // processing depends on detector type
-    switch (d_detector)
+    /* split input at noise floor block boundaries */
+    while (i < noutput_items)
     {
-    case DETECTOR_TYPE_SAMPLE:
-        // just take the first sample
-        d_level = in[0].real()*in[0].real() + in[0].imag()*in[0].imag();
-        break;
+        int n = std::min(noutput_items - i, NF_BLOCK - d_nf_cnt);
+        float sum, sumsq;
 
-    case DETECTOR_TYPE_MIN:
-        // minimum peak
-        while (i < noutput_items)
-        {
-            pwr = in[i].real()*in[i].real() + in[i].imag()*in[i].imag();
-            if (pwr < d_level)
-                d_level = pwr;
-            i++;
-        }
-        break;
+        meter_stats(&in[i], n, sum, sumsq, d_min, d_max);
+        d_sum += sum;
+        d_sumsq += sumsq;
+        d_nf_acc += sum;
+        d_nf_cnt += n;
+        i += n;
 
-    case DETECTOR_TYPE_MAX:
-        // maximum peak
-        while (i < noutput_items)
+        if (d_nf_cnt == NF_BLOCK)
         {
-            pwr = in[i].real()*in[i].real() + in[i].imag()*in[i].imag();
-            if (pwr > d_level)
-                d_level = pwr;
-            i++;
-        }
-        break;
+            float db = DB(d_nf_acc / (float) NF_BLOCK);
+            int bin = (int)((db - NF_MIN_DB) / NF_BIN_DB);
 
-    case DETECTOR_TYPE_AVG:
-        // mean value
-        while (i < noutput_items)
-        {
-            pwr = in[i].real()*in[i].real() + in[i].imag()*in[i].imag();
-            d_sum += pwr;
-            i++;
-        }
-        d_level = d_sum / (float)(d_num);
-        break;
+            bin = std::max(0, std::min(NF_BINS - 1, bin));
+            d_nf_hist[bin] += 1.0f;
+            d_nf_total += 1.0f;
+            if (d_nf_total >= NF_WINDOW)
+            {
+                for (int j = 0; j < NF_BINS; j++)
+                    d_nf_hist[j] *= 0.5f;
+                d_nf_total *= 0.5f;
+            }
 
-    case DETECTOR_TYPE_RMS:
-        // root mean square
-        while (i < noutput_items)
-        {
-            pwr = in[i].real()*in[i].real() + in[i].imag()*in[i].imag();
-            d_sumsq += pwr*pwr;
-            i++;
+            d_nf_acc = 0.0f;
+            d_nf_cnt = 0;
         }
-        d_level = sqrt(d_sumsq / (float)(d_num));
-        break;
-
-    default:
-        std::cout << "Invalid detector type: " << d_detector << std::endl;
-        std::cout << "Fallback to DETECTOR_TYPE_RMS." << std::endl;
-        d_detector = DETECTOR_TYPE_RMS;
-        break;
     }
 
-    d_level_db = (float) 10. * log10f(d_level + 1.0e-20);
+    d_num += noutput_items;
+    d_sample = in[noutput_items - 1].real() * in[noutput_items - 1].real() +
+               in[noutput_items - 1].imag() * in[noutput_items - 1].imag();
 
     return noutput_items;
 }
@@ -140,7 +164,9 @@ int rx_meter_c::work (int noutput_items,
 
 float rx_meter_c::get_level()
 {
-    float retval = d_level;
+    gr::thread::scoped_lock lock(d_setlock);
+
+    float retval = level();
     reset_stats();
 
     return retval;
@@ -148,27 +174,105 @@ float rx_meter_c::get_level()
 
 float rx_meter_c::get_level_db()
 {
-    float retval = d_level_db;
+    gr::thread::scoped_lock lock(d_setlock);
+
+    float retval = DB(level());
     reset_stats();
 
     return retval;
 }
 
+void rx_meter_c::get_levels(rx_meter_levels &levels)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    float avg = d_num ? d_sum / d_num : d_sample;
+    float rms = d_num ? sqrt(d_sumsq / d_num) : d_sample;
+
+    levels.level = DB(level());
+    levels.peak = DB(d_num ? d_max : d_sample);
+    levels.rms = DB(rms);
+    levels.min = DB(d_num ? d_min : d_sample);
+    levels.noise_floor = noise_floor();
+    /* the noise floor is an average power, compare like with like */
+    levels.snr = DB(avg) - levels.noise_floor;
+
+    reset_stats();
+}
+
 
 void rx_meter_c::set_detector_type(int detector)
 {
+    gr::thread::scoped_lock lock(d_setlock);
+
     if (d_detector == detector)
         return;
 
+    if (detector < DETECTOR_TYPE_SAMPLE || detector > DETECTOR_TYPE_RMS)
+    {
+        std::cout << "Invalid detector type: " << detector << std::endl;
+        std::cout << "Fallback to DETECTOR_TYPE_RMS." << std::endl;
+        detector = DETECTOR_TYPE_RMS;
+    }
+
     d_detector = detector;
     reset_stats();
 }
 
-/*! \brief Reset statistics. */
+/*! \brief Level of the selected detector in the current interval.
+ *
+ * If no samples have been received since the last reset the level of
+ * the last sample is returned.
+ */
+float rx_meter_c::level()
+{
+    if (d_num == 0)
+        return d_sample;
+
+    switch (d_detector)
+    {
+    case DETECTOR_TYPE_SAMPLE:
+        return d_sample;
+
+    case DETECTOR_TYPE_MIN:
+        return d_min;
+
+    case DETECTOR_TYPE_MAX:
+        return d_max;
+
+    case DETECTOR_TYPE_AVG:
+        return d_sum / d_num;
+
+    case DETECTOR_TYPE_RMS:
+    default:
+        return sqrt(d_sumsq / d_num);
+    }
+}
+
+/*! \brief Noise floor in dBFS from the block power histogram. */
+float rx_meter_c::noise_floor() const
+{
+    float target = NF_PERCENTILE * d_nf_total;
+    float acc = 0.0f;
+    int   bin;
+
+    if (d_nf_total <= 0.0f)
+        return NF_MIN_DB;
+
+    for (bin = 0; bin < NF_BINS - 1; bin++)
+    {
+        acc += d_nf_hist[bin];
+        if (acc >= target)
+            break;
+    }
+
+    return NF_MIN_DB + (bin + 0.5f) * NF_BIN_DB;
+}
+
 void rx_meter_c::reset_stats()
 {
-    //d_level = 0.0;
-    d_level_db = 0.0;
+    d_min = 1.0e20f;
+    d_max = 0.0f;
     d_sum = 0.0;
     d_sumsq = 0.0;
     d_num = 0;
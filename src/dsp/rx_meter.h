@@ -24,6 +24,7 @@
 #define RX_METER_H
 
 #include <gnuradio/sync_block.h>
+#include <vector>
 
 enum detector_type_e {
     DETECTOR_TYPE_NONE   = 0,
@@ -35,6 +36,18 @@ enum detector_type_e {
 };
 
 
+/*! \brief All levels measured by rx_meter_c in one interval, in dBFS. */
+struct rx_meter_levels
+{
+    float   level;          /*!< Level of the selected detector type. */
+    float   peak;           /*!< Highest sample power. */
+    float   rms;            /*!< Root mean square of the sample power, as the RMS detector. */
+    float   min;            /*!< Lowest sample power. */
+    float   noise_floor;    /*!< Noise floor estimate (average power). */
+    float   snr;            /*!< Average power - noise_floor [dB]. */
+};
+
+
 class rx_meter_c;
 
 typedef boost::shared_ptr<rx_meter_c> rx_meter_c_sptr;
@@ -50,13 +63,18 @@ typedef boost::shared_ptr<rx_meter_c> rx_meter_c_sptr;
 rx_meter_c_sptr make_rx_meter_c(int detector=DETECTOR_TYPE_RMS);
 
 
-/*! \brief Block for measuring signal strength (complex input).
+/*! \brief Signal level meter.
  *  \ingroup DSP
  *
- * This block can be used to meausre the received signal strength.
- * For each group of samples received this block stores the maximum power level,
- * which then can be retrieved using the get_level() and get_level_db()
- * methods.
+ * All detectors are computed in a single pass over the input. The
+ * measurement interval is the time between two calls to get_level(),
+ * get_level_db() or get_levels(); each call starts a new interval.
+ *
+ * The noise floor is estimated by a histogram of the average power in
+ * short blocks of samples. The histogram decays exponentially and the
+ * noise floor is taken as a low percentile, so it follows the floor
+ * between transmissions without being pulled up by the signal. It can only
+ * tell the noise floor when the channel is not occupied all of the time.
  */
 class rx_meter_c : public gr::sync_block
 {
@@ -78,6 +96,9 @@ public:
     /*! \brief Get the current signal level in dBFS. */
     float get_level_db();
 
+    /*! \brief Get the levels of all detectors in dBFS. */
+    void get_levels(rx_meter_levels &levels);
+
     /*! \brief Enable or disable averaging.
      *  \param detector Detector type.
      */
@@ -90,13 +111,22 @@ public:
 
 private:
     int    d_detector;  /*! Detector type. */
-    float  d_level;     /*! The current level in the range 0.0 to 1.0 */
-    float  d_level_db;  /*! The current level in dBFS with FS = 1.0 */
-    float  d_sum;       /*! Sum of msamples. */
-    float  d_sumsq;     /*! Sum of samples squared. */
+    float  d_sample;    /*! Power of the last sample. */
+    float  d_min;       /*! Lowest sample power. */
+    float  d_max;       /*! Highest sample power. */
+    double d_sum;       /*! Sum of samples. */
+    double d_sumsq;     /*! Sum of samples squared. */
     int    d_num;       /*! Number of samples in d_sum and d_sumsq. */
 
-    void reset_stats();
+    /* noise floor estimator */
+    std::vector<float>  d_nf_hist;  /*! Histogram of block powers in dB. */
+    float  d_nf_total;  /*! Sum of d_nf_hist. */
+    float  d_nf_acc;    /*! Power accumulated in the current block. */
+    int    d_nf_cnt;    /*! Number of samples in d_nf_acc. */
+
+    float  level();
+    float  noise_floor() const;
+    void   reset_stats();
 };
 
 
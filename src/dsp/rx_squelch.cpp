@@ -0,0 +1,218 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <math.h>
+#include <algorithm>
+#include <gnuradio/io_signature.h>
+#include "dsp/rx_squelch.h"
+
+
+rx_sql_cc_sptr make_rx_sql_cc(double sample_rate, double threshold_db,
+                              double alpha)
+{
+    return gnuradio::get_initial_sptr(new rx_sql_cc(sample_rate, threshold_db,
+                                                    alpha));
+}
+
+rx_sql_cc::rx_sql_cc(double sample_rate, double threshold_db, double alpha)
+    : gr::block("rx_sql_cc",
+                gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                gr::io_signature::make(1, 1, sizeof(gr_complex))),
+      d_sample_rate(sample_rate),
+      d_attack_ms(0.0),
+      d_hang_ms(0.0),
+      d_gate(false),
+      d_pwr(0.0f),
+      d_open(false),
+      d_hang_samples(0),
+      d_hang_left(0),
+      d_ramp_step(1.0f),
+      d_gain(0.0f),
+      d_tag_key(pmt::intern(RX_SQL_TAG_KEY)),
+      d_tag_pending(true),
+      d_tag_interval(std::max(1, (int)(sample_rate / 10.0))),
+      d_tag_left(0),
+      d_open_count(0),
+      d_total_count(0)
+{
+    set_threshold(threshold_db);
+    set_alpha(alpha);
+}
+
+rx_sql_cc::~rx_sql_cc()
+{
+}
+
+void rx_sql_cc::forecast(int noutput_items, gr_vector_int &ninput_items_required)
+{
+    ninput_items_required[0] = noutput_items;
+}
+
+int rx_sql_cc::general_work(int noutput_items,
+                            gr_vector_int &ninput_items,
+                            gr_vector_const_void_star &input_items,
+                            gr_vector_void_star &output_items)
+{
+    const gr_complex *in = (const gr_complex *) input_items[0];
+    gr_complex *out = (gr_complex *) output_items[0];
+    int ninput = std::min(noutput_items, ninput_items[0]);
+    int nout = 0;
+    int nopen = 0;
+    bool was_open;
+
+    gr::thread::scoped_lock lock(d_setlock);
+
+    for (int i = 0; i < ninput; i++)
+    {
+        float mag_sqrd = in[i].real() * in[i].real() + in[i].imag() * in[i].imag();
+
+        was_open = d_open;
+
+        d_pwr += d_alpha * (mag_sqrd - d_pwr);
+
+        if (d_pwr >= d_threshold)
+        {
+            d_open = true;
+            d_hang_left = d_hang_samples;
+        }
+        else if (d_open)
+        {
+            if (d_hang_left > 0)
+                d_hang_left--;
+            else
+                d_open = false;
+        }
+
+        if (d_open != was_open)
+            d_tag_pending = true;
+
+        if (d_open)
+        {
+            nopen++;
+            d_gain = std::min(1.0f, d_gain + d_ramp_step);
+        }
+        else
+        {
+            d_gain = std::max(0.0f, d_gain - d_ramp_step);
+        }
+
+        // gate closed samples, but let the one carrying the closed tag through
+        if (d_gain <= 0.0f && d_gate && !d_tag_pending)
+            continue;
+
+        // tag the state on the sample where it changes
+        if (d_tag_pending || --d_tag_left <= 0)
+        {
+            add_item_tag(0, nitems_written(0) + nout, d_tag_key,
+                         pmt::from_bool(d_open));
+            d_tag_pending = false;
+            d_tag_left = d_tag_interval;
+        }
+
+        out[nout++] = (d_gain > 0.0f) ? in[i] * d_gain : gr_complex(0.0f, 0.0f);
+    }
+
+    d_open_count += nopen;
+    d_total_count += ninput;
+
+    consume_each(ninput);
+
+    return nout;
+}
+
+void rx_sql_cc::set_threshold(double threshold_db)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_threshold_db = threshold_db;
+    d_threshold = powf(10.0f, threshold_db / 10.0);
+}
+
+void rx_sql_cc::set_alpha(double alpha)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_alpha = alpha;
+}
+
+void rx_sql_cc::set_attack(double attack_ms)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    double samples = attack_ms * 1.0e-3 * d_sample_rate;
+
+    d_attack_ms = attack_ms;
+    d_ramp_step = samples > 1.0 ? 1.0 / samples : 1.0;
+}
+
+void rx_sql_cc::set_hang(double hang_ms)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_hang_ms = hang_ms;
+    d_hang_samples = (int)(hang_ms * 1.0e-3 * d_sample_rate);
+    if (d_hang_samples < 0)
+        d_hang_samples = 0;
+    if (d_hang_left > d_hang_samples)
+        d_hang_left = d_hang_samples;
+}
+
+void rx_sql_cc::set_gate(bool gate)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_gate = gate;
+}
+
+bool rx_sql_cc::is_open()
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    return d_open;
+}
+
+bool rx_sql_cc::has_signal()
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    return d_pwr >= d_threshold;
+}
+
+void rx_sql_cc::reset_power()
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_pwr = 0.0f;
+}
+
+float rx_sql_cc::get_duty_cycle()
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    float duty = d_total_count ? (float)d_open_count / (float)d_total_count :
+                                 (d_open ? 1.0f : 0.0f);
+
+    d_open_count = 0;
+    d_total_count = 0;
+
+    return duty;
+}
@@ -0,0 +1,157 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef RX_SQUELCH_H
+#define RX_SQUELCH_H
+
+#include <gnuradio/block.h>
+#include <gnuradio/gr_complex.h>
+#include <pmt/pmt.h>
+
+/*! Key of the stream tags with the squelch state. */
+#define RX_SQL_TAG_KEY "squelch"
+
+class rx_sql_cc;
+
+typedef boost::shared_ptr<rx_sql_cc> rx_sql_cc_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of rx_sql_cc.
+ *  \param sample_rate The sample rate, used for attack and hang times.
+ *  \param threshold_db Squelch threshold in dBFS.
+ *  \param alpha Power averaging constant.
+ *
+ * This is effectively the public constructor for a new squelch block.
+ * To avoid accidental use of raw pointers, the rx_sql_cc constructor is private.
+ * make_rx_sql_cc is the public interface for creating new instances.
+ */
+rx_sql_cc_sptr make_rx_sql_cc(double sample_rate, double threshold_db=-150.0,
+                              double alpha=0.001);
+
+
+/*! \brief Power squelch with attack, hang and optional gating.
+ *  \ingroup DSP
+ *
+ * The squelch opens as soon as the averaged power reaches the threshold and
+ * closes when it has been below the threshold for the hang time. The output
+ * is faded in over the attack time when the squelch opens and faded out
+ * over the same time when it closes, which avoids clicks.
+ *
+ * By default samples are zeroed while the squelch is closed, like
+ * gr::analog::simple_squelch_cc. In gate mode no samples are produced at
+ * all while the squelch is closed, so the AGC, demodulator, audio resampler
+ * and everything else downstream stay idle instead of processing silence.
+ * Sinks downstream must therefore tolerate gaps in the stream.
+ *
+ * The state is tagged on the output with the key RX_SQL_TAG_KEY and a
+ * boolean value when it changes and every 100 ms while samples are
+ * produced, so that sinks further down the chain, e.g. the audio recorder,
+ * can follow the squelch. In gate mode the sample on which the squelch
+ * closes is always let through, as silence if the fade out has already
+ * ended, so the closed tag reaches the sinks before the stream stops.
+ */
+class rx_sql_cc : public gr::block
+{
+    friend rx_sql_cc_sptr make_rx_sql_cc(double sample_rate, double threshold_db,
+                                         double alpha);
+
+protected:
+    rx_sql_cc(double sample_rate, double threshold_db, double alpha);
+
+public:
+    ~rx_sql_cc();
+
+    void forecast(int noutput_items, gr_vector_int &ninput_items_required);
+
+    int general_work(int noutput_items,
+                     gr_vector_int &ninput_items,
+                     gr_vector_const_void_star &input_items,
+                     gr_vector_void_star &output_items);
+
+    void set_threshold(double threshold_db);
+    double threshold() const { return d_threshold_db; }
+
+    void set_alpha(double alpha);
+    double alpha() const { return d_alpha; }
+
+    /*! \brief Set fade in/out time in milliseconds. */
+    void set_attack(double attack_ms);
+    double attack() const { return d_attack_ms; }
+
+    /*! \brief Set time in milliseconds the squelch stays open after the
+     *         signal has dropped below the threshold. */
+    void set_hang(double hang_ms);
+    double hang() const { return d_hang_ms; }
+
+    /*! \brief Enable or disable gate mode (no output while closed). */
+    void set_gate(bool gate);
+    bool gate() const { return d_gate; }
+
+    bool is_open();
+
+    /*! \brief Whether the averaged power is above the threshold right now.
+     *
+     * Unlike is_open() this ignores the hang time, so it tells when a
+     * signal has gone as soon as the power average has decayed.
+     */
+    bool has_signal();
+
+    /*! \brief Restart the power average, e.g. after the channel has moved.
+     *
+     * The average starts from zero, so a strong signal in the previous
+     * channel does not keep has_signal() true while the average decays.
+     */
+    void reset_power();
+
+    /*! \brief Get fraction of time the squelch has been open.
+     *
+     * Returns the duty cycle in the range 0.0 to 1.0 since the previous
+     * call to this function.
+     */
+    float get_duty_cycle();
+
+private:
+    double  d_sample_rate;
+    double  d_threshold_db;
+    double  d_alpha;
+    double  d_attack_ms;
+    double  d_hang_ms;
+    bool    d_gate;
+
+    float   d_threshold;    /*! Threshold as linear power. */
+    float   d_pwr;          /*! Averaged power. */
+    bool    d_open;         /*! Squelch state. */
+    int     d_hang_samples; /*! Hang time in samples. */
+    int     d_hang_left;    /*! Samples left until the squelch closes. */
+    float   d_ramp_step;    /*! Gain change per sample while fading. */
+    float   d_gain;         /*! Current output gain 0.0 to 1.0. */
+
+    pmt::pmt_t  d_tag_key;
+    bool    d_tag_pending;  /*! State changed but not tagged yet. */
+    int     d_tag_interval; /*! Samples between repeated state tags. */
+    int     d_tag_left;     /*! Output samples until the next state tag. */
+
+    unsigned long   d_open_count;   /*! Samples with the squelch open. */
+    unsigned long   d_total_count;  /*! Samples processed. */
+};
+
+#endif /* RX_SQUELCH_H */
@@ -0,0 +1,548 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <bitset>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/filter/firdes.h>
+#include "dsp/rx_tone_sql.h"
+
+#define DETECT_RATE         2000.0  /* Nominal detector sample rate. */
+#define STAGE1_RATE         8000.0  /* Nominal rate after first stage. */
+#define DETECT_PASS         260.0   /* Pass band edge of detector LPF. */
+#define DETECT_STOP         400.0   /* Stop band edge of detector LPF. */
+#define DC_CORNER           2.0     /* DC blocker corner frequency. */
+
+#define CTCSS_HOP_TIME      0.25    /* Goertzel block length in seconds. */
+#define CTCSS_HOPS          3       /* Blocks per analysis window (0.75 s). */
+#define CTCSS_OPEN_RATIO    0.20f   /* Fraction of energy needed to open. */
+#define CTCSS_HOLD_RATIO    0.05f   /* Fraction of energy needed to stay open. */
+#define CTCSS_CLOSE_HOPS    2       /* Missed evaluations before closing. */
+
+#define DCS_BITRATE         134.4f
+#define DCS_PLL_GAIN        0.3f
+#define DCS_MAX_ERRORS      2       /* Bit errors accepted per codeword. */
+#define DCS_OPEN_BITS       12      /* Consecutive matching bits to open. */
+#define DCS_CLOSE_BITS      30      /* Consecutive missing bits to close. */
+#define DCS_MASK            0x7FFFFF
+#define GOLAY_POLY          0xC75   /* x^11+x^10+x^6+x^5+x^4+x^2+1 */
+
+#define AUDIO_HPF_CORNER    300.0
+#define RAMP_TIME           0.005
+
+
+static const float ctcss_tbl[] = {
+     67.0f,  69.3f,  71.9f,  74.4f,  77.0f,  79.7f,  82.5f,  85.4f,  88.5f,
+     91.5f,  94.8f,  97.4f, 100.0f, 103.5f, 107.2f, 110.9f, 114.8f, 118.8f,
+    123.0f, 127.3f, 131.8f, 136.5f, 141.3f, 146.2f, 150.0f, 151.4f, 156.7f,
+    159.8f, 162.2f, 165.5f, 167.9f, 171.3f, 173.8f, 177.3f, 179.9f, 183.5f,
+    186.2f, 189.9f, 192.8f, 196.6f, 199.5f, 203.5f, 206.5f, 210.7f, 218.1f,
+    225.7f, 229.1f, 233.6f, 241.8f, 250.3f, 254.1f
+};
+
+
+rx_tone_sql_ff_sptr make_rx_tone_sql_ff(double sample_rate)
+{
+    return gnuradio::get_initial_sptr(new rx_tone_sql_ff(sample_rate));
+}
+
+rx_tone_sql_ff::rx_tone_sql_ff(double sample_rate)
+    : gr::sync_block("rx_tone_sql_ff",
+                     gr::io_signature::make(1, 1, sizeof(float)),
+                     gr::io_signature::make(1, 1, sizeof(float))),
+      d_sample_rate(sample_rate),
+      d_mode(TONE_OFF),
+      d_ctcss(0.0f),
+      d_dcs(0),
+      d_open(true),
+      d_gain(1.0f),
+      d_detected(0.0f),
+      d_tone_idx(-1),
+      d_dcs_reg(0)
+{
+    unsigned int    decim1, decim2;
+    double          rate1;
+
+    d_ramp_step = 1.0 / (RAMP_TIME * d_sample_rate);
+
+    /* Two stage decimation to about 2 kHz. The first stage only needs to
+     * protect the final pass band from aliasing so it is very short. */
+    decim1 = std::max(1, (int)(d_sample_rate / STAGE1_RATE + 0.5));
+    rate1 = d_sample_rate / decim1;
+    decim2 = std::max(1, (int)(rate1 / DETECT_RATE + 0.5));
+    d_dec_rate = rate1 / decim2;
+
+    d_stage1.init(decim1, gr::filter::firdes::low_pass(1.0, d_sample_rate,
+                                        0.5 * rate1,
+                                        rate1 - 2.0 * DETECT_PASS));
+    d_stage2.init(decim2, gr::filter::firdes::low_pass(1.0, rate1,
+                                        0.5 * (DETECT_PASS + DETECT_STOP),
+                                        DETECT_STOP - DETECT_PASS));
+
+    d_dc_alpha = 1.0 - 2.0 * M_PI * DC_CORNER / d_dec_rate;
+    d_hop_len = (unsigned int)(CTCSS_HOP_TIME * d_dec_rate);
+    d_dcs_step = DCS_BITRATE / d_dec_rate;
+
+    /* 4th order Butterworth high pass as two biquads */
+    const double q[2] = { 0.54119610, 1.30656296 };
+    double w0 = 2.0 * M_PI * AUDIO_HPF_CORNER / d_sample_rate;
+    for (int s = 0; s < 2; s++)
+    {
+        double alpha = sin(w0) / (2.0 * q[s]);
+        double a0 = 1.0 + alpha;
+
+        d_hp_b[s][0] = 0.5 * (1.0 + cos(w0)) / a0;
+        d_hp_b[s][1] = -(1.0 + cos(w0)) / a0;
+        d_hp_b[s][2] = d_hp_b[s][0];
+        d_hp_a[s][0] = 1.0;
+        d_hp_a[s][1] = -2.0 * cos(w0) / a0;
+        d_hp_a[s][2] = (1.0 - alpha) / a0;
+    }
+
+    d_hop_energy.resize(CTCSS_HOPS);
+    memset(d_dcs_words, 0, sizeof(d_dcs_words));
+    reset_detector();
+}
+
+rx_tone_sql_ff::~rx_tone_sql_ff()
+{
+}
+
+const std::vector<float> &rx_tone_sql_ff::ctcss_tones()
+{
+    static const std::vector<float> tones(ctcss_tbl, ctcss_tbl +
+                                          sizeof(ctcss_tbl) / sizeof(ctcss_tbl[0]));
+    return tones;
+}
+
+void rx_tone_sql_ff::decim_stage::init(unsigned int decimation,
+                                       const std::vector<float> &new_taps)
+{
+    taps = new_taps;
+    decim = decimation;
+    delay.resize(2 * taps.size());
+    reset();
+}
+
+void rx_tone_sql_ff::decim_stage::reset()
+{
+    std::fill(delay.begin(), delay.end(), 0.0f);
+    pos = 0;
+    cnt = 0;
+}
+
+/* Returns true when a new output sample is available in y. */
+bool rx_tone_sql_ff::decim_stage::push(float x, float &y)
+{
+    unsigned int ntaps = taps.size();
+
+    delay[pos] = x;
+    delay[pos + ntaps] = x;
+    if (++pos >= ntaps)
+        pos = 0;
+
+    if (++cnt < decim)
+        return false;
+
+    cnt = 0;
+
+    /* delay[pos] is the oldest sample; the taps are symmetric */
+    const float *d = &delay[pos];
+    float acc = 0.0f;
+    for (unsigned int k = 0; k < ntaps; k++)
+        acc += taps[k] * d[k];
+
+    y = acc;
+    return true;
+}
+
+int rx_tone_sql_ff::work(int noutput_items,
+                         gr_vector_const_void_star &input_items,
+                         gr_vector_void_star &output_items)
+{
+    const float *in = (const float *) input_items[0];
+    float *out = (float *) output_items[0];
+    float y1, y2;
+
+    gr::thread::scoped_lock lock(d_setlock);
+
+    if (d_mode == TONE_OFF)
+    {
+        memcpy(out, in, noutput_items * sizeof(float));
+        return noutput_items;
+    }
+
+    for (int i = 0; i < noutput_items; i++)
+    {
+        if (d_stage1.push(in[i], y1) && d_stage2.push(y1, y2))
+            process_decimated(y2);
+
+        /* remove the sub-audible band from the audio */
+        double v = in[i];
+        for (int s = 0; s < 2; s++)
+        {
+            double y = d_hp_b[s][0] * v + d_hp_z[s][0];
+            d_hp_z[s][0] = d_hp_b[s][1] * v - d_hp_a[s][1] * y + d_hp_z[s][1];
+            d_hp_z[s][1] = d_hp_b[s][2] * v - d_hp_a[s][2] * y;
+            v = y;
+        }
+
+        if (d_open)
+            d_gain = std::min(1.0f, d_gain + d_ramp_step);
+        else
+            d_gain = std::max(0.0f, d_gain - d_ramp_step);
+
+        out[i] = d_gain * (float)v;
+    }
+
+    return noutput_items;
+}
+
+/*! \brief Process one sample at the detector rate. */
+void rx_tone_sql_ff::process_decimated(float x)
+{
+    /* DC blocker, removes the offset caused by a frequency error */
+    float y = x - d_dc_x1 + d_dc_alpha * d_dc_y1;
+    d_dc_x1 = x;
+    d_dc_y1 = y;
+
+    if (d_mode == TONE_CTCSS)
+    {
+        unsigned int ntones = d_tones.size();
+
+        d_energy += y * y;
+        for (unsigned int k = 0; k < ntones; k++)
+        {
+            float s0 = y + d_coef[k] * d_s1[k] - d_s2[k];
+            d_s2[k] = d_s1[k];
+            d_s1[k] = s0;
+        }
+
+        if (++d_hop_cnt >= d_hop_len)
+            ctcss_evaluate();
+    }
+    else if (d_mode == TONE_DCS)
+    {
+        bool bit = (y > 0.0f);
+
+        /* transitions should occur half way between the sampling points */
+        if (bit != d_dcs_last)
+        {
+            d_dcs_last = bit;
+            d_dcs_phase += DCS_PLL_GAIN * (0.5f - d_dcs_phase);
+        }
+
+        d_dcs_phase += d_dcs_step;
+        if (d_dcs_phase >= 1.0f)
+        {
+            d_dcs_phase -= 1.0f;
+            dcs_bit(bit);
+        }
+    }
+}
+
+/*! \brief Evaluate the Goertzel bank at the end of a block.
+ *
+ * The frequency resolution of a block is the inverse of its length, 4 Hz
+ * for 250 ms, which is not enough for tones 1.4-2.5 Hz apart. The result of
+ * each block is therefore kept as a complex value, rotated to a common phase
+ * reference, and the last CTCSS_HOPS blocks are added up. This is the DFT of
+ * a 750 ms window (1.33 Hz resolution) that slides by one block, so the
+ * squelch state is still updated every 250 ms.
+ */
+void rx_tone_sql_ff::ctcss_evaluate()
+{
+    unsigned int ntones = d_tones.size();
+    float   best_pwr = 0.0f;
+    float   sel_pwr = 0.0f;
+    int     best = -1;
+    int     h;
+
+    for (unsigned int k = 0; k < ntones; k++)
+    {
+        /* DFT of this block relative to the sample index of the window */
+        float y_re = d_s1[k] - d_cos[k] * d_s2[k];
+        float y_im = d_sin[k] * d_s2[k];
+        float *hop_re = &d_hop_re[k * CTCSS_HOPS];
+        float *hop_im = &d_hop_im[k * CTCSS_HOPS];
+
+        hop_re[d_hop_idx] = d_rot_re[k] * y_re - d_rot_im[k] * y_im;
+        hop_im[d_hop_idx] = d_rot_re[k] * y_im + d_rot_im[k] * y_re;
+
+        /* advance phase reference to the start of the next block */
+        float rot_re = d_rot_re[k] * d_step_re[k] - d_rot_im[k] * d_step_im[k];
+        float rot_im = d_rot_re[k] * d_step_im[k] + d_rot_im[k] * d_step_re[k];
+        float mag = sqrtf(rot_re * rot_re + rot_im * rot_im);
+        d_rot_re[k] = rot_re / mag;
+        d_rot_im[k] = rot_im / mag;
+
+        float sum_re = 0.0f;
+        float sum_im = 0.0f;
+        for (h = 0; h < CTCSS_HOPS; h++)
+        {
+            sum_re += hop_re[h];
+            sum_im += hop_im[h];
+        }
+
+        float pwr = sum_re * sum_re + sum_im * sum_im;
+        if (pwr > best_pwr)
+        {
+            best_pwr = pwr;
+            best = k;
+        }
+        if ((int)k == d_tone_idx)
+            sel_pwr = pwr;
+
+        d_s1[k] = 0.0f;
+        d_s2[k] = 0.0f;
+    }
+
+    d_hop_energy[d_hop_idx] = d_energy;
+    d_hop_idx = (d_hop_idx + 1) % CTCSS_HOPS;
+    d_energy = 0.0f;
+    d_hop_cnt = 0;
+
+    /* do not decide on a partial window, its resolution is too low */
+    if (d_hops < CTCSS_HOPS)
+    {
+        d_hops++;
+        if (d_hops < CTCSS_HOPS)
+            return;
+    }
+
+    /* a pure tone gives a normalized power of 1.0 */
+    float energy = 0.0f;
+    for (h = 0; h < CTCSS_HOPS; h++)
+        energy += d_hop_energy[h];
+
+    float norm = 0.5f * energy * (d_hop_len * CTCSS_HOPS);
+    float best_ratio = norm > 0.0f ? best_pwr / norm : 0.0f;
+    float sel_ratio = norm > 0.0f ? sel_pwr / norm : 0.0f;
+
+    d_detected = (best_ratio >= CTCSS_OPEN_RATIO) ? d_tones[best] : 0.0f;
+
+    if (best == d_tone_idx && best_ratio >= CTCSS_OPEN_RATIO)
+    {
+        d_open = true;
+        d_misses = 0;
+    }
+    else if (d_open && sel_ratio >= CTCSS_HOLD_RATIO)
+    {
+        /* speech may temporarily mask the tone */
+        d_misses = 0;
+    }
+    else if (++d_misses >= CTCSS_CLOSE_HOPS)
+    {
+        d_open = false;
+    }
+}
+
+/*! \brief Shift in a new DCS bit and correlate with the expected code. */
+void rx_tone_sql_ff::dcs_bit(bool bit)
+{
+    /* codewords are sent LSB first */
+    d_dcs_reg = (d_dcs_reg >> 1) | (bit ? (1u << 22) : 0);
+
+    bool match = false;
+    for (int i = 0; i < 46 && !match; i++)
+        match = (std::bitset<23>(d_dcs_reg ^ d_dcs_words[i]).count() <= DCS_MAX_ERRORS);
+
+    if (match)
+    {
+        d_dcs_misses = 0;
+        if (d_dcs_hits < DCS_OPEN_BITS)
+            d_dcs_hits++;
+        if (d_dcs_hits >= DCS_OPEN_BITS)
+            d_open = true;
+    }
+    else
+    {
+        d_dcs_hits = 0;
+        if (d_open && ++d_dcs_misses >= DCS_CLOSE_BITS)
+            d_open = false;
+    }
+}
+
+/*! \brief Calculate the 23 bit DCS codeword.
+ *  \param code_oct The 9 bit code, i.e. the three octal digits.
+ *
+ * The 12 data bits are the code followed by the fixed pattern 100. The
+ * remaining 11 bits are the parity of the (23,12) Golay code. Since the
+ * code is cyclic and the word is sent repeatedly, the receiver matches all
+ * rotations and the exact placement of the parity bits does not matter.
+ */
+unsigned int rx_tone_sql_ff::dcs_codeword(int code_oct)
+{
+    unsigned int data = (code_oct & 0x1FF) | 0x800;
+    unsigned int rem = data << 11;
+
+    for (int i = 22; i >= 11; i--)
+        if (rem & (1u << i))
+            rem ^= GOLAY_POLY << (i - 11);
+
+    return (data << 11) | rem;
+}
+
+void rx_tone_sql_ff::reset_detector()
+{
+    d_stage1.reset();
+    d_stage2.reset();
+    d_dc_x1 = 0.0f;
+    d_dc_y1 = 0.0f;
+
+    std::fill(d_s1.begin(), d_s1.end(), 0.0f);
+    std::fill(d_s2.begin(), d_s2.end(), 0.0f);
+    std::fill(d_rot_re.begin(), d_rot_re.end(), 1.0f);
+    std::fill(d_rot_im.begin(), d_rot_im.end(), 0.0f);
+    std::fill(d_hop_re.begin(), d_hop_re.end(), 0.0f);
+    std::fill(d_hop_im.begin(), d_hop_im.end(), 0.0f);
+    std::fill(d_hop_energy.begin(), d_hop_energy.end(), 0.0f);
+    d_hop_idx = 0;
+    d_hops = 0;
+    d_hop_cnt = 0;
+    d_energy = 0.0f;
+    d_misses = 0;
+    d_detected = 0.0f;
+
+    d_dcs_phase = 0.0f;
+    d_dcs_last = false;
+    d_dcs_hits = 0;
+    d_dcs_misses = 0;
+
+    memset(d_hp_z, 0, sizeof(d_hp_z));
+
+    /* start closed; opens within one detection period */
+    d_open = (d_mode == TONE_OFF);
+    d_gain = d_open ? 1.0f : 0.0f;
+}
+
+void rx_tone_sql_ff::set_ctcss(float tone_hz)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    if (tone_hz <= 0.0f)
+    {
+        if (d_mode == TONE_CTCSS)
+            d_mode = TONE_OFF;
+        d_ctcss = 0.0f;
+        reset_detector();
+        return;
+    }
+
+    d_mode = TONE_CTCSS;
+    d_ctcss = tone_hz;
+    d_dcs = 0;
+
+    d_tones = ctcss_tones();
+    d_tone_idx = -1;
+    for (unsigned int k = 0; k < d_tones.size(); k++)
+        if (fabsf(d_tones[k] - tone_hz) < 0.05f)
+            d_tone_idx = k;
+
+    if (d_tone_idx < 0)
+    {
+        d_tones.push_back(tone_hz);
+        d_tone_idx = d_tones.size() - 1;
+    }
+
+    unsigned int ntones = d_tones.size();
+
+    d_coef.resize(ntones);
+    d_cos.resize(ntones);
+    d_sin.resize(ntones);
+    d_step_re.resize(ntones);
+    d_step_im.resize(ntones);
+    d_rot_re.resize(ntones);
+    d_rot_im.resize(ntones);
+    d_hop_re.resize(ntones * CTCSS_HOPS);
+    d_hop_im.resize(ntones * CTCSS_HOPS);
+    d_s1.resize(ntones);
+    d_s2.resize(ntones);
+    for (unsigned int k = 0; k < ntones; k++)
+    {
+        double w = 2.0 * M_PI * d_tones[k] / d_dec_rate;
+
+        d_coef[k] = 2.0 * cos(w);
+        d_cos[k] = cos(w);
+        d_sin[k] = sin(w);
+        d_step_re[k] = cos(w * d_hop_len);
+        d_step_im[k] = -sin(w * d_hop_len);
+    }
+
+    reset_detector();
+}
+
+bool rx_tone_sql_ff::set_dcs(int code)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    if (code <= 0)
+    {
+        if (d_mode == TONE_DCS)
+            d_mode = TONE_OFF;
+        d_dcs = 0;
+        reset_detector();
+        return true;
+    }
+
+    /* code is given as octal digits written in decimal, e.g. 23 = D023 */
+    int code_oct = 0;
+    int shift = 0;
+    for (int c = code; c > 0; c /= 10, shift += 3)
+    {
+        if (c % 10 > 7 || shift > 6)
+            return false;
+        code_oct |= (c % 10) << shift;
+    }
+
+    d_mode = TONE_DCS;
+    d_dcs = code;
+    d_ctcss = 0.0f;
+
+    unsigned int cw = dcs_codeword(code_oct);
+    for (int r = 0; r < 23; r++)
+    {
+        unsigned int rot = ((cw << r) | (cw >> (23 - r))) & DCS_MASK;
+        d_dcs_words[r] = rot;
+        d_dcs_words[23 + r] = ~rot & DCS_MASK;
+    }
+
+    reset_detector();
+
+    return true;
+}
+
+bool rx_tone_sql_ff::is_open()
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    return d_open;
+}
+
+float rx_tone_sql_ff::get_detected_tone()
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    return d_detected;
+}
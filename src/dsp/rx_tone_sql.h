@@ -0,0 +1,203 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef RX_TONE_SQL_H
+#define RX_TONE_SQL_H
+
+#include <vector>
+#include <gnuradio/sync_block.h>
+
+class rx_tone_sql_ff;
+
+typedef boost::shared_ptr<rx_tone_sql_ff> rx_tone_sql_ff_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of rx_tone_sql_ff.
+ *  \param sample_rate The sample rate of the demodulated audio.
+ *
+ * This is effectively the public constructor for a new tone squelch block.
+ * To avoid accidental use of raw pointers, the rx_tone_sql_ff constructor is
+ * private. make_rx_tone_sql_ff is the public interface for creating new
+ * instances.
+ */
+rx_tone_sql_ff_sptr make_rx_tone_sql_ff(double sample_rate);
+
+
+/*! \brief CTCSS and DCS tone squelch.
+ *  \ingroup DSP
+ *
+ * The block takes the FM demodulator output and passes it through while the
+ * selected sub-audible tone or DCS code is present, otherwise it outputs
+ * silence. The sub-audible band is removed from the audio with a 300 Hz
+ * 4th order high pass filter while tone squelch is enabled. It runs at the
+ * full audio rate (two biquads per sample) and, together with the first
+ * decimator stage, is most of the cost of this block.
+ *
+ * Detection runs on a copy of the input that is low pass filtered and
+ * decimated to about 2 kHz:
+ *
+ *  - CTCSS: A bank of Goertzel filters, one per standard tone, is evaluated
+ *    over a 750 ms window that slides in steps of 250 ms. The window gives
+ *    a resolution of 1.33 Hz, enough to tell adjacent standard tones apart,
+ *    the closest being 1.4 Hz apart. The tone is considered present when its
+ *    filter is the strongest of the bank and holds a sufficient fraction of
+ *    the energy in the sub-audible band. The squelch therefore opens about
+ *    0.75-1 s after the tone appears.
+ *  - DCS: The 134.4 bit/s NRZ signal is sliced and clocked using a simple
+ *    bit synchronizer. Every new bit the last 23 bits are correlated with
+ *    all rotations of the expected Golay codeword and its complement, so
+ *    both signal polarities are accepted.
+ *
+ * When tone squelch is disabled the input is copied to the output and no
+ * detection is performed.
+ */
+class rx_tone_sql_ff : public gr::sync_block
+{
+    friend rx_tone_sql_ff_sptr make_rx_tone_sql_ff(double sample_rate);
+
+protected:
+    rx_tone_sql_ff(double sample_rate);
+
+public:
+    ~rx_tone_sql_ff();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    /*! \brief Select CTCSS tone.
+     *  \param tone_hz The tone frequency in Hz. 0 disables CTCSS squelch.
+     *
+     * Selecting a CTCSS tone disables DCS squelch. Non-standard tones are
+     * accepted and added to the detector bank.
+     */
+    void set_ctcss(float tone_hz);
+    float ctcss() const { return d_ctcss; }
+
+    /*! \brief Select DCS code.
+     *  \param code The DCS code written as a decimal number, e.g. 23 for
+     *              D023. 0 disables DCS squelch.
+     *  \returns False if the code is invalid.
+     *
+     * Selecting a DCS code disables CTCSS squelch.
+     */
+    bool set_dcs(int code);
+    int dcs() const { return d_dcs; }
+
+    /*! \brief Whether the tone squelch is open.
+     *
+     * Always true when tone squelch is disabled.
+     */
+    bool is_open();
+
+    /*! \brief Get the strongest CTCSS tone in Hz, 0 if none is detected. */
+    float get_detected_tone();
+
+    /*! \brief Standard CTCSS tones in Hz. */
+    static const std::vector<float> &ctcss_tones();
+
+private:
+    enum tone_mode {
+        TONE_OFF   = 0,
+        TONE_CTCSS = 1,
+        TONE_DCS   = 2
+    };
+
+    void reset_detector();
+    void process_decimated(float x);
+    void ctcss_evaluate();
+    void dcs_bit(bool bit);
+    static unsigned int dcs_codeword(int code_oct);
+
+    double      d_sample_rate;
+    tone_mode   d_mode;
+    float       d_ctcss;        /*! Selected CTCSS tone. */
+    int         d_dcs;          /*! Selected DCS code. */
+    bool        d_open;         /*! Tone squelch state. */
+    float       d_gain;         /*! Current audio gain 0.0 to 1.0. */
+    float       d_ramp_step;    /*! Gain change per sample. */
+    float       d_detected;     /*! Strongest CTCSS tone. */
+
+    /*! \brief FIR decimator stage.
+     *
+     * The filter is only evaluated once per output sample. The delay line
+     * is stored twice so the most recent samples are always contiguous.
+     */
+    struct decim_stage
+    {
+        std::vector<float>  taps;
+        std::vector<float>  delay;
+        unsigned int        pos;
+        unsigned int        decim;
+        unsigned int        cnt;
+
+        void init(unsigned int decimation, const std::vector<float> &new_taps);
+        void reset();
+        bool push(float x, float &y);
+    };
+
+    /* low pass filter and decimation in front of the detectors */
+    decim_stage         d_stage1;
+    decim_stage         d_stage2;
+    double              d_dec_rate;
+    float               d_dc_x1;    /*! DC blocker state. */
+    float               d_dc_y1;
+    float               d_dc_alpha;
+
+    /* Goertzel bank */
+    std::vector<float>  d_tones;
+    std::vector<float>  d_coef;
+    std::vector<float>  d_cos;
+    std::vector<float>  d_sin;
+    std::vector<float>  d_s1;
+    std::vector<float>  d_s2;
+    std::vector<float>  d_step_re;      /*! Phase advance per block. */
+    std::vector<float>  d_step_im;
+    std::vector<float>  d_rot_re;       /*! Phase of current block in window. */
+    std::vector<float>  d_rot_im;
+    std::vector<float>  d_hop_re;       /*! Block results, CTCSS_HOPS per tone. */
+    std::vector<float>  d_hop_im;
+    std::vector<float>  d_hop_energy;   /*! Input energy of each block. */
+    int                 d_hop_idx;      /*! Oldest block in the window. */
+    int                 d_hops;         /*! Number of valid blocks. */
+    int                 d_tone_idx;     /*! Index of selected tone in bank. */
+    unsigned int        d_hop_len;
+    unsigned int        d_hop_cnt;
+    float               d_energy;
+    int                 d_misses;
+
+    /* DCS */
+    unsigned int        d_dcs_words[46];    /*! All rotations, both polarities. */
+    unsigned int        d_dcs_reg;
+    float               d_dcs_phase;
+    float               d_dcs_step;
+    bool                d_dcs_last;
+    int                 d_dcs_hits;
+    int                 d_dcs_misses;
+
+    /* high pass filter removing the sub-audible band from the audio */
+    double              d_hp_b[2][3];
+    double              d_hp_a[2][3];
+    double              d_hp_z[2][2];
+};
+
+#endif /* RX_TONE_SQL_H */
@@ -0,0 +1,149 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <boost/atomic.hpp>
+
+
+/*! \brief Lock-free single producer, single consumer ring buffer.
+ *  \ingroup DSP
+ *
+ * One thread writes and one other thread reads without taking any locks.
+ * The reader accesses the samples in place through read_span() and releases
+ * them with consume(), so no copy is made on the reading side.
+ *
+ * The writer never overwrites unread samples. Samples that do not fit are
+ * dropped and counted, and the reader can check overruns() and dropped() to
+ * see whether it kept up.
+ *
+ * The capacity is rounded up to a power of two. The read and write counters
+ * run freely and are masked when used as indices.
+ */
+template <class T>
+class spsc_ring
+{
+public:
+    explicit spsc_ring(unsigned int size)
+        : d_head(0), d_tail(0), d_overruns(0), d_dropped(0)
+    {
+        unsigned int cap = 1;
+
+        while (cap < size)
+            cap <<= 1;
+        d_buf.resize(cap);
+        d_mask = cap - 1;
+    }
+
+    /*! \brief Write samples (producer side).
+     *  \param data The samples to write.
+     *  \param num The number of samples.
+     *  \returns The number of samples written. The rest are dropped.
+     */
+    unsigned int write(const T *data, unsigned int num)
+    {
+        size_t head = d_head.load(boost::memory_order_relaxed);
+        size_t tail = d_tail.load(boost::memory_order_acquire);
+        unsigned int space = d_buf.size() - (unsigned int)(head - tail);
+        unsigned int n = std::min(num, space);
+        unsigned int idx = head & d_mask;
+        unsigned int n1 = std::min(n, (unsigned int)d_buf.size() - idx);
+
+        memcpy(&d_buf[idx], data, n1 * sizeof(T));
+        memcpy(&d_buf[0], data + n1, (n - n1) * sizeof(T));
+        d_head.store(head + n, boost::memory_order_release);
+
+        if (n < num)
+        {
+            d_overruns.fetch_add(1, boost::memory_order_relaxed);
+            d_dropped.fetch_add(num - n, boost::memory_order_relaxed);
+        }
+
+        return n;
+    }
+
+    /*! \brief Get the oldest unread samples (consumer side).
+     *  \param data Set to point at the first unread sample.
+     *  \returns The number of samples that can be read contiguously.
+     *
+     * When the unread samples wrap around the end of the buffer only the
+     * first part is returned. Call consume() and read_span() again to get
+     * the rest.
+     */
+    unsigned int read_span(const T **data)
+    {
+        size_t tail = d_tail.load(boost::memory_order_relaxed);
+        size_t head = d_head.load(boost::memory_order_acquire);
+        unsigned int avail = (unsigned int)(head - tail);
+        unsigned int idx = tail & d_mask;
+
+        *data = &d_buf[idx];
+
+        return std::min(avail, (unsigned int)d_buf.size() - idx);
+    }
+
+    /*! \brief Release samples returned by read_span() (consumer side). */
+    void consume(unsigned int num)
+    {
+        size_t tail = d_tail.load(boost::memory_order_relaxed);
+
+        d_tail.store(tail + num, boost::memory_order_release);
+    }
+
+    /*! \brief Number of unread samples. */
+    unsigned int available() const
+    {
+        return (unsigned int)(d_head.load(boost::memory_order_acquire) -
+                              d_tail.load(boost::memory_order_acquire));
+    }
+
+    unsigned int capacity() const { return d_buf.size(); }
+
+    /*! \brief Number of writes that did not fit in the buffer. */
+    unsigned long overruns() const
+    {
+        return d_overruns.load(boost::memory_order_relaxed);
+    }
+
+    /*! \brief Number of samples dropped because the buffer was full. */
+    unsigned long dropped() const
+    {
+        return d_dropped.load(boost::memory_order_relaxed);
+    }
+
+private:
+    spsc_ring(const spsc_ring &);
+    spsc_ring &operator=(const spsc_ring &);
+
+    std::vector<T>              d_buf;
+    size_t                      d_mask;
+    boost::atomic<size_t>       d_head;     /*!< Samples written. */
+    boost::atomic<size_t>       d_tail;     /*!< Samples read. */
+    boost::atomic<unsigned long> d_overruns;
+    boost::atomic<unsigned long> d_dropped;
+};
+
+#endif // SPSC_RING_H
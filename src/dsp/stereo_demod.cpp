@@ -22,17 +22,22 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <gnuradio/io_signature.h>
+#include <gnuradio/math.h>
+#include <gnuradio/filter/firdes.h>
 #include <math.h>
 #include <iostream>
+#include <stdexcept>
+#include <dsp/resampler_xx.h>
 #include <dsp/stereo_demod.h>
 
 
 /* Create a new instance of stereo_demod and return a boost shared_ptr. */
 stereo_demod_sptr make_stereo_demod(float quad_rate, float audio_rate,
-                                    bool stereo, bool oirt)
+                                    bool stereo, bool oirt, double tau)
 {
     return gnuradio::get_initial_sptr(new stereo_demod(quad_rate,
-                                                       audio_rate, stereo, oirt));
+                                                       audio_rate, stereo, oirt,
+                                                       tau));
 }
 
 
@@ -41,124 +46,84 @@ static const int MAX_IN  = 1; /* Maximum number of input streams. */
 static const int MIN_OUT = 2; /* Minimum number of output streams. */
 static const int MAX_OUT = 2; /* Maximum number of output streams. */
 
-#define STEREO_DEMOD_PARANOIC
+#define STEREO_DELTA_GAIN   2.0f    /* L-R subcarrier demodulation gain */
+#define PILOT_LPF_CUTOFF    500.0   /* Pilot low pass cutoff [Hz] */
+#define PLL_LOOP_BW         0.001f  /* PLL loop bandwidth [rad/sample], FIXME */
 
 /*! \brief Create stereo demodulator object.
  *
  * Use make_stereo_demod() instead.
  */
-stereo_demod::stereo_demod(float input_rate, float audio_rate, bool stereo, bool oirt)
-    : gr::hier_block2("stereo_demod",
-                     gr::io_signature::make (MIN_IN,  MAX_IN,  sizeof (float)),
-                     gr::io_signature::make (MIN_OUT, MAX_OUT, sizeof (float))),
+stereo_demod::stereo_demod(float input_rate, float audio_rate, bool stereo, bool oirt,
+                           double tau)
+    : gr::block("stereo_demod",
+                gr::io_signature::make (MIN_IN,  MAX_IN,  sizeof (float)),
+                gr::io_signature::make (MIN_OUT, MAX_OUT, sizeof (float))),
     d_input_rate(input_rate),
     d_audio_rate(audio_rate),
     d_stereo(stereo),
-    d_oirt(oirt)
+    d_oirt(oirt),
+    d_phase(0),
+    d_pll_phase(0.0f),
+    d_pll_freq(0.0f),
+    d_tau(-1.0)
 {
-  double cutof_freq = d_oirt ? 15e3 : 17e3;
-  lpf0 = make_lpf_ff(d_input_rate, cutof_freq, 2e3); // FIXME
-  audio_rr0 = make_resampler_ff(d_audio_rate/d_input_rate);
+    resampler_plan plan = resampler_plan::make((double)d_audio_rate / (double)d_input_rate);
+    if (plan.kind == resampler_plan::RESAMPLER_ARB)
+        throw std::range_error("Stereo decoder requires a rational resampling ratio");
 
-  if (d_stereo)
-  {
-    lpf1 = make_lpf_ff(d_input_rate, cutof_freq, 2e3); // FIXME
-    audio_rr1 = make_resampler_ff(d_audio_rate/d_input_rate);
+    d_interp = plan.interp;
+    d_decim = plan.decim;
+
+    /* Audio low pass designed at the interpolated rate; gain compensates
+     * for the zero stuffing. Cutoff is below the pilot / OIRT subcarrier.
+     */
+    double cutof_freq = d_oirt ? 15e3 : 17e3;
+    std::vector<float> taps = gr::filter::firdes::low_pass(d_interp,
+                                                           d_input_rate * d_interp,
+                                                           cutof_freq, 2e3);
+
+    /* Split into polyphase branches. Each branch is stored in reverse
+     * order so that the filter is a forward dot product over the history.
+     */
+    d_ntaps = (taps.size() + d_interp - 1) / d_interp;
+    d_taps.assign(d_interp * d_ntaps, 0.0f);
+    for (unsigned int p = 0; p < d_interp; p++)
+        for (unsigned int j = 0; j < d_ntaps; j++)
+            if (p + j * d_interp < taps.size())
+                d_taps[p * d_ntaps + (d_ntaps - 1 - j)] = taps[p + j * d_interp];
+
+    d_sum.assign(d_ntaps - 1, 0.0f);
+    d_diff.assign(d_ntaps - 1, 0.0f);
+    d_base = d_ntaps - 1;
+
+    /* pilot PLL, same loop parameters as gr::analog::pll_refout_cc */
+    float damping = sqrtf(2.0f) / 2.0f;
+    float denom = 1.0f + 2.0f * damping * PLL_LOOP_BW + PLL_LOOP_BW * PLL_LOOP_BW;
+    d_pll_alpha = (4.0f * damping * PLL_LOOP_BW) / denom;
+    d_pll_beta = (4.0f * PLL_LOOP_BW * PLL_LOOP_BW) / denom;
 
     if (!d_oirt)
     {
-        d_tone_taps = gr::filter::firdes::complex_band_pass(
-                                       1.0,          // gain,
-		                                   d_input_rate, // sampling_freq
-                                       18800.,       // low_cutoff_freq
-                                       19200.,       // high_cutoff_freq
-                                       300.);        // transition_width
-        pll = gr::analog::pll_refout_cc::make(0.001,    // loop_bw FIXME
-                                2*M_PI * 19200 / input_rate,  // max_freq
-                                2*M_PI * 18800 / input_rate); // min_freq
-        subtone = gr::blocks::multiply_cc::make();
-    } else {
-        d_tone_taps = gr::filter::firdes::complex_band_pass(
-                                       1.0,          // gain,
-                                           d_input_rate, // sampling_freq
-                                       31200.,       // low_cutoff_freq
-                                       31300.,       // high_cutoff_freq
-                                       100.);        // transition_width
-        pll = gr::analog::pll_refout_cc::make(0.001,    // loop_bw FIXME
-                                2*M_PI * 31200 / input_rate,  // max_freq
-                                2*M_PI * 31300 / input_rate); // min_freq
+        d_pll_min_freq = 2.0f * M_PI * 18800.0f / d_input_rate;
+        d_pll_max_freq = 2.0f * M_PI * 19200.0f / d_input_rate;
     }
+    else
+    {
+        d_pll_min_freq = 2.0f * M_PI * 31200.0f / d_input_rate;
+        d_pll_max_freq = 2.0f * M_PI * 31300.0f / d_input_rate;
+    }
+    d_pll_freq = 0.5f * (d_pll_min_freq + d_pll_max_freq);
+
+    d_iir_alpha = 1.0f - expf(-2.0f * M_PI * PILOT_LPF_CUTOFF / d_input_rate);
+    d_iir_i[0] = d_iir_i[1] = 0.0f;
+    d_iir_q[0] = d_iir_q[1] = 0.0f;
 
-    tone = gr::filter::fir_filter_fcc::make(1, d_tone_taps);
-
-    lo = gr::blocks::complex_to_imag::make();
-
-#ifdef STEREO_DEMOD_PARANOIC
-    d_pll_taps = gr::filter::firdes::band_pass(
-                                       1.0,          // gain,
-		                                   d_input_rate, // sampling_freq
-                                       37600.,       // low_cutoff_freq
-                                       38400.,       // high_cutoff_freq
-                                       400.);        // transition_width
-    lo2 = gr::filter::fir_filter_fff::make(1, d_pll_taps);
-#endif
-
-    mixer = gr::blocks::multiply_ff::make();
-
-    cdp = gr::blocks::multiply_const_ff::make( 5.5); // FIXME
-    cdm = gr::blocks::multiply_const_ff::make(-5.5); // FIXME
-
-    add0 = gr::blocks::add_ff::make();
-    add1 = gr::blocks::add_ff::make();
-
-    /* connect block */
-    if (!d_oirt) {
-        connect(self(), 0, tone, 0);
-        connect(tone, 0, pll, 0);
-        connect(pll, 0, subtone, 0);
-        connect(pll, 0, subtone, 1);
-        connect(subtone, 0, lo, 0);
-    
-#ifdef STEREO_DEMOD_PARANOIC
-        connect(lo,  0, lo2, 0);
-        connect(lo2, 0, mixer, 0);
-#else
-        connect(lo, 0, mixer, 0);
-#endif
-    } else {
-        connect(self(), 0, tone, 0);
-        connect(tone, 0, pll, 0);
-        connect(pll, 0, lo, 0);
-        connect(lo, 0, mixer, 0);
-    } 
-
-    connect(self(), 0, mixer, 1);
-
-    connect(self(), 0, lpf0, 0);
-    connect(mixer,  0, lpf1, 0);
-
-    connect(lpf0, 0, audio_rr0, 0); // sum
-    connect(lpf1, 0, audio_rr1, 0);
-
-    connect(audio_rr1, 0, cdp,  0); // +delta
-    connect(audio_rr1, 0, cdm,  0); // -delta
-
-    connect(audio_rr0, 0, add0,   0);
-    connect(cdp,       0, add0,   1);
-    connect(add0,      0, self(), 0); // left = sum + delta
-
-    connect(audio_rr0, 0, add1,   0);
-    connect(cdm,       0, add1,   1);
-    connect(add1,      0, self(), 1); // right = sum + delta
-  }
-  else // if (!d_stereo)
-  {
-    /* connect block */
-    connect(self(), 0, lpf0, 0);
-    connect(lpf0,   0, audio_rr0, 0);
-    connect(audio_rr0, 0, self(), 0);
-    connect(audio_rr0, 0, self(), 1);
-  }
+    d_deemph_x[0] = d_deemph_x[1] = 0.0f;
+    d_deemph_y[0] = d_deemph_y[1] = 0.0f;
+    set_tau(tau);
+
+    set_relative_rate((double)d_interp / (double)d_decim);
 }
 
 
@@ -167,3 +132,157 @@ stereo_demod::~stereo_demod()
 
 }
 
+/*! \brief Set FM de-emphasis time constant.
+ *  \param tau The new time constant, 0 to disable de-emphasis.
+ */
+void stereo_demod::set_tau(double tau)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    if (tau == d_tau)
+        return;
+
+    d_tau = tau;
+
+    if (tau < 1.0e-9)
+    {
+        d_deemph_b0 = 1.0f;
+        d_deemph_b1 = 0.0f;
+        d_deemph_a1 = 0.0f;
+        return;
+    }
+
+    /* same bilinear transform as used in rx_demod_fm */
+    double fs = d_audio_rate;
+    double w_c = 1.0 / tau;
+    double w_ca = 2.0 * fs * tan(w_c / (2.0 * fs));
+    double k = -w_ca / (2.0 * fs);
+    double p1 = (1.0 + k) / (1.0 - k);
+    double b0 = -k / (1.0 - k);
+
+    d_deemph_b0 = b0;
+    d_deemph_b1 = b0;
+    d_deemph_a1 = p1;
+}
+
+void stereo_demod::forecast(int noutput_items, gr_vector_int &ninput_items_required)
+{
+    ninput_items_required[0] = (noutput_items * d_decim) / d_interp + 1;
+}
+
+/*! \brief Run the pilot PLL for one input sample.
+ *  \returns The regenerated L-R subcarrier.
+ */
+inline float stereo_demod::pll_step(float x)
+{
+    float s = sinf(d_pll_phase);
+    float c = cosf(d_pll_phase);
+
+    /* mix pilot down to DC and low pass */
+    d_iir_i[0] += d_iir_alpha * ( x * c - d_iir_i[0]);
+    d_iir_q[0] += d_iir_alpha * (-x * s - d_iir_q[0]);
+    d_iir_i[1] += d_iir_alpha * (d_iir_i[0] - d_iir_i[1]);
+    d_iir_q[1] += d_iir_alpha * (d_iir_q[0] - d_iir_q[1]);
+
+    float err = gr::fast_atan2f(d_iir_q[1], d_iir_i[1]);
+
+    d_pll_freq += d_pll_beta * err;
+    if (d_pll_freq > d_pll_max_freq)
+        d_pll_freq = d_pll_max_freq;
+    else if (d_pll_freq < d_pll_min_freq)
+        d_pll_freq = d_pll_min_freq;
+
+    d_pll_phase += d_pll_freq + d_pll_alpha * err;
+    while (d_pll_phase > M_PI)
+        d_pll_phase -= 2.0f * M_PI;
+    while (d_pll_phase < -M_PI)
+        d_pll_phase += 2.0f * M_PI;
+
+    /* The PLL locks 90 degrees behind the sine pilot, i.e. pilot = cos(phi).
+     * 38 kHz: sin(2 * (phi + pi/2)) = -sin(2 * phi).
+     * OIRT: the subcarrier itself is the reference, in phase with cos(phi).
+     */
+    return d_oirt ? c : -2.0f * s * c;
+}
+
+int stereo_demod::general_work(int noutput_items,
+                               gr_vector_int &ninput_items,
+                               gr_vector_const_void_star &input_items,
+                               gr_vector_void_star &output_items)
+{
+    const float *in = (const float *) input_items[0];
+    float *left = (float *) output_items[0];
+    float *right = (float *) output_items[1];
+
+    gr::thread::scoped_lock lock(d_setlock);
+
+    /* number of input samples needed to produce noutput_items */
+    unsigned int last = d_base + (d_phase + (noutput_items - 1) * d_decim) / d_interp;
+    unsigned int have = d_sum.size();
+    int nin = last + 1 > have ? last + 1 - have : 0;
+    if (nin > ninput_items[0])
+        nin = ninput_items[0];
+
+    d_sum.resize(have + nin);
+    d_diff.resize(have + nin);
+    for (int i = 0; i < nin; i++)
+    {
+        d_sum[have + i] = in[i];
+        if (d_stereo)
+            d_diff[have + i] = in[i] * pll_step(in[i]);
+    }
+
+    int nout = 0;
+    while (nout < noutput_items && d_base < d_sum.size())
+    {
+        const float *h = &d_taps[d_phase * d_ntaps];
+        const float *xs = &d_sum[d_base + 1 - d_ntaps];
+        float sum = 0.0f;
+
+        for (unsigned int j = 0; j < d_ntaps; j++)
+            sum += h[j] * xs[j];
+
+        if (d_stereo)
+        {
+            const float *xd = &d_diff[d_base + 1 - d_ntaps];
+            float delta = 0.0f;
+
+            for (unsigned int j = 0; j < d_ntaps; j++)
+                delta += h[j] * xd[j];
+
+            delta *= STEREO_DELTA_GAIN;
+            left[nout] = sum + delta;
+            right[nout] = sum - delta;
+        }
+        else
+        {
+            left[nout] = sum;
+            right[nout] = sum;
+        }
+
+        /* de-emphasis */
+        float l = d_deemph_b0 * left[nout] + d_deemph_b1 * d_deemph_x[0] + d_deemph_a1 * d_deemph_y[0];
+        float r = d_deemph_b0 * right[nout] + d_deemph_b1 * d_deemph_x[1] + d_deemph_a1 * d_deemph_y[1];
+        d_deemph_x[0] = left[nout];
+        d_deemph_x[1] = right[nout];
+        d_deemph_y[0] = left[nout] = l;
+        d_deemph_y[1] = right[nout] = r;
+
+        nout++;
+        d_phase += d_decim;
+        d_base += d_phase / d_interp;
+        d_phase %= d_interp;
+    }
+
+    /* drop samples that are no longer needed */
+    unsigned int drop = d_base + 1 - d_ntaps;
+    if (drop > d_sum.size())
+        drop = d_sum.size();
+    d_sum.erase(d_sum.begin(), d_sum.begin() + drop);
+    d_diff.erase(d_diff.begin(), d_diff.begin() + drop);
+    d_base -= drop;
+
+    consume_each(nin);
+
+    return nout;
+}
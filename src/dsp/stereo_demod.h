@@ -24,21 +24,10 @@
 #ifndef STEREO_DEMOD_H
 #define STEREO_DEMOD_H
 
-#include <gnuradio/hier_block2.h>
-#include <gnuradio/filter/firdes.h>
-#include <gnuradio/filter/fir_filter_fcc.h>
-#include <gnuradio/filter/fir_filter_fff.h>
-#include <gnuradio/analog/pll_refout_cc.h>
-#include <gnuradio/blocks/multiply_cc.h>
-#include <gnuradio/blocks/multiply_ff.h>
-#include <gnuradio/blocks/multiply_const_ff.h>
-#include <gnuradio/blocks/complex_to_imag.h>
-#include <gnuradio/blocks/add_ff.h>
+#include <gnuradio/block.h>
 #include <vector>
-#include "dsp/lpf.h"
-#include "dsp/resampler_xx.h"
 
- 
+
 class stereo_demod;
 
 typedef boost::shared_ptr<stereo_demod> stereo_demod_sptr;
@@ -48,59 +37,102 @@ typedef boost::shared_ptr<stereo_demod> stereo_demod_sptr;
  *  \param quad_rate The input sample rate.
  *  \param audio_rate The audio rate.
  *  \param stereo On/off stereo mode.
+ *  \param oirt Use OIRT (31.25 kHz subcarrier) instead of 19 kHz pilot system.
+ *  \param tau De-emphasis time constant (0 disables de-emphasis).
  *
  * This is effectively the public constructor. To avoid accidental use
  * of raw pointers, stereo_demod's constructor is private.
  * make_stereo_demod is the public interface for creating new instances.
+ *
+ * \throws std::range_error if audio_rate / quad_rate is not a rational ratio.
  */
 stereo_demod_sptr make_stereo_demod(float quad_rate=120e3,
                                     float audio_rate=48e3,
-                                    bool stereo=true, bool oirt=false);
+                                    bool stereo=true, bool oirt=false,
+                                    double tau=50.0e-6);
 
 
 /*! \brief FM stereo demodulator.
  *  \ingroup DSP
  *
- * This class implements the stereo demodulator for 87.5...108 MHz band.
+ * This class implements the stereo demodulator for 87.5...108 MHz band as
+ * well as the OIRT system used in the 65.8...74 MHz band.
+ *
+ * Pilot tracking, subcarrier regeneration, L+R/L-R matrixing and the
+ * resampling to the audio rate are all done in this single block:
  *
+ *  - The pilot is mixed down to DC, low pass filtered with a two stage
+ *    one pole IIR and tracked with a second order PLL.
+ *  - The L-R signal is demodulated using a 38 kHz carrier regenerated from
+ *    the pilot PLL (in OIRT mode the PLL locks to the subcarrier itself).
+ *  - Both the L+R and the L-R signals are filtered using a polyphase
+ *    rational resampler, i.e. the audio low pass filter is only evaluated
+ *    at the audio output rate.
+ *  - De-emphasis is applied to the left and right channels at the audio
+ *    rate, so the input must be the FM demodulator output without
+ *    de-emphasis.
  */
-class stereo_demod : public gr::hier_block2
+class stereo_demod : public gr::block
 {
     friend stereo_demod_sptr make_stereo_demod(float input_rate,
                                                float audio_rate,
                                                bool stereo,
-                                               bool oirt);
+                                               bool oirt,
+                                               double tau);
 
 protected:
-    stereo_demod(float input_rate, float audio_rate, bool stereo, bool oirt);
+    stereo_demod(float input_rate, float audio_rate, bool stereo, bool oirt,
+                 double tau);
 
 public:
     ~stereo_demod();
 
+    void set_tau(double tau);
+
+    void forecast(int noutput_items, gr_vector_int &ninput_items_required);
+
+    int general_work(int noutput_items,
+                     gr_vector_int &ninput_items,
+                     gr_vector_const_void_star &input_items,
+                     gr_vector_void_star &output_items);
+
 private:
-    /* GR blocks */
-    gr::filter::fir_filter_fcc::sptr  tone;  /*!< Pilot tone BPF. */
-    gr::analog::pll_refout_cc::sptr   pll;   /*!< Pilot tone PLL. */
-    gr::blocks::multiply_cc::sptr subtone;   /*!< Stereo subtone. */
-    gr::blocks::complex_to_imag::sptr lo;    /*!< Complex tone imag. */
-    gr::filter::fir_filter_fff::sptr  lo2;   /*!< Subtone BPF. */
-    gr::blocks::multiply_ff::sptr mixer;     /*!< Balance mixer. */
-    lpf_ff_sptr lpf0;              /*!< Low-pass filter #0. */
-    lpf_ff_sptr lpf1;              /*!< Low-pass filter #1. */
-    resampler_ff_sptr audio_rr0;   /*!< Audio resampler #0. */
-    resampler_ff_sptr audio_rr1;   /*!< Audio resampler #1. */
-    gr::blocks::multiply_const_ff::sptr cdp; /*!< Channel delta (plus). */
-    gr::blocks::multiply_const_ff::sptr cdm; /*!< Channel delta (minus). */
-    gr::blocks::add_ff::sptr add0;           /*!< Left stereo channel. */
-    gr::blocks::add_ff::sptr add1;           /*!< Right stereo channel. */
+    float pll_step(float x);
 
     /* other parameters */
     float d_input_rate;                  /*! Input rate. */
     float d_audio_rate;                  /*! Audio rate. */
     bool  d_stereo;                      /*! On/off stereo mode. */
     bool  d_oirt;
-    std::vector<gr_complex> d_tone_taps; /*! Tone BPF taps. */
-    std::vector<float> d_pll_taps;       /*! Subtone BPF taps. */
+
+    /* polyphase resampler */
+    unsigned int        d_interp;        /*! Interpolation. */
+    unsigned int        d_decim;         /*! Decimation. */
+    unsigned int        d_ntaps;         /*! Taps per polyphase branch. */
+    std::vector<float>  d_taps;          /*! Reversed polyphase taps, d_interp * d_ntaps. */
+    unsigned int        d_phase;         /*! Phase of next output sample. */
+    unsigned int        d_base;          /*! Buffer index of newest input for next output. */
+    std::vector<float>  d_sum;           /*! L+R history. */
+    std::vector<float>  d_diff;          /*! L-R history. */
+
+    /* pilot PLL */
+    float d_pll_phase;
+    float d_pll_freq;
+    float d_pll_min_freq;
+    float d_pll_max_freq;
+    float d_pll_alpha;
+    float d_pll_beta;
+    float d_iir_alpha;                   /*! Pilot low pass coefficient. */
+    float d_iir_i[2];                    /*! Pilot low pass state, I. */
+    float d_iir_q[2];                    /*! Pilot low pass state, Q. */
+
+    /* de-emphasis */
+    double d_tau;                        /*! De-emphasis time constant. */
+    float d_deemph_b0;
+    float d_deemph_b1;
+    float d_deemph_a1;
+    float d_deemph_x[2];                 /*! Previous input, left / right. */
+    float d_deemph_y[2];                 /*! Previous output, left / right. */
 };
 
 
@@ -0,0 +1,561 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <gnuradio/io_signature.h>
+
+#include "dsp/rx_squelch.h"
+#include "interfaces/audio_rec_sink.h"
+
+#define MAX_QUEUED_SEC  10      /* drop samples beyond this */
+#define HANG_POLL_MS    100     /* hang time check while the stream is gated */
+#define WAV_HEADER_SIZE 44
+
+
+static double get_time()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1.e-9;
+}
+
+static void put_le16(char *p, uint16_t val)
+{
+    p[0] = val & 0xff;
+    p[1] = val >> 8;
+}
+
+static void put_le32(char *p, uint32_t val)
+{
+    put_le16(p, val & 0xffff);
+    put_le16(p + 2, val >> 16);
+}
+
+/* gqrx_yyyyMMdd_hhmmss in UTC, like the other recordings */
+static std::string time_string(time_t time, const char *format)
+{
+    struct tm   tm;
+    char        buf[64];
+
+    gmtime_r(&time, &tm);
+    strftime(buf, sizeof(buf), format, &tm);
+
+    return buf;
+}
+
+
+audio_rec_sink_sptr make_audio_rec_sink(int sample_rate)
+{
+    return gnuradio::get_initial_sptr(new audio_rec_sink(sample_rate));
+}
+
+audio_rec_sink::audio_rec_sink(int sample_rate)
+    : gr::sync_block("audio_rec_sink",
+                     gr::io_signature::make(2, 2, sizeof(float)),
+                     gr::io_signature::make(0, 0, 0)),
+      d_sample_rate(sample_rate),
+      d_mode(REC_CONTINUOUS),
+      d_tag_key(pmt::intern(RX_SQL_TAG_KEY)),
+      d_sql_open(false),
+      d_untagged(0),
+      d_in_tx(false),
+      d_hang_samples(0),
+      d_hang_left(0),
+      d_last_time(0.0),
+      d_queued(0),
+      d_quit(false),
+      d_file(0),
+      d_index(0),
+      d_file_time(0),
+      d_file_frames(0),
+      d_tx_offset(0),
+      d_tx_time(0),
+      d_tx_freq(0.0),
+      d_recording(false),
+      d_frequency(0.0),
+      d_rotate(3600),
+      d_transmissions(0),
+      d_frames_written(0),
+      d_dropped(0),
+      d_active(false),
+      d_error(false)
+{
+    set_hang(1.0);
+}
+
+audio_rec_sink::~audio_rec_sink()
+{
+    close();
+}
+
+bool audio_rec_sink::open(const std::string &path, rec_mode mode)
+{
+    struct stat st;
+
+    gr::thread::scoped_lock lock(d_setlock);
+
+    if (d_recording)
+        return false;
+
+    if (mode == REC_CONTINUOUS)
+    {
+        // the file is created by the writer, check that it can be
+        FILE *fp = fopen(path.c_str(), "wb");
+
+        if (!fp)
+        {
+            std::cout << "Error opening " << path << ": " << strerror(errno)
+                      << std::endl;
+            return false;
+        }
+        fclose(fp);
+    }
+    else if (stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+    {
+        std::cout << "Error: " << path << " is not a directory" << std::endl;
+        return false;
+    }
+
+    d_path = path;
+    d_mode = mode;
+    d_in_tx = false;
+    d_last_time = get_time();
+    d_transmissions = 0;
+    d_frames_written = 0;
+    d_dropped = 0;
+    d_active = false;
+    d_error = false;
+
+    d_quit = false;
+    d_thread = gr::thread::thread(boost::bind(&audio_rec_sink::writer, this));
+    d_recording = true;
+
+    // the whole recording is one transmission
+    if (mode == REC_CONTINUOUS)
+        begin_transmission();
+
+    return true;
+}
+
+void audio_rec_sink::close()
+{
+    {
+        gr::thread::scoped_lock lock(d_setlock);
+
+        if (!d_recording)
+            return;
+
+        if (d_in_tx)
+            end_transmission();
+        d_recording = false;
+    }
+
+    {
+        gr::thread::scoped_lock lock(d_mutex);
+
+        d_quit = true;
+        d_cond.notify_one();
+    }
+
+    // the writer thread empties the queue before it exits
+    d_thread.join();
+}
+
+void audio_rec_sink::set_hang(double seconds)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_hang_samples = std::max(0, (int)(seconds * d_sample_rate));
+    d_hang_left = std::min(d_hang_left, d_hang_samples);
+}
+
+void audio_rec_sink::set_rotate(int minutes)
+{
+    d_rotate = std::max(1, minutes) * 60;
+}
+
+void audio_rec_sink::get_stats(audio_rec_stats &stats) const
+{
+    stats.transmissions = d_transmissions;
+    stats.recorded = (double) d_frames_written / d_sample_rate;
+    stats.dropped = d_dropped;
+    stats.active = d_active;
+    stats.error = d_error;
+}
+
+int audio_rec_sink::work(int noutput_items,
+                         gr_vector_const_void_star &input_items,
+                         gr_vector_void_star &output_items)
+{
+    (void) output_items;
+
+    const float    *in0 = (const float *) input_items[0];
+    const float    *in1 = (const float *) input_items[1];
+    uint64_t        start = nitems_read(0);
+    double          now = get_time();
+    std::vector<gr::tag_t>  tags;
+    int             pos = 0;
+    int             end;
+
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_last_time = now;
+
+    get_tags_in_range(tags, 0, start, start + noutput_items, d_tag_key);
+
+    for (size_t i = 0; i <= tags.size(); i++)
+    {
+        end = (i < tags.size()) ? (int)(tags[i].offset - start) : noutput_items;
+        if (end > pos)
+        {
+            process(in0 + pos, in1 + pos, end - pos);
+            pos = end;
+        }
+
+        if (i < tags.size())
+        {
+            d_sql_open = pmt::to_bool(tags[i].value);
+            d_untagged = 0;
+        }
+    }
+
+    return noutput_items;
+}
+
+/* Record samples according to the squelch state. */
+void audio_rec_sink::process(const float *in0, const float *in1, int num)
+{
+    rec_chunk   chunk;
+    bool        open;
+    int         i;
+
+    // without squelch tags the demodulator has no squelch
+    d_untagged = std::min(d_untagged + num, d_sample_rate);
+    open = d_sql_open || d_untagged >= d_sample_rate / 2 ||
+           d_mode == REC_CONTINUOUS;
+
+    if (!d_recording)
+        return;
+
+    if (open)
+    {
+        if (!d_in_tx)
+            begin_transmission();
+        d_hang_left = d_hang_samples;
+    }
+    else if (d_in_tx)
+    {
+        // keep recording for the hang time
+        num = std::min(num, d_hang_left);
+        d_hang_left -= num;
+    }
+    else
+    {
+        return;
+    }
+
+    chunk.type = CHUNK_DATA;
+    chunk.samples.resize(2 * num);
+    for (i = 0; i < num; i++)
+    {
+        chunk.samples[2 * i] = (int16_t) lrintf(std::max(-1.f, std::min(1.f, in0[i])) * 32767.f);
+        chunk.samples[2 * i + 1] = (int16_t) lrintf(std::max(-1.f, std::min(1.f, in1[i])) * 32767.f);
+    }
+    queue(chunk);
+
+    if (!open && d_hang_left == 0)
+        end_transmission();
+}
+
+/* End the transmission if the squelch has closed and no samples have
+ * arrived for the rest of the hang time. In gate mode the squelch stops
+ * the stream when it closes, so work() is not called to count down the
+ * hang time; the writer thread calls this instead while it is idle.
+ */
+void audio_rec_sink::check_hang()
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    if (!d_in_tx || d_mode == REC_CONTINUOUS)
+        return;
+
+    if (d_sql_open || d_untagged >= d_sample_rate / 2)
+        return;
+
+    if (get_time() - d_last_time > (double) d_hang_left / d_sample_rate)
+        end_transmission();
+}
+
+void audio_rec_sink::begin_transmission()
+{
+    rec_chunk   chunk;
+
+    chunk.type = CHUNK_START;
+    chunk.time = time(0);
+    chunk.frequency = d_frequency;
+    queue(chunk);
+
+    d_in_tx = true;
+    d_hang_left = d_hang_samples;
+}
+
+void audio_rec_sink::end_transmission()
+{
+    rec_chunk   chunk;
+
+    chunk.type = CHUNK_END;
+    queue(chunk);
+
+    d_in_tx = false;
+}
+
+/* Hand a chunk to the writer thread. Data is dropped if the queue is full,
+ * start and end markers are always queued.
+ */
+void audio_rec_sink::queue(rec_chunk &chunk)
+{
+    gr::thread::scoped_lock lock(d_mutex);
+
+    if (chunk.type == CHUNK_DATA)
+    {
+        if (d_queued + chunk.samples.size() >
+                (size_t)(2 * MAX_QUEUED_SEC * d_sample_rate))
+        {
+            d_dropped += chunk.samples.size() / 2;
+            return;
+        }
+        d_queued += chunk.samples.size();
+    }
+
+    d_queue.push_back(rec_chunk());
+    d_queue.back().type = chunk.type;
+    d_queue.back().time = chunk.time;
+    d_queue.back().frequency = chunk.frequency;
+    d_queue.back().samples.swap(chunk.samples);
+    d_cond.notify_one();
+}
+
+void audio_rec_sink::writer()
+{
+    rec_chunk   chunk;
+    bool        idle;
+
+    for (;;)
+    {
+        {
+            gr::thread::scoped_lock lock(d_mutex);
+
+            // wake up regularly to check the hang time in the squelch modes
+            if (d_queue.empty() && !d_quit)
+            {
+                if (d_mode == REC_CONTINUOUS)
+                    d_cond.wait(lock);
+                else
+                    d_cond.timed_wait(lock, boost::posix_time::milliseconds(HANG_POLL_MS));
+            }
+
+            idle = d_queue.empty();
+            if (idle && d_quit)
+                break;
+
+            if (!idle)
+            {
+                chunk.type = d_queue.front().type;
+                chunk.time = d_queue.front().time;
+                chunk.frequency = d_queue.front().frequency;
+                chunk.samples.swap(d_queue.front().samples);
+                d_queue.pop_front();
+                d_queued -= chunk.samples.size();
+            }
+        }
+
+        // check_hang() takes d_setlock, which work() holds while queueing
+        if (idle)
+            check_hang();
+        else
+            handle(chunk);
+    }
+
+    close_file();
+}
+
+void audio_rec_sink::handle(const rec_chunk &chunk)
+{
+    std::string     base;
+    char            freq[32];
+
+    switch (chunk.type)
+    {
+    case CHUNK_START:
+        snprintf(freq, sizeof(freq), "%lld", llround(chunk.frequency));
+
+        if (d_mode == REC_CONTINUOUS)
+        {
+            open_file(d_path, chunk.time);
+        }
+        else if (d_mode == REC_SQUELCH_FILES)
+        {
+            base = d_path + "/" + time_string(chunk.time, "gqrx_%Y%m%d_%H%M%S_") + freq;
+            open_file(base + ".wav", chunk.time);
+        }
+        else if (!d_file || chunk.time - d_file_time >= d_rotate)
+        {
+            // transmissions are not split between files
+            close_file();
+            base = d_path + "/" + time_string(chunk.time, "gqrx_%Y%m%d_%H%M%S");
+            if (open_file(base + ".wav", chunk.time))
+            {
+                d_index = fopen((base + ".csv").c_str(), "w");
+                if (d_index)
+                    fprintf(d_index, "offset,duration,time,frequency\n");
+                else
+                    d_error = true;
+            }
+        }
+
+        d_tx_offset = d_file_frames;
+        d_tx_time = chunk.time;
+        d_tx_freq = chunk.frequency;
+        d_transmissions++;
+        d_active = true;
+        break;
+
+    case CHUNK_DATA:
+        if (!d_file)
+            break;
+
+        if (fwrite(&chunk.samples[0], sizeof(int16_t), chunk.samples.size(),
+                   d_file) != chunk.samples.size())
+        {
+            d_error = true;
+        }
+        d_file_frames += chunk.samples.size() / 2;
+        d_frames_written += chunk.samples.size() / 2;
+        break;
+
+    case CHUNK_END:
+        d_active = false;
+        if (d_mode == REC_SQUELCH_FILES)
+        {
+            close_file();
+        }
+        else if (d_mode == REC_SQUELCH_ROTATE && d_file)
+        {
+            if (d_index)
+            {
+                fprintf(d_index, "%.3f,%.3f,%s,%lld\n",
+                        (double) d_tx_offset / d_sample_rate,
+                        (double)(d_file_frames - d_tx_offset) / d_sample_rate,
+                        time_string(d_tx_time, "%Y-%m-%dT%H:%M:%SZ").c_str(),
+                        llround(d_tx_freq));
+                fflush(d_index);
+            }
+
+            // keep the file playable if gqrx does not exit cleanly
+            update_header();
+        }
+        break;
+    }
+}
+
+bool audio_rec_sink::open_file(const std::string &filename, time_t start)
+{
+    char            header[WAV_HEADER_SIZE];
+    std::string     name = filename;
+    struct stat     st;
+
+    close_file();
+
+    // do not overwrite a transmission that started in the same second
+    for (int i = 1; d_mode != REC_CONTINUOUS && stat(name.c_str(), &st) == 0; i++)
+    {
+        char suffix[16];
+
+        snprintf(suffix, sizeof(suffix), "_%d.wav", i);
+        name = filename.substr(0, filename.size() - 4) + suffix;
+    }
+
+    d_file = fopen(name.c_str(), "wb");
+    if (!d_file)
+    {
+        d_error = true;
+        return false;
+    }
+
+    d_file_time = start;
+    d_file_frames = 0;
+
+    memset(header, 0, sizeof(header));
+    fwrite(header, 1, sizeof(header), d_file);
+    update_header();
+
+    return true;
+}
+
+/* Write the WAV header for the samples written so far. */
+void audio_rec_sink::update_header()
+{
+    char        header[WAV_HEADER_SIZE];
+    uint32_t    data_size = d_file_frames * 4;
+
+    memcpy(header, "RIFF", 4);
+    put_le32(header + 4, 36 + data_size);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put_le32(header + 16, 16);
+    put_le16(header + 20, 1);                       // PCM
+    put_le16(header + 22, 2);                       // channels
+    put_le32(header + 24, d_sample_rate);
+    put_le32(header + 28, d_sample_rate * 4);       // bytes per second
+    put_le16(header + 32, 4);                       // bytes per frame
+    put_le16(header + 34, 16);                      // bits per sample
+    memcpy(header + 36, "data", 4);
+    put_le32(header + 40, data_size);
+
+    fflush(d_file);
+    fseek(d_file, 0, SEEK_SET);
+    if (fwrite(header, 1, sizeof(header), d_file) != sizeof(header))
+        d_error = true;
+    fseek(d_file, 0, SEEK_END);
+}
+
+void audio_rec_sink::close_file()
+{
+    if (d_index)
+    {
+        fclose(d_index);
+        d_index = 0;
+    }
+
+    if (!d_file)
+        return;
+
+    update_header();
+    if (fclose(d_file) != 0)
+        d_error = true;
+    d_file = 0;
+}
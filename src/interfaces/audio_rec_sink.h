@@ -0,0 +1,193 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef AUDIO_REC_SINK_H
+#define AUDIO_REC_SINK_H
+
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/atomic.hpp>
+#include <gnuradio/sync_block.h>
+#include <gnuradio/thread/thread.h>
+#include <pmt/pmt.h>
+
+
+/*! \brief Audio recorder statistics. */
+struct audio_rec_stats {
+    unsigned int        transmissions;  /*!< Transmissions recorded. */
+    double              recorded;       /*!< Seconds of audio written. */
+    unsigned long long  dropped;        /*!< Samples dropped, queue full. */
+    bool                active;         /*!< A transmission is being recorded. */
+    bool                error;          /*!< A file could not be written. */
+};
+
+
+class audio_rec_sink;
+
+typedef boost::shared_ptr<audio_rec_sink> audio_rec_sink_sptr;
+
+audio_rec_sink_sptr make_audio_rec_sink(int sample_rate);
+
+
+/*! \brief Stereo audio recorder with squelch gating.
+ *  \ingroup IO
+ *
+ * The block records its two inputs to 16 bit stereo WAV files. It can stay
+ * connected to the receiver all the time; when no recording is open work()
+ * only follows the squelch state.
+ *
+ * In continuous mode everything is recorded to a single file, like the
+ * WAV sink used earlier. In the squelch modes audio is only recorded while
+ * the squelch is open, plus a hang time after it closes. The squelch state
+ * is taken from the stream tags added by rx_sql_cc; if the demodulator has
+ * no squelch the audio is recorded continuously. Each transmission is
+ * written either to its own file, named after the start time and channel
+ * frequency, or to a file that is rotated every few minutes together with
+ * a CSV index of the transmissions in it:
+ *
+ *   offset,duration,time,frequency
+ *
+ * where offset and duration are in seconds from the start of the file and
+ * time is the UTC start time in ISO 8601 format.
+ *
+ * work() only converts the samples and queues them; the files are written
+ * by a separate thread. If the thread does not keep up, samples are dropped
+ * and counted instead of blocking the receiver. The writer thread also ends
+ * transmissions when the hang time has passed while a gating squelch keeps
+ * work() from being called.
+ */
+class audio_rec_sink : public gr::sync_block
+{
+    friend audio_rec_sink_sptr make_audio_rec_sink(int sample_rate);
+
+protected:
+    audio_rec_sink(int sample_rate);
+
+public:
+    enum rec_mode {
+        REC_CONTINUOUS      = 0,    /*!< One file, including silence. */
+        REC_SQUELCH_FILES   = 1,    /*!< One file per transmission. */
+        REC_SQUELCH_ROTATE  = 2     /*!< Rotated files with an index. */
+    };
+
+    ~audio_rec_sink();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    /*! \brief Start recording.
+     *  \param path The file name in continuous mode, otherwise the directory
+     *              where the files are created.
+     *  \param mode The recording mode.
+     *  \returns False if a recording is already open or the file can not
+     *           be created.
+     */
+    bool open(const std::string &path, rec_mode mode);
+
+    /*! \brief Stop recording and wait until the files have been written. */
+    void close();
+
+    bool is_open() const { return d_recording; }
+
+    /*! \brief Set the time to keep recording after the squelch has closed. */
+    void set_hang(double seconds);
+
+    /*! \brief Set how often the file is rotated in REC_SQUELCH_ROTATE mode. */
+    void set_rotate(int minutes);
+
+    /*! \brief Set the channel frequency, used in file names and the index. */
+    void set_frequency(double freq_hz) { d_frequency = freq_hz; }
+
+    void get_stats(audio_rec_stats &stats) const;
+
+private:
+    enum chunk_type {
+        CHUNK_START,    /*!< A transmission starts. */
+        CHUNK_DATA,     /*!< Interleaved samples. */
+        CHUNK_END       /*!< A transmission has ended. */
+    };
+
+    struct rec_chunk {
+        chunk_type              type;
+        time_t                  time;
+        double                  frequency;
+        std::vector<int16_t>    samples;
+    };
+
+    void process(const float *in0, const float *in1, int num);
+    void begin_transmission();
+    void end_transmission();
+    void check_hang();
+    void queue(rec_chunk &chunk);
+
+    void writer();
+    void handle(const rec_chunk &chunk);
+    bool open_file(const std::string &filename, time_t start);
+    void update_header();
+    void close_file();
+
+    int             d_sample_rate;
+    rec_mode        d_mode;
+    std::string     d_path;
+    pmt::pmt_t      d_tag_key;
+
+    /* DSP thread state, protected by d_setlock */
+    bool            d_sql_open;     /*!< Squelch state from the last tag. */
+    int             d_untagged;     /*!< Samples since the last squelch tag. */
+    bool            d_in_tx;        /*!< Recording a transmission. */
+    int             d_hang_samples;
+    int             d_hang_left;
+    double          d_last_time;    /*!< Time of the last work() call. */
+
+    /* queue between work() and the writer thread */
+    std::deque<rec_chunk>           d_queue;
+    size_t                          d_queued;   /*!< Samples in d_queue. */
+    bool                            d_quit;
+    gr::thread::mutex               d_mutex;
+    gr::thread::condition_variable  d_cond;
+    gr::thread::thread              d_thread;
+
+    /* writer thread state */
+    FILE           *d_file;
+    FILE           *d_index;
+    time_t          d_file_time;    /*!< Start time of the current file. */
+    uint32_t        d_file_frames;  /*!< Sample frames in the current file. */
+    uint32_t        d_tx_offset;    /*!< Frame where the transmission started. */
+    time_t          d_tx_time;
+    double          d_tx_freq;
+
+    boost::atomic<bool>         d_recording;
+    boost::atomic<double>       d_frequency;
+    boost::atomic<int>          d_rotate;       /*!< Rotation period in seconds. */
+    boost::atomic<unsigned int> d_transmissions;
+    boost::atomic<unsigned long long>   d_frames_written;
+    boost::atomic<unsigned long long>   d_dropped;
+    boost::atomic<bool>         d_active;
+    boost::atomic<bool>         d_error;
+};
+
+#endif // AUDIO_REC_SINK_H
@@ -0,0 +1,370 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/bind.hpp>
+#include <gnuradio/fft/fft.h>
+
+#include "interfaces/iq_file_index.h"
+#include "interfaces/iq_file_source.h"
+
+#define MAX_SLICES      512     /* time resolution of the overview */
+#define NUM_BINS        128     /* frequency resolution of the overview */
+#define FFTS_PER_SLICE  16      /* FFTs averaged per slice */
+#define MIN_SLICE_LEN   1024    /* samples */
+#define CHUNK_SIZE      65536   /* samples converted at a time */
+
+#define INDEX_MAGIC     "GQRXIDX1"
+
+
+/* Header of the index file, followed by the power and spectrum arrays. */
+struct index_header {
+    char        magic[8];
+    uint64_t    file_size;      /* size and modification time of the */
+    int64_t     file_mtime;     /* recording when it was indexed */
+    uint32_t    num_slices;
+    uint32_t    num_bins;
+    double      slice_len;
+    double      sample_rate;
+    double      frequency;
+};
+
+
+std::string iq_file_index_filename(const std::string &filename)
+{
+    return filename + ".gqrx-idx";
+}
+
+bool load_iq_file_index(const std::string &filename, iq_file_index &index)
+{
+    struct stat     st;
+    index_header    hdr;
+    FILE           *fp;
+    bool            ok;
+
+    if (stat(filename.c_str(), &st) != 0)
+        return false;
+
+    fp = fopen(iq_file_index_filename(filename).c_str(), "rb");
+    if (!fp)
+        return false;
+
+    ok = fread(&hdr, sizeof(hdr), 1, fp) == 1 &&
+         memcmp(hdr.magic, INDEX_MAGIC, sizeof(hdr.magic)) == 0 &&
+         hdr.file_size == (uint64_t) st.st_size &&
+         hdr.file_mtime == (int64_t) st.st_mtime &&
+         hdr.num_slices > 0 && hdr.num_slices <= MAX_SLICES &&
+         hdr.num_bins > 0 && hdr.num_bins <= NUM_BINS;
+
+    if (ok)
+    {
+        index.num_slices = hdr.num_slices;
+        index.num_bins = hdr.num_bins;
+        index.slice_len = hdr.slice_len;
+        index.sample_rate = hdr.sample_rate;
+        index.frequency = hdr.frequency;
+        index.power.resize(hdr.num_slices);
+        index.spectrum.resize(hdr.num_slices * hdr.num_bins);
+
+        ok = fread(&index.power[0], sizeof(float), index.power.size(), fp) ==
+                index.power.size() &&
+             fread(&index.spectrum[0], sizeof(float), index.spectrum.size(), fp) ==
+                index.spectrum.size();
+    }
+
+    fclose(fp);
+
+    return ok;
+}
+
+
+iq_file_indexer::iq_file_indexer()
+    : d_data(0),
+      d_size(0),
+      d_sample_size(8),
+      d_format(IQ_FORMAT_CF32),
+      d_num_samples(0),
+      d_running(false),
+      d_cancel(false),
+      d_ok(false),
+      d_next(0),
+      d_done(0)
+{
+    d_index.num_slices = 0;
+    d_index.num_bins = 0;
+}
+
+iq_file_indexer::~iq_file_indexer()
+{
+    cancel();
+}
+
+bool iq_file_indexer::start(const std::string &filename, double sample_rate)
+{
+    iq_file_info    info;
+    struct stat     st;
+    void           *data;
+    int             fd;
+
+    cancel();
+
+    if (!get_iq_file_info(filename, info))
+        return false;
+
+    d_format = info.format;
+    d_sample_size = (info.format == IQ_FORMAT_CS8) ? 2 :
+                    (info.format == IQ_FORMAT_CS16) ? 4 : 8;
+    d_num_samples = info.num_samples;
+    if (d_num_samples < MIN_SLICE_LEN)
+        return false;
+
+    fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    d_size = st.st_size;
+    data = mmap(0, d_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    madvise(data, d_size, MADV_SEQUENTIAL);
+    d_data = (const char *) data;
+
+    d_filename = filename;
+    d_index.sample_rate = info.sample_rate > 0.0 ? info.sample_rate : sample_rate;
+    d_index.frequency = info.frequency;
+    d_index.num_slices = (unsigned int) std::min<unsigned long long>(
+                MAX_SLICES, d_num_samples / MIN_SLICE_LEN);
+    d_index.num_bins = NUM_BINS;
+    d_index.slice_len = d_num_samples / d_index.sample_rate / d_index.num_slices;
+    d_index.power.assign(d_index.num_slices, -200.f);
+    d_index.spectrum.assign(d_index.num_slices * d_index.num_bins, -200.f);
+
+    d_next = 0;
+    d_done = 0;
+    d_ok = false;
+    d_cancel = false;
+    d_running = true;
+    d_thread = boost::thread(&iq_file_indexer::run, this);
+
+    return true;
+}
+
+void iq_file_indexer::cancel()
+{
+    d_cancel = true;
+    if (d_thread.joinable())
+        d_thread.join();
+}
+
+float iq_file_indexer::get_progress() const
+{
+    if (d_index.num_slices == 0)
+        return 0.f;
+
+    return (float) d_done / (float) d_index.num_slices;
+}
+
+bool iq_file_indexer::get_index(iq_file_index &index) const
+{
+    if (d_running || !d_ok)
+        return false;
+
+    index = d_index;
+
+    return true;
+}
+
+void iq_file_indexer::run()
+{
+    boost::thread_group     workers;
+    unsigned int            num_threads;
+
+    num_threads = std::max(1u, boost::thread::hardware_concurrency());
+    for (unsigned int i = 0; i < num_threads; i++)
+        workers.create_thread(boost::bind(&iq_file_indexer::worker, this));
+    workers.join_all();
+
+    if (!d_cancel)
+    {
+        // the index is usable even if it can not be cached
+        save_index();
+        d_ok = true;
+    }
+
+    munmap((void *) d_data, d_size);
+    d_data = 0;
+    d_running = false;
+}
+
+/* Process slices until all are done. The slices are taken in order so that
+ * the threads together read the file mostly sequentially.
+ */
+void iq_file_indexer::worker()
+{
+    gr::fft::fft_complex    fft(NUM_BINS, true);
+    std::vector<float>      window(NUM_BINS);
+    std::vector<float>      samples(2 * CHUNK_SIZE);
+    unsigned int            slice;
+
+    // Hann window
+    for (int i = 0; i < NUM_BINS; i++)
+        window[i] = 0.5f - 0.5f * cosf(2.f * (float) M_PI * i / (NUM_BINS - 1));
+
+    while (!d_cancel && (slice = d_next++) < d_index.num_slices)
+    {
+        process_slice(slice, fft, window, samples);
+        d_done++;
+    }
+}
+
+void iq_file_indexer::process_slice(unsigned int slice, gr::fft::fft_complex &fft,
+                                    const std::vector<float> &window,
+                                    std::vector<float> &samples)
+{
+    unsigned long long  start = d_num_samples * slice / d_index.num_slices;
+    unsigned long long  end = d_num_samples * (slice + 1) / d_index.num_slices;
+    unsigned long long  pos;
+    unsigned int        num, i, k;
+    double              energy = 0.0;
+    std::vector<double> psd(NUM_BINS, 0.0);
+    float               wsum = 0.f;
+
+    // mean power of all samples in the slice
+    for (pos = start; pos < end && !d_cancel; pos += num)
+    {
+        num = (unsigned int) std::min<unsigned long long>(CHUNK_SIZE, end - pos);
+        convert(pos, num, &samples[0]);
+        for (i = 0; i < 2 * num; i++)
+            energy += samples[i] * samples[i];
+    }
+    d_index.power[slice] = 10.f * log10f(energy / (end - start) + 1.e-20);
+
+    // average of FFTs spread over the slice
+    for (k = 0; k < FFTS_PER_SLICE; k++)
+    {
+        gr_complex *in = fft.get_inbuf();
+
+        pos = start + (end - start - NUM_BINS) * k / (FFTS_PER_SLICE - 1);
+        convert(pos, NUM_BINS, &samples[0]);
+        for (i = 0; i < NUM_BINS; i++)
+            in[i] = gr_complex(samples[2 * i] * window[i],
+                               samples[2 * i + 1] * window[i]);
+        fft.execute();
+
+        gr_complex *out = fft.get_outbuf();
+        for (i = 0; i < NUM_BINS; i++)
+            psd[i] += std::norm(out[i]);
+    }
+
+    for (i = 0; i < NUM_BINS; i++)
+        wsum += window[i];
+
+    // lowest frequency first
+    float *spectrum = &d_index.spectrum[slice * NUM_BINS];
+    for (i = 0; i < NUM_BINS; i++)
+        spectrum[(i + NUM_BINS / 2) % NUM_BINS] =
+                10.f * log10f(psd[i] / FFTS_PER_SLICE / (wsum * wsum) + 1.e-20);
+}
+
+/* Convert samples from the mapped file to interleaved float. */
+void iq_file_indexer::convert(unsigned long long start, unsigned int num,
+                              float *out) const
+{
+    const char     *in = d_data + start * d_sample_size;
+    unsigned int    i;
+
+    if (d_format == IQ_FORMAT_CF32)
+    {
+        memcpy(out, in, num * d_sample_size);
+    }
+    else if (d_format == IQ_FORMAT_CS16)
+    {
+        for (i = 0; i < 2 * num; i++)
+            out[i] = ((const int16_t *) in)[i] * (1.f / 32767.f);
+    }
+    else
+    {
+        for (i = 0; i < 2 * num; i++)
+            out[i] = ((const int8_t *) in)[i] * (1.f / 127.f);
+    }
+}
+
+/* Write the index next to the recording; a temporary file is renamed so
+ * that a partial index is never loaded.
+ */
+bool iq_file_indexer::save_index() const
+{
+    std::string     name = iq_file_index_filename(d_filename);
+    std::string     tmpname = name + ".tmp";
+    index_header    hdr;
+    struct stat     st;
+    FILE           *fp;
+    bool            ok;
+
+    if (stat(d_filename.c_str(), &st) != 0)
+        return false;
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, INDEX_MAGIC, sizeof(hdr.magic));
+    hdr.file_size = st.st_size;
+    hdr.file_mtime = st.st_mtime;
+    hdr.num_slices = d_index.num_slices;
+    hdr.num_bins = d_index.num_bins;
+    hdr.slice_len = d_index.slice_len;
+    hdr.sample_rate = d_index.sample_rate;
+    hdr.frequency = d_index.frequency;
+
+    fp = fopen(tmpname.c_str(), "wb");
+    if (!fp)
+        return false;
+
+    ok = fwrite(&hdr, sizeof(hdr), 1, fp) == 1 &&
+         fwrite(&d_index.power[0], sizeof(float), d_index.power.size(), fp) ==
+            d_index.power.size() &&
+         fwrite(&d_index.spectrum[0], sizeof(float), d_index.spectrum.size(), fp) ==
+            d_index.spectrum.size();
+    ok = (fclose(fp) == 0) && ok;
+
+    if (!ok || rename(tmpname.c_str(), name.c_str()) != 0)
+    {
+        remove(tmpname.c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,128 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef IQ_FILE_INDEX_H
+#define IQ_FILE_INDEX_H
+
+#include <string>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace gr {
+    namespace fft {
+        class fft_complex;
+    }
+}
+
+/*! \brief Overview of an I/Q recording.
+ *
+ * The recording is divided into equally long time slices. For each slice
+ * the mean power and a coarse spectrum are stored.
+ */
+struct iq_file_index {
+    unsigned int        num_slices;
+    unsigned int        num_bins;       /*!< Spectrum bins per slice. */
+    double              slice_len;      /*!< Slice length in seconds. */
+    double              sample_rate;
+    double              frequency;      /*!< Center frequency, 0 if unknown. */
+    std::vector<float>  power;          /*!< Mean power per slice in dBFS. */
+    std::vector<float>  spectrum;       /*!< num_slices x num_bins in dBFS,
+                                             lowest frequency first. */
+};
+
+/*! \brief Get the name of the index file of a recording. */
+std::string iq_file_index_filename(const std::string &filename);
+
+/*! \brief Load the cached index of a recording.
+ *  \returns False if there is no index or it does not match the recording,
+ *           e.g. because the recording has changed since it was indexed.
+ */
+bool load_iq_file_index(const std::string &filename, iq_file_index &index);
+
+
+/*! \brief Build the index of an I/Q recording in the background.
+ *  \ingroup IO
+ *
+ * The recording is memory mapped and the time slices are distributed over
+ * one thread per CPU core. Each slice is read once to calculate the mean
+ * power; the spectrum is the average of a few FFTs spread over the slice.
+ * When all slices are done the index is written next to the recording
+ * so that it can be loaded with load_iq_file_index() the next time.
+ */
+class iq_file_indexer
+{
+public:
+    iq_file_indexer();
+    ~iq_file_indexer();
+
+    /*! \brief Start indexing a recording.
+     *  \param filename The recording.
+     *  \param sample_rate The sample rate used if the recording has no
+     *                     metadata.
+     *  \returns False if the recording can not be read.
+     *
+     * An ongoing indexing is cancelled.
+     */
+    bool start(const std::string &filename, double sample_rate);
+
+    /*! \brief Cancel indexing and wait for the threads to finish. */
+    void cancel();
+
+    bool is_running() const { return d_running; }
+
+    /*! \brief Get the progress from 0 to 1. */
+    float get_progress() const;
+
+    /*! \brief Get the index once is_running() is false.
+     *  \returns False if indexing was cancelled or failed.
+     */
+    bool get_index(iq_file_index &index) const;
+
+    const std::string &filename() const { return d_filename; }
+
+private:
+    void run();
+    void worker();
+    void process_slice(unsigned int slice, gr::fft::fft_complex &fft,
+                       const std::vector<float> &window,
+                       std::vector<float> &samples);
+    void convert(unsigned long long start, unsigned int num, float *out) const;
+    bool save_index() const;
+
+    std::string         d_filename;
+    iq_file_index       d_index;
+    const char         *d_data;         /*!< The mapped recording. */
+    size_t              d_size;
+    unsigned int        d_sample_size;
+    int                 d_format;
+    unsigned long long  d_num_samples;
+
+    boost::thread                   d_thread;
+    boost::atomic<bool>             d_running;
+    boost::atomic<bool>             d_cancel;
+    boost::atomic<bool>             d_ok;
+    boost::atomic<unsigned int>     d_next;     /*!< Next slice to process. */
+    boost::atomic<unsigned int>     d_done;     /*!< Slices processed. */
+};
+
+#endif // IQ_FILE_INDEX_H
@@ -0,0 +1,430 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <boost/bind.hpp>
+#include <gnuradio/io_signature.h>
+
+#include "iq_file_sink.h"
+
+#define NUM_BUFFERS     32
+#define BUFFER_SIZE     (4 * 1024 * 1024)   /* multiple of page and sample size */
+#define BUFFER_ALIGN    4096
+
+
+static double get_time()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1.e-6;
+}
+
+iq_file_writer::iq_file_writer()
+    : d_fd(-1),
+      d_format(IQ_FORMAT_CF32),
+      d_sample_size(8),
+      d_direct(false),
+      d_cur(0),
+      d_cur_len(0),
+      d_quit(false),
+      d_written(0),
+      d_dropped(0),
+      d_error(false),
+      d_last_written(0),
+      d_last_time(0.0)
+{
+
+}
+
+iq_file_writer::~iq_file_writer()
+{
+    close();
+}
+
+bool iq_file_writer::open(const std::string &filename, iq_file_format format,
+                          double sample_rate, double frequency, bool direct,
+                          double history)
+{
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+
+    close();
+
+#ifdef O_DIRECT
+    d_direct = direct;
+    if (direct)
+    {
+        d_fd = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+        // not supported by all file systems, e.g. tmpfs
+        if (d_fd < 0 && errno == EINVAL)
+            d_direct = false;
+    }
+#else
+    (void) direct;
+    d_direct = false;
+#endif
+    if (!d_direct)
+        d_fd = ::open(filename.c_str(), flags, 0644);
+
+    if (d_fd < 0)
+    {
+        perror("iq_file_writer: Can not open file");
+        return false;
+    }
+
+    d_format = format;
+    d_sample_size = (format == IQ_FORMAT_CS8) ? 2 : (format == IQ_FORMAT_CS16) ? 4 : 8;
+
+    if (!write_meta(filename, sample_rate, frequency, history))
+        fprintf(stderr, "iq_file_writer: Can not write metadata for %s\n",
+                filename.c_str());
+
+    // buffers are allocated per recording; they are large
+    for (int i = 0; i < NUM_BUFFERS; i++)
+    {
+        void *buf;
+
+        if (posix_memalign(&buf, BUFFER_ALIGN, BUFFER_SIZE) != 0)
+            break;
+        d_buffers.push_back((char *) buf);
+    }
+    d_free.assign(d_buffers.begin() + 1, d_buffers.end());
+    d_cur = d_buffers.empty() ? 0 : d_buffers[0];
+    d_cur_len = 0;
+
+    d_written = 0;
+    d_dropped = 0;
+    d_error = false;
+    d_last_written = 0;
+    d_last_time = get_time();
+
+    d_quit = false;
+    d_thread = gr::thread::thread(boost::bind(&iq_file_writer::writer, this));
+
+    return true;
+}
+
+void iq_file_writer::close()
+{
+    if (d_fd < 0)
+        return;
+
+    submit();
+    {
+        gr::thread::scoped_lock lock(d_mutex);
+        d_quit = true;
+    }
+    d_cond.notify_one();
+    d_thread.join();
+
+    ::close(d_fd);
+    d_fd = -1;
+
+    for (unsigned int i = 0; i < d_buffers.size(); i++)
+        free(d_buffers[i]);
+    d_buffers.clear();
+    d_free.clear();
+    d_queue.clear();
+    d_cur = 0;
+}
+
+void iq_file_writer::write(const gr_complex *in, unsigned int num, bool wait)
+{
+    unsigned int    n, i;
+
+    if (d_fd < 0)
+        return;
+
+    while (num > 0)
+    {
+        if (!d_cur)
+        {
+            // try to get a buffer back from the writer
+            gr::thread::scoped_lock lock(d_mutex);
+
+            // the writer thread always returns its buffer, even on errors
+            while (wait && d_free.empty())
+                d_free_cond.wait(lock);
+
+            if (d_free.empty())
+            {
+                d_dropped += num;
+                return;
+            }
+            d_cur = d_free.back();
+            d_free.pop_back();
+            d_cur_len = 0;
+        }
+
+        n = std::min<size_t>(num, (BUFFER_SIZE - d_cur_len) / d_sample_size);
+
+        if (d_format == IQ_FORMAT_CF32)
+        {
+            memcpy(d_cur + d_cur_len, in, n * sizeof(gr_complex));
+        }
+        else if (d_format == IQ_FORMAT_CS16)
+        {
+            int16_t *out = (int16_t *) (d_cur + d_cur_len);
+
+            for (i = 0; i < n; i++)
+            {
+                out[2 * i] = (int16_t) lrintf(std::max(-1.f, std::min(1.f, in[i].real())) * 32767.f);
+                out[2 * i + 1] = (int16_t) lrintf(std::max(-1.f, std::min(1.f, in[i].imag())) * 32767.f);
+            }
+        }
+        else
+        {
+            int8_t *out = (int8_t *) (d_cur + d_cur_len);
+
+            for (i = 0; i < n; i++)
+            {
+                out[2 * i] = (int8_t) lrintf(std::max(-1.f, std::min(1.f, in[i].real())) * 127.f);
+                out[2 * i + 1] = (int8_t) lrintf(std::max(-1.f, std::min(1.f, in[i].imag())) * 127.f);
+            }
+        }
+
+        d_cur_len += n * d_sample_size;
+        in += n;
+        num -= n;
+
+        if (d_cur_len == BUFFER_SIZE)
+            submit();
+    }
+}
+
+/* Hand the current buffer to the writer thread. */
+void iq_file_writer::submit()
+{
+    if (!d_cur)
+        return;
+
+    if (d_cur_len > 0)
+    {
+        {
+            gr::thread::scoped_lock lock(d_mutex);
+            d_queue.push_back(std::make_pair(d_cur, d_cur_len));
+        }
+        d_cond.notify_one();
+        d_cur = 0;
+    }
+    d_cur_len = 0;
+}
+
+void iq_file_writer::writer()
+{
+    std::pair<char *, size_t>   buf;
+    ssize_t                     n;
+    size_t                      done;
+
+    while (true)
+    {
+        {
+            gr::thread::scoped_lock lock(d_mutex);
+
+            while (d_queue.empty() && !d_quit)
+                d_cond.wait(lock);
+
+            if (d_queue.empty())
+                break;
+
+            buf = d_queue.front();
+            d_queue.pop_front();
+        }
+
+#ifdef O_DIRECT
+        // only the last buffer can be partial; direct I/O needs aligned sizes
+        if (d_direct && buf.second % BUFFER_ALIGN)
+        {
+            fcntl(d_fd, F_SETFL, fcntl(d_fd, F_GETFL) & ~O_DIRECT);
+            d_direct = false;
+        }
+#endif
+
+        for (done = 0; done < buf.second && !d_error; done += n)
+        {
+            n = ::write(d_fd, buf.first + done, buf.second - done);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    n = 0;
+                    continue;
+                }
+                perror("iq_file_writer: Write failed");
+                d_error = true;
+                break;
+            }
+        }
+        // after an error the data is discarded but buffers keep circulating
+        d_written += done;
+
+        {
+            gr::thread::scoped_lock lock(d_mutex);
+            d_free.push_back(buf.first);
+        }
+        d_free_cond.notify_one();
+    }
+}
+
+void iq_file_writer::get_stats(iq_file_stats &stats)
+{
+    double now = get_time();
+    unsigned long long written = d_written;
+
+    stats.bytes_written = written;
+    stats.throughput = (now > d_last_time) ?
+                (written - d_last_written) / (now - d_last_time) : 0.0;
+    stats.dropped = d_dropped;
+    stats.error = d_error;
+    stats.buffers_total = d_buffers.size();
+    {
+        gr::thread::scoped_lock lock(d_mutex);
+        stats.buffers_free = d_free.size();
+    }
+
+    d_last_written = written;
+    d_last_time = now;
+}
+
+/* Replace the extension of the data file with .sigmf-meta */
+std::string iq_file_writer::meta_filename(const std::string &filename)
+{
+    size_t slash = filename.find_last_of('/');
+    size_t dot = filename.find_last_of('.');
+
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return filename + ".sigmf-meta";
+
+    return filename.substr(0, dot) + ".sigmf-meta";
+}
+
+bool iq_file_writer::write_meta(const std::string &filename, double sample_rate,
+                                double frequency, double history)
+{
+    static const char *datatypes[] = { "cf32_le", "ci16_le", "ci8" };
+    std::string     dataset = filename.substr(filename.find_last_of('/') + 1);
+    char            datetime[32];
+    time_t          start = time(NULL) - (time_t)(history + 0.5);
+    FILE           *fp;
+
+    strftime(datetime, sizeof(datetime), "%Y-%m-%dT%H:%M:%SZ", gmtime(&start));
+
+    fp = fopen(meta_filename(filename).c_str(), "w");
+    if (!fp)
+        return false;
+
+    // the data file does not follow the SigMF naming, hence core:dataset
+    fprintf(fp,
+            "{\n"
+            "    \"global\": {\n"
+            "        \"core:datatype\": \"%s\",\n"
+            "        \"core:sample_rate\": %.0f,\n"
+            "        \"core:version\": \"1.0.0\",\n"
+            "        \"core:dataset\": \"%s\",\n"
+            "        \"core:recorder\": \"gqrx\"\n"
+            "    },\n"
+            "    \"captures\": [\n"
+            "        {\n"
+            "            \"core:sample_start\": 0,\n"
+            "            \"core:frequency\": %.0f,\n"
+            "            \"core:datetime\": \"%s\"\n"
+            "        }\n"
+            "    ],\n"
+            "    \"annotations\": []\n"
+            "}\n",
+            datatypes[d_format], sample_rate, dataset.c_str(), frequency,
+            datetime);
+
+    return fclose(fp) == 0;
+}
+
+
+iq_file_sink_sptr make_iq_file_sink()
+{
+    return gnuradio::get_initial_sptr(new iq_file_sink());
+}
+
+iq_file_sink::iq_file_sink()
+    : gr::sync_block("iq_file_sink",
+                     gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                     gr::io_signature::make(0, 0, 0))
+{
+
+}
+
+iq_file_sink::~iq_file_sink()
+{
+
+}
+
+int iq_file_sink::work(int noutput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+{
+    (void) output_items;
+
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_writer.write((const gr_complex *) input_items[0], noutput_items);
+
+    return noutput_items;
+}
+
+bool iq_file_sink::open(const std::string &filename, iq_file_format format,
+                        double sample_rate, double frequency, bool direct)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    return d_writer.open(filename, format, sample_rate, frequency, direct);
+}
+
+/* Closing waits for the queued buffers to be written. */
+void iq_file_sink::close()
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_writer.close();
+}
+
+bool iq_file_sink::is_open()
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    return d_writer.is_open();
+}
+
+void iq_file_sink::get_stats(iq_file_stats &stats)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_writer.get_stats(stats);
+}
@@ -0,0 +1,176 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef IQ_FILE_SINK_H
+#define IQ_FILE_SINK_H
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/sync_block.h>
+#include <gnuradio/thread/thread.h>
+
+
+/*! \brief I/Q file sample formats. */
+enum iq_file_format {
+    IQ_FORMAT_CF32 = 0,     /*!< 32 bit float I/Q. */
+    IQ_FORMAT_CS16 = 1,     /*!< 16 bit signed integer I/Q. */
+    IQ_FORMAT_CS8  = 2      /*!< 8 bit signed integer I/Q. */
+};
+
+/*! \brief Recorder statistics. */
+struct iq_file_stats {
+    unsigned long long  bytes_written;  /*!< Bytes written to disk. */
+    double          throughput;     /*!< Bytes per second since last call. */
+    unsigned int    buffers_free;   /*!< Buffers available to the producer. */
+    unsigned int    buffers_total;
+    unsigned long long  dropped;    /*!< Samples dropped, buffers full. */
+    bool            error;          /*!< A write has failed. */
+};
+
+
+/*! \brief Asynchronous I/Q file writer.
+ *  \ingroup IO
+ *
+ * Samples are converted to the file format into large page aligned
+ * buffers. Filled buffers are handed to a writer thread, so the caller
+ * only pays for the conversion and never waits for the disk. When all
+ * buffers are queued because the disk does not keep up, new samples are
+ * dropped and counted rather than blocking the caller, unless the caller
+ * asks to wait for a free buffer.
+ *
+ * On Linux the file can be opened with O_DIRECT to bypass the page cache,
+ * which avoids long stalls when the kernel flushes gigabytes of dirty
+ * pages. File systems that do not support it fall back to normal I/O.
+ *
+ * A SigMF metadata file is written next to the data file, using the data
+ * file name with the extension replaced by ".sigmf-meta".
+ */
+class iq_file_writer
+{
+public:
+    iq_file_writer();
+    ~iq_file_writer();
+
+    /*! \brief Open a new file and start the writer thread.
+     *  \param filename The data file name.
+     *  \param format The sample format in the file.
+     *  \param sample_rate The sample rate, stored in the metadata.
+     *  \param frequency The center frequency, stored in the metadata.
+     *  \param direct Use direct I/O if possible.
+     *  \param history Seconds before now that the first sample was received,
+     *                 used for the start time in the metadata.
+     *  \returns False if the file can not be created.
+     */
+    bool open(const std::string &filename, iq_file_format format,
+              double sample_rate, double frequency, bool direct,
+              double history = 0.0);
+
+    /*! \brief Write the remaining samples and close the file. */
+    void close();
+
+    bool is_open() const { return d_fd >= 0; }
+
+    /*! \brief Queue samples for writing.
+     *  \param in The samples.
+     *  \param num The number of samples.
+     *  \param wait Wait for a free buffer instead of dropping samples when
+     *              all buffers are queued. Must not be used from a flow
+     *              graph thread.
+     */
+    void write(const gr_complex *in, unsigned int num, bool wait = false);
+
+    void get_stats(iq_file_stats &stats);
+
+    static std::string meta_filename(const std::string &filename);
+
+private:
+    void writer();
+    bool write_meta(const std::string &filename, double sample_rate,
+                    double frequency, double history);
+    void submit();
+
+    int             d_fd;
+    iq_file_format  d_format;
+    unsigned int    d_sample_size;  /*!< Bytes per complex sample. */
+    bool            d_direct;       /*!< File opened with O_DIRECT. */
+
+    std::vector<char *>     d_buffers;  /*!< All buffers, for cleanup. */
+    std::vector<char *>     d_free;     /*!< Buffers available for filling. */
+    std::deque< std::pair<char *, size_t> > d_queue;   /*!< Filled buffers. */
+    char           *d_cur;          /*!< Buffer being filled, may be NULL. */
+    size_t          d_cur_len;      /*!< Bytes in d_cur. */
+
+    bool            d_quit;
+    gr::thread::mutex               d_mutex;
+    gr::thread::condition_variable  d_cond;
+    gr::thread::condition_variable  d_free_cond;    /*!< A buffer was freed. */
+    gr::thread::thread              d_thread;
+
+    boost::atomic<unsigned long long>   d_written;
+    boost::atomic<unsigned long long>   d_dropped;
+    boost::atomic<bool>                 d_error;
+    unsigned long long  d_last_written; /*!< For throughput calculation. */
+    double              d_last_time;
+};
+
+
+class iq_file_sink;
+
+typedef boost::shared_ptr<iq_file_sink> iq_file_sink_sptr;
+
+iq_file_sink_sptr make_iq_file_sink(void);
+
+/*! \brief I/Q recorder block.
+ *  \ingroup IO
+ *
+ * Sink block recording I/Q samples using an iq_file_writer. The block
+ * can stay connected while closed, in which case it discards its input.
+ */
+class iq_file_sink : public gr::sync_block
+{
+    friend iq_file_sink_sptr make_iq_file_sink(void);
+
+protected:
+    iq_file_sink(void);
+
+public:
+    ~iq_file_sink();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    bool open(const std::string &filename, iq_file_format format,
+              double sample_rate, double frequency, bool direct = true);
+    void close();
+    bool is_open();
+
+    void get_stats(iq_file_stats &stats);
+
+private:
+    iq_file_writer  d_writer;
+};
+
+#endif // IQ_FILE_SINK_H
@@ -0,0 +1,338 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/io_signature.h>
+
+#include "iq_file_source.h"
+
+#define MAX_CHUNK_SEC   0.05    /* max output per work() when throttled */
+#define READAHEAD_SEC   1.0     /* prefetched after a seek */
+
+
+static double get_time()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1.e-9;
+}
+
+static unsigned int sample_size(iq_file_format format)
+{
+    return (format == IQ_FORMAT_CS8) ? 2 : (format == IQ_FORMAT_CS16) ? 4 : 8;
+}
+
+/* Find a key in the SigMF metadata and return the text after the colon. */
+static bool find_meta_value(const std::string &meta, const char *key,
+                            std::string &value)
+{
+    std::string quoted = std::string("\"") + key + "\"";
+    size_t pos = meta.find(quoted);
+
+    if (pos == std::string::npos)
+        return false;
+
+    pos = meta.find(':', pos + quoted.size());
+    if (pos == std::string::npos)
+        return false;
+
+    pos = meta.find_first_not_of(" \t\r\n", pos + 1);
+    if (pos == std::string::npos)
+        return false;
+
+    if (meta[pos] == '"')
+    {
+        size_t end = meta.find('"', pos + 1);
+
+        if (end == std::string::npos)
+            return false;
+        value = meta.substr(pos + 1, end - pos - 1);
+    }
+    else
+    {
+        value = meta.substr(pos, meta.find_first_of(",}\r\n", pos) - pos);
+    }
+
+    return true;
+}
+
+static bool read_meta(const std::string &filename, iq_file_info &info)
+{
+    std::ifstream       file(iq_file_writer::meta_filename(filename).c_str());
+    std::stringstream   buf;
+    std::string         meta, value;
+
+    if (!file)
+        return false;
+
+    buf << file.rdbuf();
+    meta = buf.str();
+
+    if (!find_meta_value(meta, "core:datatype", value))
+        return false;
+
+    if (value == "cf32_le" || value == "cf32")
+        info.format = IQ_FORMAT_CF32;
+    else if (value == "ci16_le" || value == "ci16")
+        info.format = IQ_FORMAT_CS16;
+    else if (value == "ci8")
+        info.format = IQ_FORMAT_CS8;
+    else
+        return false;
+
+    if (find_meta_value(meta, "core:sample_rate", value))
+        info.sample_rate = atof(value.c_str());
+
+    // frequency of the first capture segment
+    if (find_meta_value(meta, "core:frequency", value))
+        info.frequency = atof(value.c_str());
+
+    return true;
+}
+
+/* gqrx_yyyyMMdd_hhmmss_freq_rate_fc.ext */
+static void parse_filename(const std::string &filename, iq_file_info &info)
+{
+    std::string         name = filename.substr(filename.find_last_of('/') + 1);
+    std::string         ext = name.substr(name.find_last_of('.') + 1);
+    std::vector<std::string>    fields;
+    size_t              start = 0, end;
+
+    if (ext == "cs16")
+        info.format = IQ_FORMAT_CS16;
+    else if (ext == "cs8")
+        info.format = IQ_FORMAT_CS8;
+    else
+        info.format = IQ_FORMAT_CF32;
+
+    while ((end = name.find('_', start)) != std::string::npos)
+    {
+        fields.push_back(name.substr(start, end - start));
+        start = end + 1;
+    }
+    fields.push_back(name.substr(start));
+
+    if (fields.size() >= 5)
+    {
+        info.frequency = atof(fields[3].c_str());
+        info.sample_rate = atof(fields[4].c_str());
+    }
+}
+
+bool get_iq_file_info(const std::string &filename, iq_file_info &info)
+{
+    struct stat     st;
+
+    if (stat(filename.c_str(), &st) != 0)
+        return false;
+
+    info.format = IQ_FORMAT_CF32;
+    info.sample_rate = 0.0;
+    info.frequency = 0.0;
+
+    if (!read_meta(filename, info))
+        parse_filename(filename, info);
+
+    info.num_samples = st.st_size / sample_size(info.format);
+
+    return true;
+}
+
+
+iq_file_source_sptr make_iq_file_source(const std::string &filename,
+                                        const iq_file_info &info)
+{
+    return gnuradio::get_initial_sptr(new iq_file_source(filename, info));
+}
+
+iq_file_source::iq_file_source(const std::string &filename,
+                               const iq_file_info &info)
+    : gr::sync_block("iq_file_source",
+                     gr::io_signature::make(0, 0, 0),
+                     gr::io_signature::make(1, 1, sizeof(gr_complex))),
+      d_info(info),
+      d_fd(-1),
+      d_data(0),
+      d_size(0),
+      d_sample_size(sample_size(info.format)),
+      d_pos(0),
+      d_seek(-1),
+      d_speed(1.0),
+      d_cur_speed(1.0),
+      d_t0(0.0),
+      d_n0(0)
+{
+    struct stat st;
+    void       *data;
+
+    d_fd = open(filename.c_str(), O_RDONLY);
+    if (d_fd < 0)
+    {
+        perror("iq_file_source: Can not open file");
+        return;
+    }
+
+    if (fstat(d_fd, &st) != 0 || st.st_size < (off_t) d_sample_size)
+    {
+        fprintf(stderr, "iq_file_source: %s is empty\n", filename.c_str());
+        return;
+    }
+
+    d_size = st.st_size;
+    data = mmap(0, d_size, PROT_READ, MAP_SHARED, d_fd, 0);
+    if (data == MAP_FAILED)
+    {
+        perror("iq_file_source: Can not map file");
+        return;
+    }
+    madvise(data, d_size, MADV_SEQUENTIAL);
+
+    d_data = (const char *) data;
+    d_info.num_samples = d_size / d_sample_size;
+    if (d_info.sample_rate <= 0.0)
+        d_info.sample_rate = 96000.0;
+
+    set_output_multiple(1);
+}
+
+iq_file_source::~iq_file_source()
+{
+    if (d_data)
+        munmap((void *) d_data, d_size);
+    if (d_fd >= 0)
+        close(d_fd);
+}
+
+void iq_file_source::seek(unsigned long long sample)
+{
+    d_seek = (long long) std::min(sample, d_info.num_samples);
+}
+
+void iq_file_source::set_speed(double speed)
+{
+    d_speed = std::max(0.0, speed);
+}
+
+void iq_file_source::throttle_reset()
+{
+    d_t0 = get_time();
+    d_n0 = 0;
+}
+
+int iq_file_source::work(int noutput_items,
+                         gr_vector_const_void_star &input_items,
+                         gr_vector_void_star &output_items)
+{
+    (void) input_items;
+
+    gr_complex         *out = (gr_complex *) output_items[0];
+    long long           seek = d_seek.exchange(-1);
+    unsigned long long  pos;
+    double              speed = d_speed;
+    double              rate;
+    double              delay;
+    int                 i, n, num;
+
+    if (!d_data)
+        return -1;
+
+    if (seek >= 0)
+    {
+        size_t offset = (seek * d_sample_size) & ~(size_t)(getpagesize() - 1);
+        size_t len = READAHEAD_SEC * d_info.sample_rate * d_sample_size;
+
+        d_pos = seek;
+        madvise((void *)(d_data + offset), std::min(len, d_size - offset),
+                MADV_WILLNEED);
+        throttle_reset();
+    }
+
+    pos = d_pos;
+
+    // zeros are output in real time at the end of the file
+    if (pos >= d_info.num_samples && speed == 0.0)
+        speed = 1.0;
+
+    if (speed != d_cur_speed)
+    {
+        d_cur_speed = speed;
+        throttle_reset();
+    }
+
+    num = noutput_items;
+    if (speed > 0.0)
+    {
+        rate = d_info.sample_rate * speed;
+        num = std::min(num, std::max(1, (int)(rate * MAX_CHUNK_SEC)));
+
+        // sleep until these samples are due
+        delay = d_t0 + (d_n0 + num) / rate - get_time();
+        if (delay > 0.0)
+            boost::this_thread::sleep(boost::posix_time::microseconds((long)(delay * 1.e6)));
+        else if (delay < -1.0)
+            throttle_reset();  // do not catch up after a stall
+        d_n0 += num;
+    }
+
+    n = (int) std::min<unsigned long long>(num, d_info.num_samples - std::min(pos, d_info.num_samples));
+
+    // convert from the memory mapped file straight into the output buffer
+    if (d_info.format == IQ_FORMAT_CF32)
+    {
+        memcpy(out, d_data + pos * d_sample_size, n * sizeof(gr_complex));
+    }
+    else if (d_info.format == IQ_FORMAT_CS16)
+    {
+        const int16_t  *in = (const int16_t *)(d_data + pos * d_sample_size);
+        float          *outf = (float *) out;
+
+        for (i = 0; i < 2 * n; i++)
+            outf[i] = in[i] * (1.f / 32767.f);
+    }
+    else
+    {
+        const int8_t   *in = (const int8_t *)(d_data + pos * d_sample_size);
+        float          *outf = (float *) out;
+
+        for (i = 0; i < 2 * n; i++)
+            outf[i] = in[i] * (1.f / 127.f);
+    }
+
+    std::fill(out + n, out + num, gr_complex(0.0f, 0.0f));
+
+    // a concurrent seek is applied in the next call
+    d_pos.compare_exchange_strong(pos, pos + n);
+
+    return num;
+}
@@ -0,0 +1,120 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef IQ_FILE_SOURCE_H
+#define IQ_FILE_SOURCE_H
+
+#include <string>
+#include <boost/atomic.hpp>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/sync_block.h>
+#include "interfaces/iq_file_sink.h"
+
+
+/*! \brief Properties of an I/Q file. */
+struct iq_file_info {
+    iq_file_format      format;
+    double              sample_rate;    /*!< Sample rate, 0 if unknown. */
+    double              frequency;      /*!< Center frequency, 0 if unknown. */
+    unsigned long long  num_samples;
+};
+
+/*! \brief Get the properties of an I/Q file.
+ *
+ * The format, sample rate and frequency are read from the SigMF metadata
+ * file written by iq_file_writer when it exists. Otherwise they are taken
+ * from the file name, gqrx_yyyyMMdd_hhmmss_freq_rate_fc.ext, where the
+ * extension is .raw for cf32, .cs16 or .cs8.
+ *
+ * \returns False if the file can not be read or has an unsupported format.
+ */
+bool get_iq_file_info(const std::string &filename, iq_file_info &info);
+
+
+class iq_file_source;
+
+typedef boost::shared_ptr<iq_file_source> iq_file_source_sptr;
+
+iq_file_source_sptr make_iq_file_source(const std::string &filename,
+                                        const iq_file_info &info);
+
+
+/*! \brief Memory mapped I/Q file source.
+ *  \ingroup IO
+ *
+ * The file is mapped into memory and converted to complex float directly
+ * from the mapping, so seeking only sets the read position. seek() and
+ * set_speed() are lock-free and take effect in the next call to work().
+ *
+ * The playback speed is a factor of the file sample rate, 0 for as fast
+ * as possible. At the end of the file the block outputs zeros in real
+ * time until it is seeked back or removed from the flow graph.
+ */
+class iq_file_source : public gr::sync_block
+{
+    friend iq_file_source_sptr make_iq_file_source(const std::string &filename,
+                                                   const iq_file_info &info);
+
+protected:
+    iq_file_source(const std::string &filename, const iq_file_info &info);
+
+public:
+    ~iq_file_source();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    bool is_open() const { return d_data != 0; }
+
+    /*! \brief Set the read position in samples. */
+    void seek(unsigned long long sample);
+
+    /*! \brief Set the playback speed, e.g. 0.1 to 10, or 0 for unthrottled. */
+    void set_speed(double speed);
+
+    /*! \brief Get the read position in samples. */
+    unsigned long long get_position() const { return d_pos; }
+
+    unsigned long long get_length() const { return d_info.num_samples; }
+    double sample_rate() const { return d_info.sample_rate; }
+    double frequency() const { return d_info.frequency; }
+
+private:
+    void throttle_reset();
+
+    iq_file_info    d_info;
+    int             d_fd;
+    const char     *d_data;         /*!< The mapped file. */
+    size_t          d_size;         /*!< Size of the mapping in bytes. */
+    unsigned int    d_sample_size;
+
+    boost::atomic<unsigned long long>   d_pos;
+    boost::atomic<long long>            d_seek;     /*!< Pending seek, -1 if none. */
+    boost::atomic<double>               d_speed;
+
+    double          d_cur_speed;    /*!< Speed used for throttling. */
+    double          d_t0;           /*!< Throttle reference time. */
+    unsigned long long  d_n0;       /*!< Samples output since d_t0. */
+};
+
+#endif // IQ_FILE_SOURCE_H
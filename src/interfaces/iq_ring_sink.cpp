@@ -0,0 +1,231 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/io_signature.h>
+
+#include "iq_ring_sink.h"
+
+#define READ_CHUNK      65536   /* samples per write to the file writer */
+#define READ_SLEEP_MS   10
+
+
+iq_ring_sink_sptr make_iq_ring_sink(double sample_rate, double history)
+{
+    return gnuradio::get_initial_sptr(new iq_ring_sink(sample_rate, history));
+}
+
+iq_ring_sink::iq_ring_sink(double sample_rate, double history)
+    : gr::sync_block("iq_ring_sink",
+                     gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                     gr::io_signature::make(0, 0, 0)),
+      d_sample_rate(sample_rate),
+      d_history(history),
+      d_hist_len(0),
+      d_head(0),
+      d_tail(0),
+      d_stop_at(ULLONG_MAX),
+      d_committing(false),
+      d_dropped(0)
+{
+    resize();
+}
+
+iq_ring_sink::~iq_ring_sink()
+{
+    finish();
+}
+
+/* Allocate the ring for the current rate and history. The ring is one
+ * second larger than the history, which is how far the reader can fall
+ * behind while committing before samples are dropped.
+ */
+void iq_ring_sink::resize()
+{
+    d_hist_len = (unsigned long long)(d_history * d_sample_rate);
+
+    d_ring.clear();
+    if (d_hist_len > 0)
+        d_ring.resize(d_hist_len + (unsigned long long) d_sample_rate);
+    d_ring.shrink_to_fit();
+
+    d_head = 0;
+    d_tail = 0;
+}
+
+/* Stop committing and wait until the file is closed. */
+void iq_ring_sink::finish()
+{
+    stop_commit();
+    if (d_thread.joinable())
+        d_thread.join();
+}
+
+void iq_ring_sink::set_sample_rate(double sample_rate)
+{
+    finish();
+
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_sample_rate = sample_rate;
+    resize();
+}
+
+void iq_ring_sink::set_history(double seconds)
+{
+    finish();
+
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_history = seconds;
+    resize();
+}
+
+int iq_ring_sink::work(int noutput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+{
+    (void) output_items;
+
+    const gr_complex   *in = (const gr_complex *) input_items[0];
+    unsigned long long  head, num, space;
+    size_t              size, idx, n1;
+
+    gr::thread::scoped_lock lock(d_setlock);
+
+    size = d_ring.size();
+    if (size == 0)
+        return noutput_items;
+
+    head = d_head.load(boost::memory_order_relaxed);
+    num = noutput_items;
+
+    if (d_committing)
+    {
+        // never overwrite samples the reader has not written yet
+        space = size - (head - d_tail.load(boost::memory_order_acquire));
+        if (num > space)
+        {
+            d_dropped += num - space;
+            num = space;
+        }
+    }
+    else if (num > size)
+    {
+        in += num - size;
+        num = size;
+    }
+
+    idx = head % size;
+    n1 = std::min<size_t>(num, size - idx);
+    memcpy(&d_ring[idx], in, n1 * sizeof(gr_complex));
+    memcpy(&d_ring[0], in + n1, (num - n1) * sizeof(gr_complex));
+    d_head.store(head + num, boost::memory_order_release);
+
+    return noutput_items;
+}
+
+bool iq_ring_sink::commit(const std::string &filename, iq_file_format format,
+                          double frequency)
+{
+    unsigned long long  head, avail;
+
+    gr::thread::scoped_lock lock(d_setlock);
+
+    if (d_committing || d_ring.empty())
+        return false;
+
+    // previous commit has finished
+    if (d_thread.joinable())
+        d_thread.join();
+
+    head = d_head;
+    avail = std::min(head, d_hist_len);
+
+    if (!d_writer.open(filename, format, d_sample_rate, frequency, true,
+                       avail / d_sample_rate))
+        return false;
+
+    d_tail = head - avail;
+    d_stop_at = ULLONG_MAX;
+    d_dropped = 0;
+    d_committing = true;
+    d_thread = gr::thread::thread(boost::bind(&iq_ring_sink::reader, this));
+
+    return true;
+}
+
+void iq_ring_sink::stop_commit()
+{
+    if (d_committing)
+        d_stop_at = d_head.load();
+}
+
+/* Copy samples from the ring to the file writer until stopped. */
+void iq_ring_sink::reader()
+{
+    unsigned long long  head, tail;
+    size_t              size = d_ring.size();
+    size_t              idx, n;
+
+    while (true)
+    {
+        head = std::min(d_head.load(boost::memory_order_acquire),
+                        d_stop_at.load());
+        tail = d_tail.load(boost::memory_order_relaxed);
+
+        if (tail >= d_stop_at)
+            break;
+
+        if (head == tail)
+        {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(READ_SLEEP_MS));
+            continue;
+        }
+
+        idx = tail % size;
+        n = std::min<unsigned long long>(head - tail, size - idx);
+        n = std::min<size_t>(n, READ_CHUNK);
+
+        // wait for the disk rather than drop; work() stops at a full ring
+        d_writer.write(&d_ring[idx], n, true);
+        d_tail.store(tail + n, boost::memory_order_release);
+    }
+
+    {
+        gr::thread::scoped_lock lock(d_writer_mutex);
+        d_writer.close();
+    }
+    d_committing = false;
+}
+
+void iq_ring_sink::get_stats(iq_file_stats &stats)
+{
+    gr::thread::scoped_lock lock(d_writer_mutex);
+
+    d_writer.get_stats(stats);
+    stats.dropped += d_dropped;
+}
@@ -0,0 +1,126 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef IQ_RING_SINK_H
+#define IQ_RING_SINK_H
+
+#include <string>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/sync_block.h>
+#include <gnuradio/thread/thread.h>
+#include "interfaces/iq_file_sink.h"
+
+
+class iq_ring_sink;
+
+typedef boost::shared_ptr<iq_ring_sink> iq_ring_sink_sptr;
+
+iq_ring_sink_sptr make_iq_ring_sink(double sample_rate, double history);
+
+
+/*! \brief Pre-trigger I/Q recorder.
+ *  \ingroup IO
+ *
+ * The block keeps the most recent I/Q samples in a circular buffer in
+ * memory. When commit() is called, a file is opened and the buffered
+ * history is written to it followed by the live samples until
+ * stop_commit() is called, so a recording can start some time before the
+ * event that triggered it.
+ *
+ * work() only copies its input into the ring. The history and the live
+ * samples are read from the ring by a separate thread, which passes them
+ * to an iq_file_writer and waits for it when the disk does not keep up.
+ * While committing the ring does not overwrite samples that have not been
+ * read yet; if the reader falls behind by more than the free space in the
+ * ring, new samples are dropped in work() and counted.
+ */
+class iq_ring_sink : public gr::sync_block
+{
+    friend iq_ring_sink_sptr make_iq_ring_sink(double sample_rate, double history);
+
+protected:
+    iq_ring_sink(double sample_rate, double history);
+
+public:
+    ~iq_ring_sink();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    /*! \brief Set the sample rate. Clears the history.
+     *
+     * A running commit is finished first, which waits for the remaining
+     * samples to be written to disk, so this should not be called while the
+     * flow graph is locked.
+     */
+    void set_sample_rate(double sample_rate);
+
+    /*! \brief Set the amount of history to keep in seconds. Clears the history.
+     *
+     * Like set_sample_rate() this waits for a running commit to finish.
+     */
+    void set_history(double seconds);
+    double get_history() const { return d_history; }
+
+    /*! \brief Start writing history and live samples to a file.
+     *  \returns False if already committing or the file can not be opened.
+     */
+    bool commit(const std::string &filename, iq_file_format format,
+                double frequency);
+
+    /*! \brief Stop writing to the file.
+     *
+     * Returns immediately. The samples received so far are still written
+     * and is_committing() returns true until the file has been closed.
+     */
+    void stop_commit();
+
+    bool is_committing() const { return d_committing; }
+
+    void get_stats(iq_file_stats &stats);
+
+private:
+    void resize();
+    void finish();
+    void reader();
+
+    double          d_sample_rate;
+    double          d_history;      /*!< History in seconds. */
+
+    std::vector<gr_complex> d_ring;
+    unsigned long long      d_hist_len; /*!< History in samples. */
+
+    boost::atomic<unsigned long long>   d_head;     /*!< Samples written. */
+    boost::atomic<unsigned long long>   d_tail;     /*!< Samples read. */
+    boost::atomic<unsigned long long>   d_stop_at;  /*!< Last sample to write. */
+    boost::atomic<bool>                 d_committing;
+    boost::atomic<unsigned long long>   d_dropped;
+
+    iq_file_writer      d_writer;
+    gr::thread::mutex   d_writer_mutex; /*!< Protects d_writer.close(). */
+    gr::thread::thread  d_thread;
+};
+
+#endif // IQ_RING_SINK_H
@@ -0,0 +1,681 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <unistd.h>
+#include <gnuradio/filter/firdes.h>
+#include <boost/bind.hpp>
+
+#include "iq_server.h"
+
+#define MAX_DECIM           256
+#define MAX_QUEUE_BYTES     (4 * 1024 * 1024)   /* per client */
+#define MAX_LINE            256
+#define UDP_PAYLOAD         1472
+#define POLL_TIMEOUT_MS     10
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL        0
+#endif
+
+
+static int set_nonblocking(int sock)
+{
+    return fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) | O_NONBLOCK);
+}
+
+static unsigned int sample_size(iq_server::sample_format format)
+{
+    switch (format)
+    {
+    case iq_server::FORMAT_CS16:
+        return 4;
+    case iq_server::FORMAT_CS8:
+        return 2;
+    default:
+        return 8;
+    }
+}
+
+iq_server::iq_server()
+    : d_listen(-1),
+      d_udp4(-1),
+      d_udp6(-1),
+      d_running(false),
+      d_stop(false),
+      d_num_clients(0)
+{
+
+}
+
+iq_server::~iq_server()
+{
+    stop();
+}
+
+bool iq_server::start(int port, data_tap_c_sptr iq_tap, data_tap_c_sptr filtered_tap)
+{
+    struct sockaddr_in6 addr;
+    int                 on = 1;
+    int                 off = 0;
+
+    if (d_running)
+        stop();
+
+    // dual stack socket accepting both IPv6 and IPv4 clients
+    d_listen = socket(AF_INET6, SOCK_STREAM, 0);
+    if (d_listen < 0)
+    {
+        perror("iq_server: Can not create socket");
+        return false;
+    }
+
+    setsockopt(d_listen, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(d_listen, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons(port);
+
+    if (bind(d_listen, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+        listen(d_listen, 8) < 0)
+    {
+        perror("iq_server: Can not listen");
+        close(d_listen);
+        d_listen = -1;
+        return false;
+    }
+    set_nonblocking(d_listen);
+
+    d_taps[SOURCE_IQ] = iq_tap;
+    d_taps[SOURCE_FILTERED] = filtered_tap;
+
+    // discard what has accumulated before the server started, and feed
+    // nothing until a client starts streaming
+    for (int i = 0; i < SOURCE_COUNT; i++)
+    {
+        if (d_taps[i])
+        {
+            d_taps[i]->set_enabled(false);
+            d_taps[i]->consume(d_taps[i]->available());
+        }
+    }
+
+    d_stop = false;
+    d_running = true;
+    d_thread = boost::thread(boost::bind(&iq_server::thread_loop, this));
+
+    return true;
+}
+
+void iq_server::stop()
+{
+    if (!d_running)
+        return;
+
+    d_stop = true;
+    d_thread.join();
+    d_running = false;
+
+    for (unsigned int i = 0; i < d_clients.size(); i++)
+        close(d_clients[i]->sock);
+    d_clients.clear();
+    d_num_clients = 0;
+
+    close(d_listen);
+    d_listen = -1;
+    if (d_udp4 >= 0)
+        close(d_udp4);
+    if (d_udp6 >= 0)
+        close(d_udp6);
+    d_udp4 = d_udp6 = -1;
+
+    for (int i = 0; i < SOURCE_COUNT; i++)
+    {
+        if (d_taps[i])
+            d_taps[i]->set_enabled(true);
+        d_taps[i].reset();
+    }
+}
+
+void iq_server::set_tap(int src, data_tap_c_sptr tap)
+{
+    boost::mutex::scoped_lock lock(d_tap_mutex);
+
+    if (tap == d_taps[src])
+        return;
+
+    if (d_taps[src])
+        d_taps[src]->set_enabled(true);
+
+    d_taps[src] = tap;
+    if (tap)
+    {
+        tap->set_enabled(false);
+        tap->consume(tap->available());
+    }
+
+    // set up the clients for the new stream
+    for (unsigned int i = 0; i < d_clients.size(); i++)
+    {
+        if (d_clients[i]->src == src)
+            d_clients[i]->rate = 0.0;
+    }
+}
+
+void iq_server::thread_loop()
+{
+    std::vector<struct pollfd>  fds;
+    unsigned int                i;
+
+    while (!d_stop)
+    {
+        fds.resize(d_clients.size() + 1);
+        fds[0].fd = d_listen;
+        fds[0].events = POLLIN;
+        for (i = 0; i < d_clients.size(); i++)
+        {
+            client &c = *d_clients[i];
+
+            fds[i + 1].fd = c.sock;
+            fds[i + 1].events = POLLIN;
+            if (!c.udp_port && c.queued > 0)
+                fds[i + 1].events |= POLLOUT;
+        }
+
+        // samples arrive continuously, so the timeout paces the loop
+        poll(&fds[0], fds.size(), POLL_TIMEOUT_MS);
+
+        boost::mutex::scoped_lock lock(d_tap_mutex);
+
+        for (i = 0; i < d_clients.size(); i++)
+        {
+            if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))
+                read_commands(*d_clients[i]);
+        }
+
+        if (fds[0].revents & POLLIN)
+            accept_client();
+
+        for (i = 0; i < SOURCE_COUNT; i++)
+            process_source(i);
+
+        for (i = 0; i < d_clients.size(); i++)
+            flush_client(*d_clients[i]);
+
+        for (i = 0; i < d_clients.size(); )
+        {
+            if (d_clients[i]->closed)
+            {
+                close(d_clients[i]->sock);
+                d_clients.erase(d_clients.begin() + i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+        d_num_clients = d_clients.size();
+
+        update_taps();
+    }
+}
+
+/* Only feed the taps that have a streaming client. */
+void iq_server::update_taps()
+{
+    bool            used[SOURCE_COUNT] = { false, false };
+    unsigned int    i;
+
+    for (i = 0; i < d_clients.size(); i++)
+    {
+        if (d_clients[i]->started)
+            used[d_clients[i]->src] = true;
+    }
+
+    for (i = 0; i < SOURCE_COUNT; i++)
+    {
+        if (d_taps[i])
+            d_taps[i]->set_enabled(used[i]);
+    }
+}
+
+void iq_server::accept_client()
+{
+    boost::shared_ptr<client>   c(new client);
+    int                         on = 1;
+
+    c->addrlen = sizeof(c->addr);
+    c->sock = accept(d_listen, (struct sockaddr *) &c->addr, &c->addrlen);
+    if (c->sock < 0)
+        return;
+
+    set_nonblocking(c->sock);
+    setsockopt(c->sock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    c->udp_port = 0;
+    c->started = false;
+    c->closed = false;
+    c->src = SOURCE_IQ;
+    c->offset = 0.0;
+    c->decim = 1;
+    c->format = FORMAT_CF32;
+    c->drop = true;
+    c->rate = 0.0;
+    c->phase = 0;
+    c->queued = 0;
+    c->sent = 0;
+    c->dropped = 0;
+
+    d_clients.push_back(c);
+}
+
+void iq_server::read_commands(client &c)
+{
+    char        buf[512];
+    ssize_t     len;
+    size_t      pos;
+    std::string answer;
+
+    len = recv(c.sock, buf, sizeof(buf), 0);
+    if (len == 0 || (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+        c.closed = true;
+        return;
+    }
+    if (len < 0)
+        return;
+
+    c.inbuf.append(buf, len);
+
+    while ((pos = c.inbuf.find('\n')) != std::string::npos)
+    {
+        std::string line = c.inbuf.substr(0, pos);
+
+        c.inbuf.erase(0, pos + 1);
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+
+        answer = handle_command(c, line);
+        if (!c.started || line == "START")
+            reply(c, answer);
+    }
+
+    if (c.inbuf.size() > MAX_LINE)
+        c.closed = true;
+}
+
+/* Execute a command and return the answer. */
+std::string iq_server::handle_command(client &c, const std::string &line)
+{
+    char        cmd[32];
+    char        arg[64];
+    int         n;
+    char       *end;
+
+    n = sscanf(line.c_str(), "%31s %63s", cmd, arg);
+    if (n < 1)
+        return "ERR";
+
+    for (char *p = cmd; *p; p++)
+        *p = toupper(*p);
+    if (n == 2)
+        for (char *p = arg; *p; p++)
+            *p = toupper(*p);
+
+    if (!strcmp(cmd, "START") && n == 1)
+    {
+        c.started = true;
+        return "OK";
+    }
+    else if (!strcmp(cmd, "RATE") && n == 1)
+    {
+        char rate[32];
+        data_tap_c_sptr tap = d_taps[c.src];
+
+        snprintf(rate, sizeof(rate), "%.1f", tap ? tap->rate() / c.decim : 0.0);
+        return rate;
+    }
+    else if (n != 2)
+    {
+        return "ERR";
+    }
+    else if (!strcmp(cmd, "SOURCE"))
+    {
+        int src = !strcmp(arg, "IQ") ? SOURCE_IQ :
+                  !strcmp(arg, "FILTERED") ? SOURCE_FILTERED : -1;
+
+        if (src < 0 || !d_taps[src])
+            return "ERR";
+        c.src = src;
+        c.rate = 0.0;
+    }
+    else if (!strcmp(cmd, "OFFSET"))
+    {
+        double offset = strtod(arg, &end);
+
+        if (*end)
+            return "ERR";
+        c.offset = offset;
+        c.rate = 0.0;
+    }
+    else if (!strcmp(cmd, "DECIM"))
+    {
+        long decim = strtol(arg, &end, 10);
+
+        if (*end || decim < 1 || decim > MAX_DECIM)
+            return "ERR";
+        c.decim = decim;
+        c.rate = 0.0;
+    }
+    else if (!strcmp(cmd, "FORMAT"))
+    {
+        if (!strcmp(arg, "CF32"))
+            c.format = FORMAT_CF32;
+        else if (!strcmp(arg, "CS16"))
+            c.format = FORMAT_CS16;
+        else if (!strcmp(arg, "CS8"))
+            c.format = FORMAT_CS8;
+        else
+            return "ERR";
+    }
+    else if (!strcmp(cmd, "UDP"))
+    {
+        long port = strtol(arg, &end, 10);
+
+        if (*end || port < 0 || port > 65535)
+            return "ERR";
+        if (port > 0 && get_udp_socket(c.addr.ss_family) < 0)
+            return "ERR";
+        c.udp_port = port;
+    }
+    else if (!strcmp(cmd, "POLICY"))
+    {
+        if (!strcmp(arg, "DROP"))
+            c.drop = true;
+        else if (!strcmp(arg, "DISCONNECT"))
+            c.drop = false;
+        else
+            return "ERR";
+    }
+    else
+    {
+        return "ERR";
+    }
+
+    return "OK";
+}
+
+/* Write a reply line directly; replies are short and sent before streaming. */
+void iq_server::reply(client &c, const std::string &text)
+{
+    std::string line = text + "\n";
+
+    if (send(c.sock, line.data(), line.size(), MSG_NOSIGNAL) < 0 &&
+        errno != EAGAIN && errno != EWOULDBLOCK)
+        c.closed = true;
+}
+
+/* (Re)initialize mixer and decimation filter for the source rate. */
+void iq_server::setup_dsp(client &c, double rate)
+{
+    double w = -2.0 * M_PI * c.offset / rate;
+
+    c.rate = rate;
+    c.phasor = gr_complex(1.0f, 0.0f);
+    c.phasor_inc = gr_complex(cos(w), sin(w));
+    c.phase = 0;
+
+    if (c.decim > 1)
+    {
+        // pass band edge at 80% of the output Nyquist frequency
+        double out_rate = rate / c.decim;
+
+        c.taps = gr::filter::firdes::low_pass(1.0, rate, 0.4 * out_rate,
+                                              0.2 * out_rate);
+    }
+    else
+    {
+        c.taps.assign(1, 1.0f);
+    }
+
+    c.buf.assign(c.taps.size() - 1, gr_complex(0.0f, 0.0f));
+}
+
+void iq_server::process_source(int src)
+{
+    data_tap_c_sptr     tap = d_taps[src];
+    const gr_complex   *data;
+    unsigned int        num;
+    unsigned int        i;
+    double              rate;
+
+    if (!tap)
+        return;
+
+    rate = tap->rate();
+
+    // the ring buffer may return the data in two spans
+    while ((num = tap->read_span(&data)) > 0)
+    {
+        for (i = 0; i < d_clients.size(); i++)
+        {
+            client &c = *d_clients[i];
+
+            if (c.started && !c.closed && c.src == src)
+                process_client(c, data, num, rate);
+        }
+        tap->consume(num);
+    }
+}
+
+void iq_server::process_client(client &c, const gr_complex *in, unsigned int num,
+                               double rate)
+{
+    unsigned int    ntaps;
+    unsigned int    hist;
+    unsigned int    n, k, nout;
+    gr_complex      acc;
+
+    if (c.rate != rate)
+        setup_dsp(c, rate);
+
+    ntaps = c.taps.size();
+    hist = ntaps - 1;
+
+    // frequency shift
+    c.buf.resize(hist + num);
+    for (n = 0; n < num; n++)
+    {
+        c.buf[hist + n] = in[n] * c.phasor;
+        c.phasor *= c.phasor_inc;
+    }
+    c.phasor /= std::abs(c.phasor);
+
+    // low pass filter, evaluated only for the output samples
+    nout = 0;
+    for (n = c.phase; n < num; n += c.decim)
+    {
+        const gr_complex *x = &c.buf[n];
+
+        acc = gr_complex(0.0f, 0.0f);
+        for (k = 0; k < ntaps; k++)
+            acc += x[k] * c.taps[k];
+        c.buf[nout++] = acc;    // never overwrites unread input
+    }
+    c.phase = n - num;
+
+    // convert
+    c.out.resize(nout * sample_size(c.format));
+    if (c.format == FORMAT_CF32)
+    {
+        memcpy(&c.out[0], &c.buf[0], nout * sizeof(gr_complex));
+    }
+    else if (c.format == FORMAT_CS16)
+    {
+        int16_t *out = (int16_t *) &c.out[0];
+
+        for (n = 0; n < nout; n++)
+        {
+            *out++ = (int16_t) (std::max(-1.f, std::min(1.f, c.buf[n].real())) * 32767.f);
+            *out++ = (int16_t) (std::max(-1.f, std::min(1.f, c.buf[n].imag())) * 32767.f);
+        }
+    }
+    else
+    {
+        int8_t *out = (int8_t *) &c.out[0];
+
+        for (n = 0; n < nout; n++)
+        {
+            *out++ = (int8_t) (std::max(-1.f, std::min(1.f, c.buf[n].real())) * 127.f);
+            *out++ = (int8_t) (std::max(-1.f, std::min(1.f, c.buf[n].imag())) * 127.f);
+        }
+    }
+
+    // keep filter history
+    std::copy(c.buf.begin() + num, c.buf.begin() + num + hist, c.buf.begin());
+    c.buf.resize(hist);
+
+    if (nout > 0)
+        queue_data(c, &c.out[0], c.out.size());
+}
+
+/* Append data to the send queue of a client. UDP data is split into
+ * datagrams holding whole samples.
+ */
+void iq_server::queue_data(client &c, const char *data, size_t len)
+{
+    size_t chunk = len;
+
+    if (c.udp_port)
+    {
+        unsigned int size = sample_size(c.format);
+
+        chunk = UDP_PAYLOAD - UDP_PAYLOAD % size;
+    }
+
+    while (len > 0)
+    {
+        size_t n = std::min(chunk, len);
+
+        c.queue.push_back(std::vector<char>(data, data + n));
+        c.queued += n;
+        data += n;
+        len -= n;
+    }
+
+    if (c.queued <= MAX_QUEUE_BYTES)
+        return;
+
+    if (!c.drop)
+    {
+        c.closed = true;
+        return;
+    }
+
+    // drop the oldest data, but keep the partly sent front chunk so that
+    // the TCP stream stays aligned to samples
+    while (c.queued > MAX_QUEUE_BYTES && c.queue.size() > 1)
+    {
+        std::deque< std::vector<char> >::iterator it = c.queue.begin();
+
+        if (c.sent > 0)
+            ++it;
+        c.queued -= it->size();
+        c.dropped += it->size();
+        c.queue.erase(it);
+    }
+}
+
+/* Send as much of the queue as the socket accepts without blocking. */
+void iq_server::flush_client(client &c)
+{
+    ssize_t     n;
+
+    while (!c.closed && !c.queue.empty())
+    {
+        std::vector<char> &front = c.queue.front();
+
+        if (c.udp_port)
+        {
+            struct sockaddr_storage dest = c.addr;
+            int sock = get_udp_socket(dest.ss_family);
+
+            if (dest.ss_family == AF_INET6)
+                ((struct sockaddr_in6 *) &dest)->sin6_port = htons(c.udp_port);
+            else
+                ((struct sockaddr_in *) &dest)->sin_port = htons(c.udp_port);
+
+            n = sendto(sock, &front[0], front.size(), 0,
+                       (struct sockaddr *) &dest, c.addrlen);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+
+            // other errors, e.g. ICMP port unreachable, lose the datagram
+            c.queued -= front.size();
+            c.queue.pop_front();
+        }
+        else
+        {
+            n = send(c.sock, &front[c.sent], front.size() - c.sent, MSG_NOSIGNAL);
+            if (n < 0)
+            {
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    c.closed = true;
+                break;
+            }
+
+            c.sent += n;
+            if (c.sent < front.size())
+                break;
+
+            c.queued -= front.size();
+            c.sent = 0;
+            c.queue.pop_front();
+        }
+    }
+}
+
+/* Get the shared UDP socket for an address family. */
+int iq_server::get_udp_socket(int family)
+{
+    int &sock = (family == AF_INET6) ? d_udp6 : d_udp4;
+
+    if (sock < 0)
+    {
+        sock = socket(family, SOCK_DGRAM, 0);
+        if (sock >= 0)
+            set_nonblocking(sock);
+    }
+
+    return sock;
+}
@@ -0,0 +1,172 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef IQ_SERVER_H
+#define IQ_SERVER_H
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <sys/socket.h>
+#include <gnuradio/gr_complex.h>
+#include "dsp/data_tap.h"
+
+
+/*! \brief I/Q network streaming server.
+ *  \ingroup IO
+ *
+ * Serves baseband I/Q to any number of TCP clients. The server reads one
+ * data tap per source, so the flow graph produces each stream only once
+ * regardless of the number of clients. A tap is only fed while at least
+ * one client streams from it. Each client has its own frequency offset,
+ * decimation and sample format, applied in the server thread.
+ *
+ * Every client has a bounded send queue. When a client does not keep up,
+ * the oldest queued data is dropped, or the client is disconnected if it
+ * selected the DISCONNECT policy. Sockets are non-blocking, so a slow
+ * client never stalls the server thread or the receiver.
+ *
+ * Clients configure their stream with text commands, one per line:
+ *
+ *   SOURCE IQ|FILTERED    Full band I/Q or the output of the channel filter.
+ *   OFFSET <Hz>           Frequency offset within the source.
+ *   DECIM <n>             Decimation 1 to 256, with low pass filter.
+ *   FORMAT CF32|CS16|CS8  Sample format, interleaved I/Q, little endian.
+ *   UDP <port>            Send samples as UDP datagrams to this port on
+ *                         the client host instead of over TCP; 0 for TCP.
+ *   POLICY DROP|DISCONNECT  What to do when the send queue is full.
+ *   RATE                  Reply with the output sample rate.
+ *   START                 Start streaming.
+ *
+ * Until START each command is answered with "OK", "ERR" or the requested
+ * value on a line of its own. Once streaming, commands are still accepted,
+ * e.g. to retune the offset, but no longer answered since the replies
+ * would be mixed with the samples.
+ */
+class iq_server
+{
+public:
+    /*! \brief Available sources. */
+    enum source {
+        SOURCE_IQ       = 0,    /*!< I/Q before the channel filter. */
+        SOURCE_FILTERED = 1,    /*!< Output of the channel filter. */
+        SOURCE_COUNT    = 2
+    };
+
+    /*! \brief Sample formats. */
+    enum sample_format {
+        FORMAT_CF32 = 0,
+        FORMAT_CS16 = 1,
+        FORMAT_CS8  = 2
+    };
+
+    iq_server();
+    ~iq_server();
+
+    /*! \brief Start the server.
+     *  \param port The TCP port to listen on.
+     *  \param iq_tap Data tap providing SOURCE_IQ.
+     *  \param filtered_tap Data tap providing SOURCE_FILTERED, may be empty.
+     *  \returns False if the port can not be opened.
+     */
+    bool start(int port, data_tap_c_sptr iq_tap, data_tap_c_sptr filtered_tap);
+
+    /*! \brief Stop the server and disconnect all clients. */
+    void stop();
+
+    /*! \brief Replace the data tap of a source, e.g. after the receiver
+     *         providing SOURCE_FILTERED has changed.
+     *  \param src The source.
+     *  \param tap The new tap, may be empty if the source is not available.
+     */
+    void set_tap(int src, data_tap_c_sptr tap);
+
+    bool is_running() const { return d_running; }
+
+    /*! \brief Get the number of connected clients. */
+    unsigned int num_clients() const { return d_num_clients; }
+
+private:
+    struct client {
+        int             sock;
+        struct sockaddr_storage addr;
+        socklen_t       addrlen;
+        int             udp_port;   /*!< 0 when streaming over TCP. */
+        std::string     inbuf;      /*!< Partial command line. */
+        bool            started;
+        bool            closed;
+
+        /* stream configuration */
+        int             src;
+        double          offset;
+        unsigned int    decim;
+        sample_format   format;
+        bool            drop;       /*!< Drop data, else disconnect. */
+
+        /* signal processing state */
+        double          rate;       /*!< Source rate it is set up for. */
+        gr_complex      phasor;
+        gr_complex      phasor_inc;
+        std::vector<float>      taps;
+        std::vector<gr_complex> buf;    /*!< History + mixed input. */
+        unsigned int    phase;      /*!< Input samples to next output. */
+        std::vector<char>       out;    /*!< Formatted output. */
+
+        /* send queue */
+        std::deque< std::vector<char> > queue;
+        size_t          queued;     /*!< Bytes in queue. */
+        size_t          sent;       /*!< Bytes of queue.front() sent. */
+        unsigned long   dropped;    /*!< Bytes dropped. */
+    };
+
+    void thread_loop();
+    void update_taps();
+    void accept_client();
+    void read_commands(client &c);
+    std::string handle_command(client &c, const std::string &line);
+    void setup_dsp(client &c, double rate);
+    void process_source(int src);
+    void process_client(client &c, const gr_complex *in, unsigned int num,
+                        double rate);
+    void queue_data(client &c, const char *data, size_t len);
+    void flush_client(client &c);
+    void reply(client &c, const std::string &text);
+    int  get_udp_socket(int family);
+
+    int             d_listen;       /*!< Listening socket. */
+    int             d_udp4;         /*!< UDP sockets, created when needed. */
+    int             d_udp6;
+    bool            d_running;
+    boost::atomic<bool>         d_stop;
+    boost::atomic<unsigned int> d_num_clients;
+    boost::thread   d_thread;
+
+    boost::mutex    d_tap_mutex;    /*!< Protects d_taps and d_clients. */
+    data_tap_c_sptr d_taps[SOURCE_COUNT];
+    std::vector< boost::shared_ptr<client> >    d_clients;
+};
+
+#endif // IQ_SERVER_H
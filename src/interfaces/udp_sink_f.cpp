@@ -20,18 +20,37 @@
  * the Free Software Foundation, Inc., 51 Franklin Street,
  * Boston, MA 02110-1301, USA.
  */
-#include <gnuradio/hier_block2.h>
-#include <gnuradio/blocks/float_to_short.h>
-#include <gnuradio/blocks/udp_sink.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <unistd.h>
 #include <gnuradio/io_signature.h>
 
 #include "udp_sink_f.h"
 
+#define HEADER_SIZE     16
+#define HEADER_MAGIC    0x5147
+#define HEADER_VERSION  1
+
+/* Maximum number of packets per sendmmsg() call. */
+#define MAX_BATCH       32
+
+#ifdef GQRX_OS_MACX
+// There seems to be excessive packet loss (even to localhost) on OS X
+// unless the packet size is limited.
+#define DEFAULT_PACKET_SIZE     512
+#else
+#define DEFAULT_PACKET_SIZE     1472
+#endif
+
+#define MAX_PACKET_SIZE         65507
+
 
 /*
- * Create a new instance of gr::fcd::source_c_impl and return an
- * upcasted boost shared_ptr. This is effectively the public
- * constructor.
+ * Create a new instance of udp_sink_f and return a boost shared_ptr.
+ * This is effectively the public constructor.
  */
 udp_sink_f_sptr make_udp_sink_f()
 {
@@ -39,46 +58,353 @@ udp_sink_f_sptr make_udp_sink_f()
 }
 
 static const int MIN_IN = 1;  /*!< Mininum number of input streams. */
-static const int MAX_IN = 1;  /*!< Maximum number of input streams. */
+static const int MAX_IN = 2;  /*!< Maximum number of input streams. */
 static const int MIN_OUT = 0; /*!< Minimum number of output streams. */
 static const int MAX_OUT = 0; /*!< Maximum number of output streams. */
 
 udp_sink_f::udp_sink_f()
-    : gr::hier_block2("udp_sink_f",
-                      gr::io_signature::make(MIN_IN, MAX_IN, sizeof(float)),
-                      gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof(float)))
+    : gr::sync_block("udp_sink_f",
+                     gr::io_signature::make(MIN_IN, MAX_IN, sizeof(float)),
+                     gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof(float))),
+      d_sock4(-1),
+      d_sock6(-1),
+      d_stereo(false),
+      d_format(FORMAT_S16),
+      d_header(false),
+      d_packet_size(DEFAULT_PACKET_SIZE),
+      d_buf_len(0),
+      d_seq(0),
+      d_timestamp(0)
 {
-
-    d_f2s = gr::blocks::float_to_short::make(1, 32767);
-#ifdef GQRX_OS_MACX
-    // There seems to be excessive packet loss (even to localhost) on OS X
-    // unless the buffer size is limited.
-    d_sink = gr::blocks::udp_sink::make(sizeof(short), "localhost", 7355, 512);
-#else
-    d_sink = gr::blocks::udp_sink::make(sizeof(short), "localhost", 7355);
-#endif
-    d_sink->disconnect();
-
-    connect(self(), 0, d_f2s, 0);
-    connect(d_f2s, 0, d_sink, 0);
+    d_hdr.resize(MAX_BATCH * HEADER_SIZE);
+    d_iov.resize(MAX_BATCH * 2);
 }
 
 udp_sink_f::~udp_sink_f()
 {
+    if (d_sock4 >= 0)
+        close(d_sock4);
+    if (d_sock6 >= 0)
+        close(d_sock6);
 }
 
 /*! \brief Start streaming through the UDP sink
  *  \param host The hostname or IP address of the client.
  *  \param port The port used for the UDP stream
+ *
+ * Replaces any previous destinations.
  */
 void udp_sink_f::start_streaming(const std::string host, int port)
 {
-    d_sink->connect(host, port);
+    stop_streaming();
+    add_destination(host, port);
 }
 
 
 void udp_sink_f::stop_streaming(void)
 {
-    d_sink->disconnect();
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_dest.clear();
+}
+
+/*! \brief Add a destination.
+ *  \param host The hostname or IP address of the client.
+ *  \param port The port used for the UDP stream
+ *  \returns False if the host could not be resolved.
+ *
+ * A new stream is started with sequence number and sample index 0 when the
+ * first destination is added.
+ */
+bool udp_sink_f::add_destination(const std::string host, int port)
+{
+    struct addrinfo     hints;
+    struct addrinfo    *res;
+    destination         dest;
+    char                port_str[8];
+    int                 err;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    snprintf(port_str, sizeof(port_str), "%d", port);
+
+    err = getaddrinfo(host.c_str(), port_str, &hints, &res);
+    if (err != 0)
+    {
+        fprintf(stderr, "udp_sink_f: Can not resolve %s: %s\n",
+                host.c_str(), gai_strerror(err));
+        return false;
+    }
+
+    dest.host = host;
+    dest.port = port;
+    memcpy(&dest.addr, res->ai_addr, res->ai_addrlen);
+    dest.addrlen = res->ai_addrlen;
+    freeaddrinfo(res);
+
+    remove_destination(host, port);
+
+    gr::thread::scoped_lock lock(d_setlock);
+
+    dest.sock = get_socket(dest.addr.ss_family);
+    if (dest.sock < 0)
+        return false;
+
+    if (d_dest.empty())
+        reset_stream();
+
+    d_dest.push_back(dest);
+
+    return true;
+}
+
+/*! \brief Remove a destination.
+ *  \returns False if the destination was not found.
+ */
+bool udp_sink_f::remove_destination(const std::string host, int port)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+    std::vector<destination>::iterator it;
+
+    for (it = d_dest.begin(); it != d_dest.end(); ++it)
+    {
+        if (it->host == host && it->port == port)
+        {
+            d_dest.erase(it);
+            return true;
+        }
+    }
+
+    return false;
 }
 
+/*! \brief Set stream format.
+ *  \param stereo Send both channels instead of channel 0 only.
+ *  \param format The sample format.
+ *  \param header Prepend a header to each packet.
+ *
+ * Samples not yet sent are discarded and a new stream is started.
+ */
+void udp_sink_f::set_format(bool stereo, sample_format format, bool header)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_stereo = stereo;
+    d_format = format;
+    d_header = header;
+    reset_stream();
+}
+
+/*! \brief Set the maximum datagram size, including the header if enabled. */
+void udp_sink_f::set_packet_size(int bytes)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_packet_size = std::max(HEADER_SIZE + 8, std::min(bytes, MAX_PACKET_SIZE));
+    reset_stream();
+}
+
+/* Discard pending samples and restart sequence numbers. Caller holds lock. */
+void udp_sink_f::reset_stream()
+{
+    d_buf_len = 0;
+    d_seq = 0;
+    d_timestamp = 0;
+}
+
+/* Get socket for address family, creating it if necessary. Caller holds lock. */
+int udp_sink_f::get_socket(int family)
+{
+    int    *sock = (family == AF_INET6) ? &d_sock6 : &d_sock4;
+
+    if (*sock >= 0)
+        return *sock;
+
+    *sock = socket(family, SOCK_DGRAM, 0);
+    if (*sock < 0)
+    {
+        perror("udp_sink_f: Can not create socket");
+        return -1;
+    }
+
+    // never block the flow graph; packets are dropped if the socket is full
+    fcntl(*sock, F_SETFL, fcntl(*sock, F_GETFL) | O_NONBLOCK);
+
+    return *sock;
+}
+
+int udp_sink_f::work(int noutput_items,
+                     gr_vector_const_void_star &input_items,
+                     gr_vector_void_star &output_items)
+{
+    gr::thread::scoped_lock lock(d_setlock);
+
+    const float    *in0 = (const float *) input_items[0];
+    const float    *in1 = in0;
+    unsigned int    channels = d_stereo ? 2 : 1;
+    unsigned int    sample_bytes = (d_format == FORMAT_F32) ? 4 : 2;
+    unsigned int    frame_bytes = channels * sample_bytes;
+    unsigned int    payload;
+    unsigned int    num_packets;
+    unsigned int    sent;
+    int             i;
+
+    (void) output_items;
+
+    if (d_dest.empty())
+        return noutput_items;
+
+    if (d_stereo && input_items.size() > 1)
+        in1 = (const float *) input_items[1];
+
+    if (d_buf.size() < d_buf_len + noutput_items * frame_bytes)
+        d_buf.resize(d_buf_len + noutput_items * frame_bytes);
+
+    // convert once for all destinations
+    if (d_format == FORMAT_F32)
+    {
+        float  *out = (float *) &d_buf[d_buf_len];
+
+        for (i = 0; i < noutput_items; i++)
+        {
+            *out++ = in0[i];
+            if (d_stereo)
+                *out++ = in1[i];
+        }
+    }
+    else
+    {
+        int16_t    *out = (int16_t *) &d_buf[d_buf_len];
+
+        for (i = 0; i < noutput_items; i++)
+        {
+            float l = std::max(-1.f, std::min(1.f, in0[i]));
+            float r = std::max(-1.f, std::min(1.f, in1[i]));
+
+            *out++ = (int16_t) (l * 32767.f);
+            if (d_stereo)
+                *out++ = (int16_t) (r * 32767.f);
+        }
+    }
+    d_buf_len += noutput_items * frame_bytes;
+
+    payload = d_packet_size - (d_header ? HEADER_SIZE : 0);
+    payload -= payload % frame_bytes;
+
+    num_packets = d_buf_len / payload;
+    if (num_packets > 0)
+    {
+        send_packets(num_packets, payload);
+
+        // keep samples that do not fill a packet
+        sent = num_packets * payload;
+        memmove(&d_buf[0], &d_buf[sent], d_buf_len - sent);
+        d_buf_len -= sent;
+    }
+
+    return noutput_items;
+}
+
+/* Store little endian integers. */
+static inline void put_le16(unsigned char *p, uint16_t v)
+{
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+static inline void put_le32(unsigned char *p, uint32_t v)
+{
+    put_le16(p, v & 0xffff);
+    put_le16(p + 2, v >> 16);
+}
+
+static inline void put_le64(unsigned char *p, uint64_t v)
+{
+    put_le32(p, v & 0xffffffff);
+    put_le32(p + 4, v >> 32);
+}
+
+/*
+ * Send num_packets packets from the start of d_buf to all destinations.
+ * The headers and iovecs are built once per batch and shared by all
+ * destinations. Caller holds lock.
+ */
+void udp_sink_f::send_packets(unsigned int num_packets, unsigned int payload)
+{
+    unsigned int    frame_bytes = (d_stereo ? 2 : 1) * (d_format == FORMAT_F32 ? 4 : 2);
+    unsigned int    niov = d_header ? 2 : 1;
+    unsigned int    first, batch, p, k;
+    unsigned char   flags = (d_stereo ? 0x01 : 0) | (d_format == FORMAT_F32 ? 0x02 : 0);
+
+#ifdef __linux__
+    struct mmsghdr  msgs[MAX_BATCH];
+#else
+    struct msghdr   msg;
+#endif
+
+    for (first = 0; first < num_packets; first += batch)
+    {
+        batch = std::min(num_packets - first, (unsigned int) MAX_BATCH);
+
+        for (p = 0; p < batch; p++)
+        {
+            unsigned char *hdr = &d_hdr[p * HEADER_SIZE];
+
+            if (d_header)
+            {
+                put_le16(hdr, HEADER_MAGIC);
+                hdr[2] = HEADER_VERSION;
+                hdr[3] = flags;
+                put_le32(hdr + 4, d_seq);
+                put_le64(hdr + 8, d_timestamp);
+
+                d_iov[p * 2].iov_base = hdr;
+                d_iov[p * 2].iov_len = HEADER_SIZE;
+            }
+            d_iov[p * 2 + niov - 1].iov_base = &d_buf[(first + p) * payload];
+            d_iov[p * 2 + niov - 1].iov_len = payload;
+
+            d_seq++;
+            d_timestamp += payload / frame_bytes;
+        }
+
+        for (k = 0; k < d_dest.size(); k++)
+        {
+            destination &dest = d_dest[k];
+
+#ifdef __linux__
+            unsigned int done = 0;
+            int ret;
+
+            memset(msgs, 0, batch * sizeof(struct mmsghdr));
+            for (p = 0; p < batch; p++)
+            {
+                msgs[p].msg_hdr.msg_name = &dest.addr;
+                msgs[p].msg_hdr.msg_namelen = dest.addrlen;
+                msgs[p].msg_hdr.msg_iov = &d_iov[p * 2];
+                msgs[p].msg_hdr.msg_iovlen = niov;
+            }
+
+            while (done < batch)
+            {
+                ret = sendmmsg(dest.sock, &msgs[done], batch - done, 0);
+                if (ret <= 0)
+                    break;      // socket buffer full or error: drop the rest
+                done += ret;
+            }
+#else
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_name = &dest.addr;
+            msg.msg_namelen = dest.addrlen;
+            msg.msg_iovlen = niov;
+            for (p = 0; p < batch; p++)
+            {
+                msg.msg_iov = &d_iov[p * 2];
+                if (sendmsg(dest.sock, &msg, 0) < 0)
+                    break;
+            }
+#endif
+        }
+    }
+}
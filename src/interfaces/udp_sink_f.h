@@ -23,9 +23,12 @@
 #ifndef UDP_SINK_F_H
 #define UDP_SINK_F_H
 
-#include <gnuradio/hier_block2.h>
-#include <gnuradio/blocks/float_to_short.h>
-#include <gnuradio/blocks/udp_sink.h>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <gnuradio/sync_block.h>
 
 
 class udp_sink_f;
@@ -34,19 +37,90 @@ typedef boost::shared_ptr<udp_sink_f> udp_sink_f_sptr;
 
 udp_sink_f_sptr make_udp_sink_f(void);
 
-class udp_sink_f : public gr::hier_block2
+
+/*! \brief UDP audio streaming sink.
+ *  \ingroup IO
+ *
+ * The block streams one or two audio channels to any number of UDP
+ * destinations. Samples are converted to the selected format once and the
+ * same packets are sent to every destination. On Linux packets are sent in
+ * batches using sendmmsg(), elsewhere one sendmsg() per packet.
+ *
+ * The default mode is compatible with earlier versions: channel 0 only,
+ * 16 bit signed samples and no header. With the header enabled each packet
+ * starts with 16 bytes, all fields little endian:
+ *
+ *   offset  size  field
+ *        0     2  magic, 0x5147 ("GQ")
+ *        2     1  version, currently 1
+ *        3     1  flags: bit 0 set for stereo, bit 1 set for float32 samples
+ *        4     4  packet sequence number
+ *        8     8  index of the first sample frame in the packet
+ *
+ * Sample frames follow the header, interleaved left/right in stereo mode.
+ * The sequence number lets clients detect lost and reordered packets, and
+ * the sample index lets them insert the right amount of silence. Samples
+ * are sent in host byte order, i.e. little endian on supported platforms.
+ *
+ * Packets are always filled completely; samples that do not fill a packet
+ * are held back until the next call to work().
+ */
+class udp_sink_f : public gr::sync_block
 {
-public:
+    friend udp_sink_f_sptr make_udp_sink_f(void);
+
+protected:
     udp_sink_f(void);
+
+public:
+    enum sample_format {
+        FORMAT_S16 = 0,     /*!< 16 bit signed integer. */
+        FORMAT_F32 = 1      /*!< 32 bit float. */
+    };
+
     ~udp_sink_f();
 
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
     void start_streaming(const std::string host, int port);
     void stop_streaming(void);
 
+    bool add_destination(const std::string host, int port);
+    bool remove_destination(const std::string host, int port);
+
+    void set_format(bool stereo, sample_format format, bool header);
+    void set_packet_size(int bytes);
+
 private:
-    gr::blocks::udp_sink::sptr        d_sink;  /*!< The gnuradio UDP sink. */
-    gr::blocks::float_to_short::sptr  d_f2s;   /*!< Converts float to short. */
+    struct destination {
+        std::string             host;
+        int                     port;
+        struct sockaddr_storage addr;
+        socklen_t               addrlen;
+        int                     sock;
+    };
+
+    void reset_stream();
+    void send_packets(unsigned int num_packets, unsigned int payload);
+    int  get_socket(int family);
+
+    std::vector<destination>    d_dest;
+    int             d_sock4;        /*!< IPv4 socket, -1 until needed. */
+    int             d_sock6;        /*!< IPv6 socket, -1 until needed. */
+
+    bool            d_stereo;
+    sample_format   d_format;
+    bool            d_header;
+    int             d_packet_size;  /*!< Maximum datagram size in bytes. */
 
+    std::vector<char>           d_buf;      /*!< Converted samples. */
+    unsigned int                d_buf_len;  /*!< Bytes in d_buf. */
+    std::vector<unsigned char>  d_hdr;      /*!< Headers of current batch. */
+    std::vector<struct iovec>   d_iov;
+    uint32_t        d_seq;          /*!< Sequence number of next packet. */
+    uint64_t        d_timestamp;    /*!< Sample index of next packet. */
 };
 
 
@@ -49,9 +49,11 @@ portaudio_sink::portaudio_sink(const string device_name, int audio_rate,
   : gr::sync_block ("portaudio_sink",
         gr::io_signature::make (1, 2, sizeof(float)),
         gr::io_signature::make (0, 0, 0)),
+    d_stream(0),
     d_stream_name(stream_name),
     d_app_name(app_name),
-    d_audio_rate(audio_rate)
+    d_audio_rate(audio_rate),
+    d_fifo(audio_rate, 100)
 {
 
     // find device index
@@ -75,7 +77,7 @@ portaudio_sink::portaudio_sink(const string device_name, int audio_rate,
     d_out_params.channelCount = 2;
     d_out_params.sampleFormat = paFloat32;
     d_out_params.suggestedLatency =
-            Pa_GetDeviceInfo(d_out_params.device)->defaultHighOutputLatency;
+            Pa_GetDeviceInfo(d_out_params.device)->defaultLowOutputLatency;
     d_out_params.hostApiSpecificStreamInfo = NULL;
 
     if (Pa_IsFormatSupported(NULL, &d_out_params, d_audio_rate) != paFormatIsSupported)
@@ -92,20 +94,25 @@ bool portaudio_sink::start()
 {
     PaError     err;
 
+    gr::thread::scoped_lock lock(d_setlock);
+
+    d_fifo.flush();
+
     err = Pa_OpenStream(&d_stream,
                         NULL,           // inputParameters
                         &d_out_params,
                         d_audio_rate,
                         paFramesPerBufferUnspecified,
                         paClipOff,
-                        NULL,           // no callback, use blocking API
-                        NULL);
+                        &portaudio_sink::stream_callback,
+                        this);
 
     if (err != paNoError)
     {
         fprintf(stderr,
                 "portaudio_sink::start(): Failed to open audio stream: %s\n",
                 Pa_GetErrorText(err));
+        d_stream = 0;
         return false;
     }
 
@@ -127,6 +134,11 @@ bool portaudio_sink::stop()
     PaError     err;
     bool        retval = true;
 
+    gr::thread::scoped_lock lock(d_setlock);
+
+    if (!d_stream)
+        return false;
+
     err = Pa_StopStream(d_stream);
     if (err != paNoError)
     {
@@ -144,6 +156,7 @@ bool portaudio_sink::stop()
                 "portaudio_sink::stop(): Error closing audio stream: %s\n",
                 Pa_GetErrorText(err));
     }
+    d_stream = 0;
 
     return retval;
 }
@@ -153,63 +166,90 @@ void portaudio_sink::select_device(string device_name)
 
 }
 
-#define BUFFER_SIZE 100000
-int portaudio_sink::work(int noutput_items,
-                         gr_vector_const_void_star &input_items,
-                         gr_vector_void_star &output_items)
+void portaudio_sink::set_target_latency(unsigned int target_ms)
 {
-    PaError     err;
+    d_fifo.set_target_latency(target_ms);
+}
 
-    static float    audio_buffer[BUFFER_SIZE];
-    float      *ptr = &audio_buffer[0];
-    int         i;
+void portaudio_sink::get_stats(audio_fifo_stats &stats) const
+{
+    d_fifo.get_stats(stats);
+}
 
-    (void) output_items;
+/**
+ * Set the device buffer latency.
+ * @param tlength_ms Suggested output latency in ms, 0 for the device default.
+ * @param minreq_ms Not used by portaudio.
+ * @param prebuf_ms Not used by portaudio.
+ *
+ * The new latency is used when the stream is opened by the next start().
+ */
+void portaudio_sink::set_buffer_attr(int tlength_ms, int minreq_ms, int prebuf_ms)
+{
+    (void) minreq_ms;
+    (void) prebuf_ms;
 
-    if (noutput_items > BUFFER_SIZE/2)
-        noutput_items = BUFFER_SIZE/2;
+    if (tlength_ms > 0)
+        d_out_params.suggestedLatency = 1.0e-3 * tlength_ms;
+    else
+        d_out_params.suggestedLatency =
+                Pa_GetDeviceInfo(d_out_params.device)->defaultLowOutputLatency;
+}
 
-    // two channels (stereo)
-    const float *data_l = (const float*) input_items[0];
-    const float *data_r = (const float*) input_items[1];
-    for (i = noutput_items; i > 0; i--)
-    {
-        *ptr++ = *data_l++;
-        *ptr++ = *data_r++;
-    }
+/**
+ * Get the output latency.
+ * @returns The latency in ms, including the audio_fifo, or -1 if unknown.
+ *
+ * The device part is the output latency reported by portaudio for the open
+ * stream.
+ */
+double portaudio_sink::get_latency()
+{
+    const PaStreamInfo *info;
+    audio_fifo_stats    stats;
 
-    err = Pa_WriteStream(d_stream, audio_buffer, noutput_items);
-    if (err)
-        fprintf(stderr,
-                "portaudio_sink::work(): Error writing to audio device: %s\n",
-                Pa_GetErrorText(err));
+    gr::thread::scoped_lock lock(d_setlock);
 
-    return noutput_items;
+    if (!d_stream)
+        return -1.0;
 
-// code below supports 1 or 2 channels
-#if 0
-    if (input_items.size() == 2)
-    {
-        // two channels (stereo)
-        const float *data_l = (const float*) input_items[0]; // left channel
-        const float *data_r = (const float*) input_items[1]; // right channel
-        for (i = noutput_items; i > 0; i--)
-        {
-            *ptr++ = *data_l++;
-            *ptr++ = *data_r++;
-        }
-    }
-    else
-    {
-        // assume 1 channel (mono)
-        const float *data = (const float*) input_items[0];
-        for (i = noutput_items; i > 0; i--)
-        {
-            float a = *data++;
-            *ptr++ = a; // same data in left and right channel
-            *ptr++ = a;
-        }
-    }
-#endif
+    info = Pa_GetStreamInfo(d_stream);
+    if (!info)
+        return -1.0;
+
+    d_fifo.get_stats(stats);
+
+    return 1.0e3 * info->outputLatency + stats.latency_ms;
+}
+
+/* Audio callback, called from the portaudio thread. */
+int portaudio_sink::stream_callback(const void *input, void *output,
+                                    unsigned long frame_count,
+                                    const PaStreamCallbackTimeInfo *time_info,
+                                    PaStreamCallbackFlags status_flags,
+                                    void *user_data)
+{
+    portaudio_sink *self = (portaudio_sink *) user_data;
 
+    (void) input;
+    (void) time_info;
+    (void) status_flags;
+
+    self->d_fifo.read((float *) output, frame_count);
+
+    return paContinue;
+}
+
+int portaudio_sink::work(int noutput_items,
+                         gr_vector_const_void_star &input_items,
+                         gr_vector_void_star &output_items)
+{
+    (void) output_items;
+
+    // one or two channels; mono is copied to both
+    d_fifo.write((const float *) input_items[0],
+                 input_items.size() == 2 ? (const float *) input_items[1] : NULL,
+                 noutput_items);
+
+    return noutput_items;
 }
@@ -25,6 +25,7 @@
 #include <gnuradio/sync_block.h>
 #include <portaudio.h>
 #include <string>
+#include "dsp/audio_fifo.h"
 
 using namespace std;
 
@@ -36,7 +37,12 @@ portaudio_sink_sptr make_portaudio_sink(const string device_name, int audio_rate
                                         const string app_name,
                                         const string stream_name);
 
-/** Two-channel portaudio sink */
+/**
+ * Two-channel portaudio sink.
+ *
+ * The stream runs in callback mode and is fed from an audio_fifo, so work()
+ * never blocks on the audio device.
+ */
 class portaudio_sink : public gr::sync_block
 {
     friend portaudio_sink_sptr make_portaudio_sink(const string device_name,
@@ -58,10 +64,24 @@ public:
 
     void select_device(string device_name);
 
+    /** Set the target latency of the audio buffer in ms. */
+    void set_target_latency(unsigned int target_ms);
+    void get_stats(audio_fifo_stats &stats) const;
+
+    void set_buffer_attr(int tlength_ms, int minreq_ms, int prebuf_ms);
+    double get_latency();
+
 private:
+    static int stream_callback(const void *input, void *output,
+                               unsigned long frame_count,
+                               const PaStreamCallbackTimeInfo *time_info,
+                               PaStreamCallbackFlags status_flags,
+                               void *user_data);
+
     PaStream           *d_stream;
     PaStreamParameters  d_out_params;
     string      d_stream_name;       // Descriptive name of the stream.
     string      d_app_name;          // Descriptive name of the applcation.
     int         d_audio_rate;
+    audio_fifo  d_fifo;              // Buffer between work() and the callback.
 };
@@ -21,13 +21,16 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <gnuradio/io_signature.h>
-#include <pulse/simple.h>
-#include <pulse/error.h>
-#include <pulse/gccmacro.h>
+#include <pulse/pulseaudio.h>
 #include <stdio.h>
 
 #include "pa_sink.h"
 
+/* Default latency requested from the pulseaudio server. The audio_fifo in
+ * front of the stream adds its own target latency on top of this.
+ */
+#define DEFAULT_TLENGTH_MS  50
+
 
 /*! \brief Create a new pulseaudio sink object.
  *  \param device_name The name of the audio device, or NULL for default.
@@ -49,47 +52,93 @@ pa_sink::pa_sink(const string device_name, int audio_rate,
   : gr::sync_block ("pa_sink",
         gr::io_signature::make (1, 2, sizeof(float)),
         gr::io_signature::make (0, 0, 0)),
+    d_context(0),
+    d_stream(0),
+    d_device_name(device_name),
     d_stream_name(stream_name),
-    d_app_name(app_name)
+    d_app_name(app_name),
+    d_running(false),
+    d_fifo(audio_rate, 100)
 {
-    int error;
+    pa_context_state_t state;
 
     /* The sample type to use */
     d_ss.format = PA_SAMPLE_FLOAT32LE;
     d_ss.rate = audio_rate;
     d_ss.channels = 2;
-    d_pasink = pa_simple_new(NULL,
-                             d_app_name.c_str(),
-                             PA_STREAM_PLAYBACK,
-                             device_name.empty() ? NULL : device_name.c_str(),
-                             d_stream_name.c_str(),
-                             &d_ss,
-                             NULL,
-                             NULL,
-                             &error);
-
-    if (!d_pasink) {
+
+    d_attr.maxlength = (uint32_t) -1;
+    d_attr.tlength = pa_usec_to_bytes(DEFAULT_TLENGTH_MS * 1000, &d_ss);
+    d_attr.prebuf = (uint32_t) -1;
+    d_attr.minreq = (uint32_t) -1;
+    d_attr.fragsize = (uint32_t) -1;
+
+    d_mainloop = pa_threaded_mainloop_new();
+    d_context = pa_context_new(pa_threaded_mainloop_get_api(d_mainloop),
+                               d_app_name.c_str());
+    pa_context_set_state_callback(d_context, &pa_sink::context_state_cb, this);
+
+    pa_threaded_mainloop_lock(d_mainloop);
+
+    if (pa_context_connect(d_context, NULL, PA_CONTEXT_NOFLAGS, NULL) < 0 ||
+        pa_threaded_mainloop_start(d_mainloop) < 0)
+    {
         /** FIXME: Throw an exception **/
-        fprintf(stderr, __FILE__": pa_simple_new() failed: %s\n", pa_strerror(error));
+        fprintf(stderr, __FILE__": pa_context_connect() failed: %s\n",
+                pa_strerror(pa_context_errno(d_context)));
+        pa_threaded_mainloop_unlock(d_mainloop);
+        return;
     }
 
+    for (;;)
+    {
+        state = pa_context_get_state(d_context);
+        if (state == PA_CONTEXT_READY)
+            break;
+
+        if (!PA_CONTEXT_IS_GOOD(state))
+        {
+            fprintf(stderr, __FILE__": Failed to connect to pulseaudio: %s\n",
+                    pa_strerror(pa_context_errno(d_context)));
+            break;
+        }
+
+        pa_threaded_mainloop_wait(d_mainloop);
+    }
+
+    if (state == PA_CONTEXT_READY)
+        create_stream();
+
+    pa_threaded_mainloop_unlock(d_mainloop);
 }
 
 
 pa_sink::~pa_sink()
 {
-    if (d_pasink) {
-        pa_simple_free(d_pasink);
-    }
+    pa_threaded_mainloop_lock(d_mainloop);
+    destroy_stream();
+    pa_context_disconnect(d_context);
+    pa_threaded_mainloop_unlock(d_mainloop);
+
+    pa_threaded_mainloop_stop(d_mainloop);
+    pa_context_unref(d_context);
+    pa_threaded_mainloop_free(d_mainloop);
 }
 
 bool pa_sink::start()
 {
+    d_fifo.flush();
+    d_running = true;
+    cork_stream(false);
+
     return true;
 }
 
 bool pa_sink::stop()
 {
+    d_running = false;
+    cork_stream(true);
+
     return true;
 }
 
@@ -99,68 +148,217 @@ bool pa_sink::stop()
  */
 void pa_sink::select_device(string device_name)
 {
-    int error;
+    pa_threaded_mainloop_lock(d_mainloop);
+    d_device_name = device_name;
+    destroy_stream();
+    create_stream();
+    pa_threaded_mainloop_unlock(d_mainloop);
+}
 
-    pa_simple_free(d_pasink);
+void pa_sink::set_target_latency(unsigned int target_ms)
+{
+    d_fifo.set_target_latency(target_ms);
+}
 
-    d_pasink = pa_simple_new(NULL,
-                             d_app_name.c_str(),
-                             PA_STREAM_PLAYBACK,
-                             device_name.empty() ? NULL : device_name.c_str(),
-                             d_stream_name.c_str(),
-                             &d_ss,
-                             NULL,
-                             NULL,
-                             &error);
+void pa_sink::get_stats(audio_fifo_stats &stats) const
+{
+    d_fifo.get_stats(stats);
+}
 
-    if (!d_pasink) {
-        /** FIXME: Throw an exception **/
-        fprintf(stderr, __FILE__": pa_simple_new() failed: %s\n", pa_strerror(error));
+/* Convert buffer attribute in ms to bytes, (uint32_t) -1 for server default. */
+static uint32_t ms_to_bytes(int ms, const pa_sample_spec *ss)
+{
+    if (ms <= 0)
+        return (uint32_t) -1;
+
+    return pa_usec_to_bytes((pa_usec_t) ms * 1000, ss);
+}
+
+/*! \brief Set the server side buffer attributes.
+ *  \param tlength_ms Target length of the server buffer in ms.
+ *  \param minreq_ms Minimum request size in ms.
+ *  \param prebuf_ms Amount of data required before playback starts in ms.
+ *
+ * Values less than or equal to 0 leave the choice to the server. Lower
+ * values reduce the latency at the risk of dropouts when the system is
+ * loaded. The stream is recreated if the attributes have changed.
+ */
+void pa_sink::set_buffer_attr(int tlength_ms, int minreq_ms, int prebuf_ms)
+{
+    pa_buffer_attr attr = d_attr;
+
+    attr.tlength = ms_to_bytes(tlength_ms, &d_ss);
+    attr.minreq = ms_to_bytes(minreq_ms, &d_ss);
+    attr.prebuf = ms_to_bytes(prebuf_ms, &d_ss);
+
+    if (attr.tlength == d_attr.tlength && attr.minreq == d_attr.minreq &&
+        attr.prebuf == d_attr.prebuf)
+        return;
+
+    pa_threaded_mainloop_lock(d_mainloop);
+    d_attr = attr;
+    if (d_context && pa_context_get_state(d_context) == PA_CONTEXT_READY)
+    {
+        destroy_stream();
+        create_stream();
     }
+    pa_threaded_mainloop_unlock(d_mainloop);
 }
 
+/*! \brief Get the measured output latency.
+ *  \returns The latency in ms, including the audio_fifo, or -1 if unknown.
+ *
+ * The server part is measured by pulseaudio using the timing information
+ * of the stream, i.e. the time until a sample written now is played.
+ */
+double pa_sink::get_latency()
+{
+    audio_fifo_stats    stats;
+    pa_usec_t           usec;
+    int                 negative;
+    double              latency = -1.0;
 
-#define BUFFER_SIZE 100000
+    pa_threaded_mainloop_lock(d_mainloop);
+    if (d_stream && pa_stream_get_latency(d_stream, &usec, &negative) == 0)
+        latency = negative ? 0.0 : 1.0e-3 * usec;
+    pa_threaded_mainloop_unlock(d_mainloop);
 
-int pa_sink::work (int noutput_items,
-                   gr_vector_const_void_star &input_items,
-                   gr_vector_void_star &output_items)
+    if (latency < 0.0)
+        return latency;
+
+    d_fifo.get_stats(stats);
+
+    return latency + stats.latency_ms;
+}
+
+
+/*! \brief Create and connect the playback stream.
+ *
+ * Must be called with the main loop locked. The stream is created corked
+ * unless the block is running.
+ */
+bool pa_sink::create_stream()
 {
-    static float audio_buffer[BUFFER_SIZE];
-    float *ptr = &audio_buffer[0];
-    int i, error;
+    pa_stream_flags_t   flags;
+    pa_stream_state_t   state;
 
-    (void) output_items;
+    d_stream = pa_stream_new(d_context, d_stream_name.c_str(), &d_ss, NULL);
+    if (!d_stream)
+    {
+        fprintf(stderr, __FILE__": pa_stream_new() failed: %s\n",
+                pa_strerror(pa_context_errno(d_context)));
+        return false;
+    }
+
+    pa_stream_set_state_callback(d_stream, &pa_sink::stream_state_cb, this);
+    pa_stream_set_write_callback(d_stream, &pa_sink::stream_write_cb, this);
 
-    if (noutput_items > BUFFER_SIZE/2)
-        noutput_items = BUFFER_SIZE/2;
+    flags = (pa_stream_flags_t)(PA_STREAM_ADJUST_LATENCY |
+                                PA_STREAM_INTERPOLATE_TIMING |
+                                PA_STREAM_AUTO_TIMING_UPDATE);
+    if (!d_running)
+        flags = (pa_stream_flags_t)(flags | PA_STREAM_START_CORKED);
 
-    if (input_items.size() == 2)
+    if (pa_stream_connect_playback(d_stream,
+                                   d_device_name.empty() ? NULL : d_device_name.c_str(),
+                                   &d_attr, flags, NULL, NULL) < 0)
     {
-        // two channels (stereo)
-        const float *data_l = (const float*) input_items[0]; // left channel
-        const float *data_r = (const float*) input_items[1]; // right channel
-        for (i = noutput_items; i > 0; i--)
-        {
-            *ptr++ = *data_l++;
-            *ptr++ = *data_r++;
-        }
+        fprintf(stderr, __FILE__": pa_stream_connect_playback() failed: %s\n",
+                pa_strerror(pa_context_errno(d_context)));
+        destroy_stream();
+        return false;
     }
-    else
+
+    for (;;)
     {
-        // assume 1 channel (mono)
-        const float *data = (const float*) input_items[0];
-        for (i = noutput_items; i > 0; i--)
+        state = pa_stream_get_state(d_stream);
+        if (state == PA_STREAM_READY)
+            return true;
+
+        if (!PA_STREAM_IS_GOOD(state))
         {
-            float a = *data++;
-            *ptr++ = a; // same data in left and right channel
-            *ptr++ = a;
+            fprintf(stderr, __FILE__": Failed to create audio stream: %s\n",
+                    pa_strerror(pa_context_errno(d_context)));
+            destroy_stream();
+            return false;
         }
+
+        pa_threaded_mainloop_wait(d_mainloop);
     }
+}
+
+/*! \brief Disconnect and free the stream. Must be called with the main loop locked. */
+void pa_sink::destroy_stream()
+{
+    if (!d_stream)
+        return;
+
+    pa_stream_set_state_callback(d_stream, NULL, NULL);
+    pa_stream_set_write_callback(d_stream, NULL, NULL);
+    pa_stream_disconnect(d_stream);
+    pa_stream_unref(d_stream);
+    d_stream = 0;
+}
 
-    if (pa_simple_write(d_pasink, audio_buffer, 2*noutput_items*sizeof(float), &error) < 0) { //!!!
-        fprintf(stderr, __FILE__": pa_simple_write() failed: %s\n", pa_strerror(error));
+void pa_sink::cork_stream(bool cork)
+{
+    pa_operation *op;
+
+    pa_threaded_mainloop_lock(d_mainloop);
+    if (d_stream)
+    {
+        op = pa_stream_cork(d_stream, cork ? 1 : 0, NULL, NULL);
+        if (op)
+            pa_operation_unref(op);
     }
+    pa_threaded_mainloop_unlock(d_mainloop);
+}
+
+
+void pa_sink::context_state_cb(pa_context *c, void *userdata)
+{
+    pa_sink *self = (pa_sink *) userdata;
+
+    (void) c;
+    pa_threaded_mainloop_signal(self->d_mainloop, 0);
+}
+
+void pa_sink::stream_state_cb(pa_stream *s, void *userdata)
+{
+    pa_sink *self = (pa_sink *) userdata;
+
+    (void) s;
+    pa_threaded_mainloop_signal(self->d_mainloop, 0);
+}
+
+/*! \brief Stream write callback, called from the main loop thread. */
+void pa_sink::stream_write_cb(pa_stream *s, size_t nbytes, void *userdata)
+{
+    pa_sink        *self = (pa_sink *) userdata;
+    void           *data = NULL;
+    size_t          frames;
+
+    if (pa_stream_begin_write(s, &data, &nbytes) < 0 || !data)
+        return;
+
+    frames = nbytes / (2 * sizeof(float));
+    self->d_fifo.read((float *) data, frames);
+
+    pa_stream_write(s, data, frames * 2 * sizeof(float), NULL, 0,
+                    PA_SEEK_RELATIVE);
+}
+
+
+int pa_sink::work (int noutput_items,
+                   gr_vector_const_void_star &input_items,
+                   gr_vector_void_star &output_items)
+{
+    (void) output_items;
+
+    // one or two channels; mono is copied to both
+    d_fifo.write((const float *) input_items[0],
+                 input_items.size() == 2 ? (const float *) input_items[1] : NULL,
+                 noutput_items);
 
     return noutput_items;
 }
@@ -24,8 +24,9 @@
 #define PA_SINK_H
 
 #include <gnuradio/sync_block.h>
-#include <pulse/simple.h>
+#include <pulse/pulseaudio.h>
 #include <string>
+#include "dsp/audio_fifo.h"
 
 using namespace std;
 
@@ -41,8 +42,10 @@ pa_sink_sptr make_pa_sink(const string device_name, int audio_rate,
 /*! \brief Pulseaudio sink
  *  \ingroup IO
  *
- * This block implements a two-channel pulseaudio sink using the Pulseaudio simple API.
- *
+ * This block implements a two-channel pulseaudio sink using the asynchronous
+ * Pulseaudio API. The stream is serviced from the write callback of a
+ * threaded main loop and fed from an audio_fifo, so work() never blocks on
+ * the audio server.
  */
 class pa_sink : public gr::sync_block
 {
@@ -63,11 +66,32 @@ public:
 
     void select_device(string device_name);
 
+    /*! \brief Set the target latency of the audio buffer in ms. */
+    void set_target_latency(unsigned int target_ms);
+    void get_stats(audio_fifo_stats &stats) const;
+
+    void set_buffer_attr(int tlength_ms, int minreq_ms, int prebuf_ms);
+    double get_latency();
+
 private:
-    pa_simple *d_pasink;    /*! The pulseaudio object. */
+    bool create_stream();
+    void destroy_stream();
+    void cork_stream(bool cork);
+
+    static void context_state_cb(pa_context *c, void *userdata);
+    static void stream_state_cb(pa_stream *s, void *userdata);
+    static void stream_write_cb(pa_stream *s, size_t nbytes, void *userdata);
+
+    pa_threaded_mainloop   *d_mainloop;  /*! The pulseaudio main loop. */
+    pa_context     *d_context;      /*! Connection to the pulseaudio server. */
+    pa_stream      *d_stream;       /*! The playback stream. */
+    string d_device_name;   /*! Output device, empty for default. */
     string d_stream_name;   /*! Descriptive name of the stream. */
     string d_app_name;      /*! Descriptive name of the applcation. */
     pa_sample_spec d_ss;    /*! pulseaudio sample specification. */
+    pa_buffer_attr d_attr;  /*! Requested server side buffering. */
+    bool           d_running;       /*! Whether the stream should be playing. */
+    audio_fifo     d_fifo;          /*! Buffer between work() and the stream. */
 };
 
 #endif /* PA_SINK_H */
@@ -31,6 +31,7 @@
 
 
 #define SAMPLES_PER_BUFFER 1024 /*! Max number of samples we read every cycle. */
+#define DEFAULT_FRAGSIZE_MS 20  /*! Default fragment size requested from the server. */
 
 
 /*! \brief Create a new pulseaudio source object.
@@ -54,11 +55,11 @@ pa_source::pa_source (const string device_name, int sample_rate, int num_chan,
   : gr::sync_block ("pa_source",
         gr::io_signature::make (0, 0, 0),
         gr::io_signature::make (0, 0, 0)),
+    d_device_name(device_name),
     d_stream_name(stream_name),
-    d_app_name(app_name)
+    d_app_name(app_name),
+    d_pasrc(0)
 {
-    int error;
-
 /** FIXME: only 2 channels supported **/
 //    if ((num_chan != 1) && (num_chan != 2)) {
 //        num_chan = 2;
@@ -72,20 +73,13 @@ pa_source::pa_source (const string device_name, int sample_rate, int num_chan,
     d_ss.rate = sample_rate;
     d_ss.channels = num_chan;
 
-    d_pasrc = pa_simple_new(NULL,
-                            d_app_name.c_str(),
-                            PA_STREAM_RECORD,
-                            device_name.empty() ? NULL : device_name.c_str(),
-                            d_stream_name.c_str(),
-                            &d_ss,
-                            NULL,
-                            NULL,
-                            &error);
+    d_attr.maxlength = (uint32_t) -1;
+    d_attr.tlength = (uint32_t) -1;
+    d_attr.prebuf = (uint32_t) -1;
+    d_attr.minreq = (uint32_t) -1;
+    d_attr.fragsize = pa_usec_to_bytes(DEFAULT_FRAGSIZE_MS * 1000, &d_ss);
 
-    if (!d_pasrc) {
-        /** FIXME: throw and exception */
-        fprintf(stderr, __FILE__": pa_simple_new() failed: %s\n", pa_strerror(error));
-    }
+    open_stream();
 }
 
 
@@ -101,19 +95,27 @@ pa_source::~pa_source()
  *  \param device_name The name of the new output.
  */
 void pa_source::select_device(string device_name)
+{
+    d_device_name = device_name;
+    open_stream();
+}
+
+/*! \brief (Re)open the record stream with the current device and attributes. */
+void pa_source::open_stream()
 {
     int error;
 
-    pa_simple_free(d_pasrc);
+    if (d_pasrc)
+        pa_simple_free(d_pasrc);
 
     d_pasrc = pa_simple_new(NULL,
                             d_app_name.c_str(),
                             PA_STREAM_RECORD,
-                            device_name.empty() ? NULL : device_name.c_str(),
+                            d_device_name.empty() ? NULL : d_device_name.c_str(),
                             d_stream_name.c_str(),
                             &d_ss,
                             NULL,
-                            NULL,
+                            &d_attr,
                             &error);
 
     if (!d_pasrc) {
@@ -130,23 +132,31 @@ int pa_source::work(int noutput_items,
 
     float audio_buffer[SAMPLES_PER_BUFFER*2]; /** FIXME: Channels **/
     float *out0 = (float *) output_items[0];
-    float *out1 = (float *) output_items[1];  // see gr_complex_to_float
+    float *out1 = output_items.size() > 1 ? (float *) output_items[1] : 0;
     int error=0;
     int i=0;
 
+    if (!d_pasrc)
+        return 0;
+
+    // read no more than the scheduler has room for
+    if (noutput_items > SAMPLES_PER_BUFFER)
+        noutput_items = SAMPLES_PER_BUFFER;
 
-    if (pa_simple_read(d_pasrc, &audio_buffer[0], sizeof(audio_buffer), &error) < 0)
+    if (pa_simple_read(d_pasrc, &audio_buffer[0],
+                       noutput_items * 2 * sizeof(float), &error) < 0)
     {
         fprintf(stderr, __FILE__": pa_simple_read() failed: %s\n", pa_strerror(error));
 
         return 0;
     }
 
-    for (i = 0; i < SAMPLES_PER_BUFFER; i++)
+    for (i = 0; i < noutput_items; i++)
     {
         out0[i] = audio_buffer[i*2];
-        out1[i] = audio_buffer[(i*2)+1];
+        if (out1)
+            out1[i] = audio_buffer[(i*2)+1];
     }
 
-    return SAMPLES_PER_BUFFER;
+    return noutput_items;
 }
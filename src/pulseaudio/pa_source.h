@@ -61,10 +61,14 @@ public:
     void select_device(string device_name);
 
 private:
+    void open_stream();
+
+    string         d_device_name;  /*! Input device, empty for default. */
     pa_sample_spec d_ss;           /*! Sample specification. */
     string         d_stream_name;  /*! Descriptive name of the stream. */
     string         d_app_name;     /*! Descriptive name of the applcation. */
     pa_simple     *d_pasrc;        /*! The pulseaudio object. */
+    pa_buffer_attr d_attr;         /*! Requested server side buffering. */
 
 };
 
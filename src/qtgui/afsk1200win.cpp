@@ -29,12 +29,15 @@
 #include "ui_afsk1200win.h"
 
 
-Afsk1200Win::Afsk1200Win(QWidget *parent) :
+Afsk1200Win::Afsk1200Win(int id, QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::Afsk1200Win)
+    ui(new Ui::Afsk1200Win),
+    decoder_id(id)
 {
     ui->setupUi(this);
 
+    setWindowTitle(QString("%1 #%2").arg(windowTitle()).arg(id + 1));
+
     /* select font for text viewer */
 #ifdef Q_OS_MAC
     ui->textView->setFont(QFont("Monaco", 12));
@@ -42,44 +45,33 @@ Afsk1200Win::Afsk1200Win(QWidget *parent) :
     ui->textView->setFont(QFont("Monospace", 11));
 #endif
 
+    /* audio channel the decoder is connected to */
+    channelSelector = new QComboBox(this);
+    channelSelector->addItem(tr("Left"));
+    channelSelector->addItem(tr("Right"));
+    channelSelector->setToolTip(tr("Audio channel to decode"));
+    ui->toolBar->addWidget(channelSelector);
+    connect(channelSelector, SIGNAL(activated(int)), this, SLOT(channelSelected(int)));
+
     /* Add right-aligned info button */
     QWidget *spacer = new QWidget();
     spacer->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     ui->toolBar->addWidget(spacer);
     ui->toolBar->addAction(ui->actionInfo);
-
-    /* AFSK1200 decoder */
-    decoder = new CAfsk12(this);
-    connect(decoder, SIGNAL(newMessage(QString)), ui->textView, SLOT(appendPlainText(QString)));
 }
 
 Afsk1200Win::~Afsk1200Win()
 {
     qDebug() << "AFSK1200 decoder destroyed.";
 
-    delete decoder;
     delete ui;
 }
 
 
-/*! \brief Process new set of samples. */
-void Afsk1200Win::process_samples(float *buffer, int length)
+/*! \brief Display a new decoded frame. */
+void Afsk1200Win::addMessage(const QString &message)
 {
-    int overlap = 18;
-    int i;
-
-    for (i = 0; i < length; i++) {
-        tmpbuf.append(buffer[i]);
-    }
-
-    decoder->demod(tmpbuf.data(), length);
-
-    /* clear tmpbuf and store "overlap" */
-    tmpbuf.clear();
-    for (i = length-overlap; i < length; i++) {
-        tmpbuf.append(buffer[i]);
-    }
-
+    ui->textView->appendPlainText(message);
 }
 
 
@@ -92,6 +84,13 @@ void Afsk1200Win::closeEvent(QCloseEvent *ev)
 }
 
 
+/*! \brief New audio channel selected. */
+void Afsk1200Win::channelSelected(int index)
+{
+    emit channelChanged(index);
+}
+
+
 /*! \brief User clicked on the Clear button. */
 void Afsk1200Win::on_actionClear_triggered()
 {
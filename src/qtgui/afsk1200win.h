@@ -23,9 +23,8 @@
 #ifndef AFSK1200WIN_H
 #define AFSK1200WIN_H
 
+#include <QComboBox>
 #include <QMainWindow>
-#include <QVarLengthArray>
-#include "dsp/afsk1200/cafsk12.h"
 
 
 namespace Ui {
@@ -33,23 +32,33 @@ namespace Ui {
 }
 
 
-/*! \brief AFSK1200 decoder window. */
+/*! \brief AFSK1200 decoder window.
+ *
+ * The decoding itself is done by the receiver, the window only displays the
+ * decoded frames. Each window belongs to one decoder in the receiver.
+ */
 class Afsk1200Win : public QMainWindow
 {
     Q_OBJECT
 
 public:
-    explicit Afsk1200Win(QWidget *parent = 0);
+    explicit Afsk1200Win(int id, QWidget *parent = 0);
     ~Afsk1200Win();
-    void process_samples(float *buffer, int length);
+
+    int decoderId() const { return decoder_id; }
+
+public slots:
+    void addMessage(const QString &message);
 
 protected:
     void closeEvent(QCloseEvent *ev);
 
 signals:
     void windowClosed();  /*! Signal we emit when window is closed. */
+    void channelChanged(int channel);  /*! New audio channel selected, 0 = left, 1 = right. */
 
 private slots:
+    void channelSelected(int index);
     void on_actionClear_triggered();
     void on_actionSave_triggered();
     void on_actionInfo_triggered();
@@ -57,9 +66,9 @@ private slots:
 private:
     Ui::Afsk1200Win *ui;  /*! Qt Designer form. */
 
-    CAfsk12 *decoder;     /*! The AFSK1200 decoder object. */
+    QComboBox *channelSelector;  /*! Audio channel selector in the tool bar. */
 
-    QVarLengthArray<float, 16384> tmpbuf;   /*! Needed to remember "overlap" smples. */
+    int decoder_id;       /*! The id of the decoder in the receiver. */
 };
 
 #endif // AFSK1200WIN_H
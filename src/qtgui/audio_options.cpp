@@ -78,6 +78,25 @@ void CAudioOptions::setRecDir(const QString &dir)
     ui->recDirEdit->setText(dir);
 }
 
+/** Set audio recording mode without emitting newRecMode(). */
+void CAudioOptions::setRecMode(int mode, double hang, int rotate_min)
+{
+    ui->recMode->blockSignals(true);
+    ui->recHang->blockSignals(true);
+    ui->recRotate->blockSignals(true);
+
+    ui->recMode->setCurrentIndex(mode);
+    ui->recHang->setValue(hang);
+    ui->recRotate->setValue(rotate_min);
+
+    ui->recMode->blockSignals(false);
+    ui->recHang->blockSignals(false);
+    ui->recRotate->blockSignals(false);
+
+    ui->recHang->setEnabled(mode != 0);
+    ui->recRotate->setEnabled(mode == 2);
+}
+
 /** Set new UDP host name or IP. */
 void CAudioOptions::setUdpHost(const QString &host)
 {
@@ -90,6 +109,25 @@ void CAudioOptions::setUdpPort(int port)
     ui->udpPort->setValue(port);
 }
 
+/** Set UDP stream format without emitting newUdpFormat(). */
+void CAudioOptions::setUdpFormat(bool stereo, int format, bool header, int packet_size)
+{
+    ui->udpStereo->blockSignals(true);
+    ui->udpFormat->blockSignals(true);
+    ui->udpHeader->blockSignals(true);
+    ui->udpPacketSize->blockSignals(true);
+
+    ui->udpStereo->setChecked(stereo);
+    ui->udpFormat->setCurrentIndex(format);
+    ui->udpHeader->setChecked(header);
+    ui->udpPacketSize->setValue(packet_size);
+
+    ui->udpStereo->blockSignals(false);
+    ui->udpFormat->blockSignals(false);
+    ui->udpHeader->blockSignals(false);
+    ui->udpPacketSize->blockSignals(false);
+}
+
 
 void CAudioOptions::setFftSplit(int pct_2d)
 {
@@ -140,6 +178,69 @@ void CAudioOptions::on_wfRangeSlider_valuesChanged(int min, int max)
     emit newWaterfallRange(min, max);
 }
 
+/**
+ * Set audio output buffering without emitting newBufferAttr().
+ *
+ * All values are in ms, 0 means server default (not for latency_ms).
+ */
+void CAudioOptions::setBufferAttr(int latency_ms, int server_ms, int minreq_ms,
+                                  int prebuf_ms)
+{
+    ui->bufLatency->blockSignals(true);
+    ui->serverLatency->blockSignals(true);
+    ui->minReq->blockSignals(true);
+    ui->preBuf->blockSignals(true);
+
+    ui->bufLatency->setValue(latency_ms);
+    ui->serverLatency->setValue(server_ms);
+    ui->minReq->setValue(minreq_ms);
+    ui->preBuf->setValue(prebuf_ms);
+
+    ui->bufLatency->blockSignals(false);
+    ui->serverLatency->blockSignals(false);
+    ui->minReq->blockSignals(false);
+    ui->preBuf->blockSignals(false);
+}
+
+void CAudioOptions::getBufferAttr(int * latency_ms, int * server_ms,
+                                  int * minreq_ms, int * prebuf_ms) const
+{
+    *latency_ms = ui->bufLatency->value();
+    *server_ms = ui->serverLatency->value();
+    *minreq_ms = ui->minReq->value();
+    *prebuf_ms = ui->preBuf->value();
+}
+
+void CAudioOptions::emitBufferAttr()
+{
+    emit newBufferAttr(ui->bufLatency->value(), ui->serverLatency->value(),
+                       ui->minReq->value(), ui->preBuf->value());
+}
+
+void CAudioOptions::on_bufLatency_valueChanged(int value)
+{
+    Q_UNUSED(value);
+    emitBufferAttr();
+}
+
+void CAudioOptions::on_serverLatency_valueChanged(int value)
+{
+    Q_UNUSED(value);
+    emitBufferAttr();
+}
+
+void CAudioOptions::on_minReq_valueChanged(int value)
+{
+    Q_UNUSED(value);
+    emitBufferAttr();
+}
+
+void CAudioOptions::on_preBuf_valueChanged(int value)
+{
+    Q_UNUSED(value);
+    emitBufferAttr();
+}
+
 
 /**
  * Slot called when the recordings directory has changed either
@@ -171,6 +272,34 @@ void CAudioOptions::on_recDirButton_clicked()
         ui->recDirEdit->setText(dir);
 }
 
+void CAudioOptions::emitRecMode()
+{
+    emit newRecMode(ui->recMode->currentIndex(), ui->recHang->value(),
+                    ui->recRotate->value());
+}
+
+/** Recording mode has changed. */
+void CAudioOptions::on_recMode_currentIndexChanged(int index)
+{
+    ui->recHang->setEnabled(index != 0);
+    ui->recRotate->setEnabled(index == 2);
+    emitRecMode();
+}
+
+/** Squelch hang time has changed. */
+void CAudioOptions::on_recHang_valueChanged(double value)
+{
+    Q_UNUSED(value);
+    emitRecMode();
+}
+
+/** File rotation period has changed. */
+void CAudioOptions::on_recRotate_valueChanged(int value)
+{
+    Q_UNUSED(value);
+    emitRecMode();
+}
+
 /** UDP host name has changed. */
 void CAudioOptions::on_udpHost_textChanged(const QString &text)
 {
@@ -184,3 +313,36 @@ void CAudioOptions::on_udpPort_valueChanged(int port)
     emit newUdpPort(port);
 }
 
+void CAudioOptions::emitUdpFormat()
+{
+    emit newUdpFormat(ui->udpStereo->isChecked(), ui->udpFormat->currentIndex(),
+                      ui->udpHeader->isChecked(), ui->udpPacketSize->value());
+}
+
+/** UDP sample format has changed. */
+void CAudioOptions::on_udpFormat_currentIndexChanged(int index)
+{
+    Q_UNUSED(index);
+    emitUdpFormat();
+}
+
+/** UDP packet size has changed. */
+void CAudioOptions::on_udpPacketSize_valueChanged(int value)
+{
+    Q_UNUSED(value);
+    emitUdpFormat();
+}
+
+/** UDP stereo streaming toggled. */
+void CAudioOptions::on_udpStereo_toggled(bool checked)
+{
+    Q_UNUSED(checked);
+    emitUdpFormat();
+}
+
+/** UDP packet header toggled. */
+void CAudioOptions::on_udpHeader_toggled(bool checked)
+{
+    Q_UNUSED(checked);
+    emitUdpFormat();
+}
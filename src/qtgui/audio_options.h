@@ -44,8 +44,10 @@ public:
     void closeEvent(QCloseEvent *event);
 
     void setRecDir(const QString &dir);
+    void setRecMode(int mode, double hang, int rotate_min);
     void setUdpHost(const QString &host);
     void setUdpPort(int port);
+    void setUdpFormat(bool stereo, int format, bool header, int packet_size);
 
     void setFftSplit(int pct_2d);
     int  getFftSplit(void) const;
@@ -56,6 +58,10 @@ public:
     void setWaterfallRange(int min, int max);
     void getWaterfallRange(int * min, int * max) const;
 
+    void setBufferAttr(int latency_ms, int server_ms, int minreq_ms, int prebuf_ms);
+    void getBufferAttr(int * latency_ms, int * server_ms, int * minreq_ms,
+                       int * prebuf_ms) const;
+
 signals:
     void newFftSplit(int pct_2d);
     void newPandapterRange(int min, int max);
@@ -64,19 +70,43 @@ signals:
     /*! \brief Signal emitted when a new valid directory has been selected. */
     void newRecDirSelected(const QString &dir);
 
+    /*! \brief Recording mode changed. Mode is audio_rec_sink::rec_mode. */
+    void newRecMode(int mode, double hang, int rotate_min);
+
     void newUdpHost(const QString text);
     void newUdpPort(int port);
 
+    /*! \brief UDP stream format changed. Format is udp_sink_f::sample_format. */
+    void newUdpFormat(bool stereo, int format, bool header, int packet_size);
+
+    /*! \brief Audio output buffering changed. All values in ms, 0 means default. */
+    void newBufferAttr(int latency_ms, int server_ms, int minreq_ms, int prebuf_ms);
+
 private slots:
     void on_fftSplitSlider_valueChanged(int value);
     void on_pandRangeSlider_valuesChanged(int min, int max);
     void on_wfRangeSlider_valuesChanged(int min, int max);
     void on_recDirEdit_textChanged(const QString &text);
     void on_recDirButton_clicked();
+    void on_recMode_currentIndexChanged(int index);
+    void on_recHang_valueChanged(double value);
+    void on_recRotate_valueChanged(int value);
     void on_udpHost_textChanged(const QString &text);
     void on_udpPort_valueChanged(int port);
+    void on_udpFormat_currentIndexChanged(int index);
+    void on_udpPacketSize_valueChanged(int value);
+    void on_udpStereo_toggled(bool checked);
+    void on_udpHeader_toggled(bool checked);
+    void on_bufLatency_valueChanged(int value);
+    void on_serverLatency_valueChanged(int value);
+    void on_minReq_valueChanged(int value);
+    void on_preBuf_valueChanged(int value);
 
 private:
+    void emitBufferAttr();
+    void emitUdpFormat();
+    void emitRecMode();
+
     Ui::CAudioOptions *ui;            /*!< The user interface widget. */
     QDir              *work_dir;      /*!< Used for validating chosen directory. */
     QPalette          *error_palette; /*!< Palette used to indicate an error. */
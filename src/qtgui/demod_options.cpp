@@ -90,11 +90,44 @@ int maxdev_to_index(float max_dev)
         return 3;
 }
 
+/* standard CTCSS tones and DCS codes; index 0 in the combos is "Off" */
+const float ctcss_tbl[] = {
+     67.0,  69.3,  71.9,  74.4,  77.0,  79.7,  82.5,  85.4,  88.5,  91.5,
+     94.8,  97.4, 100.0, 103.5, 107.2, 110.9, 114.8, 118.8, 123.0, 127.3,
+    131.8, 136.5, 141.3, 146.2, 150.0, 151.4, 156.7, 159.8, 162.2, 165.5,
+    167.9, 171.3, 173.8, 177.3, 179.9, 183.5, 186.2, 189.9, 192.8, 196.6,
+    199.5, 203.5, 206.5, 210.7, 218.1, 225.7, 229.1, 233.6, 241.8, 250.3,
+    254.1
+};
+const int ctcss_tbl_len = sizeof(ctcss_tbl) / sizeof(ctcss_tbl[0]);
+
+const int dcs_tbl[] = {
+     23,  25,  26,  31,  32,  36,  43,  47,  51,  53,  54,  65,  71,  72,
+     73,  74, 114, 115, 116, 122, 125, 131, 132, 134, 143, 145, 152, 155,
+    156, 162, 165, 172, 174, 205, 212, 223, 225, 226, 243, 244, 245, 246,
+    251, 252, 255, 261, 263, 265, 266, 271, 274, 306, 311, 315, 325, 331,
+    332, 343, 346, 351, 356, 364, 365, 371, 411, 412, 413, 423, 431, 432,
+    445, 446, 452, 454, 455, 462, 464, 465, 466, 503, 506, 516, 523, 526,
+    532, 546, 565, 606, 612, 624, 627, 631, 632, 654, 662, 664, 703, 712,
+    723, 731, 732, 734, 743, 754
+};
+const int dcs_tbl_len = sizeof(dcs_tbl) / sizeof(dcs_tbl[0]);
+
 CDemodOptions::CDemodOptions(QWidget *parent) :
     QDialog(parent),
     ui(new Ui::CDemodOptions)
 {
+    int i;
+
     ui->setupUi(this);
+
+    ui->ctcssSelector->addItem(tr("Off"));
+    for (i = 0; i < ctcss_tbl_len; i++)
+        ui->ctcssSelector->addItem(QString("%1 Hz").arg(ctcss_tbl[i], 0, 'f', 1));
+
+    ui->dcsSelector->addItem(tr("Off"));
+    for (i = 0; i < dcs_tbl_len; i++)
+        ui->dcsSelector->addItem(QString("D%1").arg(dcs_tbl[i], 3, 10, QChar('0')));
 }
 
 CDemodOptions::~CDemodOptions()
@@ -156,6 +189,46 @@ double CDemodOptions::getEmph(void) const
     return tau_from_index(ui->emphSelector->currentIndex());
 }
 
+void CDemodOptions::setCtcss(float tone_hz)
+{
+    int index = 0;
+
+    for (int i = 0; i < ctcss_tbl_len; i++)
+        if (qAbs(ctcss_tbl[i] - tone_hz) < 0.05f)
+            index = i + 1;
+
+    ui->ctcssSelector->setCurrentIndex(index);
+    if (index > 0)
+        ui->dcsSelector->setCurrentIndex(0);
+}
+
+float CDemodOptions::getCtcss(void) const
+{
+    int index = ui->ctcssSelector->currentIndex();
+
+    return index > 0 ? ctcss_tbl[index - 1] : 0.0;
+}
+
+void CDemodOptions::setDcs(int code)
+{
+    int index = 0;
+
+    for (int i = 0; i < dcs_tbl_len; i++)
+        if (dcs_tbl[i] == code)
+            index = i + 1;
+
+    ui->dcsSelector->setCurrentIndex(index);
+    if (index > 0)
+        ui->ctcssSelector->setCurrentIndex(0);
+}
+
+int CDemodOptions::getDcs(void) const
+{
+    int index = ui->dcsSelector->currentIndex();
+
+    return index > 0 ? dcs_tbl[index - 1] : 0;
+}
+
 void CDemodOptions::on_maxdevSelector_activated(int index)
 {
     emit fmMaxdevSelected(maxdev_from_index(index));
@@ -166,6 +239,22 @@ void CDemodOptions::on_emphSelector_activated(int index)
     emit fmEmphSelected(tau_from_index(index));
 }
 
+void CDemodOptions::on_ctcssSelector_activated(int index)
+{
+    if (index > 0)
+        ui->dcsSelector->setCurrentIndex(0);
+
+    emit fmCtcssSelected(index > 0 ? ctcss_tbl[index - 1] : 0.0);
+}
+
+void CDemodOptions::on_dcsSelector_activated(int index)
+{
+    if (index > 0)
+        ui->ctcssSelector->setCurrentIndex(0);
+
+    emit fmDcsSelected(index > 0 ? dcs_tbl[index - 1] : 0);
+}
+
 void CDemodOptions::on_dcrCheckBox_toggled(bool checked)
 {
     emit amDcrToggled(checked);
@@ -66,6 +66,12 @@ public:
     void setEmph(double tau);
     double getEmph(void) const;
 
+    void setCtcss(float tone_hz);
+    float getCtcss(void) const;
+
+    void setDcs(int code);
+    int  getDcs(void) const;
+
 signals:
     /*! \brief Signal emitted when new FM deviation is selected. */
     void fmMaxdevSelected(float max_dev);
@@ -73,6 +79,12 @@ signals:
     /*! \brief Signal emitted when new FM de-emphasis constant is selected. */
     void fmEmphSelected(double tau);
 
+    /*! \brief Signal emitted when new CTCSS tone is selected (0 = off). */
+    void fmCtcssSelected(float tone_hz);
+
+    /*! \brief Signal emitted when new DCS code is selected (0 = off). */
+    void fmDcsSelected(int code);
+
     /*! \brief Signal emitted when AM DCR is toggled. */
     void amDcrToggled(bool enabled);
 
@@ -82,6 +94,8 @@ signals:
 private slots:
     void on_maxdevSelector_activated(int index);
     void on_emphSelector_activated(int index);
+    void on_ctcssSelector_activated(int index);
+    void on_dcsSelector_activated(int index);
     void on_dcrCheckBox_toggled(bool checked);
     void on_cwOffsetSpin_valueChanged(int value);
 
@@ -29,6 +29,13 @@
 DockAudio::DockAudio(QWidget *parent) :
     QDockWidget(parent),
     ui(new Ui::DockAudio),
+    rec_mode(0),
+    rec_hang(1.0),
+    rec_rotate(60),
+    udp_stereo(false),
+    udp_format(0),
+    udp_header(false),
+    udp_packet_size(1472),
     autoSpan(true),
     rx_freq(144000000)
 {
@@ -56,8 +63,11 @@ DockAudio::DockAudio(QWidget *parent) :
     connect(audioOptions, SIGNAL(newPandapterRange(int,int)), this, SLOT(setNewPandapterRange(int,int)));
     connect(audioOptions, SIGNAL(newWaterfallRange(int,int)), this, SLOT(setNewWaterfallRange(int,int)));
     connect(audioOptions, SIGNAL(newRecDirSelected(QString)), this, SLOT(setNewRecDir(QString)));
+    connect(audioOptions, SIGNAL(newRecMode(int,double,int)), this, SLOT(setNewRecMode(int,double,int)));
     connect(audioOptions, SIGNAL(newUdpHost(QString)), this, SLOT(setNewUdpHost(QString)));
     connect(audioOptions, SIGNAL(newUdpPort(int)), this, SLOT(setNewUdpPort(int)));
+    connect(audioOptions, SIGNAL(newUdpFormat(bool,int,bool,int)), this, SLOT(setNewUdpFormat(bool,int,bool,int)));
+    connect(audioOptions, SIGNAL(newBufferAttr(int,int,int,int)), this, SIGNAL(audioBufferChanged(int,int,int,int)));
 
     ui->audioSpectrum->setFreqUnits(1000);
     ui->audioSpectrum->setSampleRate(48000);  // Full bandwidth
@@ -127,6 +137,26 @@ void DockAudio::setFftFill(bool enabled)
     ui->audioSpectrum->setFftFill(enabled);
 }
 
+/*! \brief Show the measured audio output latency.
+ *  \param latency_ms The latency in ms, negative if not available.
+ *  \param underruns Number of audio buffer underruns.
+ *  \param overruns Number of audio buffer overruns.
+ */
+void DockAudio::setAudioLatency(double latency_ms, unsigned long underruns,
+                                unsigned long overruns)
+{
+    if (latency_ms < 0.0)
+    {
+        ui->audioLatencyLabel->clear();
+        return;
+    }
+
+    ui->audioLatencyLabel->setText(QString("%1 ms").arg(latency_ms, 0, 'f', 0));
+    ui->audioLatencyLabel->setToolTip(tr("Measured audio output latency\n"
+                                         "Underruns: %1\nOverruns: %2")
+                                      .arg(underruns).arg(overruns));
+}
+
 /*! Public slot to trig audio recording by external events (e.g. satellite AOS).
  *
  * If a recording is already in progress we ignore the event.
@@ -193,13 +223,21 @@ void DockAudio::on_audioStreamButton_clicked(bool checked)
 void DockAudio::on_audioRecButton_clicked(bool checked)
 {
     if (checked) {
-        // FIXME: option to use local time
-        // use toUTC() function compatible with older versions of Qt.
-        QString file_name = QDateTime::currentDateTime().toUTC().toString("gqrx_yyyyMMdd_hhmmss");
-        last_audio = QString("%1/%2_%3.wav").arg(rec_dir).arg(file_name).arg(rx_freq);
+        if (rec_mode != 0)
+        {
+            // the recorder names the files when the squelch opens
+            emit audioRecStarted(rec_dir);
+        }
+        else
+        {
+            // FIXME: option to use local time
+            // use toUTC() function compatible with older versions of Qt.
+            QString file_name = QDateTime::currentDateTime().toUTC().toString("gqrx_yyyyMMdd_hhmmss");
+            last_audio = QString("%1/%2_%3.wav").arg(rec_dir).arg(file_name).arg(rx_freq);
 
-        // emit signal and start timer
-        emit audioRecStarted(last_audio);
+            // emit signal and start timer
+            emit audioRecStarted(last_audio);
+        }
 
         ui->audioRecButton->setToolTip(tr("Stop audio recorder"));
         ui->audioPlayButton->setEnabled(false); /* prevent playback while recording */
@@ -288,6 +326,7 @@ void DockAudio::setAudioPlayButtonState(bool checked)
 void DockAudio::saveSettings(QSettings *settings)
 {
     int     ival, fft_min, fft_max;
+    int     latency, server, minreq, prebuf;
 
     if (!settings)
         return;
@@ -327,6 +366,21 @@ void DockAudio::saveSettings(QSettings *settings)
     else
         settings->remove("rec_dir");
 
+    if (rec_mode != 0)
+        settings->setValue("rec_mode", rec_mode);
+    else
+        settings->remove("rec_mode");
+
+    if (rec_hang != 1.0)
+        settings->setValue("rec_hang", rec_hang);
+    else
+        settings->remove("rec_hang");
+
+    if (rec_rotate != 60)
+        settings->setValue("rec_rotate", rec_rotate);
+    else
+        settings->remove("rec_rotate");
+
     if (udp_host.isEmpty())
         settings->remove("udp_host");
     else
@@ -337,12 +391,51 @@ void DockAudio::saveSettings(QSettings *settings)
     else
         settings->remove("udp_port");
 
+    if (udp_stereo)
+        settings->setValue("udp_stereo", true);
+    else
+        settings->remove("udp_stereo");
+
+    if (udp_format != 0)
+        settings->setValue("udp_format", udp_format);
+    else
+        settings->remove("udp_format");
+
+    if (udp_header)
+        settings->setValue("udp_header", true);
+    else
+        settings->remove("udp_header");
+
+    if (udp_packet_size != 1472)
+        settings->setValue("udp_packet_size", udp_packet_size);
+    else
+        settings->remove("udp_packet_size");
+
+    audioOptions->getBufferAttr(&latency, &server, &minreq, &prebuf);
+    if (latency != 100)
+        settings->setValue("buffer_ms", latency);
+    else
+        settings->remove("buffer_ms");
+    if (server != 50)
+        settings->setValue("server_latency_ms", server);
+    else
+        settings->remove("server_latency_ms");
+    if (minreq != 0)
+        settings->setValue("minreq_ms", minreq);
+    else
+        settings->remove("minreq_ms");
+    if (prebuf != 0)
+        settings->setValue("prebuf_ms", prebuf);
+    else
+        settings->remove("prebuf_ms");
+
     settings->endGroup();
 }
 
 void DockAudio::readSettings(QSettings *settings)
 {
     int     ival, fft_min, fft_max;
+    int     latency, server, minreq, prebuf;
     bool    conv_ok = false;
 
     if (!settings)
@@ -378,6 +471,19 @@ void DockAudio::readSettings(QSettings *settings)
     rec_dir = settings->value("rec_dir", QDir::homePath()).toString();
     audioOptions->setRecDir(rec_dir);
 
+    rec_mode = settings->value("rec_mode", 0).toInt(&conv_ok);
+    if (!conv_ok || rec_mode < 0 || rec_mode > 2)
+        rec_mode = 0;
+    rec_hang = settings->value("rec_hang", 1.0).toDouble(&conv_ok);
+    if (!conv_ok || rec_hang < 0.0)
+        rec_hang = 1.0;
+    rec_rotate = settings->value("rec_rotate", 60).toInt(&conv_ok);
+    if (!conv_ok || rec_rotate < 1)
+        rec_rotate = 60;
+
+    audioOptions->setRecMode(rec_mode, rec_hang, rec_rotate);
+    emit audioRecModeChanged(rec_mode, rec_hang, rec_rotate);
+
     // Audio streaming host and port
     udp_host = settings->value("udp_host", "localhost").toString();
     udp_port = settings->value("udp_port", 7355).toInt(&conv_ok);
@@ -387,6 +493,35 @@ void DockAudio::readSettings(QSettings *settings)
     audioOptions->setUdpHost(udp_host);
     audioOptions->setUdpPort(udp_port);
 
+    udp_stereo = settings->value("udp_stereo", false).toBool();
+    udp_format = settings->value("udp_format", 0).toInt(&conv_ok);
+    if (!conv_ok || udp_format < 0 || udp_format > 1)
+        udp_format = 0;
+    udp_header = settings->value("udp_header", false).toBool();
+    udp_packet_size = settings->value("udp_packet_size", 1472).toInt(&conv_ok);
+    if (!conv_ok)
+        udp_packet_size = 1472;
+
+    audioOptions->setUdpFormat(udp_stereo, udp_format, udp_header, udp_packet_size);
+    emit audioStreamFormatChanged(udp_stereo, udp_format, udp_header, udp_packet_size);
+
+    // Audio output buffering
+    latency = settings->value("buffer_ms", 100).toInt(&conv_ok);
+    if (!conv_ok)
+        latency = 100;
+    server = settings->value("server_latency_ms", 50).toInt(&conv_ok);
+    if (!conv_ok)
+        server = 50;
+    minreq = settings->value("minreq_ms", 0).toInt(&conv_ok);
+    if (!conv_ok)
+        minreq = 0;
+    prebuf = settings->value("prebuf_ms", 0).toInt(&conv_ok);
+    if (!conv_ok)
+        prebuf = 0;
+
+    audioOptions->setBufferAttr(latency, server, minreq, prebuf);
+    emit audioBufferChanged(latency, server, minreq, prebuf);
+
     settings->endGroup();
 }
 
@@ -408,6 +543,18 @@ void DockAudio::setNewRecDir(const QString &dir)
     rec_dir = dir;
 }
 
+/*! \brief Slot called when the recording mode has been changed in the audio
+ *         conf dialog.
+ */
+void DockAudio::setNewRecMode(int mode, double hang, int rotate_min)
+{
+    rec_mode = mode;
+    rec_hang = hang;
+    rec_rotate = rotate_min;
+
+    emit audioRecModeChanged(mode, hang, rotate_min);
+}
+
 /*! \brief Slot called when a new network host has been entered. */
 void DockAudio::setNewUdpHost(const QString &host)
 {
@@ -422,3 +569,14 @@ void DockAudio::setNewUdpPort(int port)
 {
     udp_port = port;
 }
+
+/*! \brief Slot called when the UDP stream format has changed. */
+void DockAudio::setNewUdpFormat(bool stereo, int format, bool header, int packet_size)
+{
+    udp_stereo = stereo;
+    udp_format = format;
+    udp_header = header;
+    udp_packet_size = packet_size;
+
+    emit audioStreamFormatChanged(stereo, format, header, packet_size);
+}
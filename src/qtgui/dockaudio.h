@@ -63,6 +63,9 @@ public:
     void setFftColor(QColor color);
     void setFftFill(bool enabled);
 
+    void setAudioLatency(double latency_ms, unsigned long underruns,
+                         unsigned long overruns);
+
     void saveSettings(QSettings *settings);
     void readSettings(QSettings *settings);
 
@@ -81,9 +84,15 @@ signals:
     /*! \brief Audio streaming stopped. */
     void audioStreamingStopped();
 
+    /*! \brief Audio streaming format changed. Format is udp_sink_f::sample_format. */
+    void audioStreamFormatChanged(bool stereo, int format, bool header, int packet_size);
+
     /*! \brief Signal emitted when audio recording is started. */
     void audioRecStarted(const QString filename);
 
+    /*! \brief Audio recording mode changed. Mode is audio_rec_sink::rec_mode. */
+    void audioRecModeChanged(int mode, double hang, int rotate_min);
+
     /*! \brief Signal emitted when audio recording is stopped. */
     void audioRecStopped();
 
@@ -96,6 +105,9 @@ signals:
     /*! \brief FFT rate changed. */
     void fftRateChanged(int fps);
 
+    /*! \brief Audio output buffering changed. All values in ms, 0 means default. */
+    void audioBufferChanged(int latency_ms, int server_ms, int minreq_ms, int prebuf_ms);
+
 private slots:
     void on_audioGainSlider_valueChanged(int value);
     void on_audioStreamButton_clicked(bool checked);
@@ -105,8 +117,10 @@ private slots:
     void setNewPandapterRange(int min, int max);
     void setNewWaterfallRange(int min, int max);
     void setNewRecDir(const QString &dir);
+    void setNewRecMode(int mode, double hang, int rotate_min);
     void setNewUdpHost(const QString &host);
     void setNewUdpPort(int port);
+    void setNewUdpFormat(bool stereo, int format, bool header, int packet_size);
 
 
 private:
@@ -114,9 +128,16 @@ private:
     CAudioOptions *audioOptions; /*! Audio options dialog. */
     QString        rec_dir;      /*! Location for audio recordings. */
     QString        last_audio;   /*! Last audio recording. */
+    int            rec_mode;     /*! Recording mode, 0 is continuous. */
+    double         rec_hang;     /*! Squelch hang time in seconds. */
+    int            rec_rotate;   /*! File rotation period in minutes. */
 
     QString        udp_host;     /*! UDP client host name. */
     int            udp_port;     /*! UDP client port number. */
+    bool           udp_stereo;   /*! Stream both channels. */
+    int            udp_format;   /*! UDP sample format. */
+    bool           udp_header;   /*! Send packet header. */
+    int            udp_packet_size; /*! Maximum UDP packet size. */
 
     bool           autoSpan;     /*! Whether to allow mode-dependent auto span. */
 
@@ -79,6 +79,11 @@ DockBookmarks::DockBookmarks(QWidget *parent) :
 
     m_currentFrequency = 0;
     m_updating = false;
+    m_scanRate = 0.f;
+
+    // Scanner options
+    scanOpt = new CScanOptions(this);
+    connect(scanOpt, SIGNAL(optionsChanged()), this, SIGNAL(scanOptionsChanged()));
 
     // TagList
     updateTags();
@@ -99,6 +104,156 @@ DockBookmarks::~DockBookmarks()
 {
     delete bookmarksTableModel;
     bookmarksTableModel = 0;
+    delete scanOpt;
+}
+
+/** Read scanner settings. */
+void DockBookmarks::readSettings(QSettings *settings)
+{
+    bool    conv_ok;
+    int     int_val;
+    double  dbl_val;
+
+    if (!settings)
+        return;
+
+    settings->beginGroup("bookmarks");
+
+    int_val = settings->value("scan_settle", 30).toInt(&conv_ok);
+    if (conv_ok)
+        scanOpt->setSettleTime(int_val);
+
+    int_val = settings->value("scan_retune", 100).toInt(&conv_ok);
+    if (conv_ok)
+        scanOpt->setRetuneTime(int_val);
+
+    dbl_val = settings->value("scan_dwell", 0.0).toDouble(&conv_ok);
+    if (conv_ok)
+        scanOpt->setDwellTime(dbl_val);
+
+    dbl_val = settings->value("scan_hang", 2.0).toDouble(&conv_ok);
+    if (conv_ok)
+        scanOpt->setHangTime(dbl_val);
+
+    scanOpt->setPriorityTag(settings->value("scan_priority_tag", "Priority").toString());
+
+    dbl_val = settings->value("scan_priority_interval", 2.0).toDouble(&conv_ok);
+    if (conv_ok)
+        scanOpt->setPriorityInterval(dbl_val);
+
+    settings->endGroup();
+}
+
+/** Save scanner settings. */
+void DockBookmarks::saveSettings(QSettings *settings)
+{
+    if (!settings)
+        return;
+
+    settings->beginGroup("bookmarks");
+
+    // only save non-default values
+    if (scanOpt->settleTime() != 30)
+        settings->setValue("scan_settle", scanOpt->settleTime());
+    else
+        settings->remove("scan_settle");
+
+    if (scanOpt->retuneTime() != 100)
+        settings->setValue("scan_retune", scanOpt->retuneTime());
+    else
+        settings->remove("scan_retune");
+
+    if (scanOpt->dwellTime() > 0.0)
+        settings->setValue("scan_dwell", scanOpt->dwellTime());
+    else
+        settings->remove("scan_dwell");
+
+    if (scanOpt->hangTime() != 2.0)
+        settings->setValue("scan_hang", scanOpt->hangTime());
+    else
+        settings->remove("scan_hang");
+
+    if (scanOpt->priorityTag() != "Priority")
+        settings->setValue("scan_priority_tag", scanOpt->priorityTag());
+    else
+        settings->remove("scan_priority_tag");
+
+    if (scanOpt->priorityInterval() != 2.0)
+        settings->setValue("scan_priority_interval", scanOpt->priorityInterval());
+    else
+        settings->remove("scan_priority_interval");
+
+    settings->endGroup();
+}
+
+int DockBookmarks::getScanSettleTime() const
+{
+    return scanOpt->settleTime();
+}
+
+int DockBookmarks::getScanRetuneTime() const
+{
+    return scanOpt->retuneTime();
+}
+
+double DockBookmarks::getScanDwellTime() const
+{
+    return scanOpt->dwellTime();
+}
+
+double DockBookmarks::getScanHangTime() const
+{
+    return scanOpt->hangTime();
+}
+
+QString DockBookmarks::getScanPriorityTag() const
+{
+    return scanOpt->priorityTag();
+}
+
+double DockBookmarks::getScanPriorityInterval() const
+{
+    return scanOpt->priorityInterval();
+}
+
+/** Update the scan button when the scanner has been started or stopped. */
+void DockBookmarks::setScanRunning(bool running)
+{
+    ui->scanButton->blockSignals(true);
+    ui->scanButton->setChecked(running);
+    ui->scanButton->blockSignals(false);
+
+    if (!running)
+        ui->scanLabel->clear();
+}
+
+/** Show the scan rate in channels per second. */
+void DockBookmarks::setScanRate(float channels_per_s)
+{
+    m_scanRate = channels_per_s;
+    ui->scanLabel->setText(tr("%1 ch/s").arg(channels_per_s, 0, 'f', 1));
+}
+
+/** Show the channel the scanner has stopped on. */
+void DockBookmarks::setScanActive(bool active, const QString &name)
+{
+    if (active)
+        ui->scanLabel->setText(tr("Stopped on %1").arg(name));
+    else if (m_scanRate > 0.f)
+        setScanRate(m_scanRate);
+    else
+        ui->scanLabel->clear();
+}
+
+void DockBookmarks::on_scanButton_toggled(bool checked)
+{
+    m_scanRate = 0.f;
+    emit scanToggled(checked);
+}
+
+void DockBookmarks::on_scanOptButton_clicked()
+{
+    scanOpt->show();
 }
 
 void DockBookmarks::activated(const QModelIndex & index)
@@ -23,8 +23,10 @@
 #pragma once
 
 #include <QDockWidget>
+#include <QSettings>
 #include <QTableWidgetItem>
 #include "qtgui/bookmarkstablemodel.h"
+#include "qtgui/scan_options.h"
 #include <QItemDelegate>
 
 namespace Ui {
@@ -48,8 +50,10 @@ class DockBookmarks : public QDockWidget
 private:
     Ui::DockBookmarks *ui;
     QMenu*             contextmenu;
+    CScanOptions*      scanOpt;
     qint64             m_currentFrequency;
     bool               m_updating;
+    float              m_scanRate;
 
     bool eventFilter(QObject* object, QEvent* event);
 
@@ -66,11 +70,26 @@ public:
     void updateBookmarks();
     void changeBookmarkTags(int row, int /*column*/);
 
+    void readSettings(QSettings *settings);
+    void saveSettings(QSettings *settings);
+
+    int     getScanSettleTime() const;
+    int     getScanRetuneTime() const;
+    double  getScanDwellTime() const;
+    double  getScanHangTime() const;
+    QString getScanPriorityTag() const;
+    double  getScanPriorityInterval() const;
+
 signals:
     void newBookmarkActivated(qint64, QString, int);
+    void scanToggled(bool enabled);
+    void scanOptionsChanged();
 
 public slots:
     void setNewFrequency(qint64 rx_freq);
+    void setScanRunning(bool running);
+    void setScanRate(float channels_per_s);
+    void setScanActive(bool active, const QString &name);
 
 private slots:
     void activated(const QModelIndex & index );
@@ -81,4 +100,6 @@ private slots:
     void ShowContextMenu(const QPoint&pos);
     bool DeleteSelectedBookmark();
     void doubleClicked(const QModelIndex & index);
+    void on_scanButton_toggled(bool checked);
+    void on_scanOptButton_clicked();
 };
@@ -76,6 +76,7 @@ DockRxOpt::DockRxOpt(qint64 filterOffsetRange, QWidget *parent) :
     ui->agcButton->setAttribute(Qt::WA_LayoutUsesWidgetRect);
     ui->autoSquelchButton->setAttribute(Qt::WA_LayoutUsesWidgetRect);
     ui->resetSquelchButton->setAttribute(Qt::WA_LayoutUsesWidgetRect);
+    ui->sqlOptButton->setAttribute(Qt::WA_LayoutUsesWidgetRect);
 #endif
 
 #ifdef Q_OS_LINUX
@@ -83,6 +84,7 @@ DockRxOpt::DockRxOpt(qint64 filterOffsetRange, QWidget *parent) :
     ui->agcButton->setMinimumSize(32, 24);
     ui->autoSquelchButton->setMinimumSize(32, 24);
     ui->resetSquelchButton->setMinimumSize(32, 24);
+    ui->sqlOptButton->setMinimumSize(32, 24);
     ui->nbOptButton->setMinimumSize(32, 24);
     ui->nb2Button->setMinimumSize(32, 24);
     ui->nb1Button->setMinimumSize(32, 24);
@@ -100,6 +102,8 @@ DockRxOpt::DockRxOpt(qint64 filterOffsetRange, QWidget *parent) :
     demodOpt->setCurrentPage(CDemodOptions::PAGE_FM_OPT);
     connect(demodOpt, SIGNAL(fmMaxdevSelected(float)), this, SLOT(demodOpt_fmMaxdevSelected(float)));
     connect(demodOpt, SIGNAL(fmEmphSelected(double)), this, SLOT(demodOpt_fmEmphSelected(double)));
+    connect(demodOpt, SIGNAL(fmCtcssSelected(float)), this, SLOT(demodOpt_fmCtcssSelected(float)));
+    connect(demodOpt, SIGNAL(fmDcsSelected(int)), this, SLOT(demodOpt_fmDcsSelected(int)));
     connect(demodOpt, SIGNAL(amDcrToggled(bool)), this, SLOT(demodOpt_amDcrToggled(bool)));
     connect(demodOpt, SIGNAL(cwOffsetChanged(int)), this, SLOT(demodOpt_cwOffsetChanged(int)));
 
@@ -114,6 +118,12 @@ DockRxOpt::DockRxOpt(qint64 filterOffsetRange, QWidget *parent) :
     // Noise blanker options
     nbOpt = new CNbOptions(this);
     connect(nbOpt, SIGNAL(thresholdChanged(int,double)), this, SLOT(nbOpt_thresholdChanged(int,double)));
+
+    // Squelch options
+    sqlOpt = new CSqlOptions(this);
+    connect(sqlOpt, SIGNAL(attackChanged(double)), this, SLOT(sqlOpt_attackChanged(double)));
+    connect(sqlOpt, SIGNAL(hangChanged(double)), this, SLOT(sqlOpt_hangChanged(double)));
+    connect(sqlOpt, SIGNAL(gateToggled(bool)), this, SLOT(sqlOpt_gateToggled(bool)));
 }
 
 DockRxOpt::~DockRxOpt()
@@ -122,6 +132,7 @@ DockRxOpt::~DockRxOpt()
     delete demodOpt;
     delete agcOpt;
     delete nbOpt;
+    delete sqlOpt;
 }
 
 /**
@@ -294,6 +305,40 @@ double DockRxOpt::currentEmph() const
     return demodOpt->getEmph();
 }
 
+/** Get the current CTCSS squelch tone in Hz, 0 if off. */
+float DockRxOpt::currentCtcss() const
+{
+    return demodOpt->getCtcss();
+}
+
+/** Get the current DCS squelch code, 0 if off. */
+int DockRxOpt::currentDcs() const
+{
+    return demodOpt->getDcs();
+}
+
+/**
+ * @brief Select CTCSS squelch tone.
+ * @param tone_hz The tone in Hz, 0 to disable.
+ *
+ * Only updates the demodulator options, no signal is emitted.
+ */
+void DockRxOpt::setCtcss(float tone_hz)
+{
+    demodOpt->setCtcss(tone_hz);
+}
+
+/**
+ * @brief Select DCS squelch code.
+ * @param code The DCS code, e.g. 23 for D023, 0 to disable.
+ *
+ * Only updates the demodulator options, no signal is emitted.
+ */
+void DockRxOpt::setDcs(int code)
+{
+    demodOpt->setDcs(code);
+}
+
 /**
  * @brief Set squelch level.
  * @param level Squelch level in dBFS
@@ -308,6 +353,24 @@ double DockRxOpt::getSqlLevel(void) const
     return ui->sqlSpinBox->value();
 }
 
+/** Get the squelch attack (fade) time in milliseconds. */
+double DockRxOpt::getSqlAttack(void) const
+{
+    return sqlOpt->attack();
+}
+
+/** Get the squelch hang time in milliseconds. */
+double DockRxOpt::getSqlHang(void) const
+{
+    return sqlOpt->hang();
+}
+
+/** Get the squelch gating state. */
+bool DockRxOpt::getSqlGate(void) const
+{
+    return sqlOpt->gate();
+}
+
 /**
  * @brief Get the current squelch level
  * @returns The current squelch setting in dBFS
@@ -362,6 +425,14 @@ void DockRxOpt::readSettings(QSettings *settings)
     if (conv_ok && dbl_val >= 0)
         demodOpt->setEmph(1.0e-6 * dbl_val); // was stored as usec
 
+    dbl_val = settings->value("receiver/ctcss", 0.0).toDouble(&conv_ok);
+    if (conv_ok && dbl_val > 0.0)
+        demodOpt->setCtcss(dbl_val);
+
+    int_val = settings->value("receiver/dcs", 0).toInt(&conv_ok);
+    if (conv_ok && int_val > 0)
+        demodOpt->setDcs(int_val);
+
     qint64 offs = settings->value("receiver/offset", 0).toInt(&conv_ok);
     if (offs)
     {
@@ -373,6 +444,16 @@ void DockRxOpt::readSettings(QSettings *settings)
     if (conv_ok && dbl_val < 1.0)
         ui->sqlSpinBox->setValue(dbl_val);
 
+    dbl_val = settings->value("receiver/sql_attack", 0.0).toDouble(&conv_ok);
+    if (conv_ok && dbl_val >= 0.0)
+        sqlOpt->setAttack(dbl_val);
+
+    dbl_val = settings->value("receiver/sql_hang", 0.0).toDouble(&conv_ok);
+    if (conv_ok && dbl_val >= 0.0)
+        sqlOpt->setHang(dbl_val);
+
+    sqlOpt->setGate(settings->value("receiver/sql_gate", false).toBool());
+
     // AGC settings
     int_val = settings->value("receiver/agc_threshold", -100).toInt(&conv_ok);
     if (conv_ok)
@@ -441,6 +522,16 @@ void DockRxOpt::saveSettings(QSettings *settings)
     else
         settings->setValue("receiver/fm_deemph", int_val);
 
+    if (demodOpt->getCtcss() > 0.0f)
+        settings->setValue("receiver/ctcss", demodOpt->getCtcss());
+    else
+        settings->remove("receiver/ctcss");
+
+    if (demodOpt->getDcs() > 0)
+        settings->setValue("receiver/dcs", demodOpt->getDcs());
+    else
+        settings->remove("receiver/dcs");
+
     qint64 offs = ui->filterFreq->getFrequency();
     if (offs)
         settings->setValue("receiver/offset", offs);
@@ -455,6 +546,21 @@ void DockRxOpt::saveSettings(QSettings *settings)
     else
         settings->remove("receiver/sql_level");
 
+    if (sqlOpt->attack() > 0.0)
+        settings->setValue("receiver/sql_attack", sqlOpt->attack());
+    else
+        settings->remove("receiver/sql_attack");
+
+    if (sqlOpt->hang() > 0.0)
+        settings->setValue("receiver/sql_hang", sqlOpt->hang());
+    else
+        settings->remove("receiver/sql_hang");
+
+    if (sqlOpt->gate())
+        settings->setValue("receiver/sql_gate", true);
+    else
+        settings->remove("receiver/sql_gate");
+
     // AGC settings
     int_val = agcOpt->threshold();
     if (int_val != -100)
@@ -599,6 +705,30 @@ void DockRxOpt::on_resetSquelchButton_clicked()
     ui->sqlSpinBox->setValue(-150.0);
 }
 
+/** Show squelch options. */
+void DockRxOpt::on_sqlOptButton_clicked()
+{
+    sqlOpt->show();
+}
+
+/** Squelch attack time changed in the options popup. */
+void DockRxOpt::sqlOpt_attackChanged(double attack_ms)
+{
+    emit sqlAttackChanged(attack_ms);
+}
+
+/** Squelch hang time changed in the options popup. */
+void DockRxOpt::sqlOpt_hangChanged(double hang_ms)
+{
+    emit sqlHangChanged(hang_ms);
+}
+
+/** Squelch gating toggled in the options popup. */
+void DockRxOpt::sqlOpt_gateToggled(bool gate)
+{
+    emit sqlGateToggled(gate);
+}
+
 /** AGC preset has changed. */
 void DockRxOpt::on_agcPresetCombo_currentIndexChanged(int index)
 {
@@ -700,6 +830,18 @@ void DockRxOpt::demodOpt_fmEmphSelected(double tau)
     emit fmEmphSelected(tau);
 }
 
+/** CTCSS squelch tone selected in the demodulator options. */
+void DockRxOpt::demodOpt_fmCtcssSelected(float tone_hz)
+{
+    emit fmCtcssSelected(tone_hz);
+}
+
+/** DCS squelch code selected in the demodulator options. */
+void DockRxOpt::demodOpt_fmDcsSelected(int code)
+{
+    emit fmDcsSelected(code);
+}
+
 /**
  * @brief AM DC removal toggled by user.
  * @param enabled Whether DCR is enabled or not.
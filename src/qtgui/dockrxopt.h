@@ -28,6 +28,7 @@
 #include "qtgui/agc_options.h"
 #include "qtgui/demod_options.h"
 #include "qtgui/nb_options.h"
+#include "qtgui/sql_options.h"
 
 #define FILTER_PRESET_WIDE      0
 #define FILTER_PRESET_NORMAL    1
@@ -102,11 +103,16 @@ public:
     float currentMaxdev() const;
     double currentEmph() const;
     double currentSquelchLevel() const;
+    float  currentCtcss() const;
+    int    currentDcs() const;
 
     void    getFilterPreset(int mode, int preset, int * lo, int * hi) const;
     int     getCwOffset() const;
 
     double  getSqlLevel(void) const;
+    double  getSqlAttack(void) const;
+    double  getSqlHang(void) const;
+    bool    getSqlGate(void) const;
 
     static QStringList ModulationStrings;
     static QString GetStringForModulationIndex(int iModulationIndex);
@@ -118,6 +124,8 @@ public slots:
     void setCurrentDemod(int demod);
     void setFilterOffset(qint64 freq_hz);
     void setSquelchLevel(double level);
+    void setCtcss(float tone_hz);
+    void setDcs(int code);
 
 private:
     void updateHwFreq();
@@ -140,6 +148,12 @@ signals:
     /** Signal emitted when new FM de-emphasis constant is selected. */
     void fmEmphSelected(double tau);
 
+    /** Signal emitted when new CTCSS squelch tone is selected (0 = off). */
+    void fmCtcssSelected(float tone_hz);
+
+    /** Signal emitted when new DCS squelch code is selected (0 = off). */
+    void fmDcsSelected(int code);
+
     /** Signal emitted when AM DCR status is toggled. */
     void amDcrToggled(bool enabled);
 
@@ -156,6 +170,15 @@ signals:
      */
     double sqlAutoClicked();
 
+    /** Signal emitted when squelch attack (fade) time has changed. Time is in millisec. */
+    void sqlAttackChanged(double attack_ms);
+
+    /** Signal emitted when squelch hang time has changed. Time is in millisec. */
+    void sqlHangChanged(double hang_ms);
+
+    /** Signal emitted when squelch gating is toggled. */
+    void sqlGateToggled(bool gate);
+
     /** Signal emitted when AGC is togglen ON/OFF. */
     void agcToggled(bool agc_on);
 
@@ -188,6 +211,7 @@ private slots:
     void on_agcButton_clicked();
     void on_autoSquelchButton_clicked();
     void on_resetSquelchButton_clicked();
+    void on_sqlOptButton_clicked();
     //void on_agcPresetCombo_activated(int index);
     void on_agcPresetCombo_currentIndexChanged(int index);
     void on_sqlSpinBox_valueChanged(double value);
@@ -201,6 +225,8 @@ private slots:
     // Signals coming from demod options pop-up
     void demodOpt_fmMaxdevSelected(float max_dev);
     void demodOpt_fmEmphSelected(double tau);
+    void demodOpt_fmCtcssSelected(float tone_hz);
+    void demodOpt_fmDcsSelected(int code);
     void demodOpt_amDcrToggled(bool enabled);
     void demodOpt_cwOffsetChanged(int offset);
 
@@ -211,11 +237,17 @@ private slots:
     void agcOpt_slopeChanged(int value);
     void agcOpt_decayChanged(int value);
 
+    // Signals coming from squelch options popup
+    void sqlOpt_attackChanged(double attack_ms);
+    void sqlOpt_hangChanged(double hang_ms);
+    void sqlOpt_gateToggled(bool gate);
+
 private:
     Ui::DockRxOpt *ui;        /** The Qt designer UI file. */
     CDemodOptions *demodOpt;  /** Demodulator options. */
     CAgcOptions   *agcOpt;    /** AGC options. */
     CNbOptions    *nbOpt;     /** Noise blanker options. */
+    CSqlOptions   *sqlOpt;    /** Squelch options. */
 
     bool agc_is_on;
 
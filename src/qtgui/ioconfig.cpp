@@ -112,6 +112,23 @@ CIoConfig::CIoConfig(QSettings * settings,
     ui->decimCombo->setCurrentIndex(idx);
     decimationChanged(idx);
 
+    // decimation filter: 0 = FIR, otherwise half band attenuation in dB
+    switch (settings->value("input/decim_filter", 0).toInt())
+    {
+    case 70:
+        ui->decimFilterCombo->setCurrentIndex(1);
+        break;
+    case 100:
+        ui->decimFilterCombo->setCurrentIndex(2);
+        break;
+    case 140:
+        ui->decimFilterCombo->setCurrentIndex(3);
+        break;
+    default:
+        ui->decimFilterCombo->setCurrentIndex(0);
+        break;
+    }
+
     // Analog bandwidth
     ui->bwSpinBox->setValue(1.0e-6*settings->value("input/bandwidth", 0.0).toDouble());
 
@@ -313,6 +330,13 @@ void CIoConfig::saveConfig()
         m_settings->remove("input/decimation");
     else
         m_settings->setValue("input/decimation", int_val);
+
+    static const int decim_filter_atten[] = {0, 70, 100, 140};
+    idx = ui->decimFilterCombo->currentIndex();
+    if (idx < 1 || idx > 3)
+        m_settings->remove("input/decim_filter");
+    else
+        m_settings->setValue("input/decim_filter", decim_filter_atten[idx]);
 }
 
 
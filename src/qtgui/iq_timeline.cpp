@@ -0,0 +1,146 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <QPainter>
+#include <QPolygonF>
+
+#include "iq_timeline.h"
+
+
+CIqTimeline::CIqTimeline(QWidget *parent) :
+    QFrame(parent),
+    m_Duration(0.0),
+    m_Position(0.0)
+{
+    setCursor(Qt::CrossCursor);
+}
+
+QSize CIqTimeline::minimumSizeHint() const
+{
+    return QSize(100, 50);
+}
+
+/*! \brief Show the overview of a recording.
+ *  \param spectrogram Image with one column per time slice and the highest
+ *                     frequency in the top row.
+ *  \param power The mean power per time slice in dBFS.
+ *  \param duration The length of the recording in seconds.
+ */
+void CIqTimeline::setOverview(const QImage &spectrogram,
+                              const QVector<float> &power, double duration)
+{
+    m_Spectrogram = spectrogram;
+    m_Power = power;
+    m_Duration = duration;
+    m_Message.clear();
+    update();
+}
+
+/*! \brief Remove the overview and show a message instead. */
+void CIqTimeline::clearOverview(const QString &message)
+{
+    m_Spectrogram = QImage();
+    m_Power.clear();
+    m_Duration = 0.0;
+    m_Message = message;
+    update();
+}
+
+/*! \brief Set the position of the playback cursor. */
+void CIqTimeline::setPosition(double seconds)
+{
+    if (seconds == m_Position)
+        return;
+
+    m_Position = seconds;
+    update();
+}
+
+void CIqTimeline::paintEvent(QPaintEvent *event)
+{
+    QPainter    painter(this);
+    QRect       r = contentsRect();
+
+    painter.fillRect(r, Qt::black);
+
+    if (m_Spectrogram.isNull())
+    {
+        painter.setPen(Qt::gray);
+        painter.drawText(r, Qt::AlignCenter, m_Message);
+        QFrame::paintEvent(event);
+        return;
+    }
+
+    painter.drawImage(r, m_Spectrogram);
+
+    // mean power, scaled to the range of the recording
+    if (m_Power.size() > 1)
+    {
+        float       pmin = m_Power[0], pmax = m_Power[0];
+        QPolygonF   line;
+
+        for (int i = 1; i < m_Power.size(); i++)
+        {
+            pmin = qMin(pmin, m_Power[i]);
+            pmax = qMax(pmax, m_Power[i]);
+        }
+        if (pmax - pmin < 10.f)
+            pmin = pmax - 10.f;
+
+        for (int i = 0; i < m_Power.size(); i++)
+        {
+            qreal x = r.left() + (i + 0.5) * r.width() / m_Power.size();
+            qreal y = r.bottom() - (m_Power[i] - pmin) / (pmax - pmin) * (r.height() - 2);
+            line << QPointF(x, y);
+        }
+
+        painter.setPen(QColor(255, 255, 255, 160));
+        painter.drawPolyline(line);
+    }
+
+    if (m_Duration > 0.0)
+    {
+        int x = r.left() + (int)(m_Position / m_Duration * r.width());
+
+        painter.setPen(Qt::red);
+        painter.drawLine(x, r.top(), x, r.bottom());
+    }
+
+    QFrame::paintEvent(event);
+}
+
+void CIqTimeline::mousePressEvent(QMouseEvent *event)
+{
+    QRect   r = contentsRect();
+
+    if (event->button() != Qt::LeftButton || m_Duration <= 0.0 ||
+        !r.contains(event->pos()))
+    {
+        QFrame::mousePressEvent(event);
+        return;
+    }
+
+    double seconds = m_Duration * (event->pos().x() - r.left()) / r.width();
+    double offset = 0.5 - (double)(event->pos().y() - r.top()) / r.height();
+
+    emit positionSelected(seconds, offset);
+}
@@ -0,0 +1,72 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef IQ_TIMELINE_H
+#define IQ_TIMELINE_H
+
+#include <QFrame>
+#include <QImage>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QString>
+#include <QVector>
+
+/*! \brief Timeline with a spectrogram overview of an I/Q recording.
+ *
+ * Time runs from left to right and frequency from bottom to top, with the
+ * mean power of the recording drawn on top of the spectrogram. Clicking
+ * on the timeline selects a time and frequency in the recording.
+ */
+class CIqTimeline : public QFrame
+{
+    Q_OBJECT
+
+public:
+    explicit CIqTimeline(QWidget *parent = 0);
+
+    QSize minimumSizeHint() const;
+
+    void setOverview(const QImage &spectrogram, const QVector<float> &power,
+                     double duration);
+    void clearOverview(const QString &message = QString());
+    void setPosition(double seconds);
+
+signals:
+    /*! \brief The user has clicked on the timeline.
+     *  \param seconds The time from the beginning of the recording.
+     *  \param offset The frequency relative to the sample rate, -0.5 to 0.5.
+     */
+    void positionSelected(double seconds, double offset);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+
+private:
+    QImage          m_Spectrogram;
+    QVector<float>  m_Power;        /*!< Mean power per slice in dBFS. */
+    QString         m_Message;      /*!< Shown when there is no overview. */
+    double          m_Duration;     /*!< Length of the recording in seconds. */
+    double          m_Position;     /*!< Playback position in seconds. */
+};
+
+#endif // IQ_TIMELINE_H
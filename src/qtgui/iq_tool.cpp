@@ -21,16 +21,21 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <QMessageBox>
+#include <QDateTime>
 #include <QDebug>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QDir>
+#include <QImage>
+#include <QListWidgetItem>
 #include <QPalette>
+#include <QPixmap>
 #include <QString>
 #include <QStringList>
 #include <QTime>
 
-#include <math.h>
+#include <algorithm>
+#include <vector>
 
 #include "iq_tool.h"
 #include "ui_iq_tool.h"
@@ -43,15 +48,18 @@ CIqTool::CIqTool(QWidget *parent) :
     ui->setupUi(this);
 
     is_recording = false;
+    is_committing = false;
     is_playing = false;
     bytes_per_sample = 8;
     sample_rate = 192000;
     rec_len = 0;
-    plot_spp = 1;
+    is_indexing = false;
 
     //ui->recDirEdit->setText(QDir::currentPath());
 
-    recdir = new QDir(QDir::homePath(), "*.raw");
+    recdir = new QDir(QDir::homePath(), "*.raw *.cs16 *.cs8");
+
+    ui->listWidget->setIconSize(QSize(48, 16));
 
     error_palette = new QPalette();
     error_palette->setColor(QPalette::Text, Qt::red);
@@ -84,6 +92,120 @@ void CIqTool::setSampleRate(qint64 sr)
     }
 }
 
+/*! \brief Show recorder statistics.
+ *  \param throughput Write rate in bytes per second.
+ *  \param headroom Free buffer space in percent.
+ *  \param dropped Number of samples dropped because the buffers were full.
+ *  \param error Whether writing to the file has failed.
+ */
+void CIqTool::setRecordingStats(double throughput, int headroom, qint64 dropped,
+                                bool error)
+{
+    if (!is_recording && !is_committing)
+        return;
+
+    if (error)
+    {
+        ui->recStatsLabel->setText(tr("Write error"));
+        return;
+    }
+
+    QString text = tr("%1 MB/s, %2% free").arg(throughput * 1.e-6, 0, 'f', 1)
+                                          .arg(headroom);
+    if (dropped > 0)
+        text += tr(", %1 dropped").arg(dropped);
+    ui->recStatsLabel->setText(text);
+}
+
+QString CIqTool::recDir() const
+{
+    return recdir->path();
+}
+
+/*! \brief Get the sample format selected for new recordings. */
+int CIqTool::recFormat() const
+{
+    return ui->formatCombo->currentIndex();
+}
+
+int CIqTool::triggerMode() const
+{
+    return ui->trigModeCombo->currentIndex();
+}
+
+/*! \brief Get the SNR threshold of the activity trigger in dB. */
+double CIqTool::triggerSnr() const
+{
+    return ui->trigSnrSpin->value();
+}
+
+/*! \brief Get the time to keep recording after a trigger has ended in seconds. */
+int CIqTool::triggerHold() const
+{
+    return ui->trigHoldSpin->value();
+}
+
+/*! \brief Update the trigger button to show whether a pre-trigger
+ *         recording is in progress.
+ */
+void CIqTool::setTriggerStatus(bool committing)
+{
+    if (committing && !is_committing)
+        ui->recStatsLabel->clear();
+
+    is_committing = committing;
+    ui->trigButton->setChecked(committing);
+}
+
+/*! \brief Get the selected playback speed, 0 for as fast as possible. */
+double CIqTool::playbackSpeed() const
+{
+    static const double speeds[] = {0.1, 0.25, 0.5, 1.0, 2.0, 4.0, 10.0, 0.0};
+    int index = ui->speedCombo->currentIndex();
+
+    if (index < 0 || index >= (int)(sizeof(speeds) / sizeof(speeds[0])))
+        return 1.0;
+
+    return speeds[index];
+}
+
+/*! \brief Update the slider with the playback position.
+ *  \param seconds The position in the file reported by the receiver.
+ */
+void CIqTool::setPlaybackPosition(double seconds)
+{
+    if (!is_playing || ui->slider->isSliderDown())
+        return;
+
+    ui->slider->blockSignals(true);
+    ui->slider->setValue((int)seconds);
+    ui->slider->blockSignals(false);
+    refreshTimeWidgets();
+    ui->timeline->setPosition(seconds);
+}
+
+/*! \brief Playback speed changed. */
+void CIqTool::on_speedCombo_currentIndexChanged(int index)
+{
+    Q_UNUSED(index);
+    emit newPlaybackSpeed(playbackSpeed());
+}
+
+/*! \brief Pre-trigger history changed. */
+void CIqTool::on_preTrigSpin_valueChanged(int value)
+{
+    ui->trigButton->setEnabled(value > 0);
+    emit newPreTrigger(value);
+}
+
+/*! \brief Trigger button clicked. */
+void CIqTool::on_trigButton_clicked(bool checked)
+{
+    // the button state follows the receiver, see setTriggerStatus()
+    ui->trigButton->setChecked(is_committing);
+    emit triggerRecording(checked);
+}
+
 /*! \brief Slot activated when the user selects a file. */
 void CIqTool::on_listWidget_currentTextChanged(const QString &currentText)
 {
@@ -93,10 +215,11 @@ void CIqTool::on_listWidget_currentTextChanged(const QString &currentText)
 
     // Get duration of selected recording and update label
     sample_rate = sampleRateFromFileName(currentText);
+    bytes_per_sample = bytesPerSampleFromFileName(currentText);
     rec_len = (int)(info.size() / (sample_rate * bytes_per_sample));
 
     refreshTimeWidgets();
-
+    loadOverview(false);
 }
 
 /*! \brief Start/stop playback */
@@ -128,6 +251,10 @@ void CIqTool::on_playButton_clicked(bool checked)
             ui->recButton->setEnabled(false);
             emit startPlayback(recdir->absoluteFilePath(current_file),
                                (float)sample_rate);
+
+            // start from the position selected on the timeline
+            if (ui->slider->value() > 0)
+                emit seek((qint64)ui->slider->value() * sample_rate);
         }
     }
     else
@@ -154,7 +281,7 @@ void CIqTool::cancelPlayback()
 }
 
 
-/*! \brief Plot waveform. */
+/*! \brief Rebuild the overview of the selected recording. */
 void CIqTool::on_plotButton_clicked()
 {
     if (current_file.isEmpty())
@@ -174,61 +301,158 @@ void CIqTool::on_plotButton_clicked()
         return;
     }
 
-    QFile *file = new QFile(recdir->filePath(current_file));
-    if (!file->open(QIODevice::ReadOnly))
+    loadOverview(true);
+}
+
+/*! \brief Show the overview of the selected recording.
+ *  \param rebuild Ignore the cached index and rebuild the overview.
+ *
+ * The overview is loaded from the index file next to the recording when it
+ * is up to date. Otherwise it is built in the background and shown by
+ * timeoutFunction() when done.
+ */
+void CIqTool::loadOverview(bool rebuild)
+{
+    iq_file_index index;
+
+    indexer.cancel();
+    is_indexing = false;
+
+    if (current_file.isEmpty())
     {
+        ui->timeline->clearOverview();
         return;
     }
 
-    // number of data points with 1 point / second
-    int num_points = rec_len / plot_spp;
-    int chunk_size = sample_rate / plot_spp * bytes_per_sample;
+    QFileInfo info(*recdir, current_file);
+    std::string filename = info.absoluteFilePath().toStdString();
 
-    char *readbuf = (char*)malloc(chunk_size);
-    struct iqt_cplx *cplxbuf = (iqt_cplx *)readbuf;  // FIXME: We assume gr_complex
+    if (!rebuild && load_iq_file_index(filename, index))
+    {
+        showOverview(index);
+        return;
+    }
 
-    qDebug() << "*** NUM POINTS:" << num_points;
-    qDebug() << "*** CHUNK SIZE:" << chunk_size;
+    // the file is indexed when it is no longer being written
+    if (info.lastModified().secsTo(QDateTime::currentDateTime()) < 2)
+    {
+        ui->timeline->clearOverview(tr("Recording"));
+        return;
+    }
 
-    for (int i = 0; i < num_points; i++)
+    if (!indexer.start(filename, sample_rate))
     {
-        // read data chunk
-        if (!file->seek(i * chunk_size))
+        ui->timeline->clearOverview(tr("No overview available"));
+        return;
+    }
+
+    is_indexing = true;
+    ui->timeline->clearOverview(tr("Building overview..."));
+}
+
+/*! \brief Convert the spectrum of an index to an image with one column per
+ *         time slice and the highest frequency at the top.
+ */
+static QImage overviewImage(const iq_file_index &index)
+{
+    QImage  image(index.num_slices, index.num_bins, QImage::Format_RGB32);
+    std::vector<float> sorted(index.spectrum);
+    float   floor, peak, val;
+
+    // from the noise floor to the strongest signal
+    std::sort(sorted.begin(), sorted.end());
+    floor = sorted[sorted.size() / 10];
+    peak = qMax(sorted.back(), floor + 20.f);
+
+    for (unsigned int t = 0; t < index.num_slices; t++)
+    {
+        const float *spectrum = &index.spectrum[t * index.num_bins];
+
+        for (unsigned int f = 0; f < index.num_bins; f++)
         {
-            continue;
+            val = qBound(0.f, (spectrum[f] - floor) / (peak - floor), 1.f);
+            image.setPixel(t, index.num_bins - 1 - f,
+                           QColor::fromHsvF(0.67 * (1.0 - val), 1.0,
+                                            0.2 + 0.8 * val).rgb());
         }
+    }
+
+    return image;
+}
 
-        qint64 read = file->read(readbuf, chunk_size);
+/*! \brief Show an overview on the timeline and use it as thumbnail. */
+void CIqTool::showOverview(const iq_file_index &index)
+{
+    QImage image = overviewImage(index);
+    QVector<float> power(index.power.size());
 
-        // calculate average and max
-        float val, avg=0.0, max=0.0;
-        for (int j = 0; j < read/bytes_per_sample; j++)
+    std::copy(index.power.begin(), index.power.end(), power.begin());
+    ui->timeline->setOverview(image, power, index.num_slices * index.slice_len);
+
+    // the index has the sample rate from the metadata, if any
+    if ((int)index.sample_rate != sample_rate && index.sample_rate > 0.0)
+        setSampleRate((qint64)index.sample_rate);
+
+    thumbnails[recdir->absoluteFilePath(current_file)] = QIcon(QPixmap::fromImage(
+            image.scaled(ui->listWidget->iconSize(), Qt::IgnoreAspectRatio,
+                         Qt::SmoothTransformation)));
+    updateThumbnails();
+}
+
+/*! \brief Show the overview thumbnails of indexed files in the list. */
+void CIqTool::updateThumbnails(void)
+{
+    iq_file_index index;
+
+    for (int i = 0; i < ui->listWidget->count(); i++)
+    {
+        QListWidgetItem *item = ui->listWidget->item(i);
+        QString name = recdir->absoluteFilePath(item->text());
+
+        // each file is checked once; new indexes are added by showOverview()
+        if (!thumbnails.contains(name))
         {
-            val = fabs(cplxbuf[j].re);
-            avg += val;
-            if (val > max)
-                max = val;
-        }
-        avg /= read/bytes_per_sample;
+            QIcon icon;
 
-        qDebug() << i << "   AVG:" << avg << "  MAX:" << max;
+            if (load_iq_file_index(name.toStdString(), index))
+            {
+                icon = QIcon(QPixmap::fromImage(
+                        overviewImage(index).scaled(ui->listWidget->iconSize(),
+                                                    Qt::IgnoreAspectRatio,
+                                                    Qt::SmoothTransformation)));
+            }
+            thumbnails[name] = icon;
+        }
 
-        // store data in plot buffer
+        item->setIcon(thumbnails[name]);
     }
+}
 
-    // plot data
-
-    // clean up
-    file->close();
-    delete file;
+/*! \brief The user has clicked on the timeline.
+ *
+ * Jumps to the selected time and, during playback, tunes the channel to
+ * the selected frequency.
+ */
+void CIqTool::on_timeline_positionSelected(double seconds, double offset)
+{
+    ui->slider->blockSignals(true);
+    ui->slider->setValue((int)seconds);
+    ui->slider->blockSignals(false);
+    refreshTimeWidgets();
+    ui->timeline->setPosition(seconds);
 
-    free(readbuf);
+    if (is_playing)
+    {
+        emit seek((qint64)(seconds * sample_rate));
+        emit newFilterOffset((qint64)(offset * sample_rate));
+    }
 }
 
 /*! \brief Slider value (seek position) has changed. */
 void CIqTool::on_slider_valueChanged(int value)
 {
     refreshTimeWidgets();
+    ui->timeline->setPosition(value);
 
     qint64 seek_pos = (qint64)(value)*sample_rate;
     emit seek(seek_pos);
@@ -244,7 +468,8 @@ void CIqTool::on_recButton_clicked(bool checked)
     {
         ui->playButton->setEnabled(false);
         //ui->plotButton->setEnabled(false);
-        emit startRecording(recdir->path());
+        ui->recStatsLabel->clear();
+        emit startRecording(recdir->path(), ui->formatCombo->currentIndex());
 
         refreshDir();
         ui->listWidget->setCurrentRow(ui->listWidget->count()-1);
@@ -268,6 +493,7 @@ void CIqTool::on_recButton_clicked(bool checked)
 void CIqTool::cancelRecording()
 {
     ui->recButton->setChecked(false);
+    ui->recStatsLabel->clear();
     ui->playButton->setEnabled(true);
     is_recording = false;
 }
@@ -307,6 +533,35 @@ void CIqTool::saveSettings(QSettings *settings)
     else
         settings->remove("baseband/rec_dir");
 
+    if (ui->formatCombo->currentIndex() != 0)
+        settings->setValue("baseband/rec_format", ui->formatCombo->currentIndex());
+    else
+        settings->remove("baseband/rec_format");
+
+    if (ui->preTrigSpin->value() > 0)
+        settings->setValue("baseband/pretrigger", ui->preTrigSpin->value());
+    else
+        settings->remove("baseband/pretrigger");
+
+    if (ui->trigModeCombo->currentIndex() != TRIGGER_MANUAL)
+        settings->setValue("baseband/trigger_mode", ui->trigModeCombo->currentIndex());
+    else
+        settings->remove("baseband/trigger_mode");
+
+    if (ui->trigSnrSpin->value() != 10.0)
+        settings->setValue("baseband/trigger_snr", ui->trigSnrSpin->value());
+    else
+        settings->remove("baseband/trigger_snr");
+
+    if (ui->trigHoldSpin->value() != 2)
+        settings->setValue("baseband/trigger_hold", ui->trigHoldSpin->value());
+    else
+        settings->remove("baseband/trigger_hold");
+
+    if (ui->speedCombo->currentIndex() != 3)
+        settings->setValue("baseband/play_speed", ui->speedCombo->currentIndex());
+    else
+        settings->remove("baseband/play_speed");
 }
 
 void CIqTool::readSettings(QSettings *settings)
@@ -317,6 +572,27 @@ void CIqTool::readSettings(QSettings *settings)
     // Location of baseband recordings
     QString dir = settings->value("baseband/rec_dir", QDir::homePath()).toString();
     ui->recDirEdit->setText(dir);
+
+    int format = settings->value("baseband/rec_format", 0).toInt();
+    if (format >= 0 && format < ui->formatCombo->count())
+        ui->formatCombo->setCurrentIndex(format);
+
+    int mode = settings->value("baseband/trigger_mode", TRIGGER_MANUAL).toInt();
+    if (mode >= 0 && mode < ui->trigModeCombo->count())
+        ui->trigModeCombo->setCurrentIndex(mode);
+    ui->trigSnrSpin->setValue(settings->value("baseband/trigger_snr", 10.0).toDouble());
+    ui->trigHoldSpin->setValue(settings->value("baseband/trigger_hold", 2).toInt());
+
+    int speed = settings->value("baseband/play_speed", 3).toInt();
+    if (speed >= 0 && speed < ui->speedCombo->count())
+        ui->speedCombo->setCurrentIndex(speed);
+
+    // always emitted so that the receiver is configured
+    int pretrig = settings->value("baseband/pretrigger", 0).toInt();
+    ui->preTrigSpin->blockSignals(true);
+    ui->preTrigSpin->setValue(pretrig);
+    ui->preTrigSpin->blockSignals(false);
+    on_preTrigSpin_valueChanged(pretrig);
 }
 
 
@@ -356,20 +632,30 @@ void CIqTool::timeoutFunction(void)
 {
     refreshDir();
 
-    if (is_playing)
+    // the playback position is updated by setPlaybackPosition()
+    if (is_recording)
+        refreshTimeWidgets();
+
+    if (is_indexing)
     {
-        // advance slider with one second
-        int val = ui->slider->value();
-        if (val < ui->slider->maximum())
+        iq_file_index index;
+
+        if (indexer.is_running())
+        {
+            ui->timeline->clearOverview(tr("Building overview %1%")
+                                        .arg((int)(100.f * indexer.get_progress())));
+        }
+        else if (indexer.get_index(index))
+        {
+            is_indexing = false;
+            showOverview(index);
+        }
+        else
         {
-            ui->slider->blockSignals(true);
-            ui->slider->setValue(val+1);
-            ui->slider->blockSignals(false);
-            refreshTimeWidgets();
+            is_indexing = false;
+            ui->timeline->clearOverview(tr("No overview available"));
         }
     }
-    if (is_recording)
-        refreshTimeWidgets();
 }
 
 /*! \brief Refresh list of files in current working directory. */
@@ -385,6 +671,7 @@ void CIqTool::refreshDir()
     ui->listWidget->insertItems(0, files);
     ui->listWidget->setCurrentRow(selection);
     ui->listWidget->blockSignals(false);
+    updateThumbnails();
 
     if (is_recording)
     {
@@ -448,3 +735,14 @@ qint64 CIqTool::sampleRateFromFileName(const QString &filename)
     else
         return sample_rate;  // return current rate
 }
+
+/*! \brief Get the sample size from the file name extension. */
+int CIqTool::bytesPerSampleFromFileName(const QString &filename)
+{
+    if (filename.endsWith(".cs16"))
+        return 4;
+    else if (filename.endsWith(".cs8"))
+        return 2;
+    else
+        return 8;
+}
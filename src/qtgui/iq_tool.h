@@ -26,24 +26,21 @@
 #include <QCloseEvent>
 #include <QDialog>
 #include <QDir>
+#include <QHash>
+#include <QIcon>
 #include <QPalette>
 #include <QSettings>
 #include <QShowEvent>
 #include <QString>
 #include <QTimer>
 
+#include "interfaces/iq_file_index.h"
+
 namespace Ui {
     class CIqTool;
 }
 
 
-struct iqt_cplx
-{
-    float re;
-    float im;
-};
-
-
 /*! \brief User interface for I/Q recording and playback. */
 class CIqTool : public QDialog
 {
@@ -54,6 +51,24 @@ public:
     ~CIqTool();
 
     void setSampleRate(qint64 sr);
+    void setRecordingStats(double throughput, int headroom, qint64 dropped,
+                           bool error);
+
+    /*! \brief Pre-trigger recording modes. */
+    enum trigger_mode {
+        TRIGGER_MANUAL   = 0,   /*!< Trigger button or remote control. */
+        TRIGGER_SQUELCH  = 1,   /*!< Squelch open. */
+        TRIGGER_ACTIVITY = 2    /*!< SNR above threshold. */
+    };
+
+    QString recDir() const;
+    int recFormat() const;
+    int triggerMode() const;
+    double triggerSnr() const;
+    int triggerHold() const;
+    void setTriggerStatus(bool committing);
+    double playbackSpeed() const;
+    void setPlaybackPosition(double seconds);
     
     void closeEvent(QCloseEvent *event);
     void showEvent(QShowEvent * event);
@@ -62,11 +77,15 @@ public:
     void readSettings(QSettings *settings);
 
 signals:
-    void startRecording(const QString recdir);
+    void startRecording(const QString recdir, int format);
+    void newPreTrigger(int seconds);
+    void triggerRecording(bool start);
     void stopRecording();
     void startPlayback(const QString filename, float samprate);
     void stopPlayback();
     void seek(qint64 seek_pos);
+    void newPlaybackSpeed(double speed);
+    void newFilterOffset(qint64 offset);
 
 public slots:
     void cancelRecording();
@@ -77,8 +96,12 @@ private slots:
     void on_recDirButton_clicked();
     void on_recButton_clicked(bool checked);
     void on_playButton_clicked(bool checked);
+    void on_preTrigSpin_valueChanged(int value);
+    void on_trigButton_clicked(bool checked);
     void on_plotButton_clicked();
     void on_slider_valueChanged(int value);
+    void on_speedCombo_currentIndexChanged(int index);
+    void on_timeline_positionSelected(double seconds, double offset);
     void on_listWidget_currentTextChanged(const QString &currentText);
     void timeoutFunction(void);
 
@@ -86,6 +109,10 @@ private:
     void refreshDir(void);
     void refreshTimeWidgets(void);
     qint64 sampleRateFromFileName(const QString &filename);
+    int bytesPerSampleFromFileName(const QString &filename);
+    void loadOverview(bool rebuild);
+    void showOverview(const iq_file_index &index);
+    void updateThumbnails(void);
 
 
 private:
@@ -95,14 +122,18 @@ private:
     QTimer      *timer;
     QPalette    *error_palette; /*!< Palette used to indicate an error. */
 
+    iq_file_indexer         indexer;    /*!< Builds overviews in the background. */
+    QHash<QString, QIcon>   thumbnails; /*!< Overview icons by file path. */
+
     QString current_file;      /*!< Selected file in file browser. */
 
     bool    is_recording;
+    bool    is_committing;     /*!< Pre-trigger recording in progress. */
     bool    is_playing;
-    int     bytes_per_sample;  /*!< Bytes per sample (fc = 4) */
+    bool    is_indexing;       /*!< Overview of the selected file being built. */
+    int     bytes_per_sample;  /*!< Bytes per sample (fc = 8, cs16 = 4, cs8 = 2) */
     int     sample_rate;       /*!< Current sample rate. */
     int     rec_len;           /*!< Length of a recording in seconds */
-    int     plot_spp;          /*!< [seconds / datapoint] */
 };
 
 #endif // IQ_TOOL_H
@@ -0,0 +1,144 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include "scan_options.h"
+#include "ui_scan_options.h"
+
+CScanOptions::CScanOptions(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::CScanOptions)
+{
+    ui->setupUi(this);
+}
+
+CScanOptions::~CScanOptions()
+{
+    delete ui;
+}
+
+/*! \brief Catch window close events.
+ *
+ * This method is called when the user closes the dialog window using the
+ * window close icon. We catch the event and hide the dialog but keep it
+ * around for later use.
+ */
+void CScanOptions::closeEvent(QCloseEvent *event)
+{
+    hide();
+    event->ignore();
+}
+
+void CScanOptions::setSettleTime(int settle_ms)
+{
+    ui->settleSpinBox->setValue(settle_ms);
+}
+
+int CScanOptions::settleTime() const
+{
+    return ui->settleSpinBox->value();
+}
+
+void CScanOptions::setRetuneTime(int retune_ms)
+{
+    ui->retuneSpinBox->setValue(retune_ms);
+}
+
+int CScanOptions::retuneTime() const
+{
+    return ui->retuneSpinBox->value();
+}
+
+void CScanOptions::setDwellTime(double dwell_s)
+{
+    ui->dwellSpinBox->setValue(dwell_s);
+}
+
+double CScanOptions::dwellTime() const
+{
+    return ui->dwellSpinBox->value();
+}
+
+void CScanOptions::setHangTime(double hang_s)
+{
+    ui->hangSpinBox->setValue(hang_s);
+}
+
+double CScanOptions::hangTime() const
+{
+    return ui->hangSpinBox->value();
+}
+
+void CScanOptions::setPriorityTag(const QString &tag)
+{
+    ui->priorityTagEdit->setText(tag);
+    emit optionsChanged();
+}
+
+QString CScanOptions::priorityTag() const
+{
+    return ui->priorityTagEdit->text().trimmed();
+}
+
+void CScanOptions::setPriorityInterval(double interval_s)
+{
+    ui->priorityIntervalSpinBox->setValue(interval_s);
+}
+
+double CScanOptions::priorityInterval() const
+{
+    return ui->priorityIntervalSpinBox->value();
+}
+
+void CScanOptions::on_settleSpinBox_valueChanged(int val)
+{
+    Q_UNUSED(val);
+    emit optionsChanged();
+}
+
+void CScanOptions::on_retuneSpinBox_valueChanged(int val)
+{
+    Q_UNUSED(val);
+    emit optionsChanged();
+}
+
+void CScanOptions::on_dwellSpinBox_valueChanged(double val)
+{
+    Q_UNUSED(val);
+    emit optionsChanged();
+}
+
+void CScanOptions::on_hangSpinBox_valueChanged(double val)
+{
+    Q_UNUSED(val);
+    emit optionsChanged();
+}
+
+void CScanOptions::on_priorityTagEdit_editingFinished()
+{
+    emit optionsChanged();
+}
+
+void CScanOptions::on_priorityIntervalSpinBox_valueChanged(double val)
+{
+    Q_UNUSED(val);
+    emit optionsChanged();
+}
@@ -0,0 +1,79 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef SCAN_OPTIONS_H
+#define SCAN_OPTIONS_H
+
+#include <QDialog>
+#include <QCloseEvent>
+#include <QString>
+
+namespace Ui {
+class CScanOptions;
+}
+
+/*! \brief Bookmark scanner options dialog (timing and priority channels). */
+class CScanOptions : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit CScanOptions(QWidget *parent = 0);
+    ~CScanOptions();
+
+    void closeEvent(QCloseEvent *event);
+
+    void setSettleTime(int settle_ms);
+    int  settleTime() const;
+
+    void setRetuneTime(int retune_ms);
+    int  retuneTime() const;
+
+    void setDwellTime(double dwell_s);
+    double dwellTime() const;
+
+    void setHangTime(double hang_s);
+    double hangTime() const;
+
+    void setPriorityTag(const QString &tag);
+    QString priorityTag() const;
+
+    void setPriorityInterval(double interval_s);
+    double priorityInterval() const;
+
+signals:
+    /*! \brief One of the options has been changed. */
+    void optionsChanged();
+
+private slots:
+    void on_settleSpinBox_valueChanged(int val);
+    void on_retuneSpinBox_valueChanged(int val);
+    void on_dwellSpinBox_valueChanged(double val);
+    void on_hangSpinBox_valueChanged(double val);
+    void on_priorityTagEdit_editingFinished();
+    void on_priorityIntervalSpinBox_valueChanged(double val);
+
+private:
+    Ui::CScanOptions *ui;
+};
+
+#endif // SCAN_OPTIONS_H
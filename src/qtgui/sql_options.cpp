@@ -0,0 +1,93 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2013 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include "sql_options.h"
+#include "ui_sql_options.h"
+
+CSqlOptions::CSqlOptions(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::CSqlOptions)
+{
+    ui->setupUi(this);
+}
+
+CSqlOptions::~CSqlOptions()
+{
+    delete ui;
+}
+
+/*! \brief Catch window close events.
+ *
+ * This method is called when the user closes the dialog window using the
+ * window close icon. We catch the event and hide the dialog but keep it
+ * around for later use.
+ */
+void CSqlOptions::closeEvent(QCloseEvent *event)
+{
+    hide();
+    event->ignore();
+}
+
+void CSqlOptions::setAttack(double attack_ms)
+{
+    ui->attackSpinBox->setValue(attack_ms);
+}
+
+double CSqlOptions::attack() const
+{
+    return ui->attackSpinBox->value();
+}
+
+void CSqlOptions::setHang(double hang_ms)
+{
+    ui->hangSpinBox->setValue(hang_ms);
+}
+
+double CSqlOptions::hang() const
+{
+    return ui->hangSpinBox->value();
+}
+
+void CSqlOptions::setGate(bool gate)
+{
+    ui->gateCheckBox->setChecked(gate);
+}
+
+bool CSqlOptions::gate() const
+{
+    return ui->gateCheckBox->isChecked();
+}
+
+void CSqlOptions::on_attackSpinBox_valueChanged(double val)
+{
+    emit attackChanged(val);
+}
+
+void CSqlOptions::on_hangSpinBox_valueChanged(double val)
+{
+    emit hangChanged(val);
+}
+
+void CSqlOptions::on_gateCheckBox_toggled(bool checked)
+{
+    emit gateToggled(checked);
+}
@@ -0,0 +1,67 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2013 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef SQL_OPTIONS_H
+#define SQL_OPTIONS_H
+
+#include <QDialog>
+#include <QCloseEvent>
+
+namespace Ui {
+class CSqlOptions;
+}
+
+/*! \brief Squelch options dialog (attack, hang and gating). */
+class CSqlOptions : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit CSqlOptions(QWidget *parent = 0);
+    ~CSqlOptions();
+
+    void closeEvent(QCloseEvent *event);
+
+    void setAttack(double attack_ms);
+    double attack() const;
+
+    void setHang(double hang_ms);
+    double hang() const;
+
+    void setGate(bool gate);
+    bool gate() const;
+
+signals:
+    void attackChanged(double attack_ms);
+    void hangChanged(double hang_ms);
+    void gateToggled(bool gate);
+
+private slots:
+    void on_attackSpinBox_valueChanged(double val);
+    void on_hangSpinBox_valueChanged(double val);
+    void on_gateCheckBox_toggled(bool checked);
+
+private:
+    Ui::CSqlOptions *ui;
+};
+
+#endif // SQL_OPTIONS_H
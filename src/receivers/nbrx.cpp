@@ -44,12 +44,13 @@ nbrx::nbrx(float quad_rate, float audio_rate)
     nb = make_rx_nb_cc(PREF_QUAD_RATE, 3.3, 2.5);
     filter = make_rx_filter(PREF_QUAD_RATE, -5000.0, 5000.0, 1000.0);
     agc = make_rx_agc_cc(PREF_QUAD_RATE, true, -100, 0, 0, 500, false);
-    sql = gr::analog::simple_squelch_cc::make(-150.0, 0.001);
+    sql = make_rx_sql_cc(PREF_QUAD_RATE, -150.0, 0.001);
     meter = make_rx_meter_c(DETECTOR_TYPE_RMS);
     demod_raw = gr::blocks::complex_to_float::make(1);
     demod_ssb = gr::blocks::complex_to_real::make(1);
     demod_fm = make_rx_demod_fm(PREF_QUAD_RATE, 5000.0, 75.0e-6);
     demod_am = make_rx_demod_am(PREF_QUAD_RATE, true);
+    tone_sql = make_rx_tone_sql_ff(PREF_QUAD_RATE);
 
     audio_rr.reset();
     if (d_audio_rate != PREF_QUAD_RATE)
@@ -60,6 +61,7 @@ nbrx::nbrx(float quad_rate, float audio_rate)
     }
 
     demod = demod_fm;
+    demod_out = tone_sql;
     connect(self(), 0, iq_resamp, 0);
     connect(iq_resamp, 0, nb, 0);
     connect(nb, 0, filter, 0);
@@ -67,17 +69,18 @@ nbrx::nbrx(float quad_rate, float audio_rate)
     connect(filter, 0, sql, 0);
     connect(sql, 0, agc, 0);
     connect(agc, 0, demod, 0);
+    connect(demod_fm, 0, tone_sql, 0);
 
     if (audio_rr)
     {
-        connect(demod, 0, audio_rr, 0);
+        connect(demod_out, 0, audio_rr, 0);
         connect(audio_rr, 0, self(), 0); // left  channel
         connect(audio_rr, 0, self(), 1); // right channel
     }
     else
     {
-        connect(demod, 0, self(), 0);
-        connect(demod, 0, self(), 1);
+        connect(demod_out, 0, self(), 0);
+        connect(demod_out, 0, self(), 1);
     }
 
 }
@@ -135,6 +138,11 @@ float nbrx::get_signal_level(bool dbfs)
 
 }
 
+void nbrx::get_signal_levels(rx_meter_levels &levels)
+{
+    meter->get_levels(levels);
+}
+
 void nbrx::set_nb_on(int nbid, bool on)
 {
     if (nbid == 1)
@@ -161,6 +169,61 @@ void nbrx::set_sql_alpha(double alpha)
     sql->set_alpha(alpha);
 }
 
+void nbrx::set_sql_attack(double attack_ms)
+{
+    sql->set_attack(attack_ms);
+}
+
+void nbrx::set_sql_hang(double hang_ms)
+{
+    sql->set_hang(hang_ms);
+}
+
+void nbrx::set_sql_gate(bool gate)
+{
+    sql->set_gate(gate);
+}
+
+float nbrx::get_sql_duty_cycle()
+{
+    return sql->get_duty_cycle();
+}
+
+bool nbrx::get_sql_open()
+{
+    return sql->is_open();
+}
+
+bool nbrx::get_sql_signal()
+{
+    return sql->has_signal();
+}
+
+void nbrx::reset_sql_power()
+{
+    sql->reset_power();
+}
+
+void nbrx::set_ctcss(float tone_hz)
+{
+    tone_sql->set_ctcss(tone_hz);
+}
+
+bool nbrx::set_dcs(int code)
+{
+    return tone_sql->set_dcs(code);
+}
+
+bool nbrx::get_tone_sql_open()
+{
+    return tone_sql->is_open();
+}
+
+float nbrx::get_ctcss_detected()
+{
+    return tone_sql->get_detected_tone();
+}
+
 void nbrx::set_agc_on(bool agc_on)
 {
     agc->set_agc_on(agc_on);
@@ -205,12 +268,19 @@ void nbrx::set_demod(int rx_demod)
     }
 
     disconnect(agc, 0, demod, 0);
+    if (current_demod == NBRX_DEMOD_FM)
+        disconnect(demod_fm, 0, tone_sql, 0);
     if (audio_rr)
-        disconnect(demod, 0, audio_rr, 0);
+        disconnect(demod_out, 0, audio_rr, 0);
+    else if (current_demod == NBRX_DEMOD_NONE)
+    {
+        disconnect(demod_out, 0, self(), 0);
+        disconnect(demod_out, 1, self(), 1);
+    }
     else
     {
-        disconnect(demod, 0, self(), 0);
-        disconnect(demod, 0, self(), 1);
+        disconnect(demod_out, 0, self(), 0);
+        disconnect(demod_out, 0, self(), 1);
     }
 
     switch (rx_demod) {
@@ -238,20 +308,30 @@ void nbrx::set_demod(int rx_demod)
     }
 
     connect(agc, 0, demod, 0);
+    if (d_demod == NBRX_DEMOD_FM)
+    {
+        connect(demod_fm, 0, tone_sql, 0);
+        demod_out = tone_sql;
+    }
+    else
+    {
+        demod_out = demod;
+    }
+
     if (audio_rr)
     {
         // FIXME: DEMOD_NONE has two outputs.
-        connect(demod, 0, audio_rr, 0);
+        connect(demod_out, 0, audio_rr, 0);
     }
     else if (d_demod == NBRX_DEMOD_NONE)
     {
-        connect(demod, 0, self(), 0);
-        connect(demod, 1, self(), 1);
+        connect(demod_out, 0, self(), 0);
+        connect(demod_out, 1, self(), 1);
     }
     else
     {
-        connect(demod, 0, self(), 0);
-        connect(demod, 0, self(), 1);
+        connect(demod_out, 0, self(), 0);
+        connect(demod_out, 0, self(), 1);
     }
 
 }
@@ -270,3 +350,18 @@ void nbrx::set_am_dcr(bool enabled)
 {
     demod_am->set_dcr(enabled);
 }
+
+double nbrx::get_filter_tap_rate()
+{
+    return PREF_QUAD_RATE;
+}
+
+void nbrx::connect_filter_tap(gr::basic_block_sptr tap)
+{
+    connect(filter, 0, tap, 0);
+}
+
+void nbrx::disconnect_filter_tap(gr::basic_block_sptr tap)
+{
+    disconnect(filter, 0, tap, 0);
+}
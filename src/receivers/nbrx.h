@@ -23,7 +23,6 @@
 #ifndef NBRX_H
 #define NBRX_H
 
-#include <gnuradio/analog/simple_squelch_cc.h>
 #include <gnuradio/basic_block.h>
 #include <gnuradio/blocks/complex_to_float.h>
 #include <gnuradio/blocks/complex_to_real.h>
@@ -31,6 +30,8 @@
 #include "dsp/rx_noise_blanker_cc.h"
 #include "dsp/rx_filter.h"
 #include "dsp/rx_meter.h"
+#include "dsp/rx_squelch.h"
+#include "dsp/rx_tone_sql.h"
 #include "dsp/rx_agc_xx.h"
 #include "dsp/rx_demod_fm.h"
 #include "dsp/rx_demod_am.h"
@@ -75,6 +76,7 @@ public:
     void set_cw_offset(double offset);
 
     float get_signal_level(bool dbfs);
+    void get_signal_levels(rx_meter_levels &levels);
 
     /* Noise blanker */
     bool has_nb() { return true; }
@@ -85,6 +87,20 @@ public:
     bool has_sql() { return true; }
     void set_sql_level(double level_db);
     void set_sql_alpha(double alpha);
+    void set_sql_attack(double attack_ms);
+    void set_sql_hang(double hang_ms);
+    void set_sql_gate(bool gate);
+    float get_sql_duty_cycle();
+    bool get_sql_open();
+    bool get_sql_signal();
+    void reset_sql_power();
+
+    /* Tone squelch */
+    bool has_tone_sql() { return true; }
+    void set_ctcss(float tone_hz);
+    bool set_dcs(int code);
+    bool get_tone_sql_open();
+    float get_ctcss_detected();
 
     /* AGC */
     bool has_agc() { return true; }
@@ -106,6 +122,12 @@ public:
     bool has_am() { return true; }
     void set_am_dcr(bool enabled);
 
+    /* Data taps */
+    bool has_filter_tap() { return true; }
+    double get_filter_tap_rate();
+    void connect_filter_tap(gr::basic_block_sptr tap);
+    void disconnect_filter_tap(gr::basic_block_sptr tap);
+
 private:
     bool   d_running;          /*!< Whether receiver is running or not. */
     float  d_quad_rate;        /*!< Input sample rate. */
@@ -119,14 +141,16 @@ private:
     rx_nb_cc_sptr             nb;         /*!< Noise blanker. */
     rx_meter_c_sptr           meter;      /*!< Signal strength. */
     rx_agc_cc_sptr            agc;        /*!< Receiver AGC. */
-    gr::analog::simple_squelch_cc::sptr sql;        /*!< Squelch. */
+    rx_sql_cc_sptr            sql;        /*!< Squelch. */
     gr::blocks::complex_to_float::sptr  demod_raw;  /*!< Raw I/Q passthrough. */
     gr::blocks::complex_to_real::sptr   demod_ssb;  /*!< SSB demodulator. */
     rx_demod_fm_sptr          demod_fm;   /*!< FM demodulator. */
     rx_demod_am_sptr          demod_am;   /*!< AM demodulator. */
+    rx_tone_sql_ff_sptr       tone_sql;   /*!< CTCSS/DCS squelch (FM only). */
     resampler_ff_sptr         audio_rr;   /*!< Audio resampler. */
 
     gr::basic_block_sptr      demod;    // dummy pointer used for simplifying reconf
+    gr::basic_block_sptr      demod_out;  // last block before audio, tone_sql in FM
 };
 
 #endif // NBRX_H
@@ -74,6 +74,66 @@ void receiver_base_cf::set_sql_alpha(double alpha)
     (void) alpha;
 }
 
+void receiver_base_cf::set_sql_attack(double attack_ms)
+{
+    (void) attack_ms;
+}
+
+void receiver_base_cf::set_sql_hang(double hang_ms)
+{
+    (void) hang_ms;
+}
+
+void receiver_base_cf::set_sql_gate(bool gate)
+{
+    (void) gate;
+}
+
+float receiver_base_cf::get_sql_duty_cycle()
+{
+    return 1.0;
+}
+
+bool receiver_base_cf::get_sql_open()
+{
+    return true;
+}
+
+bool receiver_base_cf::get_sql_signal()
+{
+    return true;
+}
+
+void receiver_base_cf::reset_sql_power()
+{
+}
+
+bool receiver_base_cf::has_tone_sql()
+{
+    return false;
+}
+
+void receiver_base_cf::set_ctcss(float tone_hz)
+{
+    (void) tone_hz;
+}
+
+bool receiver_base_cf::set_dcs(int code)
+{
+    (void) code;
+    return false;
+}
+
+bool receiver_base_cf::get_tone_sql_open()
+{
+    return true;
+}
+
+float receiver_base_cf::get_ctcss_detected()
+{
+    return 0.0;
+}
+
 bool receiver_base_cf::has_agc()
 {
     return false;
@@ -156,3 +216,23 @@ bool receiver_base_cf::is_rds_decoder_active()
 {
     return false;
 }
+
+bool receiver_base_cf::has_filter_tap()
+{
+    return false;
+}
+
+double receiver_base_cf::get_filter_tap_rate()
+{
+    return 0.0;
+}
+
+void receiver_base_cf::connect_filter_tap(gr::basic_block_sptr tap)
+{
+    (void) tap;
+}
+
+void receiver_base_cf::disconnect_filter_tap(gr::basic_block_sptr tap)
+{
+    (void) tap;
+}
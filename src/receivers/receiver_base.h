@@ -24,6 +24,7 @@
 #define RECEIVER_BASE_H
 
 #include <gnuradio/hier_block2.h>
+#include "dsp/rx_meter.h"
 
 
 class receiver_base_cf;
@@ -58,6 +59,7 @@ public:
     virtual void set_cw_offset(double offset) = 0;
 
     virtual float get_signal_level(bool dbfs) = 0;
+    virtual void get_signal_levels(rx_meter_levels &levels) = 0;
 
     virtual void set_demod(int demod) = 0;
 
@@ -72,6 +74,20 @@ public:
     virtual bool has_sql();
     virtual void set_sql_level(double level_db);
     virtual void set_sql_alpha(double alpha);
+    virtual void set_sql_attack(double attack_ms);
+    virtual void set_sql_hang(double hang_ms);
+    virtual void set_sql_gate(bool gate);
+    virtual float get_sql_duty_cycle();
+    virtual bool get_sql_open();
+    virtual bool get_sql_signal();
+    virtual void reset_sql_power();
+
+    /* Tone squelch (CTCSS/DCS) */
+    virtual bool has_tone_sql();
+    virtual void set_ctcss(float tone_hz);
+    virtual bool set_dcs(int code);
+    virtual bool get_tone_sql_open();
+    virtual float get_ctcss_detected();
 
     /* AGC */
     virtual bool has_agc();
@@ -97,6 +113,12 @@ public:
     virtual void reset_rds_parser();
     virtual bool is_rds_decoder_active();
 
+    /* Data taps at the channel filter output */
+    virtual bool has_filter_tap();
+    virtual double get_filter_tap_rate();
+    virtual void connect_filter_tap(gr::basic_block_sptr tap);
+    virtual void disconnect_filter_tap(gr::basic_block_sptr tap);
+
 };
 
 #endif // RECEIVER_BASE_H
@@ -26,7 +26,6 @@
 #include "receivers/wfmrx.h"
 
 #define PREF_QUAD_RATE   240e3 // Nominal channel spacing is 200 kHz
-#define PREF_MIDLE_RATE  120e3 // Midle rate for stereo decoder
 
 wfmrx_sptr make_wfmrx(float quad_rate, float audio_rate)
 {
@@ -43,13 +42,13 @@ wfmrx::wfmrx(float quad_rate, float audio_rate)
     iq_resamp = make_resampler_cc(PREF_QUAD_RATE/d_quad_rate);
 
     filter = make_rx_filter(PREF_QUAD_RATE, -80000.0, 80000.0, 20000.0);
-    sql = gr::analog::simple_squelch_cc::make(-150.0, 0.001);
+    sql = make_rx_sql_cc(PREF_QUAD_RATE, -150.0, 0.001);
     meter = make_rx_meter_c(DETECTOR_TYPE_RMS);
-    demod_fm = make_rx_demod_fm(PREF_QUAD_RATE, 75000.0, 50.0e-6);
-    midle_rr = make_resampler_ff(PREF_MIDLE_RATE/PREF_QUAD_RATE);
-    stereo = make_stereo_demod(PREF_MIDLE_RATE, d_audio_rate, true);
-    stereo_oirt = make_stereo_demod(PREF_MIDLE_RATE, d_audio_rate, true, true);
-    mono   = make_stereo_demod(PREF_MIDLE_RATE, d_audio_rate, false);
+    /* de-emphasis is done in the stereo decoder after matrixing */
+    demod_fm = make_rx_demod_fm(PREF_QUAD_RATE, 75000.0, 0.0);
+    stereo = make_stereo_demod(PREF_QUAD_RATE, d_audio_rate, true);
+    stereo_oirt = make_stereo_demod(PREF_QUAD_RATE, d_audio_rate, true, true);
+    mono   = make_stereo_demod(PREF_QUAD_RATE, d_audio_rate, false);
 
     /* create rds blocks but dont connect them */
     rds = make_rx_rds(PREF_QUAD_RATE);
@@ -63,8 +62,7 @@ wfmrx::wfmrx(float quad_rate, float audio_rate)
     connect(filter, 0, meter, 0);
     connect(filter, 0, sql, 0);
     connect(sql, 0, demod_fm, 0);
-    connect(demod_fm, 0, midle_rr, 0);
-    connect(midle_rr, 0, mono, 0);
+    connect(demod_fm, 0, mono, 0);
     connect(mono, 0, self(), 0); // left  channel
     connect(mono, 1, self(), 1); // right channel
 }
@@ -121,6 +119,11 @@ float wfmrx::get_signal_level(bool dbfs)
 
 }
 
+void wfmrx::get_signal_levels(rx_meter_levels &levels)
+{
+    meter->get_levels(levels);
+}
+
 /*
 void nbrx::set_nb_on(int nbid, bool on)
 {
@@ -149,6 +152,41 @@ void wfmrx::set_sql_alpha(double alpha)
     sql->set_alpha(alpha);
 }
 
+void wfmrx::set_sql_attack(double attack_ms)
+{
+    sql->set_attack(attack_ms);
+}
+
+void wfmrx::set_sql_hang(double hang_ms)
+{
+    sql->set_hang(hang_ms);
+}
+
+void wfmrx::set_sql_gate(bool gate)
+{
+    sql->set_gate(gate);
+}
+
+float wfmrx::get_sql_duty_cycle()
+{
+    return sql->get_duty_cycle();
+}
+
+bool wfmrx::get_sql_open()
+{
+    return sql->is_open();
+}
+
+bool wfmrx::get_sql_signal()
+{
+    return sql->has_signal();
+}
+
+void wfmrx::reset_sql_power()
+{
+    sql->reset_power();
+}
+
 /*
 void nbrx::set_agc_on(bool agc_on)
 {
@@ -200,19 +238,19 @@ void wfmrx::set_demod(int demod)
 
     case WFMRX_DEMOD_MONO:
     default:
-        disconnect(midle_rr, 0, mono, 0);
+        disconnect(demod_fm, 0, mono, 0);
         disconnect(mono, 0, self(), 0); // left  channel
         disconnect(mono, 1, self(), 1); // right channel
         break;
 
     case WFMRX_DEMOD_STEREO:
-        disconnect(midle_rr, 0, stereo, 0);
+        disconnect(demod_fm, 0, stereo, 0);
         disconnect(stereo, 0, self(), 0); // left  channel
         disconnect(stereo, 1, self(), 1); // right channel
         break;
 
     case WFMRX_DEMOD_STEREO_UKW:
-        disconnect(midle_rr, 0, stereo_oirt, 0);
+        disconnect(demod_fm, 0, stereo_oirt, 0);
         disconnect(stereo_oirt, 0, self(), 0); // left  channel
         disconnect(stereo_oirt, 1, self(), 1); // right channel
         break;
@@ -222,19 +260,19 @@ void wfmrx::set_demod(int demod)
 
     case WFMRX_DEMOD_MONO:
     default:
-        connect(midle_rr, 0, mono, 0);
+        connect(demod_fm, 0, mono, 0);
         connect(mono, 0, self(), 0); // left  channel
         connect(mono, 1, self(), 1); // right channel
         break;
 
     case WFMRX_DEMOD_STEREO:
-        connect(midle_rr, 0, stereo, 0);
+        connect(demod_fm, 0, stereo, 0);
         connect(stereo, 0, self(), 0); // left  channel
         connect(stereo, 1, self(), 1); // right channel
         break;
 
     case WFMRX_DEMOD_STEREO_UKW:
-        connect(midle_rr, 0, stereo_oirt, 0);
+        connect(demod_fm, 0, stereo_oirt, 0);
         connect(stereo_oirt, 0, self(), 0); // left  channel
         connect(stereo_oirt, 1, self(), 1); // right channel
         break;
@@ -252,7 +290,9 @@ void wfmrx::set_fm_maxdev(float maxdev_hz)
 
 void wfmrx::set_fm_deemph(double tau)
 {
-    demod_fm->set_tau(tau);
+    mono->set_tau(tau);
+    stereo->set_tau(tau);
+    stereo_oirt->set_tau(tau);
 }
 
 void wfmrx::get_rds_data(std::string &outbuff, int &num)
@@ -289,3 +329,18 @@ bool wfmrx::is_rds_decoder_active()
 {
     return rds_enabled;
 }
+
+double wfmrx::get_filter_tap_rate()
+{
+    return PREF_QUAD_RATE;
+}
+
+void wfmrx::connect_filter_tap(gr::basic_block_sptr tap)
+{
+    connect(filter, 0, tap, 0);
+}
+
+void wfmrx::disconnect_filter_tap(gr::basic_block_sptr tap)
+{
+    disconnect(filter, 0, tap, 0);
+}
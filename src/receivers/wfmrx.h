@@ -24,11 +24,11 @@
 #ifndef WFMRX_H
 #define WFMRX_H
 
-#include <gnuradio/analog/simple_squelch_cc.h>
 #include "receivers/receiver_base.h"
 #include "dsp/rx_noise_blanker_cc.h"
 #include "dsp/rx_filter.h"
 #include "dsp/rx_meter.h"
+#include "dsp/rx_squelch.h"
 #include "dsp/rx_demod_fm.h"
 #include "dsp/stereo_demod.h"
 #include "dsp/resampler_xx.h"
@@ -72,6 +72,7 @@ public:
     void set_cw_offset(double offset) { (void)offset; }
 
     float get_signal_level(bool dbfs);
+    void get_signal_levels(rx_meter_levels &levels);
 
     /* Noise blanker */
     bool has_nb() { return false; }
@@ -82,6 +83,13 @@ public:
     bool has_sql() { return true; }
     void set_sql_level(double level_db);
     void set_sql_alpha(double alpha);
+    void set_sql_attack(double attack_ms);
+    void set_sql_hang(double hang_ms);
+    void set_sql_gate(bool gate);
+    float get_sql_duty_cycle();
+    bool get_sql_open();
+    bool get_sql_signal();
+    void reset_sql_power();
 
     /* AGC */
     bool has_agc() { return false; }
@@ -105,6 +113,12 @@ public:
     void reset_rds_parser();
     bool is_rds_decoder_active();
 
+    /* Data taps */
+    bool has_filter_tap() { return true; }
+    double get_filter_tap_rate();
+    void connect_filter_tap(gr::basic_block_sptr tap);
+    void disconnect_filter_tap(gr::basic_block_sptr tap);
+
 private:
     bool   d_running;          /*!< Whether receiver is running or not. */
     float  d_quad_rate;        /*!< Input sample rate. */
@@ -116,9 +130,8 @@ private:
     rx_filter_sptr            filter;    /*!< Non-translating bandpass filter.*/
 
     rx_meter_c_sptr           meter;     /*!< Signal strength. */
-    gr::analog::simple_squelch_cc::sptr sql;       /*!< Squelch. */
+    rx_sql_cc_sptr            sql;       /*!< Squelch. */
     rx_demod_fm_sptr          demod_fm;  /*!< FM demodulator. */
-    resampler_ff_sptr         midle_rr;  /*!< Resampler. */
     stereo_demod_sptr         stereo;    /*!< FM stereo demodulator. */
     stereo_demod_sptr         stereo_oirt;    /*!< FM stereo oirt demodulator. */
     stereo_demod_sptr         mono;      /*!< FM stereo demodulator OFF. */